@@ -96,6 +96,6 @@ void FrameBuffer::render(IG::Pixmap pix, TIA &tia)
 	}
 	else
 	{
-		pix.writeTransformed([this](uint8_t p){ return tiaColorMap16[p]; }, framePix);
+		pix.writeLookup(tiaColorMap16, framePix);
 	}
 }
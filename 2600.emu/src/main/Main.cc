@@ -48,6 +48,7 @@ Controller::Type autoDetectedInput1{};
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2011-2020\nRobert Broglia\nwww.explusalpha.com\n\nPortions (c) the\nStella Team\nstella-emu.github.io";
 bool EmuSystem::hasPALVideoSystem = true;
 bool EmuSystem::hasResetModes = true;
+EmuSystem::StateFileFormat EmuSystem::stateFileFormat = StateFileFormat::RAW;
 EmuSystem::NameFilterFunc EmuSystem::defaultFsFilter =
 	[](const char *name)
 	{
@@ -189,22 +190,23 @@ void EmuSystem::reset(ResetMode mode)
 	}
 }
 
-EmuSystem::Error EmuSystem::saveState(const char *path)
+EmuSystem::Error EmuSystem::saveStateToBuffer(std::vector<uint8_t> &buff)
 {
-	Serializer state(string(path), Serializer::Mode::ReadWrite);
+	Serializer state;
 	if(!osystem->state().saveState(state))
 	{
-		return makeFileWriteError();
+		return makeError("Error writing state to memory");
 	}
+	state.getData(buff);
 	return {};
 }
 
-EmuSystem::Error EmuSystem::loadState(const char *path)
+EmuSystem::Error EmuSystem::loadStateFromBuffer(IG::ConstBufferView buff)
 {
-	Serializer state(string(path), Serializer::Mode::ReadOnly);
+	Serializer state((const uInt8*)buff.data(), buff.size());
 	if(!osystem->state().loadState(state))
 	{
-		return makeFileReadError();
+		return makeError("Error reading state from memory");
 	}
 	updateSwitchValues();
 	return {};
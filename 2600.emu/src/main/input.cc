@@ -171,6 +171,19 @@ uint EmuSystem::translateInputAction(uint input, bool &turbo)
 	return 0;
 }
 
+bool EmuSystem::inputActionNeedsMainThread(uint emuKey)
+{
+	// console switches post a message
+	switch(emuKey & 0xFF)
+	{
+		case Event::Combo1:
+		case Event::Combo2:
+		case Event::Combo3:
+			return true;
+	}
+	return false;
+}
+
 void EmuSystem::handleInputAction(uint state, uint emuKey)
 {
 	auto &ev = osystem->eventHandler().event();
@@ -80,6 +80,19 @@ Serializer::Serializer()
   }
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Serializer::Serializer(const uInt8* data, size_t size)
+  : myStream(nullptr)
+{
+  myStream = make_unique<stringstream>(string(reinterpret_cast<const char*>(data), size),
+                                       ios::in | ios::out | ios::binary);
+  if(myStream)
+  {
+    myStream->exceptions( ios_base::failbit | ios_base::badbit | ios_base::eofbit );
+    rewind();
+  }
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Serializer::rewind()
 {
@@ -94,6 +107,16 @@ size_t Serializer::size() const
   return myStream->tellp();
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Serializer::getData(std::vector<uInt8>& data) const
+{
+  data.resize(size());
+  auto readPos = myStream->tellg();
+  myStream->seekg(0);
+  myStream->read(reinterpret_cast<char*>(data.data()), data.size());
+  myStream->seekg(readPos);
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt8 Serializer::getByte() const
 {
@@ -52,6 +52,12 @@ class Serializer
     Serializer(const string& filename, Mode m = Mode::ReadWrite);
     Serializer();
 
+    /**
+      Creates a new in-memory Serializer device initialized with a copy
+      of the given data, positioned at its beginning.
+    */
+    Serializer(const uInt8* data, size_t size);
+
   public:
     /**
       Answers whether the serializer is currently initialized for reading
@@ -69,6 +75,14 @@ class Serializer
     */
     size_t size() const;
 
+    /**
+      Copies everything written to the stream so far into the given vector,
+      replacing its contents.
+
+      @param data  The vector to store the bytes in
+    */
+    void getData(std::vector<uInt8>& data) const;
+
     /**
       Reads a byte value (unsigned 8-bit) from the current input stream.
 
@@ -78,6 +78,7 @@ ViceSystem currSystem = VICE_SYSTEM_C64;
 bool EmuSystem::hasPALVideoSystem = true;
 bool EmuSystem::hasResetModes = true;
 bool EmuSystem::handlesGenericIO = false;
+bool EmuSystem::hasDirectVideoRendering = true;
 
 const char *EmuSystem::shortSystemName()
 {
@@ -380,6 +381,9 @@ static void saveSnapshotTrap(uint16_t, void *data)
 		snapData->hasError = false;
 }
 
+// VICE snapshots are only written to and read from files through a CPU trap that
+// needs extra emulated frames to complete, so this core keeps the default
+// saveStateToBuffer()/loadStateFromBuffer() that report memory states as unsupported
 EmuSystem::Error EmuSystem::saveState(const char *path)
 {
 	SnapshotTrapData data;
@@ -537,10 +541,12 @@ void EmuSystem::runFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
 {
 	audioPtr = audio;
 	setCanvasSkipFrame(!video);
+	setCanvasDirectVideo(task, video);
 	execC64Frame();
 	if(video)
 	{
-		video->startFrameWithFormat(task, canvasSrcPix);
+		if(!endCanvasDirectFrame(task, *video))
+			video->startFrameWithFormat(task, canvasSrcPix);
 	}
 	audioPtr = {};
 }
@@ -336,6 +336,12 @@ static void setC64KBKey(uint32_t key, bool pushed)
 	}
 }
 
+bool EmuSystem::inputActionNeedsMainThread(uint emuKey)
+{
+	// extra keys post messages, change the virtual keyboard, or sync the emulation thread
+	return (emuKey >> KEY_MODE_SHIFT) == EX_MODE;
+}
+
 void EmuSystem::handleInputAction(uint state, uint emuKey)
 {
 	switch(emuKey >> KEY_MODE_SHIFT)
@@ -7,6 +7,8 @@
 #include <emuframework/EmuSystem.hh>
 
 class EmuAudio;
+class EmuVideo;
+class EmuSystemTask;
 
 extern VicePlugin plugin;
 extern ViceSystem currSystem;
@@ -57,6 +59,8 @@ bool autostartBasicLoad();
 void setSysModel(int model);
 void setCanvasSkipFrame(bool on);
 void startCanvasRunningFrame();
+void setCanvasDirectVideo(EmuSystemTask *task, EmuVideo *video);
+bool endCanvasDirectFrame(EmuSystemTask *task, EmuVideo &video);
 int sysModel();
 void setDefaultC64Model(int model);
 void setDefaultDTVModel(int model);
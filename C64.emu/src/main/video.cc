@@ -16,6 +16,7 @@
 #define LOGTAG "video"
 #include <emuframework/EmuSystem.hh>
 #include <emuframework/EmuApp.hh>
+#include <emuframework/EmuVideo.hh>
 #include "internal.hh"
 
 extern "C"
@@ -23,6 +24,7 @@ extern "C"
 	#include "palette.h"
 	#include "video.h"
 	#include "videoarch.h"
+	#include "viewport.h"
 	#include "kbdbuf.h"
 	#include "sound.h"
 	#include "vsync.h"
@@ -31,8 +33,13 @@ extern "C"
 
 struct video_canvas_s *activeCanvas{};
 IG::Pixmap canvasSrcPix{};
+static IG::WP canvasSrcPos{};
 double systemFrameRate = 60.0;
 static std::atomic_bool runningFrame{};
+static EmuSystemTask *directTask{};
+static EmuVideo *directVideo{};
+static EmuVideoImage directImg{};
+static bool canvasPixmapIsStale{};
 
 void setCanvasSkipFrame(bool on)
 {
@@ -44,6 +51,31 @@ void startCanvasRunningFrame()
 	runningFrame = true;
 }
 
+void setCanvasDirectVideo(EmuSystemTask *task, EmuVideo *video)
+{
+	directTask = task;
+	directVideo = video && video->directRendering() ? video : nullptr;
+}
+
+bool endCanvasDirectFrame(EmuSystemTask *task, EmuVideo &video)
+{
+	directTask = {};
+	directVideo = {};
+	if(directImg)
+	{
+		directImg.endFrame();
+		directImg = {};
+		return true;
+	}
+	if(canvasPixmapIsStale)
+	{
+		// nothing was refreshed and the last frame only went to the video image
+		video.startUnchangedFrame(task);
+		return true;
+	}
+	return false;
+}
+
 CLINK LVISIBLE int vsync_do_vsync2(struct video_canvas_s *c, int been_skipped);
 int vsync_do_vsync2(struct video_canvas_s *c, int been_skipped)
 {
@@ -97,7 +129,19 @@ int video_canvas_set_palette(video_canvas_t *c, struct palette_s *palette)
 	return 0;
 }
 
-void video_canvas_refresh(struct video_canvas_s *c, unsigned int xs, unsigned int ys, unsigned int xi, unsigned int yi, unsigned int w, unsigned int h)
+static bool canRenderDirect(struct video_canvas_s *c)
+{
+	return directVideo && c->videoconfig->scalex == 1 && c->videoconfig->scaley == 1;
+}
+
+static bool coversCanvasSrcPix(unsigned int xi, unsigned int yi, unsigned int w, unsigned int h)
+{
+	return (int)xi <= canvasSrcPos.x && (int)yi <= canvasSrcPos.y
+		&& (int)(xi + w) >= canvasSrcPos.x + (int)canvasSrcPix.w()
+		&& (int)(yi + h) >= canvasSrcPos.y + (int)canvasSrcPix.h();
+}
+
+static void renderCanvas(struct video_canvas_s *c, unsigned int xs, unsigned int ys, unsigned int xi, unsigned int yi, unsigned int w, unsigned int h)
 {
 	xi *= c->videoconfig->scalex;
 	w *= c->videoconfig->scalex;
@@ -107,7 +151,52 @@ void video_canvas_refresh(struct video_canvas_s *c, unsigned int xs, unsigned in
 	w = std::min(w, c->pixmap->w());
 	h = std::min(h, c->pixmap->h());
 
+	if(canRenderDirect(c))
+	{
+		if(!directImg)
+			directImg = directVideo->startDirectFrame(directTask, canvasSrcPix);
+		if(directImg)
+		{
+			// render only the part of the update inside canvasSrcPix, relative to its origin
+			int x1 = std::max((int)xi, canvasSrcPos.x);
+			int y1 = std::max((int)yi, canvasSrcPos.y);
+			int x2 = std::min((int)(xi + w), canvasSrcPos.x + (int)canvasSrcPix.w());
+			int y2 = std::min((int)(yi + h), canvasSrcPos.y + (int)canvasSrcPix.h());
+			if(x2 > x1 && y2 > y1)
+			{
+				auto pix = directImg.pixmap();
+				plugin.video_canvas_render(c, (uint8_t*)pix.pixel({}), x2 - x1, y2 - y1,
+					xs + (x1 - xi), ys + (y1 - yi), x1 - canvasSrcPos.x, y1 - canvasSrcPos.y,
+					pix.pitchBytes(), pixFmt.bitsPerPixel());
+			}
+			canvasPixmapIsStale = true;
+			return;
+		}
+	}
 	plugin.video_canvas_render(c, (uint8_t*)c->pixmap->pixel({}), w, h, xs, ys, xi, yi, c->pixmap->pitchBytes(), pixFmt.bitsPerPixel());
+	canvasPixmapIsStale = false;
+}
+
+void video_canvas_refresh(struct video_canvas_s *c, unsigned int xs, unsigned int ys, unsigned int xi, unsigned int yi, unsigned int w, unsigned int h)
+{
+	if((canRenderDirect(c) || canvasPixmapIsStale) &&
+		!coversCanvasSrcPix(xi * c->videoconfig->scalex, yi * c->videoconfig->scaley,
+			w * c->videoconfig->scalex, h * c->videoconfig->scaley))
+	{
+		// The video image and a stale canvas pixmap don't hold the previous frame,
+		// so expand partial updates to the whole canvas like video_canvas_refresh_all()
+		auto viewport = c->viewport;
+		auto geometry = c->geometry;
+		renderCanvas(c,
+			viewport->first_x + geometry->extra_offscreen_border_left,
+			viewport->first_line,
+			viewport->x_offset,
+			viewport->y_offset,
+			std::min(c->draw_buffer->canvas_width, geometry->screen_size.width - viewport->first_x),
+			std::min(c->draw_buffer->canvas_height, viewport->last_line - viewport->first_line + 1));
+		return;
+	}
+	renderCanvas(c, xs, ys, xi, yi, w, h);
 }
 
 void resetCanvasSourcePixmap(struct video_canvas_s *c)
@@ -131,10 +220,12 @@ void resetCanvasSourcePixmap(struct video_canvas_s *c)
 		int width = 320+(xBorderSize*2 - startX*2);
 		int widthPadding = startX*2;
 		canvasSrcPix = c->pixmap->subPixmap({startX, startY}, {width, height});
+		canvasSrcPos = {startX, startY};
 	}
 	else
 	{
 		canvasSrcPix = *c->pixmap;
+		canvasSrcPos = {};
 	}
 }
 
@@ -147,6 +238,7 @@ void video_canvas_resize(struct video_canvas_s *c, char resize_canvas)
 	logMsg("resized canvas to %d,%d, renderer %d", x, y, c->videoconfig->rendermode);
 	delete c->pixmap;
 	c->pixmap = new IG::MemPixmap{{{x, y}, pixFmt}};
+	canvasPixmapIsStale = true;
 	resetCanvasSourcePixmap(c);
 }
 
@@ -12,11 +12,17 @@ ConfigFile.cc \
 CreditsView.cc \
 EmuApp.cc \
 EmuAudio.cc \
+EmuFrameTrace.cc \
 EmuInput.cc \
+EmuInputQueue.cc \
 EmuInputView.cc \
 EmuLoadProgressView.cc \
 EmuMainMenuView.cc \
+EmuMovie.cc \
 EmuOptions.cc \
+EmuRewind.cc \
+EmuRunAhead.cc \
+EmuStateWriter.cc \
 EmuSystemActionsView.cc \
 EmuSystem.cc \
 EmuSystemTask.cc \
@@ -28,9 +34,12 @@ EmuViewController.cc \
 FilePicker.cc \
 FileUtils.cc \
 GUIOptionView.cc \
+HeadlessBenchmark.cc \
 InputManagerView.cc \
 Recent.cc \
 RecentGameView.cc \
+RomLibrary.cc \
+RomLibraryView.cc \
 Screenshot.cc \
 StateSlotView.cc \
 SystemOptionView.cc \
@@ -64,6 +73,7 @@ LDLIBS := -l$(libName) $(LDLIBS)
 
 include $(IMAGINE_PATH)/make/package/imagine.mk
 include $(IMAGINE_PATH)/make/package/stdc++.mk
+include $(IMAGINE_PATH)/make/package/zlib.mk
 
 include $(IMAGINE_PATH)/make/imagineStaticLibTarget.mk
 
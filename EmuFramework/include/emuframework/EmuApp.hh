@@ -81,8 +81,8 @@ public:
 	static void printScreenshotResult(int num, bool success);
 	static void saveAutoState();
 	static bool loadAutoState();
-	static EmuSystem::Error saveState(const char *path);
-	static EmuSystem::Error saveStateWithSlot(int slot);
+	static EmuSystem::Error saveState(const char *path, bool notifyOnSuccess = false);
+	static EmuSystem::Error saveStateWithSlot(int slot, bool notifyOnSuccess = false);
 	static EmuSystem::Error loadState(const char *path);
 	static EmuSystem::Error loadStateWithSlot(int slot);
 	static void setDefaultVControlsButtonSpacing(int spacing);
@@ -16,10 +16,12 @@
 	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
 
 #include <imagine/audio/OutputStream.hh>
+#include <imagine/audio/Resampler.hh>
 #include <imagine/time/Time.hh>
 #include <imagine/util/ringbuffer/RingBuffer.hh>
 #include <memory>
 #include <atomic>
+#include <vector>
 
 class EmuAudio
 {
@@ -32,37 +34,61 @@ public:
 		MULTI_UNDERRUN
 	};
 
-	constexpr EmuAudio() {}
+	EmuAudio() {}
 	void open(IG::Audio::Api api);
 	void start(IG::Microseconds targetBufferFillUSecs, IG::Microseconds bufferIncrementUSecs);
 	void stop();
 	void close();
 	void flush();
+	void openNullSink();
+	void clearNullSink();
 	void writeFrames(const void *samples, uint32_t framesToWrite);
-	void setRate(uint32_t rate);
+	// inputRate is the rate of the samples passed to writeFrames() when it
+	// differs from the output rate, they're resampled to match
+	void setRate(uint32_t rate, uint32_t inputRate = 0);
 	void setFormat(IG::Audio::SampleFormat sample, uint8_t channels);
 	void setDefaultMonoFormat();
 	void setSpeedMultiplier(uint8_t speed);
 	void setAddSoundBuffersOnUnderrun(bool on);
+	void setRateControl(bool on);
 	void setSoundDuringFastForward(bool on);
+	void setVolume(uint8_t percent);
+	void setFloatOutput(bool on);
+	// format of the samples passed to writeFrames()
 	IG::Audio::PcmFormat pcmFormat() const;
+	// input frames needed to reach the fill level rate control aims for before a write
+	uint32_t framesUntilTargetFill() const;
 	explicit operator bool() const;
 
 protected:
 	std::unique_ptr<IG::Audio::OutputStream> audioStream{};
 	IG::RingBuffer rBuff{};
+	IG::Audio::Resampler resampler{};
+	std::vector<char> convBuff{};
 	IG::Audio::PcmFormat format{44100, IG::Audio::SampleFormats::i16, 2};
+	// format of the ring buffer and output stream
+	IG::Audio::PcmFormat outFormat{format};
 	IG::Time lastUnderrunTime{};
 	uint32_t targetBufferFillBytes = 0;
 	uint32_t bufferIncrementBytes = 0;
+	uint32_t outputRate = 44100;
+	float rateRatio = 1;
+	float volume = 1;
 	std::atomic<AudioWriteState> audioWriteState = AudioWriteState::BUFFER;
 	bool addSoundBuffersOnUnderrun = false;
 	uint8_t speedMultiplier = 1;
 	bool soundDuringFastForward = true;
+	bool rateControl = true;
+	bool floatOutput = false;
 
 	uint32_t framesFree() const;
 	uint32_t framesWritten() const;
 	uint32_t framesCapacity() const;
 	bool shouldStartAudioWrites(uint32_t bytesToWrite = 0) const;
 	void resizeAudioBuffer(uint32_t targetBufferFillBytes);
+	float updateRateRatio();
+	void resetRateControl();
+	void initResampler();
+	void updateOutputFormat();
+	const void *convertFrames(const void *samples, uint32_t frames);
 };
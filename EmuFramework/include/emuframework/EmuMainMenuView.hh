@@ -31,13 +31,14 @@ public:
 	void loadFileBrowserItems();
 	void loadStandardItems();
 
-	static const uint STANDARD_ITEMS = 14;
+	static const uint STANDARD_ITEMS = 15;
 	static const uint MAX_SYSTEM_ITEMS = 5;
 
 protected:
 	TextMenuItem loadGame;
 	TextMenuItem systemActions;
 	TextMenuItem recentGames;
+	TextMenuItem romLibraryItem;
 	TextMenuItem bundledGames;
 	TextMenuItem options;
 	TextMenuItem onScreenInputManager;
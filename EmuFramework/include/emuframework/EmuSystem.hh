@@ -22,9 +22,11 @@
 #include <imagine/time/Time.hh>
 #include <imagine/input/Input.hh>
 #include <imagine/util/string.h>
+#include <imagine/util/BufferView.hh>
 #include <emuframework/config.hh>
 #include <optional>
 #include <stdexcept>
+#include <vector>
 
 class EmuInputView;
 class EmuSystemTask;
@@ -90,6 +92,24 @@ public:
 
 	using OnLoadProgressDelegate = DelegateFunc<bool(int pos, int max, const char *label)>;
 
+	struct StateBenchmark
+	{
+		size_t bytes = 0;
+		IG::Time saveTime{};
+		IG::Time loadTime{};
+	};
+
+	// How a state file relates to the output of saveStateToBuffer(),
+	// CUSTOM states can only be written by saveState(), CORE_COMPRESSED
+	// states are passed through compressStateFileData() before writing
+	enum class StateFileFormat : uint8_t
+	{
+		CUSTOM,
+		RAW,
+		GZIP,
+		CORE_COMPRESSED
+	};
+
 	using Error = std::optional<std::runtime_error>;
 	using NameFilterFunc = bool(*)(const char *name);
 	static State state;
@@ -123,8 +143,12 @@ public:
 	static bool handlesGenericIO;
 	static bool hasCheats;
 	static bool hasSound;
+	static StateFileFormat stateFileFormat;
 	static int forcedSoundRate;
+	// rate the core always outputs at, resampled to the sound rate option by EmuAudio
+	static int nativeSoundRate;
 	static bool constFrameRate;
+	static bool hasDirectVideoRendering;
 	static NameFilterFunc defaultFsFilter;
 	static NameFilterFunc defaultBenchmarkFsFilter;
 	static const char *creditsViewStr;
@@ -138,6 +162,10 @@ public:
 	static void startAutoSaveStateTimer();
 	static Error loadState(const char *path);
 	static Error saveState(const char *path);
+	static Error saveStateToBuffer(std::vector<uint8_t> &buff);
+	static Error loadStateFromBuffer(IG::ConstBufferView buff);
+	// called from the state writer thread, must only touch the buffer
+	static Error compressStateFileData(std::vector<uint8_t> &buff);
 	static bool stateExists(int slot);
 	static bool shouldOverwriteExistingState();
 	static const char *systemName();
@@ -202,6 +230,8 @@ public:
 	static void configFrameTime();
 	static void clearInputBuffers(EmuInputView &view);
 	static void handleInputAction(uint state, uint emuKey);
+	// true if handling the action touches the UI and can't run on the emulation thread
+	static bool inputActionNeedsMainThread(uint emuKey);
 	static uint translateInputAction(uint input, bool &turbo);
 	static uint translateInputAction(uint input)
 	{
@@ -218,6 +248,9 @@ public:
 	static void clearGamePaths();
 	static FS::PathString baseDefaultGameSavePath();
 	static IG::Time benchmark();
+	static Error benchmarkStates(StateBenchmark &result);
+	// guest CPU instructions run so far, 0 if the core doesn't count them
+	static uint64_t executedInstructions();
 	static bool gameIsRunning()
 	{
 		return !string_equal(gameName_.data(), "");
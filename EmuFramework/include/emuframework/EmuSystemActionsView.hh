@@ -30,7 +30,7 @@ public:
 	void onShow() override;
 	void loadStandardItems();
 
-	static const uint STANDARD_ITEMS = 9;
+	static const uint STANDARD_ITEMS = 11;
 	static const uint MAX_SYSTEM_ITEMS = 5;
 
 protected:
@@ -44,6 +44,8 @@ protected:
 	TextMenuItem addLauncherIcon;
 	#endif
 	TextMenuItem screenshot;
+	TextMenuItem recordMovie;
+	TextMenuItem playMovie;
 	TextMenuItem resetSessionOptions;
 	TextMenuItem close;
 	StaticArrayList<MenuItem*, STANDARD_ITEMS + MAX_SYSTEM_ITEMS> item{};
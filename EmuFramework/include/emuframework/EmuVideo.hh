@@ -30,6 +30,7 @@ public:
 	IG::Pixmap pixmap() const;
 	explicit operator bool() const;
 	void endFrame();
+	void endFrame(IG::Pixmap srcPix);
 
 private:
 	EmuSystemTask *task{};
@@ -52,6 +53,7 @@ public:
 	void startFrame(EmuSystemTask *task, IG::Pixmap pix);
 	EmuVideoImage startFrameWithFormat(EmuSystemTask *task, IG::PixmapDesc desc);
 	void startFrameWithFormat(EmuSystemTask *task, IG::Pixmap pix);
+	EmuVideoImage startDirectFrame(EmuSystemTask *task, IG::PixmapDesc desc);
 	void startUnchangedFrame(EmuSystemTask *task);
 	void finishFrame(EmuSystemTask *task, Gfx::LockedTextureBuffer texBuff);
 	void finishFrame(EmuSystemTask *task, IG::Pixmap pix);
@@ -66,6 +68,9 @@ public:
 	bool formatIsEqual(IG::PixmapDesc desc) const;
 	void setOnFrameFinished(FrameFinishedDelegate del);
 	void setOnFormatChanged(FormatChangedDelegate del);
+	void setNullSink(bool on);
+	void setDirectRendering(bool on);
+	bool directRendering() const;
 
 protected:
 	Gfx::RendererTask &rTask;
@@ -75,6 +80,8 @@ protected:
 	FrameFinishedDelegate onFrameFinished{};
 	FormatChangedDelegate onFormatChanged{};
 	bool screenshotNextFrame = false;
+	bool nullSink = false;
+	bool directRendering_ = false;
 
 	void doScreenshot(EmuSystemTask *task, IG::Pixmap pix);
 	void dispatchFinishFrame(EmuSystemTask *task);
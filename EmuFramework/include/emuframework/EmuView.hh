@@ -16,7 +16,7 @@
 	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
 
 #include <imagine/gui/View.hh>
-#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
+#if defined CONFIG_EMUFRAMEWORK_AUDIO_STATS || defined CONFIG_EMUFRAMEWORK_FRAME_STATS
 #include <imagine/gfx/GfxText.hh>
 #endif
 
@@ -33,8 +33,11 @@ public:
 	bool inputEvent(Input::Event e) final;
 	bool hasLayer() const { return layer; }
 	void setLayoutInputView(EmuInputView *view);
-	void updateAudioStats(uint underruns, uint overruns, uint callbacks, double avgCallbackFrames, uint frames);
+	void updateAudioStats(uint underruns, uint overruns, uint callbacks, double avgCallbackFrames, uint frames,
+		double fillMSecs, double targetFillMSecs, float rateRatio);
 	void clearAudioStats();
+	void updateFrameStats(const char *stats);
+	void clearFrameStats();
 	EmuVideoLayer *videoLayer() const { return layer; }
 
 private:
@@ -45,4 +48,9 @@ private:
 	Gfx::GCRect audioStatsRect{};
 	std::array<char, 512> audioStatsStr{};
 	#endif
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_STATS
+	Gfx::Text frameStatsText{};
+	Gfx::GCRect frameStatsRect{};
+	std::array<char, 768> frameStatsStr{};
+	#endif
 };
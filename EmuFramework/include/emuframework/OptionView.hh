@@ -49,6 +49,8 @@ protected:
 	MultiChoiceMenuItem frameInterval;
 	#endif
 	BoolMenuItem dropLateFrames;
+	TextMenuItem framePacingItem[4];
+	MultiChoiceMenuItem framePacing;
 	char frameRateStr[64]{};
 	TextMenuItem frameRate;
 	char frameRatePALStr[64]{};
@@ -88,11 +90,12 @@ protected:
 	#endif
 	TextMenuItem gpuMultithreadingItem[3];
 	MultiChoiceMenuItem gpuMultithreading;
+	BoolMenuItem directRendering;
 	TextHeadingMenuItem visualsHeading;
 	TextHeadingMenuItem screenShapeHeading;
 	TextHeadingMenuItem advancedHeading;
 	TextHeadingMenuItem systemSpecificHeading;
-	StaticArrayList<MenuItem*, 28> item{};
+	StaticArrayList<MenuItem*, 29> item{};
 
 	void pushAndShowFrameRateSelectMenu(EmuSystem::VideoSystem vidSys, Input::Event e);
 	bool onFrameTimeChange(EmuSystem::VideoSystem vidSys, IG::FloatSeconds time);
@@ -116,6 +119,10 @@ protected:
 	TextMenuItem soundBuffersItem[7];
 	MultiChoiceMenuItem soundBuffers;
 	BoolMenuItem addSoundBuffersOnUnderrun;
+	BoolMenuItem rateControl;
+	BoolMenuItem floatOutput;
+	TextMenuItem volumeItem[6];
+	MultiChoiceMenuItem volume;
 	StaticArrayList<TextMenuItem, 5> audioRateItem{};
 	MultiChoiceMenuItem audioRate;
 	#ifdef CONFIG_AUDIO_MANAGER_SOLO_MIX
@@ -148,6 +155,12 @@ protected:
 	static constexpr uint MIN_FAST_FORWARD_SPEED = 2;
 	TextMenuItem fastForwardSpeedItem[6];
 	MultiChoiceMenuItem fastForwardSpeed;
+	TextMenuItem rewindBufferSizeItem[5];
+	MultiChoiceMenuItem rewindBufferSize;
+	TextMenuItem rewindIntervalItem[4];
+	MultiChoiceMenuItem rewindInterval;
+	TextMenuItem runAheadFramesItem[5];
+	MultiChoiceMenuItem runAheadFrames;
 	#if defined __ANDROID__
 	TextMenuItem processPriorityItem[3];
 	MultiChoiceMenuItem processPriority;
@@ -31,6 +31,12 @@ static void setSoundBuffers(int val)
 	optionSoundBuffers = val;
 }
 
+static void setSoundVolume(uint8_t val)
+{
+	optionSoundVolume = val;
+	emuAudio.setVolume(val);
+}
+
 AudioOptionView::AudioOptionView(ViewAttachParams attach, bool customMenu):
 	TableView{"Audio Options", attach, item},
 	snd
@@ -89,6 +95,41 @@ AudioOptionView::AudioOptionView(ViewAttachParams attach, bool customMenu):
 			emuAudio.setAddSoundBuffersOnUnderrun(optionAddSoundBuffersOnUnderrun);
 		}
 	},
+	rateControl
+	{
+		"Dynamic Rate Control",
+		(bool)optionAudioRateControl,
+		[this](BoolMenuItem &item, Input::Event e)
+		{
+			optionAudioRateControl = item.flipBoolValue(*this);
+			emuAudio.setRateControl(optionAudioRateControl);
+		}
+	},
+	floatOutput
+	{
+		"Floating-point Output",
+		(bool)optionAudioFloatOutput,
+		[this](BoolMenuItem &item, Input::Event e)
+		{
+			optionAudioFloatOutput = item.flipBoolValue(*this);
+			emuAudio.setFloatOutput(optionAudioFloatOutput);
+		}
+	},
+	volumeItem
+	{
+		{"25%", []() { setSoundVolume(25); }},
+		{"50%", []() { setSoundVolume(50); }},
+		{"75%", []() { setSoundVolume(75); }},
+		{"100%", []() { setSoundVolume(100); }},
+		{"125%", []() { setSoundVolume(125); }},
+		{"150%", []() { setSoundVolume(150); }},
+	},
+	volume
+	{
+		"Volume",
+		std::clamp(optionSoundVolume / 25 - 1, 0, 5),
+		volumeItem
+	},
 	audioRate
 	{
 		"Sound Rate",
@@ -146,6 +187,7 @@ void AudioOptionView::loadStockItems()
 {
 	item.emplace_back(&snd);
 	item.emplace_back(&soundDuringFastForward);
+	item.emplace_back(&volume);
 	if(!optionSoundRate.isConst)
 	{
 		audioRateItem.clear();
@@ -166,7 +208,10 @@ void AudioOptionView::loadStockItems()
 		updateAudioRateItem();
 	}
 	item.emplace_back(&soundBuffers);
+	item.emplace_back(&rateControl);
 	item.emplace_back(&addSoundBuffersOnUnderrun);
+	if(!optionAudioFloatOutput.isConst)
+		item.emplace_back(&floatOutput);
 	#ifdef CONFIG_AUDIO_MANAGER_SOLO_MIX
 	item.emplace_back(&audioSoloMix);
 	#endif
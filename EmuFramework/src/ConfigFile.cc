@@ -129,6 +129,7 @@ static OptionBase *cfgFileOption[] =
 	&optionShowOnSecondScreen,
 	#endif
 	&optionImgFilter,
+	&optionDirectVideoRendering,
 	#ifdef CONFIG_GFX_OPENGL_SHADER_PIPELINE
 	&optionImgEffect,
 	&optionImageEffectPixelFormat,
@@ -165,6 +166,9 @@ static OptionBase *cfgFileOption[] =
 	&optionSwappedGamepadConfirm,
 	&optionConfirmOverwriteState,
 	&optionFastForwardSpeed,
+	&optionRewindBufferSize,
+	&optionRewindInterval,
+	&optionRunAheadFrames,
 	#ifdef CONFIG_INPUT_DEVICE_HOTSWAP
 	&optionNotifyInputDeviceChange,
 	#endif
@@ -175,6 +179,7 @@ static OptionBase *cfgFileOption[] =
 	&optionFrameInterval,
 	#endif
 	&optionSkipLateFrames,
+	&optionFramePacing,
 	&optionFrameRate,
 	&optionFrameRatePAL,
 	&optionVibrateOnPush,
@@ -203,6 +208,9 @@ static OptionBase *cfgFileOption[] =
 	#endif
 	&optionSoundBuffers,
 	&optionAddSoundBuffersOnUnderrun,
+	&optionAudioRateControl,
+	&optionAudioFloatOutput,
+	&optionSoundVolume,
 	#ifdef CONFIG_AUDIO_MANAGER_SOLO_MIX
 	&optionAudioSoloMix,
 	#endif
@@ -451,6 +459,7 @@ void loadConfigFile()
 				bcase CFGKEY_FRAME_INTERVAL: optionFrameInterval.readFromIO(io, size);
 				#endif
 				bcase CFGKEY_SKIP_LATE_FRAMES: optionSkipLateFrames.readFromIO(io, size);
+				bcase CFGKEY_FRAME_PACING: optionFramePacing.readFromIO(io, size);
 				bcase CFGKEY_FRAME_RATE: optionFrameRate.readFromIO(io, size);
 				bcase CFGKEY_FRAME_RATE_PAL: optionFrameRatePAL.readFromIO(io, size);
 				bcase CFGKEY_LAST_DIR: optionLastLoadPath.readFromIO(io, size);
@@ -458,6 +467,7 @@ void loadConfigFile()
 				bcase CFGKEY_GAME_ORIENTATION: optionGameOrientation.readFromIO(io, size);
 				bcase CFGKEY_MENU_ORIENTATION: optionMenuOrientation.readFromIO(io, size);
 				bcase CFGKEY_GAME_IMG_FILTER: optionImgFilter.readFromIO(io, size);
+				bcase CFGKEY_DIRECT_VIDEO_RENDERING: optionDirectVideoRendering.readFromIO(io, size);
 				bcase CFGKEY_GAME_ASPECT_RATIO: optionAspectRatio.readFromIO(io, size);
 				bcase CFGKEY_IMAGE_ZOOM: optionImageZoom.readFromIO(io, size);
 				bcase CFGKEY_VIEWPORT_ZOOM: optionViewportZoom.readFromIO(io, size);
@@ -483,6 +493,9 @@ void loadConfigFile()
 				bcase CFGKEY_HIDE_STATUS_BAR: optionHideStatusBar.readFromIO(io, size);
 				bcase CFGKEY_CONFIRM_OVERWRITE_STATE: optionConfirmOverwriteState.readFromIO(io, size);
 				bcase CFGKEY_FAST_FORWARD_SPEED: optionFastForwardSpeed.readFromIO(io, size);
+				bcase CFGKEY_REWIND_BUFFER_SIZE: optionRewindBufferSize.readFromIO(io, size);
+				bcase CFGKEY_REWIND_INTERVAL: optionRewindInterval.readFromIO(io, size);
+				bcase CFGKEY_RUN_AHEAD_FRAMES: optionRunAheadFrames.readFromIO(io, size);
 				#ifdef CONFIG_INPUT_DEVICE_HOTSWAP
 				bcase CFGKEY_NOTIFY_INPUT_DEVICE_CHANGE: optionNotifyInputDeviceChange.readFromIO(io, size);
 				#endif
@@ -506,6 +519,9 @@ void loadConfigFile()
 				#endif
 				bcase CFGKEY_SOUND_BUFFERS: optionSoundBuffers.readFromIO(io, size);
 				bcase CFGKEY_ADD_SOUND_BUFFERS_ON_UNDERRUN: optionAddSoundBuffersOnUnderrun.readFromIO(io, size);
+				bcase CFGKEY_AUDIO_RATE_CONTROL: optionAudioRateControl.readFromIO(io, size);
+				bcase CFGKEY_AUDIO_FLOAT_OUTPUT: optionAudioFloatOutput.readFromIO(io, size);
+				bcase CFGKEY_SOUND_VOLUME: optionSoundVolume.readFromIO(io, size);
 				#ifdef CONFIG_AUDIO_MANAGER_SOLO_MIX
 				bcase CFGKEY_AUDIO_SOLO_MIX: optionAudioSoloMix.readFromIO(io, size);
 				#endif
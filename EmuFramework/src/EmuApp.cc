@@ -32,6 +32,7 @@
 #include "privateInput.hh"
 #include "configFile.hh"
 #include "EmuSystemTask.hh"
+#include "EmuStateWriter.hh"
 
 class ExitConfirmAlertView : public AlertView
 {
@@ -75,10 +76,13 @@ Gfx::Renderer renderer;
 static Gfx::RendererTask rendererTask{renderer};
 static AppWindowData mainWin{};
 static EmuSystemTask emuSystemTask{};
+static EmuStateWriter stateWriter{};
 EmuViewController emuViewController{mainWin, renderer, rendererTask, vController, emuVideoLayer, emuSystemTask};
 EmuVideo emuVideo{rendererTask};
 EmuVideoLayer emuVideoLayer{emuVideo};
 EmuAudio emuAudio{};
+EmuMovie emuMovie{};
+RomLibrary romLibrary{};
 DelegateFunc<void ()> onUpdateInputDevices{};
 #ifdef CONFIG_BLUETOOTH
 BluetoothAdapter *bta{};
@@ -223,6 +227,7 @@ void mainInitCommon(int argc, char** argv)
 		});
 	initOptions();
 	auto launchGame = parseCmdLineArgs(argc, argv);
+	romLibrary.load();
 	loadConfigFile();
 	if(auto err = EmuSystem::onOptionsLoaded();
 		err)
@@ -235,6 +240,9 @@ void mainInitCommon(int argc, char** argv)
 	if(optionSoundRate > optionSoundRate.defaultVal)
 		optionSoundRate.reset();
 	emuAudio.setAddSoundBuffersOnUnderrun(optionAddSoundBuffersOnUnderrun);
+	emuAudio.setRateControl(optionAudioRateControl);
+	emuAudio.setFloatOutput(optionAudioFloatOutput);
+	emuAudio.setVolume(optionSoundVolume);
 	emuAudio.setSoundDuringFastForward(soundDuringFastForwardIsEnabled());
 	applyOSNavStyle(false);
 
@@ -283,6 +291,7 @@ void mainInitCommon(int argc, char** argv)
 	updateInputDevices();
 
 	emuVideoLayer.setLinearFilter(optionImgFilter);
+	emuVideo.setDirectRendering(optionDirectVideoRendering);
 	emuVideoLayer.setOverlayIntensity(optionOverlayEffectLevel/100.);
 
 	Base::addOnResume(
@@ -330,6 +339,7 @@ void mainInitCommon(int argc, char** argv)
 				emuViewController.closeSystem();
 				emuVideo.deleteImage();
 			}
+			stateWriter.waitForPending();
 			emuAudio.close();
 			AudioManager::endSession();
 
@@ -488,9 +498,21 @@ void runBenchmarkOneShot()
 {
 	logMsg("starting benchmark");
 	IG::FloatSeconds time = EmuSystem::benchmark();
+	EmuSystem::StateBenchmark stateBench;
+	auto stateErr = EmuSystem::benchmarkStates(stateBench);
 	emuViewController.closeSystem(false);
 	logMsg("done in: %f", time.count());
-	EmuApp::printfMessage(2, 0, "%.2f fps", double(180.)/time.count());
+	if(stateErr)
+	{
+		logMsg("skipped state benchmark:%s", stateErr->what());
+		EmuApp::printfMessage(2, 0, "%.2f fps", double(180.)/time.count());
+		return;
+	}
+	auto saveUSecs = IG::FloatSeconds(stateBench.saveTime).count() * 1000000.;
+	auto loadUSecs = IG::FloatSeconds(stateBench.loadTime).count() * 1000000.;
+	logMsg("%zu byte state, save:%.1fus load:%.1fus", stateBench.bytes, saveUSecs, loadUSecs);
+	EmuApp::printfMessage(4, 0, "%.2f fps\nState: %zu bytes\nSave: %.1fus Load: %.1fus",
+		double(180.)/time.count(), stateBench.bytes, saveUSecs, loadUSecs);
 }
 
 void EmuApp::showEmuation()
@@ -712,7 +734,7 @@ bool EmuApp::loadAutoState()
 	return 0;
 }
 
-EmuSystem::Error EmuApp::saveState(const char *path)
+EmuSystem::Error EmuApp::saveState(const char *path, bool notifyOnSuccess)
 {
 	if(!EmuSystem::gameIsRunning())
 	{
@@ -721,13 +743,39 @@ EmuSystem::Error EmuApp::saveState(const char *path)
 	fixFilePermissions(path);
 	syncEmulationThread();
 	logMsg("saving state %s", path);
-	return EmuSystem::saveState(path);
+	if(EmuSystem::stateFileFormat == EmuSystem::StateFileFormat::CUSTOM)
+	{
+		auto err = EmuSystem::saveState(path);
+		if(!err && notifyOnSuccess)
+			postMessage("State Saved");
+		return err;
+	}
+	// capture the state now and leave compression & disk I/O to the writer thread
+	std::vector<uint8_t> data;
+	if(auto err = EmuSystem::saveStateToBuffer(data);
+		err)
+	{
+		return err;
+	}
+	stateWriter.write(FS::makePathString(path), std::move(data), EmuSystem::stateFileFormat,
+		[notifyOnSuccess](EmuSystem::Error err)
+		{
+			if(err)
+			{
+				printfMessage(4, true, "Save State: %s", err->what());
+			}
+			else if(notifyOnSuccess)
+			{
+				postMessage("State Saved");
+			}
+		});
+	return {};
 }
 
-EmuSystem::Error EmuApp::saveStateWithSlot(int slot)
+EmuSystem::Error EmuApp::saveStateWithSlot(int slot, bool notifyOnSuccess)
 {
 	auto path = EmuSystem::sprintStateFilename(slot);
-	return saveState(path.data());
+	return saveState(path.data(), notifyOnSuccess);
 }
 
 EmuSystem::Error EmuApp::loadState(const char *path)
@@ -736,6 +784,12 @@ EmuSystem::Error EmuApp::loadState(const char *path)
 	{
 		return EmuSystem::makeError("System not running");
 	}
+	if(emuMovie.isActive())
+	{
+		return EmuSystem::makeError("Can't load a state while a movie is active");
+	}
+	// a state for this path may still be in the process of being written
+	stateWriter.waitForPending();
 	if(!FS::exists(path))
 	{
 		return EmuSystem::makeError("File doesn't exist");
@@ -743,7 +797,13 @@ EmuSystem::Error EmuApp::loadState(const char *path)
 	fixFilePermissions(path);
 	syncEmulationThread();
 	logMsg("loading state %s", path);
-	return EmuSystem::loadState(path);
+	auto err = EmuSystem::loadState(path);
+	if(!err)
+	{
+		emuViewController.resetRewind();
+		emuViewController.resetRunAhead();
+	}
+	return err;
 }
 
 EmuSystem::Error EmuApp::loadStateWithSlot(int slot)
@@ -927,6 +987,11 @@ void onInit(int argc, char** argv)
 		Base::exitWithErrorMessagePrintf(-1, "%s", err->what());
 		return;
 	}
+	if(int exitVal; runHeadlessBenchmarkFromArgs(argc, argv, exitVal))
+	{
+		Base::exit(exitVal);
+		return;
+	}
 	mainInitCommon(argc, argv);
 }
 
@@ -17,7 +17,9 @@
 #include <emuframework/EmuAudio.hh>
 #include <emuframework/EmuSystem.hh>
 #include "private.hh"
+#include <imagine/audio/SampleConvert.hh>
 #include <imagine/logger/logger.h>
+#include <algorithm>
 
 struct AudioStats
 {
@@ -26,12 +28,18 @@ struct AudioStats
 	uint overruns = 0;
 	std::atomic_uint callbacks{};
 	std::atomic_uint callbackBytes{};
+	std::atomic_uint fillBytes{};
+	std::atomic<float> rateRatio{1};
+	uint targetFillBytes = 0;
 
-	void reset()
+	void reset(uint targetFillBytes_)
 	{
 		underruns = overruns = 0;
 		callbacks = 0;
 		callbackBytes = 0;
+		fillBytes = 0;
+		rateRatio = 1;
+		targetFillBytes = targetFillBytes_;
 	}
 };
 
@@ -40,16 +48,19 @@ static AudioStats audioStats{};
 static Base::Timer audioStatsTimer{"audioStatsTimer"};
 #endif
 
-static void startAudioStats(IG::Audio::PcmFormat format)
+static void startAudioStats(IG::Audio::PcmFormat format, uint32_t targetFillBytes)
 {
 	#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
-	audioStats.reset();
+	audioStats.reset(targetFillBytes);
 	audioStatsTimer.run(IG::Seconds(1), IG::Seconds(1), {},
 		[format]()
 		{
 			auto frames = format.bytesToFrames(audioStats.callbackBytes);
 			emuViewController.updateEmuAudioStats(audioStats.underruns, audioStats.overruns,
-				audioStats.callbacks, frames / (double)audioStats.callbacks, frames);
+				audioStats.callbacks, frames / (double)audioStats.callbacks, frames,
+				format.bytesToTime(audioStats.fillBytes).count() * 1000.,
+				format.bytesToTime(audioStats.targetFillBytes).count() * 1000.,
+				audioStats.rateRatio);
 			audioStats.callbacks = 0;
 			audioStats.callbackBytes = 0;
 		});
@@ -60,23 +71,36 @@ static void stopAudioStats()
 {
 	#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
 	audioStatsTimer.deinit();
-	clearEmuAudioStats();
+	emuViewController.clearEmuAudioStats();
 	#endif
 }
 
 uint EmuAudio::framesFree() const
 {
-	return format.bytesToFrames(rBuff.freeSpace());
+	return outFormat.bytesToFrames(rBuff.freeSpace());
 }
 
 uint EmuAudio::framesWritten() const
 {
-	return format.bytesToFrames(rBuff.size());
+	return outFormat.bytesToFrames(rBuff.size());
 }
 
 uint EmuAudio::framesCapacity() const
 {
-	return format.bytesToFrames(rBuff.capacity());
+	return outFormat.bytesToFrames(rBuff.capacity());
+}
+
+uint32_t EmuAudio::framesUntilTargetFill() const
+{
+	// while buffering the target is the fill that starts playback,
+	// afterwards it's half a video frame under, matching updateRateRatio()
+	int targetBytes = targetBufferFillBytes;
+	if(audioWriteState == AudioWriteState::ACTIVE)
+		targetBytes -= bufferIncrementBytes / 2;
+	auto outFrames = outFormat.bytesToFrames(std::max(targetBytes - (int)rBuff.size(), 0));
+	if(format.rate == outFormat.rate)
+		return outFrames;
+	return std::ceil(outFrames * (double)format.rate / outFormat.rate);
 }
 
 bool EmuAudio::shouldStartAudioWrites(uint32_t bytesToWrite) const
@@ -103,24 +127,107 @@ static void simpleResample(T *dest, uint destFrames, const T *src, uint srcFrame
 	}
 }
 
+static void simpleResample(void *dest, uint destFrames, const void *src, uint srcFrames, uint frameBytes)
+{
+	switch(frameBytes)
+	{
+		bcase 2: simpleResample<int16_t>((int16_t*)dest, destFrames, (const int16_t*)src, srcFrames);
+		bcase 4: simpleResample<int32_t>((int32_t*)dest, destFrames, (const int32_t*)src, srcFrames);
+		bcase 8: simpleResample<int64_t>((int64_t*)dest, destFrames, (const int64_t*)src, srcFrames);
+		bdefault: bug_unreachable("frameBytes == %u", frameBytes);
+	}
+}
+
 void EmuAudio::resizeAudioBuffer(uint32_t targetBufferFillBytes)
 {
 	auto oldCapacity = rBuff.capacity();
-	rBuff.setMinCapacity(targetBufferFillBytes + bufferIncrementBytes);
+	// rate control needs room to run a little above the target
+	rBuff.setMinCapacity(targetBufferFillBytes + bufferIncrementBytes * (rateControl ? 2 : 1));
 	if(Config::DEBUG_BUILD && rBuff.capacity() != oldCapacity)
 	{
 		logMsg("created audio buffer:%d frames (%.4fs), fill target:%d frames (%.4fs)",
-			format.bytesToFrames(rBuff.freeSpace()), format.bytesToTime(rBuff.freeSpace()).count(),
-			format.bytesToFrames(targetBufferFillBytes), format.bytesToTime(targetBufferFillBytes).count());
+			outFormat.bytesToFrames(rBuff.freeSpace()), outFormat.bytesToTime(rBuff.freeSpace()).count(),
+			outFormat.bytesToFrames(targetBufferFillBytes), outFormat.bytesToTime(targetBufferFillBytes).count());
 	}
 }
 
+float EmuAudio::updateRateRatio()
+{
+	// Nudge the output rate from the buffer fill level so drift between the emulated
+	// and device clocks is absorbed without the fill level walking off its target.
+	// The fill before a write should average half a video frame below the target and
+	// the full adjustment is reached when it's a whole video frame away.
+	constexpr float maxRateDelta = .005;
+	float frameBytes = bufferIncrementBytes;
+	float fillError = ((float)rBuff.size() - ((float)targetBufferFillBytes - frameBytes / 2.f)) / frameBytes;
+	rateRatio = 1.f - maxRateDelta * std::clamp(fillError, -1.f, 1.f);
+	#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
+	audioStats.fillBytes.store(rBuff.size(), std::memory_order_relaxed);
+	audioStats.rateRatio.store(rateRatio, std::memory_order_relaxed);
+	#endif
+	return rateRatio;
+}
+
+void EmuAudio::resetRateControl()
+{
+	rateRatio = 1;
+	if(resampler)
+		resampler.reset();
+}
+
+void EmuAudio::updateOutputFormat()
+{
+	outFormat = {outputRate, floatOutput ? IG::Audio::SampleFormats::f32 : IG::Audio::SampleFormats::i16, format.channels};
+}
+
+const void *EmuAudio::convertFrames(const void *samples, uint32_t frames)
+{
+	// convert to the output format and apply the volume, float output isn't
+	// clipped here so the full range is kept until the device mix
+	if(format.sample == outFormat.sample && volume == 1.f)
+		return samples;
+	auto bytes = outFormat.framesToBytes(frames);
+	if(convBuff.size() < bytes)
+		convBuff.resize(bytes);
+	auto dest = convBuff.data();
+	auto count = frames * format.channels;
+	if(format.sample.isFloat())
+	{
+		if(outFormat.sample.isFloat())
+			IG::Audio::convertSamples((float*)dest, (const float*)samples, count, volume);
+		else
+			IG::Audio::convertSamples((int16_t*)dest, (const float*)samples, count, volume);
+	}
+	else
+	{
+		if(outFormat.sample.isFloat())
+			IG::Audio::convertSamples((float*)dest, (const int16_t*)samples, count, volume);
+		else
+			IG::Audio::convertSamples((int16_t*)dest, (const int16_t*)samples, count, volume);
+	}
+	return dest;
+}
+
 void EmuAudio::open(IG::Audio::Api api)
 {
 	close();
 	audioStream = IG::Audio::makeOutputStream(api);
 }
 
+void EmuAudio::initResampler()
+{
+	if(!resampler)
+	{
+		// with matching input and output rates the resampler only follows the rate control ratio
+		resampler = {format.rate, outFormat.rate, format.channels};
+	}
+	resampler.setGain(volume);
+	resetRateControl();
+	// the backlog is counted in input frames, allow the target fill on top of a full
+	// write before input is lost so only a stalled output drops anything
+	resampler.setMaxBacklog(resampler.inputFramesFor(outFormat.bytesToFrames(targetBufferFillBytes + bufferIncrementBytes)));
+}
+
 void EmuAudio::start(IG::Microseconds targetBufferFillUSecs, IG::Microseconds bufferIncrementUSecs)
 {
 	if(!audioStream)
@@ -129,15 +236,16 @@ void EmuAudio::start(IG::Microseconds targetBufferFillUSecs, IG::Microseconds bu
 		return;
 	}
 	lastUnderrunTime = {};
-	targetBufferFillBytes = format.timeToBytes(targetBufferFillUSecs);
-	bufferIncrementBytes = format.timeToBytes(bufferIncrementUSecs);
+	targetBufferFillBytes = outFormat.timeToBytes(targetBufferFillUSecs);
+	bufferIncrementBytes = outFormat.timeToBytes(bufferIncrementUSecs);
+	initResampler();
 	if(!audioStream->isOpen())
 	{
 		resizeAudioBuffer(targetBufferFillBytes);
 		audioWriteState = AudioWriteState::BUFFER;
 		IG::Audio::OutputStreamConfig outputConf
 		{
-			format,
+			outFormat,
 			[this](void *samples, unsigned bytes)
 			{
 				#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
@@ -177,12 +285,12 @@ void EmuAudio::start(IG::Microseconds targetBufferFillUSecs, IG::Microseconds bu
 			}
 		};
 		outputConf.setWantedLatencyHint({});
-		startAudioStats(format);
+		startAudioStats(outFormat, targetBufferFillBytes);
 		audioStream->open(outputConf);
 	}
 	else
 	{
-		startAudioStats(format);
+		startAudioStats(outFormat, targetBufferFillBytes);
 		if(shouldStartAudioWrites())
 		{
 			if(Config::DEBUG_BUILD)
@@ -213,6 +321,22 @@ void EmuAudio::close()
 	audioStream.reset();
 }
 
+void EmuAudio::openNullSink()
+{
+	// buffer written frames without an output device, used for headless benchmarking,
+	// resampling the same way as start() so the benchmark covers that work too
+	close();
+	targetBufferFillBytes = outFormat.timeToBytes(IG::Milliseconds{500});
+	bufferIncrementBytes = outFormat.timeToBytes(IG::Milliseconds{20});
+	initResampler();
+	resizeAudioBuffer(targetBufferFillBytes);
+}
+
+void EmuAudio::clearNullSink()
+{
+	rBuff.clear();
+}
+
 void EmuAudio::flush()
 {
 	if(unlikely(!audioStream))
@@ -222,6 +346,7 @@ void EmuAudio::flush()
 	if(audioStream)
 		audioStream->flush();
 	rBuff.clear();
+	resetRateControl();
 }
 
 void EmuAudio::writeFrames(const void *samples, uint32_t framesToWrite)
@@ -230,8 +355,8 @@ void EmuAudio::writeFrames(const void *samples, uint32_t framesToWrite)
 	switch(audioWriteState)
 	{
 		case AudioWriteState::MULTI_UNDERRUN:
-			if(speedMultiplier == 1 && addSoundBuffersOnUnderrun &&
-				format.bytesToTime(rBuff.capacity()).count() <= 1.) // hard cap buffer increase to 1 sec
+			if(speedMultiplier == 1 && addSoundBuffersOnUnderrun && !rateControl &&
+				outFormat.bytesToTime(rBuff.capacity()).count() <= 1.) // hard cap buffer increase to 1 sec
 			{
 				logWarn("increasing buffer size due to multiple underruns within a short time");
 				targetBufferFillBytes += bufferIncrementBytes;
@@ -250,45 +375,77 @@ void EmuAudio::writeFrames(const void *samples, uint32_t framesToWrite)
 		framesToWrite = std::ceil((double)framesToWrite / speedMultiplier);
 		framesToWrite = std::max(framesToWrite, 1u);
 	}
-	uint bytes = format.framesToBytes(framesToWrite);
-	uint freeBytes = rBuff.freeSpace();
-	if(bytes <= freeBytes)
+	uint bytes;
+	const bool needsRateConversion = format.rate != outFormat.rate;
+	if(((speedMultiplier == 1 && rateControl) || needsRateConversion) && resampler)
 	{
-		if(sampleFrames > framesToWrite)
+		// keep all writes going through the resampler so its history stays continuous,
+		// when it converts from a native input rate it also handles fast-forward
+		float ratio = speedMultiplier == 1 && rateControl && audioWriteState == AudioWriteState::ACTIVE ?
+			updateRateRatio() : 1.f;
+		resampler.setRatioAdjust(ratio / speedMultiplier);
+		auto maxFrames = resampler.maxOutputFrames(sampleFrames);
+		auto freeFrames = framesFree();
+		if(unlikely(maxFrames > freeFrames))
 		{
-			switch(format.channels)
-			{
-				bcase 1:
-					if(soundDuringFastForward)
-						simpleResample<int16_t>((int16_t*)rBuff.writeAddr(), framesToWrite, (int16_t*)samples, sampleFrames);
-					else
-						std::fill_n((int16_t*)rBuff.writeAddr(), framesToWrite, 0);
-				bcase 2:
-					if(soundDuringFastForward)
-						simpleResample<int32_t>((int32_t*)rBuff.writeAddr(), framesToWrite, (int32_t*)samples, sampleFrames);
-					else
-						std::fill_n((int32_t*)rBuff.writeAddr(), framesToWrite, 0);
-				bdefault: bug_unreachable("channels == %d", format.channels);
-			}
-			rBuff.commitWrite(bytes);
+			// output that doesn't fit stays in the resampler until the next write,
+			// up to the target fill plus one buffer period of input
+			logMsg("overrun, only %u out of %u frames free", freeFrames, maxFrames);
+			#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
+			audioStats.overruns++;
+			#endif
+		}
+		auto out = rBuff.writeAddr();
+		auto outFrames = std::min(maxFrames, freeFrames);
+		uint32_t frames;
+		if(format.sample.isFloat())
+		{
+			frames = outFormat.sample.isFloat() ?
+				resampler.process((const float*)samples, sampleFrames, (float*)out, outFrames) :
+				resampler.process((const float*)samples, sampleFrames, (int16_t*)out, outFrames);
 		}
 		else
-			rBuff.writeUnchecked(samples, bytes);
+		{
+			frames = outFormat.sample.isFloat() ?
+				resampler.process((const int16_t*)samples, sampleFrames, (float*)out, outFrames) :
+				resampler.process((const int16_t*)samples, sampleFrames, (int16_t*)out, outFrames);
+		}
+		bytes = outFormat.framesToBytes(frames);
+		if(unlikely(speedMultiplier > 1 && !soundDuringFastForward))
+			std::fill_n((char*)out, bytes, 0);
+		rBuff.commitWrite(bytes);
 	}
 	else
 	{
-		logMsg("overrun, only %d out of %d bytes free", freeBytes, bytes);
-		#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
-		audioStats.overruns++;
-		#endif
-		auto freeFrames = format.bytesToFrames(freeBytes);
-		switch(format.channels)
+		bytes = outFormat.framesToBytes(framesToWrite);
+		uint freeBytes = rBuff.freeSpace();
+		if(bytes <= freeBytes)
+		{
+			if(sampleFrames > framesToWrite)
+			{
+				if(soundDuringFastForward)
+				{
+					simpleResample(rBuff.writeAddr(), framesToWrite, convertFrames(samples, sampleFrames),
+						sampleFrames, outFormat.bytesPerFrame());
+				}
+				else
+					std::fill_n((char*)rBuff.writeAddr(), bytes, 0);
+				rBuff.commitWrite(bytes);
+			}
+			else
+				rBuff.writeUnchecked(convertFrames(samples, sampleFrames), bytes);
+		}
+		else
 		{
-			bcase 1: simpleResample<int16_t>((int16_t*)rBuff.writeAddr(), freeFrames, (int16_t*)samples, sampleFrames);
-			bcase 2: simpleResample<int32_t>((int32_t*)rBuff.writeAddr(), freeFrames, (int32_t*)samples, sampleFrames);
-			bdefault: bug_unreachable("channels == %d", format.channels);
+			logMsg("overrun, only %d out of %d bytes free", freeBytes, bytes);
+			#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
+			audioStats.overruns++;
+			#endif
+			auto freeFrames = outFormat.bytesToFrames(freeBytes);
+			simpleResample(rBuff.writeAddr(), freeFrames, convertFrames(samples, sampleFrames),
+				sampleFrames, outFormat.bytesPerFrame());
+			rBuff.commitWrite(outFormat.framesToBytes(freeFrames));
 		}
-		rBuff.commitWrite(freeBytes);
 	}
 	if(audioWriteState == AudioWriteState::BUFFER && shouldStartAudioWrites(bytes))
 	{
@@ -297,19 +454,23 @@ void EmuAudio::writeFrames(const void *samples, uint32_t framesToWrite)
 			auto bytes = rBuff.size();
 			auto capacity = rBuff.capacity();
 			logMsg("starting audio writes with buffer fill %u/%u bytes %.2f/%.2f secs",
-				bytes, capacity, format.bytesToTime(bytes).count(), format.bytesToTime(capacity).count());
+				bytes, capacity, outFormat.bytesToTime(bytes).count(), outFormat.bytesToTime(capacity).count());
 		}
 		audioWriteState = AudioWriteState::ACTIVE;
 	}
 }
 
-void EmuAudio::setRate(uint32_t rate)
+void EmuAudio::setRate(uint32_t rate, uint32_t inputRate)
 {
 	auto prevFormat = format;
-	format.rate = rate;
-	if(prevFormat != format)
+	auto prevOutputRate = outputRate;
+	format.rate = inputRate ? inputRate : rate;
+	outputRate = rate;
+	updateOutputFormat();
+	if(prevFormat != format || prevOutputRate != outputRate)
 	{
-		logMsg("rate changed:%u -> %u", prevFormat.rate, rate);
+		logMsg("rate changed:%u -> %u, input:%u", prevOutputRate, rate, format.rate);
+		resampler = {};
 		stop();
 	}
 }
@@ -319,8 +480,10 @@ void EmuAudio::setFormat(IG::Audio::SampleFormat sample, uint8_t channels)
 	auto prevFormat = format;
 	format.sample = sample;
 	format.channels = channels;
+	updateOutputFormat();
 	if(prevFormat != format)
 	{
+		resampler = {};
 		stop();
 	}
 }
@@ -340,11 +503,37 @@ void EmuAudio::setAddSoundBuffersOnUnderrun(bool on)
 	addSoundBuffersOnUnderrun = on;
 }
 
+void EmuAudio::setRateControl(bool on)
+{
+	rateControl = on;
+	resetRateControl();
+}
+
 void EmuAudio::setSoundDuringFastForward(bool on)
 {
 	soundDuringFastForward = on;
 }
 
+void EmuAudio::setVolume(uint8_t percent)
+{
+	volume = percent / 100.f;
+	resampler.setGain(volume);
+}
+
+void EmuAudio::setFloatOutput(bool on)
+{
+	if(floatOutput == on)
+		return;
+	floatOutput = on;
+	updateOutputFormat();
+	logMsg("output samples:%s", on ? "f32" : "i16");
+	// stream and ring buffer are re-created in the new format on the next start()
+	if(audioStream && audioStream->isOpen())
+		stop();
+	else
+		rBuff.clear();
+}
+
 IG::Audio::PcmFormat EmuAudio::pcmFormat() const
 {
 	return format;
@@ -0,0 +1,240 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#ifdef CONFIG_EMUFRAMEWORK_FRAME_STATS
+#include "EmuFrameTrace.hh"
+#include "private.hh"
+#include <imagine/io/FileIO.hh>
+#include <imagine/util/algorithm.h>
+#include <imagine/util/string.h>
+#include <imagine/logger/logger.h>
+#include <algorithm>
+#include <string>
+
+EmuFrameTrace emuFrameTrace{};
+
+using Stage = EmuFrameTrace::Stage;
+
+struct StageSpan
+{
+	const char *name;
+	Stage from, to;
+	// thread the span runs on in the trace
+	uint8_t tid;
+};
+
+static constexpr StageSpan spans[]
+{
+	{"Vsync to onFrame", Stage::VSYNC, Stage::ON_FRAME, 1},
+	{"Dispatch", Stage::ON_FRAME, Stage::EMULATE_START, 1},
+	{"Emulate", Stage::EMULATE_START, Stage::EMULATE_END, 2},
+	{"Fence wait", Stage::EMULATE_END, Stage::FENCE_WAIT_END, 2},
+	{"Upload", Stage::FENCE_WAIT_END, Stage::UPLOAD_END, 2},
+	{"Draw wait", Stage::UPLOAD_END, Stage::DRAW_START, 3},
+	{"Draw", Stage::DRAW_START, Stage::DRAW_END, 3},
+	{"Present", Stage::DRAW_END, Stage::PRESENT_END, 3},
+	{"Total", Stage::VSYNC, Stage::PRESENT_END, 0},
+};
+
+static double toMSecs(IG::Time time)
+{
+	return IG::FloatSeconds(time).count() * 1000.;
+}
+
+IG::Time EmuFrameTrace::Record::duration(Stage from, Stage to) const
+{
+	auto start = time[(size_t)from], end = time[(size_t)to];
+	if(!start.count() || end < start)
+		return {};
+	return end - start;
+}
+
+void EmuFrameTrace::start()
+{
+	{
+		std::lock_guard lock{historyMutex};
+		history.clear();
+		history.reserve(HISTORY_RECORDS);
+		historyPos = 0;
+	}
+	emulationId = finishedId = drawId = 0;
+	statsTimer.run(IG::Seconds(1), IG::Seconds(1), {},
+		[this]()
+		{
+			std::array<char, 768> str;
+			printStats(str.data(), str.size());
+			emuViewController.updateEmuFrameStats(str.data());
+		});
+}
+
+void EmuFrameTrace::stop()
+{
+	statsTimer.cancel();
+	emuViewController.clearEmuFrameStats();
+	auto path = FS::makePathStringPrintf("%s/frametrace.json", EmuSystem::savePath());
+	if(writeChromeTrace(path.data()))
+		logMsg("wrote frame trace:%s", path.data());
+}
+
+void EmuFrameTrace::beginFrame(IG::FrameTime vsyncTime, IG::Time onFrameTime, uint8_t framesEmulated)
+{
+	auto id = ++nextId;
+	if(!id) // skip 0, it marks no frame
+		id = ++nextId;
+	auto &rec = activeRecord(id);
+	rec = {};
+	rec.id = id;
+	rec.framesEmulated = framesEmulated;
+	auto vsync = std::chrono::duration_cast<IG::Time>(vsyncTime);
+	// the timestamp may come from a clock other than the steady clock, such as renderer time
+	if(vsync > onFrameTime || onFrameTime - vsync > IG::Seconds(1))
+		vsync = onFrameTime;
+	rec.time[(size_t)Stage::VSYNC] = vsync;
+	rec.time[(size_t)Stage::ON_FRAME] = onFrameTime;
+	rec.time[(size_t)Stage::DISPATCH] = IG::steadyClockTimestamp();
+	emulationId.store(id, std::memory_order_release);
+}
+
+void EmuFrameTrace::markEmulation(Stage stage)
+{
+	auto id = emulationId.load(std::memory_order_acquire);
+	if(!id)
+		return;
+	activeRecord(id).time[(size_t)stage] = IG::steadyClockTimestamp();
+}
+
+void EmuFrameTrace::finishEmulation()
+{
+	finishedId.store(emulationId.exchange(0, std::memory_order_acq_rel), std::memory_order_release);
+}
+
+void EmuFrameTrace::prepareDraw()
+{
+	drawId.store(finishedId.exchange(0, std::memory_order_acq_rel), std::memory_order_release);
+}
+
+void EmuFrameTrace::markDraw(Stage stage)
+{
+	auto id = drawId.load(std::memory_order_acquire);
+	if(!id)
+		return;
+	auto &rec = activeRecord(id);
+	rec.time[(size_t)stage] = IG::steadyClockTimestamp();
+	if(stage == Stage::PRESENT_END)
+	{
+		drawId.store(0, std::memory_order_relaxed);
+		addToHistory(rec);
+	}
+}
+
+void EmuFrameTrace::addToHistory(const Record &record)
+{
+	std::lock_guard lock{historyMutex};
+	if(history.size() < HISTORY_RECORDS)
+	{
+		history.push_back(record);
+	}
+	else
+	{
+		history[historyPos] = record;
+		historyPos = (historyPos + 1) % HISTORY_RECORDS;
+	}
+}
+
+void EmuFrameTrace::printStats(char *str, size_t size) const
+{
+	std::array<std::vector<IG::Time>, std::size(spans)> durations;
+	{
+		std::lock_guard lock{historyMutex};
+		auto count = std::min((size_t)PERCENTILE_RECORDS, history.size());
+		for(auto &d : durations)
+			d.reserve(count);
+		// newest records end just before historyPos once the history wraps
+		iterateTimes(count, i)
+		{
+			auto &rec = history[(historyPos + history.size() - 1 - i) % history.size()];
+			iterateTimes(std::size(spans), s)
+			{
+				durations[s].push_back(rec.duration(spans[s].from, spans[s].to));
+			}
+		}
+	}
+	if(durations[0].empty())
+	{
+		string_copy(str, "No frames presented", size);
+		return;
+	}
+	auto percentile =
+		[](std::vector<IG::Time> &v, double p)
+		{
+			auto it = v.begin() + std::min(size_t(p * v.size()), v.size() - 1);
+			std::nth_element(v.begin(), it, v.end());
+			return toMSecs(*it);
+		};
+	size_t pos = snprintf(str, size, "%zu frames, ms p50/p90/p99", durations[0].size());
+	iterateTimes(std::size(spans), s)
+	{
+		if(pos >= size)
+			break;
+		auto &v = durations[s];
+		double p50 = percentile(v, .5), p90 = percentile(v, .9), p99 = percentile(v, .99);
+		pos += snprintf(str + pos, size - pos, "\n%s: %.2f / %.2f / %.2f", spans[s].name, p50, p90, p99);
+	}
+}
+
+bool EmuFrameTrace::writeChromeTrace(const char *path) const
+{
+	std::string json = "{\"traceEvents\":[\n";
+	const char *threadNames[]{"Frames", "Main", "Emulation", "Renderer"};
+	iterateTimes(std::size(threadNames), i)
+	{
+		json += string_makePrintf<128>("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}},\n",
+			i, threadNames[i]).data();
+	}
+	{
+		std::lock_guard lock{historyMutex};
+		if(history.empty())
+			return false;
+		json.reserve(history.size() * std::size(spans) * 100);
+		auto base = history[historyPos % history.size()].time[(size_t)Stage::VSYNC];
+		bool first = true;
+		iterateTimes(history.size(), i)
+		{
+			auto &rec = history[(historyPos + i) % history.size()];
+			for(const auto &span : spans)
+			{
+				auto start = rec.time[(size_t)span.from];
+				auto dur = rec.duration(span.from, span.to);
+				if(!start.count())
+					continue;
+				json += string_makePrintf<256>("%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+					"\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%u,\"emulated\":%u}}",
+					first ? "" : ",\n", span.name, span.tid,
+					toMSecs(start - base) * 1000., toMSecs(dur) * 1000., rec.id, rec.framesEmulated).data();
+				first = false;
+			}
+		}
+	}
+	json += "\n],\n\"displayTimeUnit\":\"ms\"}\n";
+	FileIO file;
+	if(file.create(path))
+	{
+		logErr("error creating frame trace:%s", path);
+		return false;
+	}
+	return file.write(json.data(), json.size()) == (ssize_t)json.size();
+}
+
+#endif
@@ -0,0 +1,89 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/time/Time.hh>
+#include <imagine/base/Timer.hh>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+// Records when each displayed frame passes through the stages from the display
+// refresh that triggered it until its present. Rolling per-stage percentiles are
+// shown over the emulated video and a Chrome trace of the recent frames is written
+// when emulation pauses. Built when CONFIG_EMUFRAMEWORK_FRAME_STATS is defined.
+
+class EmuFrameTrace
+{
+public:
+	enum class Stage : uint8_t
+	{
+		VSYNC,
+		ON_FRAME,
+		DISPATCH,
+		EMULATE_START,
+		EMULATE_END,
+		FENCE_WAIT_END,
+		UPLOAD_END,
+		DRAW_START,
+		DRAW_END,
+		PRESENT_END
+	};
+	static constexpr size_t STAGES = (size_t)Stage::PRESENT_END + 1;
+
+	struct Record
+	{
+		std::array<IG::Time, STAGES> time{};
+		uint32_t id = 0;
+		uint8_t framesEmulated = 0;
+
+		IG::Time duration(Stage from, Stage to) const;
+	};
+
+	EmuFrameTrace() {}
+	void start();
+	void stop();
+	// main thread, right before the frame is sent to the emulation thread
+	void beginFrame(IG::FrameTime vsyncTime, IG::Time onFrameTime, uint8_t framesEmulated);
+	// emulation thread
+	void markEmulation(Stage stage);
+	void finishEmulation();
+	// main thread, before posting a draw that may show a new frame
+	void prepareDraw();
+	// renderer thread, the present completes the frame's record
+	void markDraw(Stage stage);
+	bool writeChromeTrace(const char *path) const;
+
+protected:
+	static constexpr uint32_t ACTIVE_RECORDS = 8;
+	static constexpr uint32_t HISTORY_RECORDS = 600;
+	static constexpr uint32_t PERCENTILE_RECORDS = 120;
+
+	std::array<Record, ACTIVE_RECORDS> active{};
+	std::vector<Record> history{};
+	mutable std::mutex historyMutex{};
+	Base::Timer statsTimer{"EmuFrameTrace::statsTimer"};
+	size_t historyPos = 0;
+	uint32_t nextId = 0;
+	std::atomic_uint32_t emulationId{};
+	std::atomic_uint32_t finishedId{};
+	std::atomic_uint32_t drawId{};
+
+	Record &activeRecord(uint32_t id) { return active[id % ACTIVE_RECORDS]; }
+	void addToHistory(const Record &record);
+	void printStats(char *str, size_t size) const;
+};
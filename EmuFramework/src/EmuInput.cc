@@ -204,7 +204,7 @@ void processRelPtr(Input::Event e)
 	{
 		//logMsg("reversed trackball X direction");
 		relPtr.x = e.pos().x;
-		EmuSystem::handleInputAction(Input::RELEASED, relPtr.xAction);
+		emuViewController.sendInputAction(Input::RELEASED, relPtr.xAction, e.time());
 	}
 	else
 		relPtr.x += e.pos().x;
@@ -212,14 +212,14 @@ void processRelPtr(Input::Event e)
 	if(e.pos().x)
 	{
 		relPtr.xAction = EmuSystem::translateInputAction(e.pos().x > 0 ? EmuControls::systemKeyMapStart+1 : EmuControls::systemKeyMapStart+3);
-		EmuSystem::handleInputAction(Input::PUSHED, relPtr.xAction);
+		emuViewController.sendInputAction(Input::PUSHED, relPtr.xAction, e.time());
 	}
 
 	if(relPtr.y != 0 && sign(relPtr.y) != sign(e.pos().y))
 	{
 		//logMsg("reversed trackball Y direction");
 		relPtr.y = e.pos().y;
-		EmuSystem::handleInputAction(Input::RELEASED, relPtr.yAction);
+		emuViewController.sendInputAction(Input::RELEASED, relPtr.yAction, e.time());
 	}
 	else
 		relPtr.y += e.pos().y;
@@ -227,7 +227,7 @@ void processRelPtr(Input::Event e)
 	if(e.pos().y)
 	{
 		relPtr.yAction = EmuSystem::translateInputAction(e.pos().y > 0 ? EmuControls::systemKeyMapStart+2 : EmuControls::systemKeyMapStart);
-		EmuSystem::handleInputAction(Input::PUSHED, relPtr.yAction);
+		emuViewController.sendInputAction(Input::PUSHED, relPtr.yAction, e.time());
 	}
 
 	//logMsg("trackball event %d,%d, rel ptr %d,%d", e.x, e.y, relPtr.x, relPtr.y);
@@ -251,12 +251,12 @@ void TurboInput::update()
 			if(clock == 0)
 			{
 				//logMsg("turbo push for player %d, action %d", e.player, e.action);
-				EmuSystem::handleInputAction(Input::PUSHED, e.action);
+				emuMovie.handleInputAction(Input::PUSHED, e.action);
 			}
 			else if(clock == turboFrames/2)
 			{
 				//logMsg("turbo release for player %d, action %d", e.player, e.action);
-				EmuSystem::handleInputAction(Input::RELEASED, e.action);
+				emuMovie.handleInputAction(Input::RELEASED, e.action);
 			}
 		}
 	}
@@ -790,6 +790,7 @@ void setActiveFaceButtons(uint btns)
 	setupVControllerVars();
 	vController.place();
 	EmuSystem::clearInputBuffers(emuViewController.inputView());
+	emuMovie.onInputBuffersCleared();
 	#endif
 }
 
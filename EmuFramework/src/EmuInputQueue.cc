@@ -0,0 +1,85 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+
+#define LOGTAG "EmuInputQueue"
+#include "EmuInputQueue.hh"
+#include "private.hh"
+#include <imagine/logger/logger.h>
+#include <algorithm>
+
+bool EmuInputQueue::push(uint32_t state, uint32_t emuKey, IG::Time time)
+{
+	auto wIdx = writeIdx.load(std::memory_order_relaxed);
+	if(unlikely(wIdx - readIdx.load(std::memory_order_acquire) == CAPACITY))
+	{
+		logWarn("queue full, dropped action:%u state:%u", emuKey, state);
+		return false;
+	}
+	ring[wIdx % CAPACITY] = {time, IG::steadyClockTimestamp(), emuKey, (uint8_t)state};
+	writeIdx.store(wIdx + 1, std::memory_order_release);
+	return true;
+}
+
+uint32_t EmuInputQueue::apply()
+{
+	auto rIdx = readIdx.load(std::memory_order_relaxed);
+	auto wIdx = writeIdx.load(std::memory_order_acquire);
+	if(rIdx == wIdx)
+		return 0;
+	auto now = IG::steadyClockTimestamp();
+	uint32_t events = wIdx - rIdx;
+	for(; rIdx != wIdx; rIdx++)
+	{
+		auto &e = ring[rIdx % CAPACITY];
+		emuMovie.handleInputAction(e.state, e.emuKey);
+		addLatency(e, now);
+	}
+	readIdx.store(rIdx, std::memory_order_release);
+	return events;
+}
+
+void EmuInputQueue::clear()
+{
+	readIdx.store(writeIdx.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+void EmuInputQueue::addLatency(const Event &e, IG::Time now)
+{
+	// device times from a different clock than steadyClockTimestamp() are skipped
+	auto start = e.queueTime;
+	if(e.time.count() && e.time <= e.queueTime && e.queueTime - e.time < IG::Seconds{1})
+	{
+		deviceLatencySum += e.queueTime - e.time;
+		deviceLatencyEvents++;
+		start = e.time;
+	}
+	queueLatencySum += now - e.queueTime;
+	maxLatency = std::max(maxLatency, now - start);
+	if(++latencyEvents == LATENCY_SAMPLE_EVENTS)
+	{
+		if(Config::DEBUG_BUILD)
+		{
+			logMsg("input latency over %u events, device->queue:%.2fms (%u events) queue->frame:%.2fms max:%.2fms",
+				latencyEvents,
+				deviceLatencyEvents ? IG::FloatSeconds(deviceLatencySum).count() * 1000. / deviceLatencyEvents : 0.,
+				deviceLatencyEvents,
+				IG::FloatSeconds(queueLatencySum).count() * 1000. / latencyEvents,
+				IG::FloatSeconds(maxLatency).count() * 1000.);
+		}
+		deviceLatencySum = queueLatencySum = maxLatency = {};
+		deviceLatencyEvents = latencyEvents = 0;
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/config/defs.hh>
+#include <imagine/time/Time.hh>
+#include <array>
+#include <atomic>
+
+// Carries input actions from the main thread to the emulation thread so they're
+// applied between frames instead of at an arbitrary point while a frame runs.
+// Single producer (main thread), single consumer (emulation thread).
+
+class EmuInputQueue
+{
+public:
+	struct Event
+	{
+		IG::Time time{}; // when the device reported it, or 0 if unknown
+		IG::Time queueTime{};
+		uint32_t emuKey = 0;
+		uint8_t state = 0;
+	};
+
+	EmuInputQueue() {}
+	bool push(uint32_t state, uint32_t emuKey, IG::Time time);
+	// passes queued actions to EmuSystem::handleInputAction(), returns how many,
+	// only call from the consumer or while it's known to be idle
+	uint32_t apply();
+	void clear();
+
+protected:
+	static constexpr uint32_t CAPACITY = 256;
+	static constexpr uint32_t LATENCY_SAMPLE_EVENTS = 64;
+
+	alignas(64) std::atomic<uint32_t> writeIdx{};
+	alignas(64) std::atomic<uint32_t> readIdx{};
+	std::array<Event, CAPACITY> ring{};
+	// latency from the device to the queue and from the queue to the start of the frame
+	IG::Time deviceLatencySum{};
+	IG::Time queueLatencySum{};
+	IG::Time maxLatency{};
+	uint32_t deviceLatencyEvents = 0;
+	uint32_t latencyEvents = 0;
+
+	void addLatency(const Event &e, IG::Time now);
+};
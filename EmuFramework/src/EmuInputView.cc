@@ -47,6 +47,7 @@ void EmuInputView::resetInput()
 	vController.resetInput();
 	#endif
 	ffToggleActive = false;
+	emuViewController.setRewindActive(false);
 }
 
 void EmuInputView::updateFastforward()
@@ -137,6 +138,11 @@ bool EmuInputView::inputEvent(Input::Event e)
 						logMsg("fast-forward state:%d", ffToggleActive);
 					}
 
+					bcase guiKeyIdxRewind:
+					{
+						emuViewController.setRewindActive(e.pushed());
+					}
+
 					bcase guiKeyIdxLoadGame:
 					if(e.pushed())
 					{
@@ -160,13 +166,11 @@ bool EmuInputView::inputEvent(Input::Event e)
 						static auto doSaveState =
 							[]()
 							{
-								if(auto err = EmuApp::saveStateWithSlot(EmuSystem::saveStateSlot);
+								if(auto err = EmuApp::saveStateWithSlot(EmuSystem::saveStateSlot, true);
 									err)
 								{
 									EmuApp::printfMessage(4, true, "Save State: %s", err->what());
 								}
-								else
-									EmuApp::postMessage("State Saved");
 							};
 
 						if(EmuSystem::shouldOverwriteExistingState())
@@ -258,7 +262,7 @@ bool EmuInputView::inputEvent(Input::Event e)
 								turboActions.removeEvent(sysAction);
 							}
 						}
-						EmuSystem::handleInputAction(e.state(), sysAction);
+						emuViewController.sendInputAction(e.state(), sysAction, e.time());
 					}
 				}
 			}
@@ -31,6 +31,7 @@
 #include "private.hh"
 #include "privateInput.hh"
 #include "RecentGameView.hh"
+#include "RomLibraryView.hh"
 #ifdef CONFIG_BLUETOOTH
 #include <imagine/bluetooth/sys.hh>
 #include <imagine/bluetooth/BluetoothInputDevScanner.hh>
@@ -65,6 +66,7 @@ public:
 			{
 				dismiss();
 				EmuSystem::reset(EmuSystem::RESET_SOFT);
+				emuViewController.resetRunAhead();
 				emuViewController.showEmulation();
 			}
 		},
@@ -75,6 +77,7 @@ public:
 			{
 				dismiss();
 				EmuSystem::reset(EmuSystem::RESET_HARD);
+				emuViewController.resetRunAhead();
 				emuViewController.showEmulation();
 			}
 		},
@@ -190,6 +193,7 @@ void EmuMainMenuView::loadFileBrowserItems()
 {
 	item.emplace_back(&loadGame);
 	item.emplace_back(&recentGames);
+	item.emplace_back(&romLibraryItem);
 	if(EmuSystem::hasBundledGames && optionShowBundledGames)
 	{
 		item.emplace_back(&bundledGames);
@@ -248,6 +252,14 @@ EmuMainMenuView::EmuMainMenuView(ViewAttachParams attach, bool customMenu):
 			}
 		}
 	},
+	romLibraryItem
+	{
+		"ROM Library",
+		[this](Input::Event e)
+		{
+			pushAndShow(makeView<RomLibraryView>(), e);
+		}
+	},
 	bundledGames
 	{
 		"Bundled Games",
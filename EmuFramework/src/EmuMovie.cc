@@ -0,0 +1,365 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+
+#define LOGTAG "EmuMovie"
+#include "EmuMovie.hh"
+#include <imagine/io/FileIO.hh>
+#include <imagine/input/Input.hh>
+#include <imagine/util/string.h>
+#include <imagine/logger/logger.h>
+#include <algorithm>
+#include <cstring>
+#include <zlib.h>
+
+// File layout, all integers little-endian:
+// "EMUMOVIE", u32 version, u32 uncompressed payload size, zlib payload
+// Payload: u8 system name length, system name, u32 frames,
+// u32 state size, state, u32 event bytes, events
+// Each event is varint frames since the previous event, varint emu key, u8 state,
+// a state of 0 marks a clear of the input buffers
+
+static constexpr char MAGIC[8]{'E', 'M', 'U', 'M', 'O', 'V', 'I', 'E'};
+static constexpr uint32_t VERSION = 1;
+static constexpr uint8_t CLEAR_MARKER = 0;
+
+static void writeVarint(std::vector<uint8_t> &buff, uint32_t val)
+{
+	while(val >= 0x80)
+	{
+		buff.push_back((val & 0x7F) | 0x80);
+		val >>= 7;
+	}
+	buff.push_back(val);
+}
+
+static bool readVarint(const std::vector<uint8_t> &buff, size_t &pos, uint32_t &val)
+{
+	val = 0;
+	for(uint32_t shift = 0; shift < 35; shift += 7)
+	{
+		if(pos == buff.size())
+			return false;
+		auto byte = buff[pos++];
+		val |= (uint32_t)(byte & 0x7F) << shift;
+		if(!(byte & 0x80))
+			return true;
+	}
+	return false;
+}
+
+static void writeU32(std::vector<uint8_t> &buff, uint32_t val)
+{
+	for(int i = 0; i < 4; i++)
+		buff.push_back(val >> (i * 8));
+}
+
+static bool readU32(const uint8_t *&data, const uint8_t *end, uint32_t &val)
+{
+	if(end - data < 4)
+		return false;
+	val = data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+	data += 4;
+	return true;
+}
+
+static bool readBytes(const uint8_t *&data, const uint8_t *end, std::vector<uint8_t> &out, uint32_t size)
+{
+	if((size_t)(end - data) < size)
+		return false;
+	out.assign(data, data + size);
+	data += size;
+	return true;
+}
+
+EmuSystem::Error EmuMovie::startRecording()
+{
+	stop();
+	if(auto err = EmuSystem::saveStateToBuffer(startState);
+		err)
+	{
+		return err;
+	}
+	mode = Mode::RECORD;
+	logMsg("recording from %zu byte start state", startState.size());
+	return {};
+}
+
+EmuSystem::Error EmuMovie::stopRecording(const char *path)
+{
+	if(!isRecording())
+		return EmuSystem::makeError("Not recording");
+	length = frameIdx;
+	mode = Mode::OFF;
+	std::vector<uint8_t> payload;
+	payload.reserve(startState.size() + events.size() + 64);
+	auto systemName = EmuSystem::shortSystemName();
+	auto nameLen = std::min(strlen(systemName), (size_t)255);
+	payload.push_back(nameLen);
+	payload.insert(payload.end(), systemName, systemName + nameLen);
+	writeU32(payload, length);
+	writeU32(payload, startState.size());
+	payload.insert(payload.end(), startState.begin(), startState.end());
+	writeU32(payload, events.size());
+	payload.insert(payload.end(), events.begin(), events.end());
+	std::vector<uint8_t> fileData(MAGIC, MAGIC + sizeof(MAGIC));
+	writeU32(fileData, VERSION);
+	writeU32(fileData, payload.size());
+	auto headerSize = fileData.size();
+	uLongf compressedSize = compressBound(payload.size());
+	fileData.resize(headerSize + compressedSize);
+	if(compress2(&fileData[headerSize], &compressedSize, payload.data(), payload.size(), Z_DEFAULT_COMPRESSION) != Z_OK)
+	{
+		return EmuSystem::makeError("Error compressing movie");
+	}
+	fileData.resize(headerSize + compressedSize);
+	FileIO file;
+	if(auto ec = file.create(path);
+		ec)
+	{
+		return EmuSystem::makeError(ec);
+	}
+	if(file.write(fileData.data(), fileData.size()) != (ssize_t)fileData.size())
+	{
+		return EmuSystem::makeFileWriteError();
+	}
+	logMsg("wrote %u frame movie with %zu bytes of events to %s (%zu bytes)",
+		length, events.size(), path, fileData.size());
+	return {};
+}
+
+EmuSystem::Error EmuMovie::startPlayback(const char *path)
+{
+	stop();
+	FileIO file;
+	if(auto ec = file.open(path, IO::AccessHint::ALL);
+		ec)
+	{
+		return EmuSystem::makeError(ec);
+	}
+	auto fileData = (const uint8_t*)file.mmapConst();
+	if(!fileData)
+	{
+		return EmuSystem::makeFileReadError();
+	}
+	auto fileEnd = fileData + file.size();
+	uint32_t version, payloadSize;
+	if((size_t)(fileEnd - fileData) < sizeof(MAGIC) || memcmp(fileData, MAGIC, sizeof(MAGIC)) != 0)
+	{
+		return EmuSystem::makeError("Not a movie file");
+	}
+	fileData += sizeof(MAGIC);
+	if(!readU32(fileData, fileEnd, version) || !readU32(fileData, fileEnd, payloadSize) ||
+		version != VERSION)
+	{
+		return EmuSystem::makeError("Unsupported movie version");
+	}
+	std::vector<uint8_t> payload(payloadSize);
+	uLongf uncompressedSize = payloadSize;
+	if(uncompress(payload.data(), &uncompressedSize, fileData, fileEnd - fileData) != Z_OK ||
+		uncompressedSize != payloadSize)
+	{
+		return EmuSystem::makeError("Error decompressing movie");
+	}
+	const uint8_t *data = payload.data();
+	auto end = data + payload.size();
+	auto systemName = EmuSystem::shortSystemName();
+	uint32_t stateSize, eventsSize;
+	if(data == end || (size_t)(end - data - 1) < data[0])
+	{
+		return EmuSystem::makeError("Movie is corrupt");
+	}
+	auto nameLen = *data++;
+	if(nameLen != strlen(systemName) || memcmp(data, systemName, nameLen) != 0)
+	{
+		return EmuSystem::makeError("Movie is for a different system");
+	}
+	data += nameLen;
+	if(!readU32(data, end, length) ||
+		!readU32(data, end, stateSize) || !readBytes(data, end, startState, stateSize) ||
+		!readU32(data, end, eventsSize) || !readBytes(data, end, events, eventsSize))
+	{
+		startState.clear();
+		events.clear();
+		return EmuSystem::makeError("Movie is corrupt");
+	}
+	if(auto err = restartPlayback();
+		err)
+	{
+		stop();
+		return err;
+	}
+	logMsg("playing %u frame movie from %s", length, path);
+	return {};
+}
+
+EmuSystem::Error EmuMovie::restartPlayback()
+{
+	releasePressedKeys();
+	if(auto err = loadStartState();
+		err)
+	{
+		return err;
+	}
+	eventPos = 0;
+	frameIdx = 0;
+	lastEventFrame = 0;
+	mode = Mode::PLAY;
+	return {};
+}
+
+void EmuMovie::stop()
+{
+	if(isRecording())
+		logMsg("discarding recording");
+	else
+		releasePressedKeys();
+	mode = Mode::OFF;
+	events.clear();
+	pressedKeys.clear();
+	eventPos = 0;
+	frameIdx = 0;
+	lastEventFrame = 0;
+	length = 0;
+}
+
+uint32_t EmuMovie::frames() const
+{
+	return isRecording() ? frameIdx : length;
+}
+
+void EmuMovie::handleInputAction(uint state, uint emuKey)
+{
+	switch(mode)
+	{
+		bcase Mode::OFF:
+			EmuSystem::handleInputAction(state, emuKey);
+		bcase Mode::RECORD:
+			writeEvent(state, emuKey);
+			applyEvent(state, emuKey);
+		bcase Mode::PLAY:
+			// live input would change the outcome
+			break;
+	}
+}
+
+void EmuMovie::onInputBuffersCleared()
+{
+	switch(mode)
+	{
+		bcase Mode::OFF:
+			break;
+		bcase Mode::RECORD:
+			writeEvent(CLEAR_MARKER, 0);
+			pressedKeys.clear();
+		bcase Mode::PLAY:
+			// restore what the movie has held down so the next frames match the recording
+			for(auto key : pressedKeys)
+			{
+				EmuSystem::handleInputAction(Input::PUSHED, key);
+			}
+	}
+}
+
+void EmuMovie::beginFrame()
+{
+	if(!isPlaying())
+		return;
+	while(eventPos < events.size())
+	{
+		auto pos = eventPos;
+		uint32_t frameDelta, emuKey;
+		if(!readVarint(events, pos, frameDelta) || lastEventFrame + frameDelta > frameIdx)
+			return;
+		if(!readVarint(events, pos, emuKey) || pos == events.size())
+		{
+			logErr("truncated event at offset %zu", eventPos);
+			eventPos = events.size();
+			return;
+		}
+		uint8_t state = events[pos++];
+		eventPos = pos;
+		lastEventFrame += frameDelta;
+		if(state == CLEAR_MARKER)
+		{
+			releasePressedKeys();
+		}
+		else
+		{
+			applyEvent(state, emuKey);
+		}
+	}
+}
+
+bool EmuMovie::endFrame()
+{
+	if(!isActive())
+		return false;
+	frameIdx++;
+	if(isPlaying() && frameIdx >= length)
+	{
+		logMsg("playback ended after %u frames", frameIdx);
+		mode = Mode::OFF;
+		return true;
+	}
+	return false;
+}
+
+FS::PathString EmuMovie::defaultPath()
+{
+	return FS::makePathStringPrintf("%s/%s.emv", EmuSystem::savePath(), EmuSystem::gameName().data());
+}
+
+void EmuMovie::writeEvent(uint8_t state, uint32_t emuKey)
+{
+	writeVarint(events, frameIdx - lastEventFrame);
+	writeVarint(events, emuKey);
+	events.push_back(state);
+	lastEventFrame = frameIdx;
+}
+
+void EmuMovie::applyEvent(uint8_t state, uint32_t emuKey)
+{
+	updatePressedKeys(state, emuKey);
+	EmuSystem::handleInputAction(state, emuKey);
+}
+
+void EmuMovie::updatePressedKeys(uint8_t state, uint32_t emuKey)
+{
+	auto it = std::find(pressedKeys.begin(), pressedKeys.end(), emuKey);
+	if(state == Input::PUSHED)
+	{
+		if(it == pressedKeys.end())
+			pressedKeys.push_back(emuKey);
+	}
+	else if(it != pressedKeys.end())
+	{
+		pressedKeys.erase(it);
+	}
+}
+
+void EmuMovie::releasePressedKeys()
+{
+	for(auto key : pressedKeys)
+	{
+		EmuSystem::handleInputAction(Input::RELEASED, key);
+	}
+	pressedKeys.clear();
+}
+
+EmuSystem::Error EmuMovie::loadStartState()
+{
+	return EmuSystem::loadStateFromBuffer({(const char*)startState.data(), startState.size()});
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <emuframework/EmuSystem.hh>
+#include <imagine/fs/FS.hh>
+#include <vector>
+
+// Records the input actions reaching the core along with the frame they were
+// applied before, starting from an in-memory save state, so a session can be
+// replayed deterministically including headless with --benchmark-movie.
+// State changes happen on the main thread while the emulation thread is paused,
+// the per-frame functions run on whichever thread is emulating.
+
+class EmuMovie
+{
+public:
+	EmuMovie() {}
+	EmuSystem::Error startRecording();
+	EmuSystem::Error stopRecording(const char *path);
+	EmuSystem::Error startPlayback(const char *path);
+	EmuSystem::Error restartPlayback();
+	void stop();
+	bool isRecording() const { return mode == Mode::RECORD; }
+	bool isPlaying() const { return mode == Mode::PLAY; }
+	bool isActive() const { return mode != Mode::OFF; }
+	uint32_t frames() const;
+	// passes a live action to the core and records it, or drops it during playback
+	void handleInputAction(uint state, uint emuKey);
+	// called after the core's input state is reset by EmuSystem::clearInputBuffers()
+	void onInputBuffersCleared();
+	// call before each emulated frame, applies the recorded actions during playback
+	void beginFrame();
+	// call after each emulated frame, returns true when playback just ended
+	bool endFrame();
+	static FS::PathString defaultPath();
+
+protected:
+	enum class Mode : uint8_t { OFF, RECORD, PLAY };
+
+	std::vector<uint8_t> startState{};
+	std::vector<uint8_t> events{};
+	std::vector<uint32_t> pressedKeys{};
+	size_t eventPos = 0;
+	uint32_t frameIdx = 0;
+	uint32_t lastEventFrame = 0;
+	uint32_t length = 0;
+	Mode mode = Mode::OFF;
+
+	void writeEvent(uint8_t state, uint32_t emuKey);
+	void applyEvent(uint8_t state, uint32_t emuKey);
+	void updatePressedKeys(uint8_t state, uint32_t emuKey);
+	void releasePressedKeys();
+	EmuSystem::Error loadStartState();
+};
@@ -65,6 +65,10 @@ Byte1Option optionSound(CFGKEY_SOUND, OPTION_SOUND_DEFAULT_FLAGS);
 Byte1Option optionSoundBuffers(CFGKEY_SOUND_BUFFERS,
 	4, 0, optionIsValidWithMinMax<2, 8, uint8_t>);
 Byte1Option optionAddSoundBuffersOnUnderrun(CFGKEY_ADD_SOUND_BUFFERS_ON_UNDERRUN, 1, 0);
+Byte1Option optionAudioRateControl(CFGKEY_AUDIO_RATE_CONTROL, 1, 0);
+Byte1Option optionAudioFloatOutput(CFGKEY_AUDIO_FLOAT_OUTPUT, 0, 0);
+Byte1Option optionSoundVolume(CFGKEY_SOUND_VOLUME,
+	100, 0, optionIsValidWithMinMax<25, 150, uint8_t>);
 
 #ifdef CONFIG_AUDIO_MANAGER_SOLO_MIX
 OptionAudioSoloMix optionAudioSoloMix(CFGKEY_AUDIO_SOLO_MIX, 1);
@@ -102,6 +106,9 @@ Byte1Option optionHideStatusBar(CFGKEY_HIDE_STATUS_BAR, 1, !Config::envIsAndroid
 OptionSwappedGamepadConfirm optionSwappedGamepadConfirm(CFGKEY_SWAPPED_GAMEPAD_CONFIM, Input::SWAPPED_GAMEPAD_CONFIRM_DEFAULT);
 Byte1Option optionConfirmOverwriteState(CFGKEY_CONFIRM_OVERWRITE_STATE, 1, 0);
 Byte1Option optionFastForwardSpeed(CFGKEY_FAST_FORWARD_SPEED, 4, 0, optionIsValidWithMinMax<2, 7>);
+Byte1Option optionRewindBufferSize(CFGKEY_REWIND_BUFFER_SIZE, 0, 0, optionIsValidWithMax<128>); // in MiB, 0 = off
+Byte1Option optionRewindInterval(CFGKEY_REWIND_INTERVAL, 1, 0, optionIsValidWithMinMax<1, 8>);
+Byte1Option optionRunAheadFrames(CFGKEY_RUN_AHEAD_FRAMES, 0, 0, optionIsValidWithMax<4>);
 #ifdef CONFIG_INPUT_DEVICE_HOTSWAP
 Byte1Option optionNotifyInputDeviceChange(CFGKEY_NOTIFY_INPUT_DEVICE_CHANGE, Config::Input::DEVICE_HOTSWAP, !Config::Input::DEVICE_HOTSWAP);
 #endif
@@ -120,6 +127,7 @@ Byte1Option optionShowBluetoothScan(CFGKEY_SHOW_BLUETOOTH_SCAN, 1);
 DoubleOption optionAspectRatio{CFGKEY_GAME_ASPECT_RATIO, (double)EmuSystem::aspectRatioInfo[0], 0, optionAspectRatioIsValid};
 
 Byte1Option optionImgFilter(CFGKEY_GAME_IMG_FILTER, 1, 0);
+Byte1Option optionDirectVideoRendering(CFGKEY_DIRECT_VIDEO_RENDERING, 1, 0);
 #ifdef CONFIG_GFX_OPENGL_SHADER_PIPELINE
 Byte1Option optionImgEffect(CFGKEY_IMAGE_EFFECT, 0, 0, optionIsValidWithMax<VideoImageEffect::LAST_EFFECT_VAL-1>);
 #endif
@@ -219,6 +227,7 @@ Byte1Option optionFrameInterval
 	{CFGKEY_FRAME_INTERVAL,	1, !Config::envIsIOS, optionIsValidWithMinMax<1, 4>};
 #endif
 Byte1Option optionSkipLateFrames{CFGKEY_SKIP_LATE_FRAMES, 1, 0};
+Byte1Option optionFramePacing{CFGKEY_FRAME_PACING, 0, 0, optionIsValidWithMax<3>};
 DoubleOption optionFrameRate{CFGKEY_FRAME_RATE, 0, 0, optionFrameTimeIsValid};
 DoubleOption optionFrameRatePAL{CFGKEY_FRAME_RATE_PAL, 1./50., !EmuSystem::hasPALVideoSystem, optionFrameTimePALIsValid};
 
@@ -321,6 +330,11 @@ void initOptions()
 	{
 		optionShowOnSecondScreen.isConst = true;
 	}
+	if(Base::androidSDK() < 21)
+	{
+		// OpenSL ES only accepts float samples on 5.0+
+		optionAudioFloatOutput.isConst = true;
+	}
 	else if(FS::exists(FS::makePathStringPrintf("%s/emuex_disable_presentation_displays", Base::sharedStoragePath().data())))
 	{
 		logMsg("force-disabling presentation display support");
@@ -385,6 +399,12 @@ void initOptions()
 		optionFrameRate.isConst = true;
 	}
 
+	if(!EmuSystem::hasDirectVideoRendering)
+	{
+		optionDirectVideoRendering.initDefault(0);
+		optionDirectVideoRendering.isConst = true;
+	}
+
 	EmuSystem::initOptions();
 
 	bool defaultToLargeControls = false;
@@ -561,7 +581,14 @@ bool OptionRecentGames::readFromIO(IO &io, uint readSize_)
 			continue; // don't add empty paths
 		info.path[bytesRead] = 0;
 		readSize -= len;
-		info.name = EmuSystem::fullGameNameForPath(info.path.data());
+		if(auto libEntry = romLibrary.findPath(info.path.data());
+			libEntry && strlen(romLibrary.title(*libEntry)))
+		{
+			// use the indexed title to avoid resolving it from the file again
+			string_copy(info.name, romLibrary.title(*libEntry));
+		}
+		else
+			info.name = EmuSystem::fullGameNameForPath(info.path.data());
 		//logMsg("adding game to recent list: %s, name: %s", info.path, info.name);
 		recentGameList.push_back(info);
 	}
@@ -75,7 +75,11 @@ enum { CFGKEY_SOUND = 0, CFGKEY_TOUCH_CONTROL_DISPLAY = 1,
 	CFGKEY_FRAME_RATE_PAL = 78, CFGKEY_TIME_FRAMES_WITH_SCREEN_REFRESH = 79,
 	CFGKEY_SUSTAINED_PERFORMANCE_MODE = 80, CFGKEY_SHOW_BLUETOOTH_SCAN = 81,
 	CFGKEY_ADD_SOUND_BUFFERS_ON_UNDERRUN = 82, CFGKEY_GPU_MULTITHREADING = 83,
-	CFGKEY_AUDIO_API = 84
+	CFGKEY_AUDIO_API = 84, CFGKEY_REWIND_BUFFER_SIZE = 85,
+	CFGKEY_REWIND_INTERVAL = 86, CFGKEY_RUN_AHEAD_FRAMES = 87,
+	CFGKEY_DIRECT_VIDEO_RENDERING = 88, CFGKEY_AUDIO_RATE_CONTROL = 89,
+	CFGKEY_AUDIO_FLOAT_OUTPUT = 90, CFGKEY_SOUND_VOLUME = 91,
+	CFGKEY_FRAME_PACING = 92
 	// 256+ is reserved
 };
 
@@ -104,6 +108,9 @@ extern Byte1Option optionConfirmAutoLoadState;
 extern Byte1Option optionSound;
 extern Byte1Option optionSoundBuffers;
 extern Byte1Option optionAddSoundBuffersOnUnderrun;
+extern Byte1Option optionAudioRateControl;
+extern Byte1Option optionAudioFloatOutput;
+extern Byte1Option optionSoundVolume;
 #ifdef CONFIG_AUDIO_MANAGER_SOLO_MIX
 using OptionAudioSoloMix = Option<OptionMethodFunc<bool, IG::AudioManager::soloMix, IG::AudioManager::setSoloMix>, uint8_t>;
 extern OptionAudioSoloMix optionAudioSoloMix;
@@ -126,6 +133,9 @@ extern Byte1Option optionHideStatusBar;
 extern OptionSwappedGamepadConfirm optionSwappedGamepadConfirm;
 extern Byte1Option optionConfirmOverwriteState;
 extern Byte1Option optionFastForwardSpeed;
+extern Byte1Option optionRewindBufferSize;
+extern Byte1Option optionRewindInterval;
+extern Byte1Option optionRunAheadFrames;
 #ifdef CONFIG_INPUT_DEVICE_HOTSWAP
 extern Byte1Option optionNotifyInputDeviceChange;
 #endif
@@ -142,6 +152,7 @@ extern Byte1Option optionShowBluetoothScan;
 #endif
 
 extern Byte1Option optionImgFilter;
+extern Byte1Option optionDirectVideoRendering;
 extern DoubleOption optionAspectRatio;
 #ifdef CONFIG_GFX_OPENGL_SHADER_PIPELINE
 extern Byte1Option optionImgEffect;
@@ -182,6 +193,7 @@ extern OptionVControllerLayoutPosition optionVControllerLayoutPos;
 extern Byte1Option optionFrameInterval;
 #endif
 extern Byte1Option optionSkipLateFrames;
+extern Byte1Option optionFramePacing;
 extern DoubleOption optionFrameRate;
 extern DoubleOption optionFrameRatePAL;
 extern DoubleOption optionRefreshRateOverride;
@@ -0,0 +1,283 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "EmuRewind"
+#include "EmuRewind.hh"
+#include "EmuOptions.hh"
+#include <emuframework/EmuSystem.hh>
+#include <imagine/time/Time.hh>
+#include <imagine/util/utility.h>
+#include <imagine/logger/logger.h>
+#include <algorithm>
+#include <cstring>
+
+// unchanged byte runs shorter than this are stored inline with the changed bytes
+// since the run header would cost about as much as the bytes themselves
+static constexpr size_t MIN_SKIP_RUN = 16;
+static constexpr size_t MAX_VARINT_BYTES = 5;
+
+static uint8_t *writeVarint(uint8_t *out, uint32_t val)
+{
+	while(val >= 0x80)
+	{
+		*out++ = val | 0x80;
+		val >>= 7;
+	}
+	*out++ = val;
+	return out;
+}
+
+static uint32_t readVarint(const uint8_t *&in)
+{
+	uint32_t val = 0;
+	uint shift = 0;
+	uint8_t byte;
+	do
+	{
+		byte = *in++;
+		val |= uint32_t(byte & 0x7F) << shift;
+		shift += 7;
+	} while(byte & 0x80);
+	return val;
+}
+
+static size_t findFirstDiff(const uint8_t *a, const uint8_t *b, size_t pos, size_t size)
+{
+	// compare a machine word at a time until a mismatch is found
+	for(; pos + sizeof(uint64_t) <= size; pos += sizeof(uint64_t))
+	{
+		uint64_t wordA, wordB;
+		memcpy(&wordA, &a[pos], sizeof(uint64_t));
+		memcpy(&wordB, &b[pos], sizeof(uint64_t));
+		if(wordA != wordB)
+			break;
+	}
+	for(; pos < size; pos++)
+	{
+		if(a[pos] != b[pos])
+			return pos;
+	}
+	return size;
+}
+
+// Writes newData XOR oldData as a series of (skip, length, bytes) runs,
+// output needs space for size + MAX_VARINT_BYTES * 2 bytes
+static size_t encodeDelta(const uint8_t *newData, const uint8_t *oldData, size_t size, uint8_t *out)
+{
+	auto outStart = out;
+	size_t pos = 0;
+	while(pos < size)
+	{
+		size_t diffStart = findFirstDiff(newData, oldData, pos, size);
+		if(diffStart == size)
+			break;
+		size_t diffEnd = diffStart + 1;
+		for(size_t i = diffEnd, equalBytes = 0; i < size; i++)
+		{
+			if(newData[i] == oldData[i])
+			{
+				if(++equalBytes == MIN_SKIP_RUN)
+					break;
+			}
+			else
+			{
+				equalBytes = 0;
+				diffEnd = i + 1;
+			}
+		}
+		out = writeVarint(out, diffStart - pos);
+		out = writeVarint(out, diffEnd - diffStart);
+		for(auto i = diffStart; i < diffEnd; i++)
+		{
+			*out++ = newData[i] ^ oldData[i];
+		}
+		pos = diffEnd;
+	}
+	return out - outStart;
+}
+
+static void applyDelta(const uint8_t *delta, size_t deltaSize, uint8_t *data)
+{
+	auto deltaEnd = delta + deltaSize;
+	while(delta < deltaEnd)
+	{
+		data += readVarint(delta);
+		auto len = readVarint(delta);
+		iterateTimes(len, i)
+		{
+			data[i] ^= delta[i];
+		}
+		data += len;
+		delta += len;
+	}
+}
+
+void EmuRewind::onFrame()
+{
+	if(disabled || !updateRingSize())
+		return;
+	if(++framesSinceCapture < optionRewindInterval.val)
+		return;
+	framesSinceCapture = 0;
+	if(!capture())
+	{
+		logErr("disabling rewind after failed state capture");
+		reset();
+		disabled = true;
+	}
+}
+
+bool EmuRewind::stepBack()
+{
+	if(disabled || lastState.empty())
+		return false;
+	bool movedBack = true;
+	if(!framesSinceCapture)
+	{
+		// current state is already the last captured one, go back one more,
+		// or stay on the oldest state if the history is exhausted
+		if(blocks.size())
+			popBlock();
+		else
+			movedBack = false;
+	}
+	if(auto err = EmuSystem::loadStateFromBuffer({(const char*)lastState.data(), lastState.size()});
+		err)
+	{
+		logErr("error restoring state:%s", err->what());
+		reset();
+		return false;
+	}
+	framesSinceCapture = 0;
+	return movedBack;
+}
+
+void EmuRewind::reset()
+{
+	blocks.clear();
+	ringHead = 0;
+	lastState.clear();
+	framesSinceCapture = 0;
+	disabled = false;
+}
+
+void EmuRewind::deinit()
+{
+	reset();
+	ring.reset();
+	ringSize = 0;
+	lastState = {};
+	newState = {};
+	deltaBuff = {};
+}
+
+size_t EmuRewind::states() const
+{
+	return lastState.size() ? blocks.size() + 1 : 0;
+}
+
+bool EmuRewind::updateRingSize()
+{
+	size_t size = optionRewindBufferSize.val * 1024 * 1024;
+	if(likely(size == ringSize))
+		return size;
+	if(!size)
+	{
+		logMsg("rewind disabled");
+		deinit();
+		return false;
+	}
+	logMsg("allocating %zu byte rewind buffer", size);
+	reset();
+	ring = std::make_unique<uint8_t[]>(size);
+	ringSize = size;
+	return true;
+}
+
+bool EmuRewind::capture()
+{
+	bool success = true;
+	auto time = IG::timeFuncDebug(
+		[&]()
+		{
+			newState.clear();
+			if(auto err = EmuSystem::saveStateToBuffer(newState);
+				err)
+			{
+				logErr("error capturing state:%s", err->what());
+				success = false;
+				return;
+			}
+			if(lastState.empty())
+			{
+				lastState.swap(newState);
+				return;
+			}
+			auto newSize = newState.size();
+			auto prevSize = lastState.size();
+			auto size = std::max(newSize, prevSize);
+			newState.resize(size);
+			lastState.resize(size);
+			deltaBuff.resize(size + MAX_VARINT_BYTES * 2);
+			auto deltaSize = encodeDelta(newState.data(), lastState.data(), size, deltaBuff.data());
+			pushBlock(deltaBuff.data(), deltaSize, prevSize);
+			newState.resize(newSize);
+			lastState.swap(newState);
+		});
+	if(unlikely(time > IG::Milliseconds{1}))
+	{
+		logWarn("state capture took %.3fms", IG::FloatSeconds(time).count() * 1000.);
+	}
+	return success;
+}
+
+void EmuRewind::pushBlock(const uint8_t *data, uint32_t size, uint32_t prevStateSize)
+{
+	if(unlikely(size > ringSize))
+	{
+		// delta doesn't fit, older states can't be reached anymore
+		logWarn("%u byte delta exceeds rewind buffer size", size);
+		blocks.clear();
+		ringHead = 0;
+		return;
+	}
+	// blocks located past the head are the oldest ones, evict them as they're overwritten
+	if(ringHead + size > ringSize)
+	{
+		while(blocks.size() && blocks.front().offset >= ringHead)
+		{
+			blocks.pop_front();
+		}
+		ringHead = 0;
+	}
+	while(blocks.size() && blocks.front().offset >= ringHead && blocks.front().offset < ringHead + size)
+	{
+		blocks.pop_front();
+	}
+	memcpy(&ring[ringHead], data, size);
+	blocks.push_back({(uint32_t)ringHead, size, prevStateSize});
+	ringHead += size;
+}
+
+void EmuRewind::popBlock()
+{
+	assumeExpr(blocks.size());
+	auto block = blocks.back();
+	blocks.pop_back();
+	ringHead = block.offset;
+	lastState.resize(std::max((size_t)block.prevStateSize, lastState.size()));
+	applyDelta(&ring[block.offset], block.size, lastState.data());
+	lastState.resize(block.prevStateSize);
+}
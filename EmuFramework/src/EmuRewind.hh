@@ -0,0 +1,59 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/config/defs.hh>
+#include <memory>
+#include <vector>
+#include <deque>
+
+// Keeps a history of emulation states in a fixed-size ring of memory.
+// Only the most recent state is stored in full, older ones are stored as
+// XOR deltas against their successor with runs of unchanged bytes RLE-encoded.
+
+class EmuRewind
+{
+public:
+	EmuRewind() {}
+	void onFrame();
+	bool stepBack();
+	void reset();
+	void deinit();
+	size_t states() const;
+
+protected:
+	struct Block
+	{
+		uint32_t offset;
+		uint32_t size;
+		uint32_t prevStateSize;
+	};
+
+	std::unique_ptr<uint8_t[]> ring{};
+	size_t ringSize = 0;
+	size_t ringHead = 0;
+	std::deque<Block> blocks{};
+	std::vector<uint8_t> lastState{};
+	std::vector<uint8_t> newState{};
+	std::vector<uint8_t> deltaBuff{};
+	uint32_t framesSinceCapture = 0;
+	bool disabled = false;
+
+	bool updateRingSize();
+	bool capture();
+	void pushBlock(const uint8_t *data, uint32_t size, uint32_t prevStateSize);
+	void popBlock();
+};
@@ -0,0 +1,92 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+
+#define LOGTAG "EmuRunAhead"
+#include "EmuRunAhead.hh"
+#include "EmuOptions.hh"
+#include "EmuSystemTask.hh"
+#include <emuframework/EmuSystem.hh>
+#include <imagine/util/utility.h>
+#include <imagine/logger/logger.h>
+
+bool EmuRunAhead::runFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
+{
+	if(optionRunAheadFrames.val != aheadFrames)
+	{
+		// the cost and any earlier failure were measured for the old frame count
+		reset();
+		aheadFrames = optionRunAheadFrames.val;
+	}
+	if(!aheadFrames || disabled)
+		return false;
+	auto start = IG::steadyClockTimestamp();
+	// frame that advances the system, only its audio is output
+	EmuSystem::runFrame(task, nullptr, audio);
+	state.clear();
+	if(auto err = EmuSystem::saveStateToBuffer(state);
+		err)
+	{
+		logErr("disabling run-ahead after failed state capture:%s", err->what());
+		disabled = true;
+		return false;
+	}
+	iterateTimes(aheadFrames - 1, i)
+	{
+		EmuSystem::runFrame(task, nullptr, nullptr);
+	}
+	EmuSystem::runFrame(task, video, nullptr);
+	if(auto err = EmuSystem::loadStateFromBuffer({(const char*)state.data(), state.size()});
+		err)
+	{
+		logErr("disabling run-ahead after failed state restore:%s", err->what());
+		disabled = true;
+		return true;
+	}
+	addFrameCost(task, IG::steadyClockTimestamp() - start);
+	return true;
+}
+
+void EmuRunAhead::addFrameCost(EmuSystemTask *task, IG::Time cost)
+{
+	costSum += cost;
+	if(++costFrames < COST_SAMPLE_FRAMES)
+		return;
+	auto avgCost = IG::FloatSeconds(costSum / costFrames);
+	costSum = {};
+	costFrames = 0;
+	auto frameTime = EmuSystem::frameTime();
+	logMsg("run-ahead cost:%.3fms per frame (%.0f%% of frame time)",
+		avgCost.count() * 1000., avgCost.count() / frameTime.count() * 100.);
+	if(avgCost > frameTime && !reportedSlow)
+	{
+		reportedSlow = true;
+		task->sendRunAheadSlowReply(avgCost.count() * 1000.);
+	}
+}
+
+void EmuRunAhead::reset()
+{
+	costSum = {};
+	costFrames = 0;
+	disabled = false;
+	reportedSlow = false;
+}
+
+void EmuRunAhead::deinit()
+{
+	reset();
+	state = {};
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/config/defs.hh>
+#include <imagine/time/Time.hh>
+#include <vector>
+
+class EmuSystemTask;
+class EmuVideo;
+class EmuAudio;
+
+// Reduces input latency by running the emulated system ahead of the frame
+// being presented. The real frame is run first with audio only and captured
+// into memory, then frames are run ahead with the current input and the
+// last one's video is presented before the captured state is restored.
+
+class EmuRunAhead
+{
+public:
+	EmuRunAhead() {}
+	bool runFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio);
+	void reset();
+	void deinit();
+
+protected:
+	static constexpr uint32_t COST_SAMPLE_FRAMES = 120;
+
+	std::vector<uint8_t> state{};
+	IG::Time costSum{};
+	uint32_t costFrames = 0;
+	uint8_t aheadFrames = 0;
+	bool disabled = false;
+	bool reportedSlow = false;
+
+	void addFrameCost(EmuSystemTask *task, IG::Time cost);
+};
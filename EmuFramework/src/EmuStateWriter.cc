@@ -0,0 +1,172 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+
+#define LOGTAG "StateWriter"
+#include "EmuStateWriter.hh"
+#include <imagine/io/FileIO.hh>
+#include <imagine/fs/FS.hh>
+#include <imagine/thread/Thread.hh>
+#include <imagine/time/Time.hh>
+#include <imagine/logger/logger.h>
+#include <zlib.h>
+
+static EmuSystem::Error gzipCompress(const std::vector<uint8_t> &data, std::vector<uint8_t> &out)
+{
+	z_stream stream{};
+	if(deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		return EmuSystem::makeError("Error initializing state compression");
+	}
+	out.resize(deflateBound(&stream, data.size()));
+	stream.next_in = (Bytef*)data.data();
+	stream.avail_in = data.size();
+	stream.next_out = out.data();
+	stream.avail_out = out.size();
+	auto result = deflate(&stream, Z_FINISH);
+	out.resize(stream.total_out);
+	deflateEnd(&stream);
+	if(result != Z_STREAM_END)
+	{
+		return EmuSystem::makeError("Error compressing state");
+	}
+	return {};
+}
+
+static EmuSystem::Error writeStateFile(const char *path, std::vector<uint8_t> &data, EmuSystem::StateFileFormat format)
+{
+	std::vector<uint8_t> compressedData;
+	auto fileData = &data;
+	if(format == EmuSystem::StateFileFormat::GZIP)
+	{
+		if(auto err = gzipCompress(data, compressedData);
+			err)
+		{
+			return err;
+		}
+		fileData = &compressedData;
+	}
+	else if(format == EmuSystem::StateFileFormat::CORE_COMPRESSED)
+	{
+		if(auto err = EmuSystem::compressStateFileData(data);
+			err)
+		{
+			return err;
+		}
+	}
+	auto tempPath = FS::makePathStringPrintf("%s.tmp", path);
+	FileIO f;
+	if(auto ec = f.create(tempPath);
+		ec)
+	{
+		return EmuSystem::makeError(std::error_code{ec});
+	}
+	if(f.write(fileData->data(), fileData->size()) != (ssize_t)fileData->size())
+	{
+		f.close();
+		FS::remove(tempPath);
+		return EmuSystem::makeFileWriteError();
+	}
+	// make sure the data is on disk before replacing any previous state
+	f.sync();
+	f.close();
+	std::error_code ec;
+	FS::rename(tempPath.data(), path, ec);
+	if(ec)
+	{
+		FS::remove(tempPath);
+		return EmuSystem::makeError(std::error_code{ec});
+	}
+	return {};
+}
+
+void EmuStateWriter::write(FS::PathString path, std::vector<uint8_t> data, EmuSystem::StateFileFormat format, OnCompleteDelegate onComplete)
+{
+	if(!started)
+		start();
+	{
+		std::lock_guard lock{mutex};
+		jobs.push_back({path, std::move(data), onComplete, {}, format});
+	}
+	jobCondition.notify_one();
+}
+
+void EmuStateWriter::waitForPending()
+{
+	if(!started)
+		return;
+	{
+		std::unique_lock lock{mutex};
+		idleCondition.wait(lock, [this](){ return jobs.empty() && !busy; });
+	}
+	dispatchFinished();
+}
+
+void EmuStateWriter::start()
+{
+	started = true;
+	donePort.attach(
+		[this](auto)
+		{
+			donePort.clear();
+			dispatchFinished();
+			return true;
+		});
+	IG::makeDetachedThread(
+		[this]()
+		{
+			runJobs();
+		});
+}
+
+void EmuStateWriter::runJobs()
+{
+	std::unique_lock lock{mutex};
+	while(true)
+	{
+		jobCondition.wait(lock, [this](){ return jobs.size(); });
+		auto job = std::move(jobs.front());
+		jobs.pop_front();
+		busy = true;
+		lock.unlock();
+		auto time = IG::timeFuncDebug(
+			[&]()
+			{
+				job.err = writeStateFile(job.path.data(), job.data, job.format);
+			});
+		logMsg("wrote %zu byte state to %s in %.3fs", job.data.size(), job.path.data(), IG::FloatSeconds(time).count());
+		job.data = {};
+		lock.lock();
+		busy = false;
+		finishedJobs.emplace_back(std::move(job));
+		if(jobs.empty())
+			idleCondition.notify_all();
+		donePort.send(true);
+	}
+}
+
+void EmuStateWriter::dispatchFinished()
+{
+	std::vector<Job> finished;
+	{
+		std::lock_guard lock{mutex};
+		finished.swap(finishedJobs);
+	}
+	for(auto &job : finished)
+	{
+		if(job.onComplete)
+			job.onComplete(std::move(job.err));
+	}
+}
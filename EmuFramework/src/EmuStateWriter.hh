@@ -0,0 +1,63 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/config/defs.hh>
+#include <imagine/base/MessagePort.hh>
+#include <imagine/fs/FSDefs.hh>
+#include <imagine/util/DelegateFunc.hh>
+#include <emuframework/EmuSystem.hh>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+
+// Writes captured save states to disk from a background thread, compressing
+// them first according to the system's StateFileFormat. Files are written to a temporary path and
+// renamed into place so an interrupted write never leaves a partial state.
+
+class EmuStateWriter
+{
+public:
+	using OnCompleteDelegate = DelegateFunc<void (EmuSystem::Error err)>;
+
+	EmuStateWriter() {}
+	void write(FS::PathString path, std::vector<uint8_t> data, EmuSystem::StateFileFormat format, OnCompleteDelegate onComplete);
+	void waitForPending();
+
+protected:
+	struct Job
+	{
+		FS::PathString path{};
+		std::vector<uint8_t> data{};
+		OnCompleteDelegate onComplete{};
+		EmuSystem::Error err{};
+		EmuSystem::StateFileFormat format{};
+	};
+
+	Base::MessagePort<bool> donePort{"EmuStateWriter"};
+	std::mutex mutex{};
+	std::condition_variable jobCondition{};
+	std::condition_variable idleCondition{};
+	std::deque<Job> jobs{};
+	std::vector<Job> finishedJobs{};
+	bool started = false;
+	bool busy = false;
+
+	void start();
+	void runJobs();
+	void dispatchFinished();
+};
@@ -62,13 +62,16 @@ IG::FloatSeconds EmuSystem::frameTimePAL{1./50.};
 [[gnu::weak]] bool EmuSystem::handlesGenericIO = true;
 [[gnu::weak]] bool EmuSystem::hasCheats = false;
 [[gnu::weak]] bool EmuSystem::hasSound = true;
+[[gnu::weak]] EmuSystem::StateFileFormat EmuSystem::stateFileFormat = StateFileFormat::CUSTOM;
 [[gnu::weak]] int EmuSystem::forcedSoundRate = 0;
+[[gnu::weak]] int EmuSystem::nativeSoundRate = 0;
 [[gnu::weak]] bool EmuSystem::constFrameRate = false;
+[[gnu::weak]] bool EmuSystem::hasDirectVideoRendering = false;
 bool EmuSystem::sessionOptionsSet = false;
 double EmuSystem::audioFramesPerVideoFrameFloat = 0;
 double EmuSystem::currentAudioFramesPerVideoFrame = 0;
 uint32_t EmuSystem::audioFramesPerVideoFrame = 0;
-static EmuTiming emuTiming{};
+EmuTiming emuTiming{};
 
 static IG::Microseconds makeWantedAudioLatencyUSecs(uint8_t buffers)
 {
@@ -102,6 +105,10 @@ bool EmuSystem::shouldOverwriteExistingState()
 
 uint32_t EmuSystem::advanceFramesWithTime(Base::FrameTime time)
 {
+	if(emuTiming.pacing() == FramePacing::AUDIO_CLOCK && emuAudio)
+	{
+		return emuTiming.advanceFramesWithAudio(time, emuAudio.framesUntilTargetFill(), audioFramesPerVideoFrameFloat);
+	}
 	return emuTiming.advanceFramesWithTime(time);
 }
 
@@ -308,15 +315,23 @@ void EmuSystem::pause()
 		state = State::PAUSED;
 	emuAudio.stop();
 	cancelAutoSaveStateTimer();
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_STATS
+	emuFrameTrace.stop();
+	#endif
 }
 
 void EmuSystem::start()
 {
 	state = State::ACTIVE;
 	clearInputBuffers(emuViewController.inputView());
+	emuMovie.onInputBuffersCleared();
 	resetFrameTime();
+	emuTiming.resetStats();
 	emuAudio.start(makeWantedAudioLatencyUSecs(optionSoundBuffers), makeWantedAudioLatencyUSecs(1));
 	startAutoSaveStateTimer();
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_STATS
+	emuFrameTrace.start();
+	#endif
 }
 
 IG::Time EmuSystem::benchmark()
@@ -330,6 +345,41 @@ IG::Time EmuSystem::benchmark()
 	return after-now;
 }
 
+[[gnu::weak]] uint64_t EmuSystem::executedInstructions() { return 0; }
+
+EmuSystem::Error EmuSystem::benchmarkStates(StateBenchmark &result)
+{
+	static constexpr uint runs = 60;
+	std::vector<uint8_t> buff;
+	// initial save sizes the buffer and isn't timed
+	if(auto err = saveStateToBuffer(buff);
+		err)
+	{
+		return err;
+	}
+	IG::Time saveTime{}, loadTime{};
+	iterateTimes(runs, i)
+	{
+		auto start = IG::steadyClockTimestamp();
+		if(auto err = saveStateToBuffer(buff);
+			err)
+		{
+			return err;
+		}
+		auto saveDone = IG::steadyClockTimestamp();
+		if(auto err = loadStateFromBuffer({(const char*)buff.data(), buff.size()});
+			err)
+		{
+			return err;
+		}
+		auto loadDone = IG::steadyClockTimestamp();
+		saveTime += saveDone - start;
+		loadTime += loadDone - saveDone;
+	}
+	result = {buff.size(), saveTime / runs, loadTime / runs};
+	return {};
+}
+
 void EmuSystem::skipFrames(EmuSystemTask *task, uint32_t frames, EmuAudio *audio)
 {
 	assumeExpr(gameIsRunning());
@@ -356,6 +406,8 @@ bool EmuSystem::skipForwardFrames(EmuSystemTask *task, uint32_t frames)
 
 void EmuSystem::configFrameTime(uint32_t rate)
 {
+	if(nativeSoundRate)
+		rate = nativeSoundRate;
 	auto fTime = frameTime();
 	configAudioRate(fTime, rate);
 	audioFramesPerVideoFrame = std::ceil(rate * fTime.count());
@@ -372,7 +424,7 @@ void EmuSystem::configFrameTime()
 void EmuSystem::configAudioPlayback(uint32_t rate)
 {
 	configFrameTime(rate);
-	emuAudio.setRate(rate);
+	emuAudio.setRate(rate, nativeSoundRate);
 }
 
 uint32_t EmuSystem::updateAudioFramesPerVideoFrame()
@@ -622,6 +674,52 @@ void EmuSystem::sessionOptionSet()
 
 [[gnu::weak]] void EmuSystem::saveBackupMem() {}
 
+[[gnu::weak]] bool EmuSystem::inputActionNeedsMainThread(uint emuKey) { return false; }
+
+[[gnu::weak]] EmuSystem::Error EmuSystem::saveState(const char *path)
+{
+	std::vector<uint8_t> buff;
+	if(auto err = saveStateToBuffer(buff);
+		err)
+	{
+		return err;
+	}
+	std::error_code ec;
+	if(FileUtils::writeToPath(path, buff.data(), buff.size(), &ec) == -1)
+	{
+		return makeError(std::error_code{ec});
+	}
+	return {};
+}
+
+[[gnu::weak]] EmuSystem::Error EmuSystem::loadState(const char *path)
+{
+	FileIO f;
+	if(auto ec = f.open(path, IO::AccessHint::ALL);
+		ec)
+	{
+		return makeError(std::error_code{ec});
+	}
+	auto stateData = f.mmapConst();
+	if(!stateData)
+	{
+		return makeFileReadError();
+	}
+	return loadStateFromBuffer({stateData, f.size()});
+}
+
+[[gnu::weak]] EmuSystem::Error EmuSystem::saveStateToBuffer(std::vector<uint8_t> &buff)
+{
+	return makeError("Saving state to memory not supported");
+}
+
+[[gnu::weak]] EmuSystem::Error EmuSystem::loadStateFromBuffer(IG::ConstBufferView buff)
+{
+	return makeError("Loading state from memory not supported");
+}
+
+[[gnu::weak]] EmuSystem::Error EmuSystem::compressStateFileData(std::vector<uint8_t> &buff) { return {}; }
+
 [[gnu::weak]] void EmuSystem::savePathChanged() {}
 
 [[gnu::weak]] uint EmuSystem::multiresVideoBaseX() { return 0; }
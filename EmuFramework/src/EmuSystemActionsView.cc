@@ -55,6 +55,7 @@ public:
 			{
 				dismiss();
 				EmuSystem::reset(EmuSystem::RESET_SOFT);
+				emuViewController.resetRunAhead();
 				emuViewController.showEmulation();
 			}
 		},
@@ -65,6 +66,7 @@ public:
 			{
 				dismiss();
 				EmuSystem::reset(EmuSystem::RESET_HARD);
+				emuViewController.resetRunAhead();
 				emuViewController.showEmulation();
 			}
 		},
@@ -93,6 +95,13 @@ void EmuSystemActionsView::onShow()
 	stateSlotText[12] = EmuSystem::saveSlotChar(EmuSystem::saveStateSlot);
 	stateSlot.compile(renderer(), projP);
 	screenshot.setActive(EmuSystem::gameIsRunning());
+	recordMovie.setName(emuMovie.isRecording() ? "Stop Recording & Save Movie" : "Record Input Movie");
+	recordMovie.compile(renderer(), projP);
+	recordMovie.setActive(EmuSystem::gameIsRunning() && !emuMovie.isPlaying());
+	playMovie.setName(emuMovie.isPlaying() ? "Stop Movie Playback" : "Play Input Movie");
+	playMovie.compile(renderer(), projP);
+	playMovie.setActive(EmuSystem::gameIsRunning() && !emuMovie.isRecording() &&
+		(emuMovie.isPlaying() || FS::exists(EmuMovie::defaultPath().data())));
 	#ifdef CONFIG_EMUFRAMEWORK_ADD_LAUNCHER_ICON
 	addLauncherIcon.setActive(EmuSystem::gameIsRunning());
 	#endif
@@ -115,6 +124,8 @@ void EmuSystemActionsView::loadStandardItems()
 	item.emplace_back(&addLauncherIcon);
 	#endif
 	item.emplace_back(&screenshot);
+	item.emplace_back(&recordMovie);
+	item.emplace_back(&playMovie);
 	item.emplace_back(&resetSessionOptions);
 	item.emplace_back(&close);
 }
@@ -151,6 +162,7 @@ EmuSystemActionsView::EmuSystemActionsView(ViewAttachParams attach, bool customM
 						{
 							view.dismiss();
 							EmuSystem::reset(EmuSystem::RESET_SOFT);
+							emuViewController.resetRunAhead();
 							emuViewController.showEmulation();
 						});
 					pushAndShowModal(std::move(ynAlertView), e);
@@ -269,6 +281,65 @@ EmuSystemActionsView::EmuSystemActionsView(ViewAttachParams attach, bool customM
 			}
 		}
 	},
+	recordMovie
+	{
+		"Record Input Movie",
+		[this](TextMenuItem &item, Input::Event)
+		{
+			if(!item.active() || !EmuSystem::gameIsRunning())
+				return;
+			EmuApp::syncEmulationThread();
+			if(emuMovie.isRecording())
+			{
+				auto frames = emuMovie.frames();
+				if(auto err = emuMovie.stopRecording(EmuMovie::defaultPath().data());
+					err)
+				{
+					EmuApp::printfMessage(4, true, "Record Movie: %s", err->what());
+				}
+				else
+				{
+					EmuApp::printfMessage(3, false, "Saved %u frame movie", frames);
+				}
+				onShow();
+				postDraw();
+				return;
+			}
+			if(auto err = emuMovie.startRecording();
+				err)
+			{
+				EmuApp::printfMessage(4, true, "Record Movie: %s", err->what());
+				return;
+			}
+			emuViewController.resetRewind();
+			emuViewController.showEmulation();
+		}
+	},
+	playMovie
+	{
+		"Play Input Movie",
+		[this](TextMenuItem &item, Input::Event)
+		{
+			if(!item.active() || !EmuSystem::gameIsRunning())
+				return;
+			EmuApp::syncEmulationThread();
+			if(emuMovie.isPlaying())
+			{
+				emuMovie.stop();
+				onShow();
+				postDraw();
+				return;
+			}
+			if(auto err = emuMovie.startPlayback(EmuMovie::defaultPath().data());
+				err)
+			{
+				EmuApp::printfMessage(4, true, "Play Movie: %s", err->what());
+				return;
+			}
+			emuViewController.resetRewind();
+			emuViewController.showEmulation();
+		}
+	},
 	resetSessionOptions
 	{
 		"Reset Saved Options",
@@ -19,11 +19,13 @@
 #include <emuframework/EmuVideo.hh>
 #include "EmuSystemTask.hh"
 #include "privateInput.hh"
+#include "private.hh"
 
 void EmuSystemTask::start()
 {
 	if(started)
 		return;
+	paused = false;
 	replyPort.attach(
 		[this](auto msgs)
 		{
@@ -44,6 +46,15 @@ void EmuSystemTask::start()
 					{
 						EmuApp::printScreenshotResult(msg.args.screenshot.num, msg.args.screenshot.success);
 					}
+					bcase Reply::RUN_AHEAD_SLOW:
+					{
+						EmuApp::printfMessage(4, true, "Run-ahead takes %.1fms per frame, too slow for full speed",
+							msg.args.runAhead.frameCostMSecs);
+					}
+					bcase Reply::MOVIE_ENDED:
+					{
+						EmuApp::postMessage("Movie playback ended");
+					}
 					bdefault:
 					{
 						logErr("unknown reply message:%d", (int)msg.reply);
@@ -70,6 +81,36 @@ void EmuSystemTask::start()
 								assumeExpr(frames);
 								auto *video = msg.args.run.video;
 								auto *audio = msg.args.run.audio;
+								#ifdef CONFIG_EMUFRAMEWORK_FRAME_STATS
+								emuFrameTrace.markEmulation(EmuFrameTrace::Stage::EMULATE_START);
+								#endif
+								// apply input queued since the last frame before any emulation
+								inputQueue.apply();
+								if(unlikely(emuMovie.isActive()))
+								{
+									// movies step every frame with its recorded input, no rewind or run-ahead
+									iterateTimes(frames, i)
+									{
+										emuMovie.beginFrame();
+										turboActions.update();
+										EmuSystem::runFrame(this, i == frames - 1u ? video : nullptr,
+											msg.args.run.skipForward ? nullptr : audio);
+										if(emuMovie.endFrame())
+										{
+											replyPort.send({Reply::MOVIE_ENDED});
+											break;
+										}
+									}
+									continue;
+								}
+								if(unlikely(rewindActive.load(std::memory_order_relaxed) && rewind.states()))
+								{
+									// restore the previous captured state and run one frame from it to update the video
+									rewind.stepBack();
+									turboActions.update();
+									EmuSystem::runFrame(this, video, nullptr);
+									continue;
+								}
 								if(unlikely(msg.args.run.skipForward))
 								{
 									if(EmuSystem::skipForwardFrames(this, frames - 1))
@@ -88,7 +129,9 @@ void EmuSystemTask::start()
 									EmuSystem::skipFrames(this, frames - 1, audio);
 								}
 								turboActions.update();
-								EmuSystem::runFrame(this, video, audio);
+								if(msg.args.run.skipForward || !runAhead.runFrame(this, video, audio))
+									EmuSystem::runFrame(this, video, audio);
+								rewind.onFrame();
 							}
 							bcase Command::PAUSE:
 							{
@@ -129,6 +172,9 @@ void EmuSystemTask::pause()
 	IG::Semaphore sem{0};
 	commandPort.send({Command::PAUSE, &sem});
 	sem.wait();
+	// the emulation thread stays idle until the next frame, apply any remaining input here
+	inputQueue.apply();
+	paused = true;
 }
 
 void EmuSystemTask::stop()
@@ -140,6 +186,10 @@ void EmuSystemTask::stop()
 	sem.wait();
 	replyPort.clear();
 	replyPort.detach();
+	inputQueue.clear();
+	rewindActive = false;
+	rewind.deinit();
+	runAhead.deinit();
 }
 
 void EmuSystemTask::runFrame(EmuVideo *video, EmuAudio *audio, uint8_t frames, bool skipForward)
@@ -147,9 +197,30 @@ void EmuSystemTask::runFrame(EmuVideo *video, EmuAudio *audio, uint8_t frames, b
 	assumeExpr(frames);
 	if(unlikely(!started))
 		return;
+	paused = false;
 	commandPort.send({Command::RUN_FRAME, video, audio, frames, skipForward});
 }
 
+void EmuSystemTask::sendInputAction(uint32_t state, uint32_t emuKey, IG::Time time)
+{
+	if(!started || paused)
+	{
+		// no frame can be running
+		emuMovie.handleInputAction(state, emuKey);
+		return;
+	}
+	if(unlikely(EmuSystem::inputActionNeedsMainThread(emuKey)))
+	{
+		// finish the current frame and any queued input first
+		pause();
+		// these don't affect the emulated state deterministically, so they aren't recorded
+		if(!emuMovie.isPlaying())
+			EmuSystem::handleInputAction(state, emuKey);
+		return;
+	}
+	inputQueue.push(state, emuKey, time);
+}
+
 void EmuSystemTask::sendVideoFormatChangedReply(EmuVideo &video, IG::PixmapDesc desc, IG::Semaphore *semAddr)
 {
 	replyPort.send({Reply::VIDEO_FORMAT_CHANGED, video, desc, semAddr});
@@ -159,3 +230,25 @@ void EmuSystemTask::sendScreenshotReply(int num, bool success)
 {
 	replyPort.send({Reply::TOOK_SCREENSHOT, num, success});
 }
+
+void EmuSystemTask::sendRunAheadSlowReply(float frameCostMSecs)
+{
+	replyPort.send({Reply::RUN_AHEAD_SLOW, frameCostMSecs});
+}
+
+void EmuSystemTask::setRewindActive(bool on)
+{
+	rewindActive.store(on, std::memory_order_relaxed);
+}
+
+void EmuSystemTask::resetRewind()
+{
+	// only call while the emulation thread is paused
+	rewind.reset();
+}
+
+void EmuSystemTask::resetRunAhead()
+{
+	// only call while the emulation thread is paused
+	runAhead.reset();
+}
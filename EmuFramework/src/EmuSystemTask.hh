@@ -19,6 +19,10 @@
 #include <imagine/base/CustomEvent.hh>
 #include <imagine/thread/Semaphore.hh>
 #include <imagine/pixmap/Pixmap.hh>
+#include "EmuRewind.hh"
+#include "EmuRunAhead.hh"
+#include "EmuInputQueue.hh"
+#include <atomic>
 
 class EmuVideo;
 class EmuAudio;
@@ -56,7 +60,7 @@ public:
 
 	enum class Reply: uint8_t
 	{
-		UNSET, VIDEO_FORMAT_CHANGED, TOOK_SCREENSHOT
+		UNSET, VIDEO_FORMAT_CHANGED, TOOK_SCREENSHOT, RUN_AHEAD_SLOW, MOVIE_ENDED
 	};
 
 	struct ReplyMessage
@@ -74,10 +78,15 @@ public:
 				int num;
 				bool success;
 			} screenshot;
+			struct RunAheadArgs
+			{
+				float frameCostMSecs;
+			} runAhead;
 		} args{};
 		Reply reply{Reply::UNSET};
 
 		constexpr ReplyMessage() {}
+		constexpr ReplyMessage(Reply reply): reply{reply} {}
 		constexpr ReplyMessage(Reply reply, EmuVideo &video, IG::PixmapDesc desc, IG::Semaphore *semAddr):
 			args{desc, &video, semAddr}, reply{reply} {}
 		constexpr ReplyMessage(Reply reply, int num, bool success):
@@ -85,6 +94,11 @@ public:
 		{
 			args.screenshot = {num, success};
 		}
+		constexpr ReplyMessage(Reply reply, float frameCostMSecs):
+			reply{reply}
+		{
+			args.runAhead = {frameCostMSecs};
+		}
 		explicit operator bool() const { return reply != Reply::UNSET; }
 	};
 
@@ -92,11 +106,21 @@ public:
 	void pause();
 	void stop();
 	void runFrame(EmuVideo *video, EmuAudio *audio, uint8_t frames, bool skipForward = false);
+	void sendInputAction(uint32_t state, uint32_t emuKey, IG::Time time = {});
 	void sendVideoFormatChangedReply(EmuVideo &video, IG::PixmapDesc desc, IG::Semaphore *semAddr);
 	void sendScreenshotReply(int num, bool success);
+	void sendRunAheadSlowReply(float frameCostMSecs);
+	void setRewindActive(bool on);
+	void resetRewind();
+	void resetRunAhead();
 
 private:
-	Base::MessagePort<CommandMessage> commandPort{"EmuSystemTask Command"};
-	Base::MessagePort<ReplyMessage> replyPort{"EmuSystemTask Reply"};
+	Base::SPSCMessagePort<CommandMessage> commandPort{"EmuSystemTask Command"};
+	Base::SPSCMessagePort<ReplyMessage> replyPort{"EmuSystemTask Reply"};
+	EmuRewind rewind{};
+	EmuRunAhead runAhead{};
+	EmuInputQueue inputQueue{};
+	std::atomic_bool rewindActive{};
 	bool started = false;
+	bool paused = false;
 };
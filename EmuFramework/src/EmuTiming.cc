@@ -15,21 +15,122 @@
 
 #include "EmuTiming.hh"
 #include <imagine/util/utility.h>
+#include <imagine/util/algorithm.h>
 #include <imagine/logger/logger.h>
+#include <algorithm>
 #include <cmath>
 
+// audio rate control can adjust up to 0.5%, lock with some headroom for clock drift
+// and only unlock near the limit so measurement noise doesn't toggle it
+static constexpr double vsyncLockRateMismatch = .0035;
+static constexpr double vsyncUnlockRateMismatch = .0045;
+static constexpr uint32_t statsLogInterval = 1200;
+
+static const char *framePacingStr(FramePacing pacing)
+{
+	switch(pacing)
+	{
+		case FramePacing::AUTO: return "Auto";
+		case FramePacing::VSYNC: return "Vsync";
+		case FramePacing::AUDIO_CLOCK: return "Audio Clock";
+		case FramePacing::TIMESTAMP: return "Timestamp";
+	}
+	return "Unknown";
+}
+
+void FrameTimeStats::addInterval(IG::FloatSeconds time)
+{
+	uint32_t idx = std::max(time.count(), 0.) * 1000. / INTERVAL_BUCKET_MSECS;
+	interval[std::min(idx, INTERVAL_BUCKETS - 1)]++;
+}
+
+void FrameTimeStats::addFramesAdvanced(uint32_t frames, bool vsyncLocked)
+{
+	framesAdvanced[std::min(frames, MAX_FRAMES_ADVANCED)]++;
+	callbacks++;
+	if(vsyncLocked)
+		vsyncLockedCallbacks++;
+}
+
+double FrameTimeStats::intervalPercentileMSecs(double percentile) const
+{
+	uint64_t total = 0;
+	for(auto count : interval)
+		total += count;
+	if(!total)
+		return 0;
+	uint64_t target = std::ceil(total * percentile);
+	uint64_t sum = 0;
+	iterateTimes(INTERVAL_BUCKETS, i)
+	{
+		sum += interval[i];
+		if(sum >= target)
+			return (i + 1) * INTERVAL_BUCKET_MSECS;
+	}
+	return INTERVAL_BUCKETS * INTERVAL_BUCKET_MSECS;
+}
+
+void FrameTimeStats::log() const
+{
+	if(!callbacks)
+		return;
+	uint32_t moreThan2 = 0;
+	for(auto i = 3u; i < framesAdvanced.size(); i++)
+		moreThan2 += framesAdvanced[i];
+	logMsg("frame pacing over %u callbacks: %.1f%% vsync locked, frames advanced 0:%u 1:%u 2:%u 3+:%u, interval p50:%.1fms p99:%.1fms",
+		callbacks, 100. * vsyncLockedCallbacks / callbacks,
+		framesAdvanced[0], framesAdvanced[1], framesAdvanced[2], moreThan2,
+		intervalPercentileMSecs(.5), intervalPercentileMSecs(.99));
+}
+
 uint32_t EmuTiming::advanceFramesWithTime(IG::FrameTime time)
 {
 	if(unlikely(!startFrameTime.count()))
 	{
 		// first frame
 		startFrameTime = time;
+		lastTime = time;
 		lastFrame = 0;
-		return 1;
+		return recordFramesAdvanced(1);
 	}
 	assumeExpr(timePerVideoFrame.count() > 0);
 	assumeExpr(startFrameTime.count() > 0);
 	assumeExpr(time > startFrameTime);
+	IG::FloatSeconds interval = time - lastTime;
+	lastTime = time;
+	stats_.addInterval(interval);
+	if(pacing_ == FramePacing::VSYNC)
+	{
+		auto vblanks = countVblanks(interval);
+		updateVsyncLock();
+		if(vsyncLocked)
+		{
+			// keep the timestamp base current so pacing continues smoothly if the lock drops
+			startFrameTime = time;
+			lastFrame = 0;
+			return recordFramesAdvanced(vblanks);
+		}
+	}
+	return recordFramesAdvanced(advanceFramesWithTimestamp(time));
+}
+
+uint32_t EmuTiming::advanceFramesWithAudio(IG::FrameTime time, uint32_t audioFramesNeeded, double audioFramesPerVideoFrame)
+{
+	if(speed > 1 || audioFramesPerVideoFrame <= 0 || unlikely(!startFrameTime.count()))
+	{
+		return advanceFramesWithTime(time);
+	}
+	stats_.addInterval(time - lastTime);
+	lastTime = time;
+	startFrameTime = time;
+	lastFrame = 0;
+	// the device consumes audio at its own rate, so emulating enough frames to keep
+	// the buffer at its target fill ties the frame rate to the audio clock
+	return recordFramesAdvanced(std::round(audioFramesNeeded / audioFramesPerVideoFrame));
+}
+
+uint32_t EmuTiming::advanceFramesWithTimestamp(IG::FrameTime time)
+{
 	auto timeTotal = time - startFrameTime;
 	uint32_t now = std::round(IG::FloatSeconds(timeTotal) / timePerVideoFrameScaled);
 	auto elapsedFrames = now - lastFrame;
@@ -37,17 +138,75 @@ uint32_t EmuTiming::advanceFramesWithTime(IG::FrameTime time)
 	return elapsedFrames;
 }
 
+uint32_t EmuTiming::countVblanks(IG::FloatSeconds interval)
+{
+	if(!displayFrameTime.count())
+		displayFrameTime = timePerVideoFrame;
+	double vblanks = std::round(interval / displayFrameTime);
+	if(vblanks < 1)
+		return 0;
+	// refine the refresh period since the screen's reported rate may only be nominal,
+	// skip long stalls where a rounding error would be spread over too few samples
+	if(vblanks <= 4)
+		displayFrameTime += (interval / vblanks - displayFrameTime) / 256.;
+	return vblanks;
+}
+
+void EmuTiming::updateVsyncLock()
+{
+	auto maxMismatch = vsyncLocked ? vsyncUnlockRateMismatch : vsyncLockRateMismatch;
+	bool locked = pacing_ == FramePacing::VSYNC && speed == 1 &&
+		displayFrameTime.count() && timePerVideoFrame.count() &&
+		std::abs(displayFrameTime / timePerVideoFrame - 1.) <= maxMismatch;
+	if(locked == vsyncLocked)
+		return;
+	vsyncLocked = locked;
+	logMsg("vsync lock %s, display frame time:%.6f emulated frame time:%.6f",
+		locked ? "on" : "off", displayFrameTime.count(), timePerVideoFrame.count());
+}
+
+uint32_t EmuTiming::recordFramesAdvanced(uint32_t frames)
+{
+	stats_.addFramesAdvanced(frames, vsyncLocked);
+	if(stats_.callbacks % statsLogInterval == 0)
+		stats_.log();
+	return frames;
+}
+
 void EmuTiming::setFrameTime(IG::FloatSeconds time)
 {
 	timePerVideoFrame = time;
 	updateScaledFrameTime();
 	logMsg("configured frame time:%.6f (%.2f fps)", time.count(), 1. / time.count());
+	updateVsyncLock();
 	reset();
 }
 
+void EmuTiming::setDisplayFrameTime(IG::FloatSeconds time)
+{
+	displayFrameTime = time.count() > 0 ? time : IG::FloatSeconds{};
+	logMsg("display frame time:%.6f", displayFrameTime.count());
+	updateVsyncLock();
+	reset();
+}
+
+void EmuTiming::setPacing(FramePacing pacing)
+{
+	pacing_ = pacing;
+	logMsg("frame pacing:%s", framePacingStr(pacing));
+	updateVsyncLock();
+	reset();
+}
+
+void EmuTiming::resetStats()
+{
+	stats_ = {};
+}
+
 void EmuTiming::reset()
 {
 	startFrameTime = {};
+	lastTime = {};
 }
 
 void EmuTiming::setSpeedMultiplier(uint8_t newSpeed)
@@ -56,6 +215,7 @@ void EmuTiming::setSpeedMultiplier(uint8_t newSpeed)
 		return;
 	speed = newSpeed ? newSpeed : 1;
 	updateScaledFrameTime();
+	updateVsyncLock();
 	reset();
 }
 
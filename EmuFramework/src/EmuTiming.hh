@@ -16,21 +16,69 @@
 	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
 
 #include <imagine/time/Time.hh>
+#include <array>
+
+enum class FramePacing : uint8_t
+{
+	AUTO,
+	// one emulated frame per display refresh when the rates are close enough for
+	// audio rate control to absorb the difference, timestamps otherwise
+	VSYNC,
+	// emulate frames as the audio device consumes them
+	AUDIO_CLOCK,
+	// round the total elapsed time into frames
+	TIMESTAMP
+};
+
+struct FrameTimeStats
+{
+	static constexpr uint32_t INTERVAL_BUCKETS = 100;
+	static constexpr double INTERVAL_BUCKET_MSECS = .5;
+	static constexpr uint32_t MAX_FRAMES_ADVANCED = 8;
+
+	// time between frame callbacks, the last bucket also counts anything longer
+	std::array<uint32_t, INTERVAL_BUCKETS> interval{};
+	// frames emulated per callback, the last entry also counts anything higher
+	std::array<uint32_t, MAX_FRAMES_ADVANCED + 1> framesAdvanced{};
+	uint32_t callbacks = 0;
+	uint32_t vsyncLockedCallbacks = 0;
+
+	void addInterval(IG::FloatSeconds time);
+	void addFramesAdvanced(uint32_t frames, bool vsyncLocked);
+	double intervalPercentileMSecs(double percentile) const;
+	void log() const;
+};
 
 class EmuTiming
 {
 public:
 	uint32_t advanceFramesWithTime(IG::FrameTime time);
+	uint32_t advanceFramesWithAudio(IG::FrameTime time, uint32_t audioFramesNeeded, double audioFramesPerVideoFrame);
 	void setFrameTime(IG::FloatSeconds time);
+	void setDisplayFrameTime(IG::FloatSeconds time);
+	void setPacing(FramePacing pacing);
+	FramePacing pacing() const { return pacing_; }
+	bool isVsyncLocked() const { return vsyncLocked; }
+	const FrameTimeStats &stats() const { return stats_; }
+	void resetStats();
 	void reset();
 	void setSpeedMultiplier(uint8_t newSpeed);
 
 protected:
 	IG::FloatSeconds timePerVideoFrame{};
 	IG::FloatSeconds timePerVideoFrameScaled{};
+	IG::FloatSeconds displayFrameTime{};
 	IG::FrameTime startFrameTime{};
+	IG::FrameTime lastTime{};
+	FrameTimeStats stats_{};
 	uint32_t lastFrame = 0;
 	uint8_t speed = 1;
+	FramePacing pacing_ = FramePacing::VSYNC;
+	bool vsyncLocked = false;
 
 	void updateScaledFrameTime();
+	void updateVsyncLock();
+	uint32_t countVblanks(IG::FloatSeconds interval);
+	uint32_t advanceFramesWithTimestamp(IG::FrameTime time);
+	uint32_t recordFramesAdvanced(uint32_t frames);
 };
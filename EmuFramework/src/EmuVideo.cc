@@ -42,6 +42,12 @@ void EmuVideo::setFormat(IG::PixmapDesc desc)
 	{
 		return; // no change to format
 	}
+	if(unlikely(nullSink))
+	{
+		memPix = {desc};
+		logMsg("resized null sink to:%dx%d", desc.w(), desc.h());
+		return;
+	}
 	if(memPix)
 	{
 		renderer().waitAsyncCommands();
@@ -75,6 +81,10 @@ void EmuVideo::postSetFormat(EmuSystemTask &task, IG::PixmapDesc desc)
 
 EmuVideoImage EmuVideo::startFrame(EmuSystemTask *task)
 {
+	if(unlikely(nullSink))
+	{
+		return {task, *this, (IG::Pixmap)memPix};
+	}
 	auto lockedTex = vidImg.lock(0);
 	if(!lockedTex)
 	{
@@ -119,35 +129,78 @@ void EmuVideo::startFrameWithFormat(EmuSystemTask *task, IG::Pixmap pix)
 	startFrame(task, pix);
 }
 
+// Returns the frame's image so a core can point its renderer's output at it,
+// or an empty image if direct rendering is off and the core should render
+// into its own buffer and call startFrame() with it as usual
+EmuVideoImage EmuVideo::startDirectFrame(EmuSystemTask *task, IG::PixmapDesc desc)
+{
+	if(!directRendering_)
+		return {};
+	return startFrameWithFormat(task, desc);
+}
+
 void EmuVideo::startUnchangedFrame(EmuSystemTask *task)
 {
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_STATS
+	emuFrameTrace.markEmulation(EmuFrameTrace::Stage::EMULATE_END);
+	emuFrameTrace.finishEmulation();
+	#endif
 	dispatchFinishFrame(task);
 }
 
 void EmuVideo::dispatchFinishFrame(EmuSystemTask *task)
 {
+	if(unlikely(nullSink))
+		return;
 	onFrameFinished(*this);
 }
 
 void EmuVideo::finishFrame(EmuSystemTask *task, Gfx::LockedTextureBuffer texBuff)
 {
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_STATS
+	emuFrameTrace.markEmulation(EmuFrameTrace::Stage::EMULATE_END);
+	#endif
 	if(unlikely(screenshotNextFrame))
 	{
 		doScreenshot(task, texBuff.pixmap());
 	}
 	rTask.acquireFenceAndWait(fence);
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_STATS
+	emuFrameTrace.markEmulation(EmuFrameTrace::Stage::FENCE_WAIT_END);
+	#endif
 	vidImg.unlock(texBuff);
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_STATS
+	emuFrameTrace.markEmulation(EmuFrameTrace::Stage::UPLOAD_END);
+	emuFrameTrace.finishEmulation();
+	#endif
 	dispatchFinishFrame(task);
 }
 
 void EmuVideo::finishFrame(EmuSystemTask *task, IG::Pixmap pix)
 {
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_STATS
+	emuFrameTrace.markEmulation(EmuFrameTrace::Stage::EMULATE_END);
+	#endif
 	if(unlikely(screenshotNextFrame))
 	{
 		doScreenshot(task, pix);
 	}
+	if(unlikely(nullSink))
+	{
+		// copy frames the core rendered into its own buffer, like a texture upload
+		if(pix.pixel({}) != memPix.pixel({}))
+			memPix.write(pix);
+		return;
+	}
 	rTask.acquireFenceAndWait(fence);
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_STATS
+	emuFrameTrace.markEmulation(EmuFrameTrace::Stage::FENCE_WAIT_END);
+	#endif
 	vidImg.write(0, pix, {});
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_STATS
+	emuFrameTrace.markEmulation(EmuFrameTrace::Stage::UPLOAD_END);
+	emuFrameTrace.finishEmulation();
+	#endif
 	dispatchFinishFrame(task);
 }
 
@@ -251,8 +304,18 @@ void EmuVideoImage::endFrame()
 	}
 }
 
+void EmuVideoImage::endFrame(IG::Pixmap srcPix)
+{
+	// fallback for cores that couldn't render directly into the image,
+	// such as when its pitch doesn't match their renderer's line stride
+	pixmap().write(srcPix);
+	endFrame();
+}
+
 IG::WP EmuVideo::size() const
 {
+	if(unlikely(nullSink))
+		return memPix.size();
 	if(!vidImg)
 		return {};
 	else
@@ -261,6 +324,8 @@ IG::WP EmuVideo::size() const
 
 bool EmuVideo::formatIsEqual(IG::PixmapDesc desc) const
 {
+	if(unlikely(nullSink))
+		return memPix && desc == memPix;
 	return vidImg && desc == vidImg.usedPixmapDesc();
 }
 
@@ -273,3 +338,18 @@ void EmuVideo::setOnFormatChanged(FormatChangedDelegate del)
 {
 	onFormatChanged = del;
 }
+
+void EmuVideo::setNullSink(bool on)
+{
+	nullSink = on;
+}
+
+void EmuVideo::setDirectRendering(bool on)
+{
+	directRendering_ = on;
+}
+
+bool EmuVideo::directRendering() const
+{
+	return directRendering_;
+}
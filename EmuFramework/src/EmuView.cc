@@ -27,6 +27,9 @@ void EmuView::prepareDraw()
 	#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
 	audioStatsText.makeGlyphs(renderer());
 	#endif
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_STATS
+	frameStatsText.makeGlyphs(renderer());
+	#endif
 }
 
 void EmuView::draw(Gfx::RendererCommands &cmds)
@@ -49,6 +52,19 @@ void EmuView::draw(Gfx::RendererCommands &cmds)
 			projP.alignYToPixel(audioStatsRect.yCenter()), LC2DO, projP);
 	}
 	#endif
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_STATS
+	if(strlen(frameStatsStr.data()))
+	{
+		cmds.setCommonProgram(CommonProgram::NO_TEX);
+		cmds.setBlendMode(BLEND_MODE_ALPHA);
+		cmds.setColor(0., 0., 0., .7);
+		GeomRect::draw(cmds, frameStatsRect);
+		cmds.setColor(1., 1., 1., 1.);
+		cmds.setCommonProgram(CommonProgram::TEX_ALPHA);
+		frameStatsText.draw(cmds, projP.alignXToPixel(frameStatsRect.x + TableView::globalXIndent),
+			projP.alignYToPixel(frameStatsRect.yCenter()), LC2DO, projP);
+	}
+	#endif
 }
 
 void EmuView::place()
@@ -66,6 +82,19 @@ void EmuView::place()
 			+ audioStatsText.nominalHeight * .5f; // adjust to bottom
 	}
 	#endif
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_STATS
+	if(strlen(frameStatsStr.data()))
+	{
+		frameStatsText.compile(renderer(), projP);
+		frameStatsRect = projP.bounds();
+		#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
+		if(strlen(audioStatsStr.data()))
+			frameStatsRect.y = audioStatsRect.y2; // stack below the audio stats
+		#endif
+		frameStatsRect.y2 = (frameStatsRect.y + frameStatsText.nominalHeight * frameStatsText.lines)
+			+ frameStatsText.nominalHeight * .5f; // adjust to bottom
+	}
+	#endif
 }
 
 bool EmuView::inputEvent(Input::Event e)
@@ -78,11 +107,13 @@ void EmuView::setLayoutInputView(EmuInputView *view)
 	inputView = view;
 }
 
-void EmuView::updateAudioStats(uint underruns, uint overruns, uint callbacks, double avgCallbackFrames, uint frames)
+void EmuView::updateAudioStats(uint underruns, uint overruns, uint callbacks, double avgCallbackFrames, uint frames,
+	double fillMSecs, double targetFillMSecs, float rateRatio)
 {
 	#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
-	string_printf(audioStatsStr, "Underruns:%u\nOverruns:%u\nCallbacks per second:%u\nFrames per callback:%.2f\nTotal frames:%u",
-		underruns, overruns, callbacks, avgCallbackFrames, frames);
+	string_printf(audioStatsStr, "Underruns:%u\nOverruns:%u\nCallbacks per second:%u\nFrames per callback:%.2f\nTotal frames:%u\n"
+		"Buffer fill:%.1fms (target %.1fms)\nRate ratio:%.4f",
+		underruns, overruns, callbacks, avgCallbackFrames, frames, fillMSecs, targetFillMSecs, rateRatio);
 	if(!audioStatsText.str)
 	{
 		audioStatsText = {audioStatsStr.data(), &View::defaultFace};
@@ -97,3 +128,22 @@ void EmuView::clearAudioStats()
 	audioStatsStr = {};
 	#endif
 }
+
+void EmuView::updateFrameStats(const char *stats)
+{
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_STATS
+	string_copy(frameStatsStr, stats);
+	if(!frameStatsText.str)
+	{
+		frameStatsText = {frameStatsStr.data(), &View::defaultFace};
+	}
+	place();
+	#endif
+}
+
+void EmuView::clearFrameStats()
+{
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_STATS
+	frameStatsStr = {};
+	#endif
+}
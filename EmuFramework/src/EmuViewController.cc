@@ -147,6 +147,9 @@ void EmuViewController::initViews(ViewAttachParams viewAttach)
 	logMsg("timestamp source:%s", useRendererTime() ? "renderer" : "screen");
 	onFrameUpdate = [this](IG::FrameParams params)
 		{
+			#ifdef CONFIG_EMUFRAMEWORK_FRAME_STATS
+			auto onFrameTime = IG::steadyClockTimestamp();
+			#endif
 			if(emuVideoInProgress)
 			{
 				// frame not ready yet, retry on next vblank
@@ -187,6 +190,9 @@ void EmuViewController::initViews(ViewAttachParams viewAttach)
 			uint32_t framesToEmulate = std::min(framesAdvanced, maxFrameSkip);
 			emuVideoInProgress = true;
 			EmuAudio *audioPtr = emuAudio ? &emuAudio : nullptr;
+			#ifdef CONFIG_EMUFRAMEWORK_FRAME_STATS
+			emuFrameTrace.beginFrame(params.timestamp(), onFrameTime, framesToEmulate);
+			#endif
 			systemTask->runFrame(&emuVideo, audioPtr, framesToEmulate, skipForward);
 			return true;
 		};
@@ -296,6 +302,9 @@ Base::WindowConfig EmuViewController::addWindowConfig(Base::WindowConfig winConf
 					return true;
 				}
 				emuView.prepareDraw();
+				#ifdef CONFIG_EMUFRAMEWORK_FRAME_STATS
+				emuFrameTrace.prepareDraw();
+				#endif
 			}
 			if(!EmuSystem::isActive())
 			{
@@ -304,6 +313,9 @@ Base::WindowConfig EmuViewController::addWindowConfig(Base::WindowConfig winConf
 			rendererTask().draw(winData.drawableHolder, win, params, {},
 				[this, &winData](Gfx::Drawable &drawable, Base::Window &win, Gfx::SyncFence fence, Gfx::RendererDrawTask task)
 				{
+					#ifdef CONFIG_EMUFRAMEWORK_FRAME_STATS
+					emuFrameTrace.markDraw(EmuFrameTrace::Stage::DRAW_START);
+					#endif
 					auto cmds = task.makeRendererCommands(drawable, winData.viewport(), winData.projectionMat);
 					cmds.clear();
 					cmds.waitSync(fence);
@@ -621,9 +633,11 @@ void EmuViewController::updateWindowViewport(AppWindowData &winData, Base::Windo
 	}
 }
 
-void EmuViewController::updateEmuAudioStats(uint underruns, uint overruns, uint callbacks, double avgCallbackFrames, uint frames)
+void EmuViewController::updateEmuAudioStats(uint underruns, uint overruns, uint callbacks, double avgCallbackFrames, uint frames,
+	double fillMSecs, double targetFillMSecs, float rateRatio)
 {
-	emuView.updateAudioStats(underruns, overruns, callbacks, avgCallbackFrames, frames);
+	emuView.updateAudioStats(underruns, overruns, callbacks, avgCallbackFrames, frames,
+		fillMSecs, targetFillMSecs, rateRatio);
 }
 
 void EmuViewController::clearEmuAudioStats()
@@ -631,6 +645,16 @@ void EmuViewController::clearEmuAudioStats()
 	emuView.clearAudioStats();
 }
 
+void EmuViewController::updateEmuFrameStats(const char *stats)
+{
+	emuView.updateFrameStats(stats);
+}
+
+void EmuViewController::clearEmuFrameStats()
+{
+	emuView.clearFrameStats();
+}
+
 bool EmuViewController::allWindowsAreFocused() const
 {
 	return mainWindowData().focused && (!extraWin || extraWin->focused);
@@ -643,6 +667,19 @@ void EmuViewController::applyFrameRates()
 	EmuSystem::setFrameTime(EmuSystem::VIDSYS_PAL,
 		optionFrameRatePAL.val ? IG::FloatSeconds(optionFrameRatePAL.val) : emuView.window().screen()->frameTime());
 	EmuSystem::configFrameTime(optionSoundRate);
+	emuTiming.setDisplayFrameTime(emuView.window().screen()->frameTime());
+	applyFramePacing();
+}
+
+void EmuViewController::applyFramePacing()
+{
+	auto pacing = (FramePacing)optionFramePacing.val;
+	if(pacing == FramePacing::AUTO)
+	{
+		// without screen timestamps the frame callbacks aren't tied to vsync
+		pacing = useRendererTime() ? FramePacing::AUDIO_CLOCK : FramePacing::VSYNC;
+	}
+	emuTiming.setPacing(pacing);
 }
 
 Base::OnFrameDelegate EmuViewController::makeOnFrameDelayed(uint8_t delay)
@@ -733,6 +770,7 @@ void EmuViewController::pauseEmulation()
 	EmuSystem::pause();
 	videoLayer().setBrightness(showingEmulation ? .75f : .25f);
 	setFastForwardActive(false);
+	setRewindActive(false);
 	emuVideoInProgress = false;
 	removeOnFrame();
 }
@@ -741,6 +779,7 @@ void EmuViewController::closeSystem(bool allowAutosaveState)
 {
 	showUI();
 	systemTask->stop();
+	emuMovie.stop();
 	EmuSystem::closeRuntimeSystem(allowAutosaveState);
 	viewStack.navView()->showRightBtn(false);
 	if(int idx = viewStack.viewIdx("System Actions");
@@ -816,7 +855,13 @@ void EmuViewController::drawMainWindow(Base::Window &win, Gfx::RendererCommands
 		viewStack.draw(cmds);
 		popup.draw(cmds);
 	}
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_STATS
+	emuFrameTrace.markDraw(EmuFrameTrace::Stage::DRAW_END);
+	#endif
 	cmds.present();
+	#ifdef CONFIG_EMUFRAMEWORK_FRAME_STATS
+	emuFrameTrace.markDraw(EmuFrameTrace::Stage::PRESENT_END);
+	#endif
 }
 
 void EmuViewController::popTo(View &v)
@@ -858,6 +903,8 @@ void EmuViewController::onInputDevicesChanged()
 
 void EmuViewController::onSystemCreated()
 {
+	resetRewind();
+	resetRunAhead();
 	viewStack.navView()->showRightBtn(true);
 }
 
@@ -981,6 +1028,26 @@ void EmuViewController::setFastForwardActive(bool active)
 	emuAudio.setAddSoundBuffersOnUnderrun(active ? optionAddSoundBuffersOnUnderrun.val : false);
 }
 
+void EmuViewController::setRewindActive(bool active)
+{
+	systemTask->setRewindActive(active);
+}
+
+void EmuViewController::resetRewind()
+{
+	systemTask->resetRewind();
+}
+
+void EmuViewController::resetRunAhead()
+{
+	systemTask->resetRunAhead();
+}
+
+void EmuViewController::sendInputAction(uint state, uint emuKey, IG::Time time)
+{
+	systemTask->sendInputAction(state, emuKey, time);
+}
+
 void EmuViewController::setUseRendererTime(bool on)
 {
 	useRendererTime_ = on;
@@ -0,0 +1,248 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+
+#define LOGTAG "HeadlessBenchmark"
+#include <emuframework/EmuSystem.hh>
+#include <emuframework/EmuVideo.hh>
+#include <emuframework/EmuAudio.hh>
+#include "EmuOptions.hh"
+#include "private.hh"
+#include <imagine/io/FileIO.hh>
+#include <imagine/time/Time.hh>
+#include <imagine/util/string.h>
+#include <imagine/logger/logger.h>
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Runs a game without a window, renderer, or audio device and reports
+// frame timings as JSON, started with:
+// --benchmark <game path> [--benchmark-frames <count>] [--benchmark-output <json path>]
+// [--benchmark-movie <movie path>]
+// A movie replays its recorded input and sets the frame count to its length
+// unless one is given.
+
+static constexpr uint DEFAULT_FRAMES = 1800;
+
+struct FrameTimes
+{
+	std::vector<IG::Time> times{};
+	IG::Time total{};
+	uint64_t instructions = 0;
+};
+
+static FrameTimes runFrames(uint frames, EmuVideo *video, EmuAudio *audio)
+{
+	FrameTimes result;
+	result.times.reserve(frames);
+	auto startInstructions = EmuSystem::executedInstructions();
+	iterateTimes(frames, i)
+	{
+		emuMovie.beginFrame();
+		auto frameTime = IG::timeFunc(
+			[&]()
+			{
+				EmuSystem::runFrame(nullptr, video, audio);
+			});
+		emuMovie.endFrame();
+		if(audio)
+			audio->clearNullSink();
+		result.times.push_back(frameTime);
+		result.total += frameTime;
+	}
+	result.instructions = EmuSystem::executedInstructions() - startInstructions;
+	return result;
+}
+
+static double toMSecs(IG::Time time)
+{
+	return IG::FloatSeconds(time).count() * 1000.;
+}
+
+static double percentileMSecs(const std::vector<IG::Time> &sortedTimes, double percentile)
+{
+	size_t idx = std::min(size_t(sortedTimes.size() * percentile), sortedTimes.size() - 1);
+	return toMSecs(sortedTimes[idx]);
+}
+
+static void appendJSONString(std::string &json, const char *str)
+{
+	json += '"';
+	for(; *str; str++)
+	{
+		auto c = *str;
+		if(c == '"' || c == '\\')
+		{
+			json += '\\';
+			json += c;
+		}
+		else if((unsigned char)c < 0x20)
+		{
+			json += string_makePrintf<8>("\\u%04x", c).data();
+		}
+		else
+			json += c;
+	}
+	json += '"';
+}
+
+static std::string makeReport(const char *gameName, FrameTimes &full, FrameTimes *videoOnly, FrameTimes *coreOnly)
+{
+	auto frames = full.times.size();
+	auto &sorted = full.times;
+	std::sort(sorted.begin(), sorted.end());
+	std::string json = "{\n\t\"system\": ";
+	appendJSONString(json, EmuSystem::shortSystemName());
+	json += ",\n\t\"game\": ";
+	appendJSONString(json, gameName);
+	json += string_makePrintf<512>(",\n\t\"frames\": %zu,\n\t\"fps\": %.2f,\n"
+		"\t\"frameTimeMs\": {\"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f},\n",
+		frames, frames / IG::FloatSeconds(full.total).count(),
+		toMSecs(full.total) / frames, percentileMSecs(sorted, .5), percentileMSecs(sorted, .9),
+		percentileMSecs(sorted, .99), toMSecs(sorted.back())).data();
+	// count against the emulation-only pass when there is one
+	auto &cpuTimes = coreOnly ? *coreOnly : full;
+	if(cpuTimes.instructions)
+	{
+		json += string_makePrintf<64>("\t\"instructionsPerSec\": %.0f,\n",
+			cpuTimes.instructions / IG::FloatSeconds(cpuTimes.total).count()).data();
+	}
+	else
+	{
+		json += "\t\"instructionsPerSec\": null,\n";
+	}
+	if(videoOnly && coreOnly)
+	{
+		// each pass starts from the same state, so the differences between
+		// them give the cost of the video and audio paths per frame
+		auto coreMSecs = toMSecs(coreOnly->total) / frames;
+		auto videoMSecs = toMSecs(videoOnly->total) / frames;
+		auto fullMSecs = toMSecs(full.total) / frames;
+		json += string_makePrintf<256>("\t\"breakdownMs\": {\"emulation\": %.4f, \"video\": %.4f, \"audio\": %.4f}\n",
+			coreMSecs, std::max(videoMSecs - coreMSecs, 0.), std::max(fullMSecs - videoMSecs, 0.)).data();
+	}
+	else
+	{
+		json += "\t\"breakdownMs\": null\n";
+	}
+	json += "}\n";
+	return json;
+}
+
+static int runHeadlessBenchmark(const char *path, uint frames, const char *outputPath, const char *moviePath)
+{
+	initOptions();
+	if(auto err = EmuSystem::onOptionsLoaded();
+		err)
+	{
+		fprintf(stderr, "%s\n", err->what());
+		return 1;
+	}
+	emuVideo.setNullSink(true);
+	emuVideo.setDirectRendering(optionDirectVideoRendering);
+	if(auto err = EmuSystem::loadGameFromPath(path, [](int pos, int max, const char *label){ return true; });
+		err)
+	{
+		fprintf(stderr, "Error loading %s: %s\n", path, err->what());
+		return 1;
+	}
+	EmuSystem::prepareAudioVideo();
+	emuAudio.openNullSink();
+	if(moviePath)
+	{
+		if(auto err = emuMovie.startPlayback(moviePath);
+			err)
+		{
+			fprintf(stderr, "Error loading movie %s: %s\n", moviePath, err->what());
+			EmuSystem::closeRuntimeSystem(false);
+			return 1;
+		}
+		if(!frames)
+			frames = std::max(emuMovie.frames(), 1u);
+	}
+	if(!frames)
+		frames = DEFAULT_FRAMES;
+	logMsg("running %u frame benchmark", frames);
+	std::vector<uint8_t> startState;
+	bool canRestoreStart = moviePath || !EmuSystem::saveStateToBuffer(startState);
+	auto restoreStart =
+		[&]()
+		{
+			if(moviePath)
+				return !emuMovie.restartPlayback();
+			return !EmuSystem::loadStateFromBuffer({(const char*)startState.data(), startState.size()});
+		};
+	auto full = runFrames(frames, &emuVideo, &emuAudio);
+	std::string report;
+	if(canRestoreStart && restoreStart())
+	{
+		auto videoOnly = runFrames(frames, &emuVideo, nullptr);
+		restoreStart();
+		auto coreOnly = runFrames(frames, nullptr, nullptr);
+		report = makeReport(EmuSystem::fullGameName().data(), full, &videoOnly, &coreOnly);
+	}
+	else
+	{
+		logMsg("state restore unsupported, skipping per-component timing");
+		report = makeReport(EmuSystem::fullGameName().data(), full, nullptr, nullptr);
+	}
+	emuMovie.stop();
+	EmuSystem::closeRuntimeSystem(false);
+	emuAudio.close();
+	if(!outputPath)
+	{
+		fputs(report.data(), stdout);
+		return 0;
+	}
+	FileIO file;
+	if(auto ec = file.create(outputPath);
+		ec)
+	{
+		fprintf(stderr, "Error creating %s: %s\n", outputPath, ec.message().c_str());
+		return 1;
+	}
+	file.write(report.data(), report.size());
+	return 0;
+}
+
+bool runHeadlessBenchmarkFromArgs(int argc, char** argv, int &exitVal)
+{
+	const char *path{};
+	const char *outputPath{};
+	const char *moviePath{};
+	uint frames = 0;
+	for(int i = 1; i < argc; i++)
+	{
+		if(i + 1 >= argc)
+			break;
+		if(string_equal(argv[i], "--benchmark"))
+			path = argv[++i];
+		else if(string_equal(argv[i], "--benchmark-frames"))
+			frames = std::max(atoi(argv[++i]), 1);
+		else if(string_equal(argv[i], "--benchmark-output"))
+			outputPath = argv[++i];
+		else if(string_equal(argv[i], "--benchmark-movie"))
+			moviePath = argv[++i];
+	}
+	if(!path)
+		return false;
+	exitVal = runHeadlessBenchmark(path, frames, outputPath, moviePath);
+	return true;
+}
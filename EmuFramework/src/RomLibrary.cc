@@ -0,0 +1,427 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "RomLibrary"
+#include "RomLibrary.hh"
+#include <emuframework/EmuApp.hh>
+#include <emuframework/EmuSystem.hh>
+#include <imagine/fs/ArchiveFS.hh>
+#include <imagine/io/FileIO.hh>
+#include <imagine/util/algorithm.h>
+#include <imagine/util/string.h>
+#include <imagine/logger/logger.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <zlib.h>
+
+// File layout, integers in host byte order since the index is a local cache:
+// IndexHeader, RomLibraryEntry[entries], string table of stringBytes
+// The string table starts with an empty string so offset 0 means "none"
+
+static constexpr char MAGIC[8]{'E', 'M', 'U', 'L', 'I', 'B', 'R', 'Y'};
+static constexpr uint32_t VERSION = 1;
+static constexpr uint32_t MAX_SCAN_THREADS = 4;
+static constexpr int MAX_SCAN_DEPTH = 8;
+static constexpr size_t CRC_BUFFER_SIZE = 64 * 1024;
+
+struct IndexHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t entries;
+	uint32_t stringBytes;
+	uint32_t entrySize;
+};
+
+struct RomFile
+{
+	std::string path{};
+	std::string member{};
+	uint64_t size = 0;
+	int64_t mTime = 0;
+	uint32_t crc32 = 0;
+	const RomLibraryEntry *prev{};
+	bool valid = true;
+};
+
+static bool isIndexableFile(const char *name)
+{
+	return EmuSystem::defaultFsFilter(name) || (!EmuSystem::handlesArchiveFiles && EmuApp::hasArchiveExtension(name));
+}
+
+static bool isInDir(const char *path, const char *dirPath)
+{
+	auto dirLen = strlen(dirPath);
+	if(dirLen == 1 && dirPath[0] == '/')
+		return true;
+	return !strncmp(path, dirPath, dirLen) && path[dirLen] == '/';
+}
+
+static bool containsNoCase(const char *str, const char *query)
+{
+	auto queryLen = strlen(query);
+	for(; *str; str++)
+	{
+		if(!strncasecmp(str, query, queryLen))
+			return true;
+	}
+	return false;
+}
+
+static uint32_t crc32OfIO(IO &io, std::vector<uint8_t> &buff)
+{
+	uLong crc = crc32(0, nullptr, 0);
+	ssize_t bytes;
+	while((bytes = io.read(buff.data(), buff.size())) > 0)
+	{
+		crc = crc32(crc, buff.data(), bytes);
+	}
+	return crc;
+}
+
+static void collectFiles(const char *dirPath, std::vector<RomFile> &files, const std::atomic_bool &cancel, int depth)
+{
+	std::error_code ec{};
+	for(auto &entry : FS::directory_iterator{dirPath, ec})
+	{
+		if(cancel.load(std::memory_order_relaxed))
+			return;
+		auto type = entry.type();
+		if(type == FS::file_type::directory)
+		{
+			if(depth < MAX_SCAN_DEPTH && entry.name()[0] != '.')
+				collectFiles(entry.path().data(), files, cancel, depth + 1);
+			continue;
+		}
+		if(type != FS::file_type::regular || !isIndexableFile(entry.name()))
+			continue;
+		auto path = entry.path();
+		auto status = FS::status(path.data());
+		RomFile file{};
+		file.path = path.data();
+		file.size = status.size();
+		file.mTime = status.lastWriteTime();
+		files.emplace_back(std::move(file));
+	}
+	if(ec)
+	{
+		logWarn("can't open %s: %s", dirPath, ec.message().c_str());
+	}
+}
+
+static void hashFile(RomFile &file, std::vector<uint8_t> &buff)
+{
+	if(!EmuSystem::handlesArchiveFiles && EmuApp::hasArchiveExtension(file.path.data()))
+	{
+		// index the archive member that loadGameFromFile() would pick
+		std::error_code ec{};
+		for(auto &entry : FS::ArchiveIterator{file.path.data(), ec})
+		{
+			if(entry.type() == FS::file_type::directory || !EmuSystem::defaultFsFilter(entry.name()))
+			{
+				continue;
+			}
+			file.member = entry.name();
+			file.crc32 = entry.crc32();
+			if(!file.crc32)
+			{
+				// format doesn't store checksums, read the data instead
+				auto io = entry.moveIO();
+				file.crc32 = crc32OfIO(io, buff);
+			}
+			return;
+		}
+		file.valid = false;
+		return;
+	}
+	FileIO io{};
+	if(auto ec = io.open(file.path.data(), IO::AccessHint::SEQUENTIAL);
+		ec)
+	{
+		logWarn("can't open %s: %s", file.path.data(), ec.message().c_str());
+		file.valid = false;
+		return;
+	}
+	file.crc32 = crc32OfIO(io, buff);
+}
+
+RomLibrary::~RomLibrary()
+{
+	cancelScan();
+}
+
+FS::PathString RomLibrary::indexPath()
+{
+	return FS::makePathStringPrintf("%s/library", EmuApp::supportPath().data());
+}
+
+bool RomLibrary::load()
+{
+	cancelScan();
+	auto path = indexPath();
+	FileIO file{};
+	if(file.open(path.data(), IO::AccessHint::ALL))
+	{
+		return false;
+	}
+	auto data = (const uint8_t*)file.mmapConst();
+	auto size = file.size();
+	IndexHeader header;
+	if(!data || size < sizeof(header))
+	{
+		logErr("can't read index:%s", path.data());
+		return false;
+	}
+	memcpy(&header, data, sizeof(header));
+	if(memcmp(header.magic, MAGIC, sizeof(MAGIC)) || header.version != VERSION
+		|| header.entrySize != sizeof(RomLibraryEntry))
+	{
+		logMsg("ignoring index with unknown format");
+		return false;
+	}
+	auto entryBytes = (size_t)header.entries * sizeof(RomLibraryEntry);
+	if(size != sizeof(header) + entryBytes + header.stringBytes
+		|| !header.stringBytes || data[size - 1] != 0)
+	{
+		logErr("index has invalid size");
+		return false;
+	}
+	entries.resize(header.entries);
+	memcpy(entries.data(), data + sizeof(header), entryBytes);
+	strings.assign((const char*)data + sizeof(header) + entryBytes, header.stringBytes);
+	bool validOffsets = std::all_of(entries.begin(), entries.end(),
+		[&](const RomLibraryEntry &e)
+		{
+			return std::max({e.pathOfs, e.memberOfs, e.titleOfs}) < header.stringBytes;
+		});
+	if(!validOffsets)
+	{
+		logErr("index has invalid string offsets");
+		clear();
+		return false;
+	}
+	logMsg("loaded %zu entries", entries.size());
+	return true;
+}
+
+bool RomLibrary::save() const
+{
+	IndexHeader header{};
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.entries = entries.size();
+	header.stringBytes = strings.size();
+	header.entrySize = sizeof(RomLibraryEntry);
+	std::vector<uint8_t> buff(sizeof(header) + entries.size() * sizeof(RomLibraryEntry) + strings.size());
+	auto dest = buff.data();
+	memcpy(dest, &header, sizeof(header));
+	dest += sizeof(header);
+	memcpy(dest, entries.data(), entries.size() * sizeof(RomLibraryEntry));
+	dest += entries.size() * sizeof(RomLibraryEntry);
+	memcpy(dest, strings.data(), strings.size());
+	std::error_code ec{};
+	if(FileUtils::writeToPath(indexPath().data(), buff.data(), buff.size(), &ec) == -1)
+	{
+		logErr("error writing index: %s", ec.message().c_str());
+		return false;
+	}
+	return true;
+}
+
+bool RomLibrary::scan(const char *dirPath)
+{
+	if(isScanning())
+		return false;
+	auto root = FS::makePathString(dirPath);
+	if(auto len = strlen(root.data()); len > 1 && root[len - 1] == '/')
+		root[len - 1] = 0;
+	logMsg("scanning %s", root.data());
+	cancelScan_ = false;
+	scannedFiles_ = 0;
+	filesToScan_ = 0;
+	if(!scanDoneEventAttached)
+	{
+		scanDoneEvent.attach(
+			[this]()
+			{
+				applyScan();
+			});
+		scanDoneEventAttached = true;
+	}
+	scanThread = std::thread
+	{
+		[this, root]()
+		{
+			// the current entries aren't modified until this thread is joined
+			std::vector<RomFile> files{};
+			collectFiles(root.data(), files, cancelScan_, 0);
+			std::vector<RomFile*> changedFiles{};
+			for(auto &f : files)
+			{
+				if(auto prev = findPath(f.path.data());
+					prev && prev->size == f.size && prev->mTime == f.mTime)
+				{
+					f.prev = prev;
+				}
+				else
+				{
+					changedFiles.emplace_back(&f);
+				}
+			}
+			filesToScan_ = changedFiles.size();
+			std::atomic_uint32_t nextFile{};
+			auto hashFiles =
+				[&]()
+				{
+					std::vector<uint8_t> buff(CRC_BUFFER_SIZE);
+					for(uint32_t i; (i = nextFile++) < changedFiles.size();)
+					{
+						if(cancelScan_.load(std::memory_order_relaxed))
+							return;
+						hashFile(*changedFiles[i], buff);
+						scannedFiles_++;
+					}
+				};
+			auto threads = std::clamp(std::thread::hardware_concurrency(), 1u, MAX_SCAN_THREADS);
+			std::vector<std::thread> workers{};
+			iterateTimes(threads - 1, i)
+			{
+				workers.emplace_back(hashFiles);
+			}
+			hashFiles();
+			for(auto &t : workers)
+			{
+				t.join();
+			}
+			if(cancelScan_)
+				return;
+			// keep entries outside the scanned folder, replace the ones inside it
+			scanEntries.clear();
+			scanStrings.assign(1, '\0');
+			auto addString =
+				[this](const char *str) -> uint32_t
+				{
+					if(!strlen(str))
+						return 0;
+					auto ofs = scanStrings.size();
+					scanStrings.append(str, strlen(str) + 1);
+					return ofs;
+				};
+			for(auto &e : entries)
+			{
+				if(isInDir(path(e), root.data()))
+					continue;
+				scanEntries.push_back({e.size, e.mTime, e.crc32, addString(path(e)), addString(member(e)), addString(title(e))});
+			}
+			for(auto &f : files)
+			{
+				if(f.prev)
+				{
+					auto &e = *f.prev;
+					scanEntries.push_back({e.size, e.mTime, e.crc32, addString(path(e)), addString(member(e)), addString(title(e))});
+				}
+				else if(f.valid)
+				{
+					// title is resolved on the main thread
+					scanEntries.push_back({f.size, f.mTime, f.crc32, addString(f.path.data()), addString(f.member.data()), 0});
+				}
+			}
+			std::sort(scanEntries.begin(), scanEntries.end(),
+				[this](const RomLibraryEntry &a, const RomLibraryEntry &b)
+				{
+					return strcmp(&scanStrings[a.pathOfs], &scanStrings[b.pathOfs]) < 0;
+				});
+			logMsg("scanned %zu files, %zu changed", files.size(), changedFiles.size());
+			scanDoneEvent.notify();
+		}
+	};
+	return true;
+}
+
+void RomLibrary::cancelScan()
+{
+	if(!scanThread.joinable())
+		return;
+	cancelScan_ = true;
+	scanThread.join();
+	scanDoneEvent.cancel();
+	scanEntries = {};
+	scanStrings = {};
+}
+
+void RomLibrary::applyScan()
+{
+	if(!scanThread.joinable())
+		return;
+	scanThread.join();
+	entries = std::move(scanEntries);
+	strings = std::move(scanStrings);
+	scanEntries = {};
+	scanStrings = {};
+	for(auto &e : entries)
+	{
+		if(e.titleOfs)
+			continue;
+		auto title = EmuSystem::fullGameNameForPath(path(e));
+		e.titleOfs = strings.size();
+		strings.append(title.data(), strlen(title.data()) + 1);
+	}
+	logMsg("library has %zu entries", entries.size());
+	save();
+	onScanDone.callSafe(*this);
+}
+
+void RomLibrary::setOnScanDone(OnScanDoneDelegate del)
+{
+	onScanDone = del;
+}
+
+const RomLibraryEntry *RomLibrary::findPath(const char *path) const
+{
+	auto it = std::lower_bound(entries.begin(), entries.end(), path,
+		[this](const RomLibraryEntry &e, const char *path)
+		{
+			return strcmp(this->path(e), path) < 0;
+		});
+	if(it == entries.end() || strcmp(this->path(*it), path))
+		return nullptr;
+	return &(*it);
+}
+
+std::vector<uint32_t> RomLibrary::search(const char *query) const
+{
+	std::vector<uint32_t> matches{};
+	iterateTimes(entries.size(), i)
+	{
+		auto &e = entries[i];
+		auto filename = strrchr(path(e), '/');
+		if(containsNoCase(title(e), query) || (filename && containsNoCase(filename + 1, query)))
+			matches.emplace_back(i);
+	}
+	std::sort(matches.begin(), matches.end(),
+		[this](uint32_t a, uint32_t b)
+		{
+			return FS::fileStringNoCaseLexCompare(title(entries[a]), title(entries[b]));
+		});
+	return matches;
+}
+
+void RomLibrary::clear()
+{
+	cancelScan();
+	entries = {};
+	strings.assign(1, '\0');
+}
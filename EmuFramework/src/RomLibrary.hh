@@ -0,0 +1,85 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/base/CustomEvent.hh>
+#include <imagine/fs/FS.hh>
+#include <imagine/util/DelegateFunc.hh>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Index of the games found by scanning folders, saved to the support path and
+// loaded at startup so the library can be listed & searched without touching
+// the files. A rescan only reads files whose size or modification time changed,
+// hashing them on a pool of worker threads. Titles come from
+// EmuSystem::fullGameNameForPath() on the main thread since some systems
+// resolve them with core state.
+
+struct RomLibraryEntry
+{
+	uint64_t size = 0;
+	int64_t mTime = 0;
+	uint32_t crc32 = 0;
+	// offsets into the string table, archives record the member that gets loaded
+	uint32_t pathOfs = 0;
+	uint32_t memberOfs = 0;
+	uint32_t titleOfs = 0;
+};
+
+class RomLibrary
+{
+public:
+	using OnScanDoneDelegate = DelegateFunc<void (RomLibrary &library)>;
+
+	RomLibrary() {}
+	~RomLibrary();
+	bool load();
+	bool save() const;
+	bool scan(const char *dirPath);
+	void cancelScan();
+	bool isScanning() const { return scanThread.joinable(); }
+	uint32_t scannedFiles() const { return scannedFiles_.load(std::memory_order_relaxed); }
+	uint32_t filesToScan() const { return filesToScan_.load(std::memory_order_relaxed); }
+	void setOnScanDone(OnScanDoneDelegate del);
+	uint32_t size() const { return entries.size(); }
+	const RomLibraryEntry &entry(uint32_t idx) const { return entries[idx]; }
+	const char *path(const RomLibraryEntry &e) const { return &strings[e.pathOfs]; }
+	const char *member(const RomLibraryEntry &e) const { return &strings[e.memberOfs]; }
+	const char *title(const RomLibraryEntry &e) const { return &strings[e.titleOfs]; }
+	const RomLibraryEntry *findPath(const char *path) const;
+	// indices of entries whose title or file name contains the query, sorted by title
+	std::vector<uint32_t> search(const char *query) const;
+	void clear();
+	static FS::PathString indexPath();
+
+protected:
+	std::vector<RomLibraryEntry> entries{}; // sorted by path
+	std::string strings{};
+	std::thread scanThread{};
+	Base::CustomEvent scanDoneEvent{"RomLibrary::scanDoneEvent"};
+	std::atomic_bool cancelScan_{};
+	std::atomic_uint32_t scannedFiles_{};
+	std::atomic_uint32_t filesToScan_{};
+	// results of the scan thread, applied on the main thread
+	std::vector<RomLibraryEntry> scanEntries{};
+	std::string scanStrings{};
+	OnScanDoneDelegate onScanDone{};
+	bool scanDoneEventAttached = false;
+
+	void applyScan();
+};
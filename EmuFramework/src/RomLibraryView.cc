@@ -0,0 +1,135 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+
+#include <emuframework/EmuApp.hh>
+#include <emuframework/FilePicker.hh>
+#include <imagine/gui/FSPicker.hh>
+#include <imagine/logger/logger.h>
+#include "RomLibraryView.hh"
+#include "EmuOptions.hh"
+#include "private.hh"
+
+RomLibraryView::RomLibraryView(ViewAttachParams attach):
+	TableView
+	{
+		"ROM Library",
+		attach,
+		[this](const TableView &)
+		{
+			return 2 + game.size();
+		},
+		[this](const TableView &, uint idx) -> MenuItem&
+		{
+			switch(idx)
+			{
+				case 0: return search;
+				case 1: return scanFolder;
+				default: return game[idx - 2];
+			}
+		}
+	},
+	search
+	{
+		"Search",
+		[this](Input::Event e)
+		{
+			EmuApp::pushAndShowNewCollectTextInputView(attachParams(), e, "Title or file name, blank for all", query.c_str(),
+				[this](CollectTextInputView &view, const char *str)
+				{
+					if(str)
+					{
+						query = str;
+						loadGameItems();
+						place();
+						window().postDraw();
+					}
+					view.dismiss();
+					return 0;
+				});
+		}
+	},
+	scanFolder
+	{
+		romLibrary.isScanning() ? "Cancel Scan" : "Scan Folder",
+		[this](TextMenuItem &item, Input::Event e)
+		{
+			if(romLibrary.isScanning())
+			{
+				romLibrary.cancelScan();
+				item.setName("Scan Folder");
+				item.compile(renderer(), projP);
+				postDraw();
+				return;
+			}
+			auto fPicker = makeView<EmuFilePicker>(optionLastLoadPath, true,
+				EmuSystem::NameFilterFunc{}, FS::RootPathInfo{}, e);
+			fPicker->setOnClose(
+				[this](FSPicker &picker, Input::Event)
+				{
+					if(romLibrary.scan(picker.path().data()))
+					{
+						scanFolder.setName("Cancel Scan");
+						scanFolder.compile(renderer(), projP);
+						EmuApp::postMessage("Scanning folder in the background");
+					}
+					picker.dismiss();
+				});
+			pushAndShowModal(std::move(fPicker), e);
+		}
+	}
+{
+	romLibrary.setOnScanDone(
+		[this](RomLibrary &library)
+		{
+			scanFolder.setName("Scan Folder");
+			EmuApp::printfMessage(3, false, "Library has %u games", library.size());
+			loadGameItems();
+			place();
+			postDraw();
+		});
+	loadGameItems();
+}
+
+RomLibraryView::~RomLibraryView()
+{
+	// scan keeps running in the background
+	romLibrary.setOnScanDone({});
+}
+
+void RomLibraryView::loadGameItems()
+{
+	game.clear();
+	gameIdx = romLibrary.search(query.c_str());
+	if(gameIdx.size() > MAX_GAME_ITEMS)
+	{
+		logMsg("limiting %zu matches to %u items", gameIdx.size(), MAX_GAME_ITEMS);
+		gameIdx.resize(MAX_GAME_ITEMS);
+	}
+	game.reserve(gameIdx.size());
+	for(auto idx : gameIdx)
+	{
+		// names point into the library's string table, items are rebuilt after each scan
+		game.emplace_back(romLibrary.title(romLibrary.entry(idx)),
+			[idx](Input::Event e)
+			{
+				EmuApp::createSystemWithMedia({}, romLibrary.path(romLibrary.entry(idx)), "", e,
+					[](Input::Event e)
+					{
+						EmuApp::launchSystemWithResumePrompt(e, true);
+					});
+			});
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/gui/TableView.hh>
+#include <imagine/gui/MenuItem.hh>
+#include <string>
+#include <vector>
+
+class RomLibraryView : public TableView
+{
+public:
+	RomLibraryView(ViewAttachParams attach);
+	~RomLibraryView();
+
+private:
+	static constexpr uint32_t MAX_GAME_ITEMS = 1000;
+	std::vector<TextMenuItem> game{};
+	std::vector<uint32_t> gameIdx{};
+	TextMenuItem search{};
+	TextMenuItem scanFolder{};
+	std::string query{};
+
+	void loadGameItems();
+};
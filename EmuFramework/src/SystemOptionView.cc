@@ -220,6 +220,66 @@ SystemOptionView::SystemOptionView(ViewAttachParams attach, bool customMenu):
 			return 0;
 		}(),
 		fastForwardSpeedItem
+	},
+	rewindBufferSizeItem
+	{
+		{"Off", [this]() { optionRewindBufferSize = 0; }},
+		{"16MB", [this]() { optionRewindBufferSize = 16; }},
+		{"32MB", [this]() { optionRewindBufferSize = 32; }},
+		{"64MB", [this]() { optionRewindBufferSize = 64; }},
+		{"128MB", [this]() { optionRewindBufferSize = 128; }},
+	},
+	rewindBufferSize
+	{
+		"Rewind Buffer",
+		[]()
+		{
+			switch(optionRewindBufferSize.val)
+			{
+				default: return 0;
+				case 16: return 1;
+				case 32: return 2;
+				case 64: return 3;
+				case 128: return 4;
+			}
+		}(),
+		rewindBufferSizeItem
+	},
+	rewindIntervalItem
+	{
+		{"Every Frame", [this]() { optionRewindInterval = 1; }},
+		{"2 Frames", [this]() { optionRewindInterval = 2; }},
+		{"4 Frames", [this]() { optionRewindInterval = 4; }},
+		{"8 Frames", [this]() { optionRewindInterval = 8; }},
+	},
+	rewindInterval
+	{
+		"Rewind Granularity",
+		[]()
+		{
+			switch(optionRewindInterval.val)
+			{
+				default: return 0;
+				case 2: return 1;
+				case 4: return 2;
+				case 8: return 3;
+			}
+		}(),
+		rewindIntervalItem
+	},
+	runAheadFramesItem
+	{
+		{"Off", [this]() { optionRunAheadFrames = 0; }},
+		{"1 Frame", [this]() { optionRunAheadFrames = 1; }},
+		{"2 Frames", [this]() { optionRunAheadFrames = 2; }},
+		{"3 Frames", [this]() { optionRunAheadFrames = 3; }},
+		{"4 Frames", [this]() { optionRunAheadFrames = 4; }},
+	},
+	runAheadFrames
+	{
+		"Run-Ahead",
+		optionRunAheadFrames.val,
+		runAheadFramesItem
 	}
 	#if defined __ANDROID__
 	,processPriorityItem
@@ -290,6 +350,9 @@ void SystemOptionView::loadStockItems()
 	item.emplace_back(&savePath);
 	item.emplace_back(&checkSavePathWriteAccess);
 	item.emplace_back(&fastForwardSpeed);
+	item.emplace_back(&rewindBufferSize);
+	item.emplace_back(&rewindInterval);
+	item.emplace_back(&runAheadFrames);
 	#ifdef __ANDROID__
 	item.emplace_back(&processPriority);
 	if(!optionSustainedPerformanceMode.isConst)
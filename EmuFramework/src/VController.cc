@@ -281,11 +281,11 @@ bool VControllerKeyboard::keyInput(VController &v, Gfx::Renderer &r, Input::Even
 		}
 		else if(e.pushed())
 		{
-			EmuSystem::handleInputAction(Input::PUSHED, currentKey());
+			emuViewController.sendInputAction(Input::PUSHED, currentKey(), e.time());
 		}
 		else
 		{
-			EmuSystem::handleInputAction(Input::RELEASED, currentKey());
+			emuViewController.sendInputAction(Input::RELEASED, currentKey(), e.time());
 		}
 		return true;
 	}
@@ -948,7 +948,7 @@ void VController::inputAction(uint action, uint vBtn)
 {
 	if(isInKeyboardMode())
 	{
-		EmuSystem::handleInputAction(action, kb.translateInput(vBtn));
+		emuViewController.sendInputAction(action, kb.translateInput(vBtn));
 	}
 	else
 	{
@@ -966,7 +966,7 @@ void VController::inputAction(uint action, uint vBtn)
 				turboActions.removeEvent(keyCode);
 			}
 		}
-		EmuSystem::handleInputAction(action, keyCode);
+		emuViewController.sendInputAction(action, keyCode);
 	}
 }
 
@@ -222,6 +222,12 @@ static void setFrameInterval(int interval)
 }
 #endif
 
+static void setFramePacing(FramePacing pacing)
+{
+	optionFramePacing = (uint8_t)pacing;
+	emuViewController.applyFramePacing();
+}
+
 #ifdef CONFIG_GFX_OPENGL_SHADER_PIPELINE
 static void setImgEffect(uint val)
 {
@@ -403,6 +409,19 @@ VideoOptionView::VideoOptionView(ViewAttachParams attach, bool customMenu):
 			optionSkipLateFrames.val = item.flipBoolValue(*this);
 		}
 	},
+	framePacingItem
+	{
+		{"Auto", []() { setFramePacing(FramePacing::AUTO); }},
+		{"Display Vsync", []() { setFramePacing(FramePacing::VSYNC); }},
+		{"Audio Clock", []() { setFramePacing(FramePacing::AUDIO_CLOCK); }},
+		{"Timestamps", []() { setFramePacing(FramePacing::TIMESTAMP); }},
+	},
+	framePacing
+	{
+		"Frame Pacing",
+		optionFramePacing,
+		framePacingItem
+	},
 	frameRate
 	{
 		frameRateStr,
@@ -765,6 +784,16 @@ VideoOptionView::VideoOptionView(ViewAttachParams attach, bool customMenu):
 		}(),
 		gpuMultithreadingItem
 	},
+	directRendering
+	{
+		"Render Directly To Texture",
+		(bool)optionDirectVideoRendering,
+		[this](BoolMenuItem &item, Input::Event e)
+		{
+			optionDirectVideoRendering.val = item.flipBoolValue(*this);
+			emuVideo.setDirectRendering(optionDirectVideoRendering);
+		}
+	},
 	visualsHeading{"Visuals"},
 	screenShapeHeading{"Screen Shape"},
 	advancedHeading{"Advanced"},
@@ -826,6 +855,7 @@ void VideoOptionView::loadStockItems()
 	item.emplace_back(&frameInterval);
 	#endif
 	item.emplace_back(&dropLateFrames);
+	item.emplace_back(&framePacing);
 	if(!optionFrameRate.isConst)
 	{
 		printFrameRateStr(frameRateStr);
@@ -863,6 +893,8 @@ void VideoOptionView::loadStockItems()
 	#endif
 	if(renderer().supportsThreadMode())
 		item.emplace_back(&gpuMultithreading);
+	if(!optionDirectVideoRendering.isConst)
+		item.emplace_back(&directRendering);
 	#if defined CONFIG_BASE_MULTI_WINDOW && defined CONFIG_BASE_X11
 	item.emplace_back(&secondDisplay);
 	#endif
@@ -29,6 +29,12 @@
 #include <emuframework/EmuAudio.hh>
 #include <emuframework/EmuVideo.hh>
 #include "Recent.hh"
+#include "EmuMovie.hh"
+#include "RomLibrary.hh"
+#include "EmuTiming.hh"
+#ifdef CONFIG_EMUFRAMEWORK_FRAME_STATS
+#include "EmuFrameTrace.hh"
+#endif
 #include <memory>
 #include <atomic>
 
@@ -77,8 +83,11 @@ public:
 	void placeElements();
 	void setEmuViewOnExtraWindow(bool on, Base::Screen &screen);
 	void startMainViewportAnimation();
-	void updateEmuAudioStats(uint underruns, uint overruns, uint callbacks, double avgCallbackFrames, uint frames);
+	void updateEmuAudioStats(uint underruns, uint overruns, uint callbacks, double avgCallbackFrames, uint frames,
+		double fillMSecs, double targetFillMSecs, float rateRatio);
 	void clearEmuAudioStats();
+	void updateEmuFrameStats(const char *stats);
+	void clearEmuFrameStats();
 	void closeSystem(bool allowAutosaveState = true);
 	void postDrawToEmuWindows();
 	Base::Screen *emuWindowScreen() const;
@@ -104,6 +113,11 @@ public:
 	void updateAutoOnScreenControlVisible();
 	void setPhysicalControlsPresent(bool present);
 	void setFastForwardActive(bool active);
+	void setRewindActive(bool active);
+	void resetRewind();
+	void resetRunAhead();
+	void sendInputAction(uint state, uint emuKey, IG::Time time = {});
+	void applyFramePacing();
 
 protected:
 	static constexpr bool HAS_USE_RENDER_TIME = Config::envIsLinux
@@ -150,6 +164,12 @@ extern DelegateFunc<void ()> onUpdateInputDevices;
 extern FS::PathString lastLoadPath;
 extern EmuVideo emuVideo;
 extern EmuAudio emuAudio;
+extern EmuMovie emuMovie;
+extern RomLibrary romLibrary;
+extern EmuTiming emuTiming;
+#ifdef CONFIG_EMUFRAMEWORK_FRAME_STATS
+extern EmuFrameTrace emuFrameTrace;
+#endif
 extern RecentGameList recentGameList;
 static constexpr const char *strftimeFormat = "%x  %r";
 
@@ -165,6 +185,7 @@ bool hasGooglePlayStoreFeatures();
 void setCPUNeedsLowLatency(bool needed);
 void onMainMenuItemOptionChanged();
 void runBenchmarkOneShot();
+bool runHeadlessBenchmarkFromArgs(int argc, char** argv, int &exitVal);
 void onSelectFileFromPicker(const char* name, Input::Event e);
 void launchSystem(bool tryAutoState, bool addToRecent);
 Gfx::PixmapTexture &getAsset(Gfx::Renderer &r, AssetID assetID);
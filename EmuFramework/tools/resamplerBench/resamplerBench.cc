@@ -0,0 +1,212 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+// Compares IG::Audio::Resampler against the resamplers the emulator cores
+// ship, built as a standalone tool so imagine's tests don't depend on the
+// cores. Converts 10s stereo 1kHz and 10kHz tones from 44.1kHz to 48kHz
+// with each and prints the throughput and SNR.
+
+#include <imagine/audio/Resampler.hh>
+#include <imagine/time/Time.hh>
+#include <imagine/util/algorithm.h>
+#include <imagine/logger/logger.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cassert>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <GBC.emu/src/common/resample/resampler.h>
+#include <GBC.emu/src/common/resample/resamplerinfo.h>
+#include <MD.emu/src/genplus-gx/sound/Fir_Resampler.h>
+
+// Snes9x and Gambatte both name their resampler class Resampler, the headers
+// Snes9x's includes are already pulled in above so only its class lands here
+namespace Snes9x
+{
+#include <Snes9x/src/snes9x/apu/resampler.h>
+}
+
+static constexpr uint32_t inRate = 44100;
+static constexpr uint32_t outRate = 48000;
+static constexpr uint32_t inFrames = inRate * 10;
+static constexpr uint32_t chunkFrames = 735; // one 60Hz video frame
+static constexpr double amplitude = 16384.;
+static constexpr double step = (double)inRate / outRate;
+
+using Samples = std::vector<int16_t>;
+
+static Samples makeTone(double freq)
+{
+	Samples samples(inFrames * 2);
+	iterateTimes(inFrames, i)
+	{
+		samples[i * 2] = samples[i * 2 + 1] = std::lround(amplitude * std::sin(2. * M_PI * freq * i / inRate));
+	}
+	return samples;
+}
+
+// resamplers differ in delay and the exact ratio they settle on, so the
+// tone is fit to the output by least squares and the residual counts as noise
+static double snrDB(const Samples &out, double freq, double outStep)
+{
+	// skip the start so filter warm-up isn't counted
+	uint32_t first = outRate / 10, last = out.size() / 2 - outRate / 10;
+	double w = 2. * M_PI * freq * outStep / inRate;
+	double sinSum = 0, cosSum = 0;
+	for(uint32_t n = first; n < last; n++)
+	{
+		sinSum += out[n * 2] * std::sin(w * n);
+		cosSum += out[n * 2] * std::cos(w * n);
+	}
+	double a = 2. * sinSum / (last - first), b = 2. * cosSum / (last - first);
+	double signal = 0, noise = 0;
+	for(uint32_t n = first; n < last; n++)
+	{
+		double ref = a * std::sin(w * n) + b * std::cos(w * n);
+		double err = out[n * 2] - ref;
+		signal += ref * ref;
+		noise += err * err;
+	}
+	return 10. * std::log10(signal / noise);
+}
+
+// nearest neighbor like EmuAudio's simpleResample(), kept as the baseline
+static double resampleNearest(const Samples &in, Samples &out)
+{
+	uint32_t outFrames = inFrames / step;
+	out.resize(outFrames * 2);
+	iterateTimes(outFrames, i)
+	{
+		auto src = std::min((uint32_t)std::lround(i * step), inFrames - 1);
+		out[i * 2] = in[src * 2];
+		out[i * 2 + 1] = in[src * 2 + 1];
+	}
+	return step;
+}
+
+// Snes9x's apu/resampler.h, fed one video frame at a time like S9xMixSamples()
+static double resampleSnes9x(const Samples &in, Samples &out)
+{
+	Snes9x::Resampler resampler{(int)chunkFrames * 4};
+	resampler.time_ratio(step);
+	out.resize((inFrames / step + chunkFrames) * 2);
+	uint32_t outSamples = 0;
+	for(uint32_t i = 0; i < inFrames; i += chunkFrames)
+	{
+		auto frames = std::min(chunkFrames, inFrames - i);
+		resampler.push((int16_t*)&in[i * 2], frames * 2);
+		auto avail = resampler.avail();
+		resampler.read(&out[outSamples], avail);
+		outSamples += avail;
+	}
+	out.resize(outSamples);
+	return (float)step;
+}
+
+// Genesis Plus GX's Fir_Resampler.c as used by MD.emu for FM output
+static double resampleFir(const Samples &in, Samples &out)
+{
+	Fir_Resampler_initialize(4096);
+	double firStep = Fir_Resampler_time_ratio(step, 0.990);
+	out.resize((inFrames / firStep + chunkFrames) * 2);
+	uint32_t outSamples = 0;
+	for(uint32_t i = 0; i < inFrames; i += chunkFrames)
+	{
+		auto frames = std::min(chunkFrames, inFrames - i);
+		std::copy_n(&in[i * 2], frames * 2, Fir_Resampler_buffer());
+		Fir_Resampler_write(frames * 2);
+		outSamples += Fir_Resampler_read(&out[outSamples], Fir_Resampler_avail());
+	}
+	Fir_Resampler_shutdown();
+	out.resize(outSamples);
+	return firStep;
+}
+
+// Gambatte's resamplers from GBC.emu, selected by index like its audio resampler
+// option, the sinc chains are built for decimating the 2MHz GB output so they
+// do worse upsampling here than in their normal use
+static double resampleGambatte(size_t idx, const Samples &in, Samples &out)
+{
+	std::unique_ptr<Resampler> resampler{ResamplerInfo::get(idx).create(inRate, outRate, chunkFrames)};
+	unsigned long mul, div;
+	resampler->exactRatio(mul, div);
+	out.resize((resampler->maxOut(chunkFrames) + 1) * ((inFrames + chunkFrames - 1) / chunkFrames) * 2);
+	uint32_t outFrames = 0;
+	for(uint32_t i = 0; i < inFrames; i += chunkFrames)
+	{
+		auto frames = std::min(chunkFrames, inFrames - i);
+		outFrames += resampler->resample(&out[outFrames * 2], &in[i * 2], frames);
+	}
+	out.resize(outFrames * 2);
+	return (double)div / mul;
+}
+
+static double resamplePolyphase(const Samples &in, Samples &out)
+{
+	IG::Audio::Resampler resampler{inRate, outRate, 2};
+	out.resize(resampler.maxOutputFrames(inFrames) * 2);
+	uint32_t outFrames = 0;
+	for(uint32_t i = 0; i < inFrames; i += chunkFrames)
+	{
+		auto frames = std::min(chunkFrames, inFrames - i);
+		outFrames += resampler.process(&in[i * 2], frames, &out[outFrames * 2], resampler.maxOutputFrames(frames));
+	}
+	out.resize(outFrames * 2);
+	return step;
+}
+
+template <class Func>
+static void bench(const char *name, Func &&func, const Samples &lowTone, const Samples &highTone)
+{
+	Samples out;
+	func(lowTone, out); // warm up caches
+	double outStep{};
+	auto time = IG::timeFunc([&](){ outStep = func(lowTone, out); });
+	double mFramesPerSec = (out.size() / 2) / IG::FloatSeconds(time).count() / 1000000.;
+	auto lowSNR = snrDB(out, 1000., outStep);
+	func(highTone, out);
+	auto highSNR = snrDB(out, 10000., outStep);
+	printf("%s: %.1f MFrames/s, SNR 1kHz:%.1fdB 10kHz:%.1fdB\n", name, mFramesPerSec, lowSNR, highSNR);
+}
+
+// imagine's logger isn't linked, print Resampler.cc's messages to stderr
+void logger_printf(LoggerSeverity, const char *msg, ...)
+{
+	va_list args;
+	va_start(args, msg);
+	vfprintf(stderr, msg, args);
+	va_end(args);
+}
+
+int main()
+{
+	printf("resampling %u stereo frames %uHz -> %uHz\n", inFrames, inRate, outRate);
+	auto lowTone = makeTone(1000.);
+	auto highTone = makeTone(10000.);
+	bench("nearest", resampleNearest, lowTone, highTone);
+	bench("Snes9x hermite", resampleSnes9x, lowTone, highTone);
+	bench("MD Fir_Resampler", resampleFir, lowTone, highTone);
+	iterateTimes(ResamplerInfo::num(), i)
+	{
+		bench(ResamplerInfo::get(i).desc,
+			[i](const Samples &in, Samples &out){ return resampleGambatte(i, in, out); }, lowTone, highTone);
+	}
+	bench("polyphase", resamplePolyphase, lowTone, highTone);
+	return 0;
+}
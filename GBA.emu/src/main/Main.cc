@@ -26,6 +26,9 @@
 #include <vbam/common/SoundDriver.h>
 #include <vbam/common/Patch.h>
 #include <vbam/Util.h>
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
 
 void setGameSpecificSettings(GBASys &gba);
 void CPULoop(GBASys &gba, EmuSystemTask *task, EmuVideo *video, EmuAudio *audio);
@@ -39,6 +42,7 @@ bool detectedRtcGame = 0;
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2012-2020\nRobert Broglia\nwww.explusalpha.com\n\nPortions (c) the\nVBA-m Team\nvba-m.com";
 bool EmuSystem::hasBundledGames = true;
 bool EmuSystem::hasCheats = true;
+EmuSystem::StateFileFormat EmuSystem::stateFileFormat = StateFileFormat::GZIP;
 
 EmuSystem::NameFilterFunc EmuSystem::defaultFsFilter =
 	[](const char *name)
@@ -109,6 +113,22 @@ EmuSystem::Error EmuSystem::loadState(const char *path)
 		return makeFileReadError();
 }
 
+EmuSystem::Error EmuSystem::saveStateToBuffer(std::vector<uint8_t> &buff)
+{
+	if(CPUWriteState(gGba, buff))
+		return {};
+	else
+		return makeError("Error writing state to memory");
+}
+
+EmuSystem::Error EmuSystem::loadStateFromBuffer(IG::ConstBufferView buff)
+{
+	if(CPUReadState(gGba, buff.data(), buff.size()))
+		return {};
+	else
+		return makeError("Error reading state from memory");
+}
+
 void EmuSystem::saveBackupMem()
 {
 	if(gameIsRunning())
@@ -165,6 +185,188 @@ static EmuSystem::Error applyGamePatches(const char *patchDir, const char *romNa
 	return {}; // no patch found
 }
 
+// Check of the instruction cache against uncached fetch & decode, enabled by
+// setting GBA_VALIDATE_INSN_CACHE to a number of frames. The cached run is
+// kept going without flushing the cache. Every GBA_VALIDATE_INSN_CACHE_INTERVAL
+// frames (default 60), a reference run without the cache replays those frames
+// from the cached run's state at the start of the interval, then the cached
+// run's state and cache contents are put back. The two runs are compared at
+// the end of each frame, stopping at the first difference in CPU registers,
+// cycle count, work RAM, or anything else in the save state.
+
+struct InsnCacheValidateResult
+{
+	u32 regs[16]{};
+	u32 nextPC{};
+	int mode{};
+	int totalTicks{};
+	bool armState{};
+	bool flags[4]{};
+	std::vector<uint8_t> workRAM{}, internalRAM{}, state{};
+};
+
+static uint32_t insnCacheValidateFrames{};
+static uint32_t insnCacheValidateInterval{};
+static uint32_t insnCacheValidatedFrames{};
+static std::vector<uint8_t> insnCacheValidateStartState{}, insnCacheValidateEndState{};
+static std::vector<InsnCacheValidateResult> insnCacheCachedResults{};
+static std::unique_ptr<GBAInsnCache> insnCacheValidateCacheCopy{};
+
+static void startInsnCacheValidation()
+{
+	insnCacheValidateFrames = 0;
+	auto framesStr = getenv("GBA_VALIDATE_INSN_CACHE");
+	if(!framesStr || !gGba.insnCache.enabled)
+		return;
+	insnCacheValidateFrames = std::max(atoi(framesStr), 1);
+	auto intervalStr = getenv("GBA_VALIDATE_INSN_CACHE_INTERVAL");
+	insnCacheValidateInterval = intervalStr ? std::max(atoi(intervalStr), 1) : 60;
+	insnCacheValidatedFrames = 0;
+	insnCacheCachedResults.clear();
+	insnCacheValidateCacheCopy = std::make_unique<GBAInsnCache>();
+	logMsg("validating instruction cache for %u frames, %u frames at a time",
+		insnCacheValidateFrames, insnCacheValidateInterval);
+}
+
+static void stopInsnCacheValidation()
+{
+	insnCacheValidateFrames = 0;
+	insnCacheValidateStartState = {};
+	insnCacheValidateEndState = {};
+	insnCacheCachedResults = {};
+	insnCacheValidateCacheCopy = {};
+}
+
+static InsnCacheValidateResult captureValidateResult()
+{
+	InsnCacheValidateResult res;
+	auto &cpu = gGba.cpu;
+	iterateTimes(16, i)
+	{
+		res.regs[i] = cpu.reg[i].I;
+	}
+	res.nextPC = cpu.armNextPC;
+	res.mode = cpu.armMode;
+	res.totalTicks = cpu.cpuTotalTicks;
+	res.armState = cpu.armState;
+	res.flags[0] = cpu.nFlag();
+	res.flags[1] = cpu.zFlag();
+	res.flags[2] = cpu.C_FLAG;
+	res.flags[3] = cpu.V_FLAG;
+	res.workRAM.assign(gGba.mem.workRAM, gGba.mem.workRAM + sizeof(gGba.mem.workRAM));
+	res.internalRAM.assign(gGba.mem.internalRAM, gGba.mem.internalRAM + sizeof(gGba.mem.internalRAM));
+	CPUWriteState(gGba, res.state);
+	return res;
+}
+
+static bool reportDivergence(const char *name, u32 uncachedVal, u32 cachedVal, u32 uncachedPC, u32 cachedPC)
+{
+	if(uncachedVal == cachedVal)
+		return false;
+	logErr("instruction cache divergence after %u frames: %s uncached:0x%08X cached:0x%08X (uncached PC:0x%08X cached PC:0x%08X)",
+		insnCacheValidatedFrames, name, uncachedVal, cachedVal, uncachedPC, cachedPC);
+	return true;
+}
+
+static bool reportMemoryDivergence(const char *memName, u32 baseAddr, const std::vector<uint8_t> &uncached, const std::vector<uint8_t> &cached)
+{
+	auto [uncachedIt, cachedIt] = std::mismatch(uncached.begin(), uncached.end(), cached.begin(), cached.end());
+	if(uncachedIt == uncached.end() && cachedIt == cached.end())
+		return false;
+	auto offset = uncachedIt - uncached.begin();
+	logErr("instruction cache divergence after %u frames: %s at 0x%08X uncached:0x%02X cached:0x%02X",
+		insnCacheValidatedFrames, memName, baseAddr + (u32)offset,
+		uncachedIt != uncached.end() ? *uncachedIt : 0, cachedIt != cached.end() ? *cachedIt : 0);
+	return true;
+}
+
+static bool compareValidateResults(const InsnCacheValidateResult &uncached, const InsnCacheValidateResult &cached)
+{
+	static const char *gprName[16]{"R0", "R1", "R2", "R3", "R4", "R5", "R6", "R7",
+		"R8", "R9", "R10", "R11", "R12", "R13", "R14", "R15"};
+	static const char *flagName[4]{"N flag", "Z flag", "C flag", "V flag"};
+	auto report =
+		[&](const char *name, u32 uncachedVal, u32 cachedVal)
+		{
+			return reportDivergence(name, uncachedVal, cachedVal, uncached.nextPC, cached.nextPC);
+		};
+	if(report("next PC", uncached.nextPC, cached.nextPC) ||
+		report("ARM state", uncached.armState, cached.armState) ||
+		report("mode", uncached.mode, cached.mode) ||
+		report("total ticks", uncached.totalTicks, cached.totalTicks))
+		return false;
+	iterateTimes(16, i)
+	{
+		if(report(gprName[i], uncached.regs[i], cached.regs[i]))
+			return false;
+	}
+	iterateTimes(4, i)
+	{
+		if(report(flagName[i], uncached.flags[i], cached.flags[i]))
+			return false;
+	}
+	// the save state covers the remaining CPU, IO, and video state
+	return !reportMemoryDivergence("work RAM", 0x02000000, uncached.workRAM, cached.workRAM) &&
+		!reportMemoryDivergence("internal RAM", 0x03000000, uncached.internalRAM, cached.internalRAM) &&
+		!reportMemoryDivergence("save state offset", 0, uncached.state, cached.state);
+}
+
+static bool runReferenceFrames()
+{
+	if(EmuSystem::saveStateToBuffer(insnCacheValidateEndState))
+	{
+		logErr("error saving state, stopping instruction cache validation");
+		return false;
+	}
+	// loading a state and writing code pages both drop cache entries, keep a copy
+	// of the cache so the cached run continues with exactly what it had built up
+	*insnCacheValidateCacheCopy = gGba.insnCache;
+	gGba.insnCache.enabled = false;
+	EmuSystem::loadStateFromBuffer({(const char*)insnCacheValidateStartState.data(), insnCacheValidateStartState.size()});
+	bool matched = true;
+	for(const auto &cachedResult : insnCacheCachedResults)
+	{
+		// no video or audio output
+		CPULoop(gGba, nullptr, nullptr, nullptr);
+		insnCacheValidatedFrames++;
+		if(!compareValidateResults(captureValidateResult(), cachedResult))
+		{
+			matched = false;
+			break;
+		}
+	}
+	// back to where the cached run left off, its RAM contents match the cache again
+	EmuSystem::loadStateFromBuffer({(const char*)insnCacheValidateEndState.data(), insnCacheValidateEndState.size()});
+	gGba.insnCache = *insnCacheValidateCacheCopy;
+	insnCacheCachedResults.clear();
+	return matched;
+}
+
+static void runValidatedFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
+{
+	if(insnCacheCachedResults.empty() && EmuSystem::saveStateToBuffer(insnCacheValidateStartState))
+	{
+		logErr("error saving state, stopping instruction cache validation");
+		stopInsnCacheValidation();
+		return;
+	}
+	CPULoop(gGba, task, video, audio);
+	insnCacheCachedResults.push_back(captureValidateResult());
+	if(insnCacheCachedResults.size() < insnCacheValidateInterval &&
+		insnCacheValidatedFrames + insnCacheCachedResults.size() < insnCacheValidateFrames)
+		return;
+	if(!runReferenceFrames())
+	{
+		stopInsnCacheValidation();
+		return;
+	}
+	if(insnCacheValidatedFrames == insnCacheValidateFrames)
+	{
+		logMsg("instruction cache matched uncached execution for %u frames", insnCacheValidatedFrames);
+		stopInsnCacheValidation();
+	}
+}
+
 EmuSystem::Error EmuSystem::loadGame(IO &io, OnLoadProgressDelegate)
 {
 	int size = CPULoadRomWithIO(gGba, io);
@@ -178,11 +380,14 @@ EmuSystem::Error EmuSystem::loadGame(IO &io, OnLoadProgressDelegate)
 	{
 		return err;
 	}
+	// set GBA_DISABLE_INSN_CACHE to benchmark against plain fetch & decode
+	gGba.insnCache.setEnabled(!getenv("GBA_DISABLE_INSN_CACHE"));
 	CPUInit(gGba, 0, 0);
 	CPUReset(gGba);
 	auto saveStr = FS::makePathStringPrintf("%s/%s.sav", EmuSystem::savePath(), EmuSystem::gameName().data());
 	CPUReadBatteryFile(gGba, saveStr.data());
 	readCheatFile();
+	startInsnCacheValidation();
 	return {};
 }
 
@@ -197,7 +402,7 @@ void systemDrawScreen(EmuSystemTask *task, EmuVideo &video)
 	IG::Pixmap framePix{{{240, 160}, IG::PIXEL_RGB565}, gGba.lcd.pix};
 	if(!directColorLookup)
 	{
-		img.pixmap().writeTransformed([](uint16_t p){ return systemColorMap.map16[p]; }, framePix);
+		img.pixmap().writeLookup(systemColorMap.map16, framePix);
 	}
 	else
 	{
@@ -217,6 +422,11 @@ void systemOnWriteDataToSoundBuffer(EmuAudio *audio, const u16 * finalWave, int
 
 void EmuSystem::runFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
 {
+	if(insnCacheValidateFrames)
+	{
+		runValidatedFrame(task, video, audio);
+		return;
+	}
 	CPULoop(gGba, task, video, audio);
 }
 
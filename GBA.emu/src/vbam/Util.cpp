@@ -2,6 +2,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <zlib.h>
+#include <algorithm>
+#include <vector>
 
 #ifndef NO_PNG
 extern "C" {
@@ -510,6 +512,78 @@ long utilGzMemTell(gzFile file)
   return memtell(file);
 }
 
+// Uncompressed in-memory stream, used for fast state snapshots
+struct UtilMemStream
+{
+  std::vector<uint8_t> *writeBuff;
+  const uint8_t *readData;
+  size_t size;
+  size_t pos;
+};
+
+static int ZEXPORT memStreamWrite(gzFile file, voidpc buffer, unsigned len)
+{
+  auto &s = *(UtilMemStream*)file;
+  if(s.pos + len > s.writeBuff->size())
+    s.writeBuff->resize(s.pos + len);
+  memcpy(s.writeBuff->data() + s.pos, buffer, len);
+  s.pos += len;
+  return len;
+}
+
+static int ZEXPORT memStreamRead(gzFile file, voidp buffer, unsigned len)
+{
+  auto &s = *(UtilMemStream*)file;
+  if(s.pos >= s.size)
+    return 0;
+  len = std::min((size_t)len, s.size - s.pos);
+  memcpy(buffer, s.readData + s.pos, len);
+  s.pos += len;
+  return len;
+}
+
+static int ZEXPORT memStreamClose(gzFile file)
+{
+  delete (UtilMemStream*)file;
+  return 0;
+}
+
+static z_off_t ZEXPORT memStreamSeek(gzFile file, z_off_t offset, int whence)
+{
+  auto &s = *(UtilMemStream*)file;
+  size_t newPos;
+  switch(whence)
+  {
+    case SEEK_SET: newPos = offset; break;
+    case SEEK_CUR: newPos = s.pos + offset; break;
+    default: return -1;
+  }
+  if(s.writeBuff && newPos > s.writeBuff->size())
+    s.writeBuff->resize(newPos);
+  s.pos = newPos;
+  return newPos;
+}
+
+static gzFile utilMemStreamOpen(UtilMemStream s)
+{
+  utilGzWriteFunc = memStreamWrite;
+  utilGzReadFunc = memStreamRead;
+  utilGzCloseFunc = memStreamClose;
+  utilGzSeekFunc = memStreamSeek;
+  return (gzFile)new UtilMemStream{s};
+}
+
+gzFile utilMemStreamOpen(std::vector<uint8_t> &buff)
+{
+  buff.clear();
+  return utilMemStreamOpen({&buff, nullptr, 0, 0});
+}
+
+gzFile utilMemStreamOpen(const void *data, size_t size)
+{
+  return utilMemStreamOpen({nullptr, (const uint8_t*)data, size, 0});
+}
+
 void utilGBAFindSave(const u8 *data, const int size)
 {
   u32 *p = (u32 *)data;
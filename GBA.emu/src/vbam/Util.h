@@ -3,6 +3,7 @@
 
 #include "System.h"
 #include <imagine/util/builtins.h>
+#include <vector>
 
 enum IMAGE_TYPE {
   IMAGE_UNKNOWN = -1,
@@ -41,6 +42,8 @@ int utilGzRead(gzFile file, voidp buffer, unsigned int len);
 int utilGzClose(gzFile file);
 z_off_t utilGzSeek(gzFile file, z_off_t offset, int whence);
 long utilGzMemTell(gzFile file);
+gzFile utilMemStreamOpen(std::vector<uint8_t> &buff);
+gzFile utilMemStreamOpen(const void *data, size_t size);
 void utilGBAFindSave(const u8 *, const int);
 void utilUpdateSystemColorMaps(bool lcd = false);
 bool utilFileExists( const char *filename );
@@ -2,6 +2,8 @@
 #include <string.h>
 #include <stdio.h>
 #include <ctype.h>
+#include <algorithm>
+#include <iterator>
 
 #include "GBA.h"
 #include "GBAinline.h"
@@ -301,10 +303,12 @@ u8 v3_deadtable2[256] = {
 #define CHEAT_IS_HEX(a) ( ((a)>='A' && (a) <='F') || ((a) >='0' && (a) <= '9'))
 
 #define CHEAT_PATCH_ROM_16BIT(a,v) \
-  WRITE16LE(((u16 *)&cpu.gba->mem.rom[(a) & 0x1ffffff]), v);
+  do { WRITE16LE(((u16 *)&cpu.gba->mem.rom[(a) & 0x1ffffff]), v); \
+    cpu.gba->insnCache.writeROM(a); } while(0)
 
 #define CHEAT_PATCH_ROM_32BIT(a,v) \
-  WRITE32LE(((u32 *)&cpu.gba->mem.rom[(a) & 0x1ffffff]), v);
+  do { WRITE32LE(((u32 *)&cpu.gba->mem.rom[(a) & 0x1ffffff]), v); \
+    cpu.gba->insnCache.writeROM(a); } while(0)
 
 static bool isMultilineWithData(int i)
 {
@@ -2597,16 +2601,24 @@ void cheatsSaveGame(gzFile file)
 {
   utilWriteInt(file, cheatsNumber);
 
-  utilGzWrite(file, cheatsList, sizeof(cheatsList));
+  utilGzWrite(file, cheatsList, cheatsNumber * sizeof(CheatsData));
 }
 
 void cheatsReadGame(gzFile file, int version)
 {
   cheatsNumber = 0;
 
-  cheatsNumber = utilReadInt(file);
+  int storedCheats = utilReadInt(file);
+  cheatsNumber = std::clamp(storedCheats, 0, (int)std::size(cheatsList));
+  // entries past the list size are skipped so the rest of the state stays in position
+  int excessCheats = std::max(storedCheats - cheatsNumber, 0);
 
-  if (version > 8)
+  if (version >= SAVE_GAME_VERSION_11) {
+    utilGzRead(file, cheatsList, cheatsNumber * sizeof(CheatsData));
+    if (excessCheats)
+      utilGzSeek(file, excessCheats * sizeof(CheatsData), SEEK_CUR);
+  }
+  else if (version > 8)
     utilGzRead(file, cheatsList, sizeof(cheatsList));
 
 
@@ -2668,6 +2680,9 @@ void cheatsReadGame(gzFile file, int version)
       }
     }
   }
+
+  if (version < 9 && excessCheats)
+    utilGzSeek(file, excessCheats * ((7 * sizeof(int)) + (52 * sizeof(char))), SEEK_CUR);
 }
 
 
@@ -2677,7 +2692,10 @@ void cheatsReadGameSkip( gzFile file, int version )
   int nCheats = 0;
   nCheats = utilReadInt( file );
 
-  if( version >= 9 ) {
+  if( version >= SAVE_GAME_VERSION_11 ) {
+    utilGzSeek( file, nCheats * sizeof( CheatsData ), SEEK_CUR );
+  }
+  else if( version >= 9 ) {
     utilGzSeek( file, sizeof( cheatsList ), SEEK_CUR );
   }
 
@@ -2277,6 +2277,23 @@ static const insnfunc_t armInsnTable[4096] = {
     REP256(armF00),                                           // F00
 };
 
+// Instruction cache fill ////////////////////////////////////////////////
+
+const GBAInsnCache::ArmTable::Entry &armInsnCacheFill(ARM7TDMI &cpu, u32 pc)
+{
+    auto &cache = cpu.gba->insnCache;
+    u32 opcode = CPUReadMemoryQuick(cpu, pc);
+    auto func = armInsnTable[((opcode>>16)&0xFF0) | ((opcode>>4)&0x0F)];
+    if (!cache.enabled || !GBAInsnCache::isCacheable(pc, 4)) {
+        cache.armScratch = {0, opcode, func};
+        return cache.armScratch;
+    }
+    auto &e = cache.arm.entryFor(pc);
+    e = {GBAInsnCache::ArmTable::tag(pc), opcode, func};
+    cache.markCode(pc);
+    return e;
+}
+
 // Wrapper routine (execution loop) ///////////////////////////////////////
 
 #if 0
@@ -2306,7 +2323,8 @@ int armExecute(ARM7TDMI &cpu)
         if ((armNextPC & 0x0803FFFF) == 0x08020000)
           busPrefetchCount = 0x100;
 
-        u32 opcode = cpu.prefetchArmOpcode();
+        insnfunc_t func;
+        u32 opcode = cpu.prefetchArmOpcode(func);
 
         busPrefetch = false;
         if (busPrefetchCount & 0xFFFFFE00)
@@ -2382,8 +2400,11 @@ int armExecute(ARM7TDMI &cpu)
             }
         }
 
-        if (cond_res)
-            (*armInsnTable[((opcode>>16)&0xFF0) | ((opcode>>4)&0x0F)])(cpu, opcode, clockTicks);
+        if (cond_res) {
+            if (UNLIKELY(!func))
+                func = armInsnTable[((opcode>>16)&0xFF0) | ((opcode>>4)&0x0F)];
+            func(cpu, opcode, clockTicks);
+        }
 #ifdef INSN_COUNTER
         count(opcode, cond_res);
 #endif
@@ -1728,6 +1728,23 @@ static const insnfunc_t thumbInsnTable[1024] = {
   thumbF8,thumbF8,thumbF8,thumbF8,thumbF8,thumbF8,thumbF8,thumbF8,
 };
 
+// Instruction cache fill ////////////////////////////////////////////////
+
+const GBAInsnCache::ThumbTable::Entry &thumbInsnCacheFill(ARM7TDMI &cpu, u32 pc)
+{
+  auto &cache = cpu.gba->insnCache;
+  u32 opcode = CPUReadHalfWordQuick(cpu, pc);
+  auto func = thumbInsnTable[opcode>>6];
+  if (!cache.enabled || !GBAInsnCache::isCacheable(pc, 2)) {
+    cache.thumbScratch = {0, opcode, func};
+    return cache.thumbScratch;
+  }
+  auto &e = cache.thumb.entryFor(pc);
+  e = {GBAInsnCache::ThumbTable::tag(pc), opcode, func};
+  cache.markCode(pc);
+  return e;
+}
+
 // Wrapper routine (execution loop) ///////////////////////////////////////
 
 int thumbExecute(ARM7TDMI &cpu)
@@ -1743,7 +1760,8 @@ int thumbExecute(ARM7TDMI &cpu)
     //if ((armNextPC & 0x0803FFFF) == 0x08020000)
     //    busPrefetchCount=0x100;
 
-    u32 opcode = cpu.prefetchThumbOpcode();
+    insnfunc_t func;
+    u32 opcode = cpu.prefetchThumbOpcode(func);
 
     busPrefetch = false;
     // TODO: check if used
@@ -1760,7 +1778,9 @@ int thumbExecute(ARM7TDMI &cpu)
     reg[15].I += 2;
     THUMB_PREFETCH_NEXT;
 
-    int clockTicks = (*thumbInsnTable[opcode>>6])(cpu, opcode, oldArmNextPC);
+    if (UNLIKELY(!func))
+      func = thumbInsnTable[opcode>>6];
+    int clockTicks = func(cpu, opcode, oldArmNextPC);
 
 		#ifdef BKPT_SUPPORT
     if (clockTicks < 0)
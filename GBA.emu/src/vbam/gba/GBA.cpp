@@ -738,21 +738,12 @@ static bool CPUWriteState(GBASys &gba, gzFile gzFile)
 
   // new to version 0.7.1
   utilWriteInt(gzFile, gba.stopState);
-  // new to version 0.8
-#ifdef VBAM_USE_IRQTICKS
-  utilWriteInt(gzFile, gCpu.IRQTicks);
-#else
-  int dummyIRQTicks = 0;
-  utilWriteInt(gzFile, dummyIRQTicks);
-#endif
 
   utilGzWrite(gzFile, gba.mem.internalRAM, 0x8000);
   utilGzWrite(gzFile, gba.lcd.paletteRAM, 0x400);
   utilGzWrite(gzFile, gba.mem.workRAM, 0x40000);
   utilGzWrite(gzFile, gba.lcd.vram, 0x20000);
   utilGzWrite(gzFile, gba.lcd.oam, 0x400);
-  u32 dummyPix[241*162] = {0};
-  utilGzWrite(gzFile, dummyPix, 4*241*162);
   utilGzWrite(gzFile, gba.mem.ioMem.b, 0x400);
 
   eepromSaveGame(gzFile);
@@ -849,7 +840,8 @@ static bool CPUReadState(GBASys &gba, gzFile gzFile)
   else
   	gba.stopState = utilReadInt(gzFile) ? true : false;
 
-  if(version < SAVE_GAME_VERSION_4)
+  // IRQ ticks were only stored from version 4 up to version 10
+  if(version < SAVE_GAME_VERSION_4 || version >= SAVE_GAME_VERSION_11)
   {
 #ifdef VBAM_USE_IRQTICKS
   	gCpu.IRQTicks = 0;
@@ -878,11 +870,11 @@ static bool CPUReadState(GBASys &gba, gzFile gzFile)
   utilGzRead(gzFile, gba.mem.workRAM, 0x40000);
   utilGzRead(gzFile, gba.lcd.vram, 0x20000);
   utilGzRead(gzFile, gba.lcd.oam, 0x400);
-  u32 dummyPix[241*162];
+  // skip the unused pixel buffer in older states
   if(version < SAVE_GAME_VERSION_6)
-    utilGzRead(gzFile, dummyPix, 4*240*160);
-  else
-    utilGzRead(gzFile, dummyPix, 4*241*162);
+    utilGzSeek(gzFile, 4*240*160, SEEK_CUR);
+  else if(version < SAVE_GAME_VERSION_11)
+    utilGzSeek(gzFile, 4*241*162, SEEK_CUR);
   utilGzRead(gzFile, gba.mem.ioMem.b, 0x400);
 
   if(skipSaveGameBattery) {
@@ -973,6 +965,7 @@ static bool CPUReadState(GBASys &gba, gzFile gzFile)
     gbaSaveType = 3;
 
   systemSaveUpdateCounter = SYSTEM_SAVE_NOT_UPDATED;
+  gba.insnCache.flush();
   if(gba.cpu.armState) {
   	gba.cpu.ARM_PREFETCH();
   } else {
@@ -984,6 +977,17 @@ static bool CPUReadState(GBASys &gba, gzFile gzFile)
   return true;
 }
 
+bool CPUWriteState(GBASys &gba, std::vector<uint8_t> &buff)
+{
+  gzFile gzFile = utilMemStreamOpen(buff);
+
+  bool res = CPUWriteState(gba, gzFile);
+
+  utilGzClose(gzFile);
+
+  return res;
+}
+
 bool CPUReadMemState(GBASys &gba, char *memory, int available)
 {
   gzFile gzFile = utilMemGzOpen(memory, available, "r");
@@ -995,6 +999,17 @@ bool CPUReadMemState(GBASys &gba, char *memory, int available)
   return res;
 }
 
+bool CPUReadState(GBASys &gba, const void *data, size_t size)
+{
+  gzFile gzFile = utilMemStreamOpen(data, size);
+
+  bool res = CPUReadState(gba, gzFile);
+
+  utilGzClose(gzFile);
+
+  return res;
+}
+
 bool CPUReadState(GBASys &gba, const char * file)
 {
   gzFile gzFile = utilGzOpen(file, "rb");
@@ -3189,6 +3204,7 @@ void CPUReset(GBASys &gba)
     break;
   }
 
+  gba.insnCache.flush();
   gba.cpu.ARM_PREFETCH();
 
   systemSaveUpdateCounter = SYSTEM_SAVE_NOT_UPDATED;
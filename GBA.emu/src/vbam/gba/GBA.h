@@ -5,11 +5,13 @@
 #include "../common/Port.h"
 #include "../NLS.h"
 #include "Flash.h"
+#include "InsnCache.h"
 #include <imagine/util/preprocessor/repeat.h>
 #include <imagine/util/builtins.h>
 #include <imagine/util/mayAliasInt.h>
 #include <imagine/logger/logger.h>
 #include <imagine/io/IO.hh>
+#include <vector>
 
 #define SAVE_GAME_VERSION_1 1
 #define SAVE_GAME_VERSION_2 2
@@ -21,7 +23,8 @@
 #define SAVE_GAME_VERSION_8 8
 #define SAVE_GAME_VERSION_9 9
 #define SAVE_GAME_VERSION_10 10
-#define SAVE_GAME_VERSION  SAVE_GAME_VERSION_10
+#define SAVE_GAME_VERSION_11 11 // drops unused pixel buffer and IRQ ticks, stores only active cheats
+#define SAVE_GAME_VERSION  SAVE_GAME_VERSION_11
 
 struct GBAMem
 {
@@ -474,6 +477,10 @@ struct ARM7TDMI
 #ifdef VBAM_USE_CPU_PREFETCH
 private:
 	u32 cpuPrefetch[2] {0};
+	// handlers of the prefetched opcodes from the instruction cache,
+	// null when the opcode must be decoded by the execute loop
+	ArmInsnFunc cpuPrefetchArmFunc[2] {};
+	ThumbInsnFunc cpuPrefetchThumbFunc[2] {};
 #endif
 public:
 	u32 busPrefetchCount = 0;
@@ -605,55 +612,73 @@ public:
 #endif
 	}
 
+	// defined after GBASys, fetch through the instruction cache
+	inline void prefetchArm(int slot, u32 pc) __attribute__((always_inline));
+	inline void prefetchThumb(int slot, u32 pc) __attribute__((always_inline));
+
 	void ARM_PREFETCH() __attribute__((always_inline))
   {
 #ifdef VBAM_USE_CPU_PREFETCH
-    cpuPrefetch[0] = CPUReadMemoryQuick(*this, armNextPC);
-    cpuPrefetch[1] = CPUReadMemoryQuick(*this, armNextPC+4);
+    prefetchArm(0, armNextPC);
+    prefetchArm(1, armNextPC+4);
 #endif
   }
 
 	void THUMB_PREFETCH() __attribute__((always_inline))
   {
 #ifdef VBAM_USE_CPU_PREFETCH
-    cpuPrefetch[0] = CPUReadHalfWordQuick(*this, armNextPC);
-    cpuPrefetch[1] = CPUReadHalfWordQuick(*this, armNextPC+2);
+    prefetchThumb(0, armNextPC);
+    prefetchThumb(1, armNextPC+2);
 #endif
   }
 
 	void ARM_PREFETCH_NEXT() __attribute__((always_inline))
 	{
 #ifdef VBAM_USE_CPU_PREFETCH
-		cpuPrefetch[1] = CPUReadMemoryQuick(*this, armNextPC+4);
+		prefetchArm(1, armNextPC+4);
 #endif
 	}
 
 	void THUMB_PREFETCH_NEXT() __attribute__((always_inline))
 	{
 #ifdef VBAM_USE_CPU_PREFETCH
-		cpuPrefetch[1] = CPUReadHalfWordQuick(*this, armNextPC+2);
+		prefetchThumb(1, armNextPC+2);
 #endif
 	}
 
-	int prefetchArmOpcode() __attribute__((always_inline))
+	void shiftPrefetch() __attribute__((always_inline))
 	{
 #ifdef VBAM_USE_CPU_PREFETCH
-		int opcode = cpuPrefetch[0];
 		cpuPrefetch[0] = cpuPrefetch[1];
+		cpuPrefetchArmFunc[0] = cpuPrefetchArmFunc[1];
+		cpuPrefetchThumbFunc[0] = cpuPrefetchThumbFunc[1];
+#endif
+	}
+
+	// func is set to the opcode's handler if known, otherwise null
+	int prefetchArmOpcode(ArmInsnFunc &func) __attribute__((always_inline))
+	{
+#ifdef VBAM_USE_CPU_PREFETCH
+		int opcode = cpuPrefetch[0];
+		func = cpuPrefetchArmFunc[0];
+		shiftPrefetch();
 		return opcode;
 #else
-		return CPUReadMemoryQuick(armNextPC);
+		func = nullptr;
+		return CPUReadMemoryQuick(*this, armNextPC);
 #endif
 	}
 
-	int prefetchThumbOpcode() __attribute__((always_inline))
+	int prefetchThumbOpcode(ThumbInsnFunc &func) __attribute__((always_inline))
 	{
 #ifdef VBAM_USE_CPU_PREFETCH
 		int opcode = cpuPrefetch[0];
-		cpuPrefetch[0] = cpuPrefetch[1];
+		func = cpuPrefetchThumbFunc[0];
+		shiftPrefetch();
 		return opcode;
 #else
-		return CPUReadHalfWordQuick(armNextPC);
+		func = nullptr;
+		return CPUReadHalfWordQuick(*this, armNextPC);
 #endif
 	}
 
@@ -968,10 +993,33 @@ struct GBASys
 	GBATimers timers;
 	GBADMA dma;
 	GBAMem mem;
+	GBAInsnCache insnCache;
 };
 
 extern GBASys gGba;
 
+#ifdef VBAM_USE_CPU_PREFETCH
+inline void ARM7TDMI::prefetchArm(int slot, u32 pc)
+{
+	const auto *e = &gba->insnCache.arm.entryFor(pc);
+	if(unlikely(e->tag != GBAInsnCache::ArmTable::tag(pc)))
+		e = &armInsnCacheFill(*this, pc);
+	cpuPrefetch[slot] = e->opcode;
+	cpuPrefetchArmFunc[slot] = e->func;
+	cpuPrefetchThumbFunc[slot] = nullptr;
+}
+
+inline void ARM7TDMI::prefetchThumb(int slot, u32 pc)
+{
+	const auto *e = &gba->insnCache.thumb.entryFor(pc);
+	if(unlikely(e->tag != GBAInsnCache::ThumbTable::tag(pc)))
+		e = &thumbInsnCacheFill(*this, pc);
+	cpuPrefetch[slot] = e->opcode;
+	cpuPrefetchThumbFunc[slot] = e->func;
+	cpuPrefetchArmFunc[slot] = nullptr;
+}
+#endif
+
 u32 biosRead8(ARM7TDMI &cpu, u32 address);
 u32 biosRead16(ARM7TDMI &cpu, u32 address);
 u32 biosRead32(ARM7TDMI &cpu, u32 address);
@@ -1027,6 +1075,8 @@ extern bool CPUReadMemState(GBASys &gba, char *, int);
 extern bool CPUReadState(GBASys &gba, const char *);
 extern bool CPUWriteMemState(GBASys &gba, char *, int);
 extern bool CPUWriteState(GBASys &gba, const char *);
+extern bool CPUReadState(GBASys &gba, const void *data, size_t size);
+extern bool CPUWriteState(GBASys &gba, std::vector<uint8_t> &buff);
 extern int CPULoadRom(GBASys &gba, const char *);
 extern int CPULoadRomWithIO(GBASys &gba, IO &);
 extern void doMirroring(GBASys &gba, bool);
@@ -596,6 +596,7 @@ static inline void CPUWriteMemory(ARM7TDMI &cpu, u32 address, u32 value)
 
   switch(address >> 24) {
   case 0x02:
+    cpu.gba->insnCache.writeWorkRAM(address);
 #ifdef BKPT_SUPPORT
     if(*((u32 *)&freezeWorkRAM[address & 0x3FFFC]))
       cheatsWriteMemory(address & 0x203FFFC,
@@ -605,6 +606,7 @@ static inline void CPUWriteMemory(ARM7TDMI &cpu, u32 address, u32 value)
       WRITE32LE(((u32 *)&cpu.gba->mem.workRAM[address & 0x3FFFC]), value);
     break;
   case 0x03:
+    cpu.gba->insnCache.writeInternalRAM(address);
 #ifdef BKPT_SUPPORT
     if(*((u32 *)&freezeInternalRAM[address & 0x7ffc]))
       cheatsWriteMemory(address & 0x3007FFC,
@@ -697,6 +699,7 @@ static inline void CPUWriteHalfWord(ARM7TDMI &cpu, u32 address, u16 value)
 
   switch(address >> 24) {
   case 2:
+    cpu.gba->insnCache.writeWorkRAM(address);
 #ifdef BKPT_SUPPORT
     if(*((u16 *)&freezeWorkRAM[address & 0x3FFFE]))
       cheatsWriteHalfWord(address & 0x203FFFE,
@@ -706,6 +709,7 @@ static inline void CPUWriteHalfWord(ARM7TDMI &cpu, u32 address, u16 value)
       WRITE16LE(((u16 *)&cpu.gba->mem.workRAM[address & 0x3FFFE]),value);
     break;
   case 3:
+    cpu.gba->insnCache.writeInternalRAM(address);
 #ifdef BKPT_SUPPORT
     if(*((u16 *)&freezeInternalRAM[address & 0x7ffe]))
       cheatsWriteHalfWord(address & 0x3007ffe,
@@ -799,6 +803,7 @@ static inline void CPUWriteByte(ARM7TDMI &cpu, u32 address, u8 b)
 	auto &oam = cpu.gba->lcd.oam;
   switch(address >> 24) {
   case 2:
+    cpu.gba->insnCache.writeWorkRAM(address);
 #ifdef BKPT_SUPPORT
     if(freezeWorkRAM[address & 0x3FFFF])
       cheatsWriteByte(address & 0x203FFFF, b);
@@ -807,6 +812,7 @@ static inline void CPUWriteByte(ARM7TDMI &cpu, u32 address, u8 b)
     	cpu.gba->mem.workRAM[address & 0x3FFFF] = b;
     break;
   case 3:
+    cpu.gba->insnCache.writeInternalRAM(address);
 #ifdef BKPT_SUPPORT
     if(freezeInternalRAM[address & 0x7fff])
       cheatsWriteByte(address & 0x3007fff, b);
@@ -0,0 +1,142 @@
+#ifndef INSNCACHE_H
+#define INSNCACHE_H
+
+#include "../common/Types.h"
+#include <imagine/util/utility.h>
+#include <cstring>
+
+struct ARM7TDMI;
+
+typedef void (*ArmInsnFunc)(ARM7TDMI &cpu, u32 opcode, int &clockTicks);
+typedef int (*ThumbInsnFunc)(ARM7TDMI &cpu, u32 opcode, u32 oldArmNextPC);
+
+// Decoded instruction caches for the ARM & Thumb interpreters. Instruction
+// fetches look up the PC here instead of going through the memory map and
+// the opcode decode tables, misses are filled by armInsnCacheFill() and
+// thumbInsnCacheFill(). Only code in the BIOS, work RAM, and ROM is cached,
+// RAM pages holding cached code are tracked so writes to them can drop
+// their entries.
+
+template <class Func, unsigned PC_SHIFT>
+struct InsnCacheTable
+{
+	struct Entry
+	{
+		u32 tag; // PC | 1 when valid, never 0 since fetches are aligned
+		u32 opcode;
+		Func func;
+	};
+
+	static constexpr u32 ENTRIES = 0x8000;
+	Entry entry[ENTRIES]{};
+
+	static u32 tag(u32 pc) { return pc | 1; }
+	Entry &entryFor(u32 pc) { return entry[(pc >> PC_SHIFT) & (ENTRIES - 1)]; }
+
+	void invalidate(u32 pc)
+	{
+		auto &e = entryFor(pc);
+		if(e.tag == tag(pc))
+			e.tag = 0;
+	}
+
+	void clear() { std::memset(entry, 0, sizeof(entry)); }
+};
+
+struct GBAInsnCache
+{
+	using ArmTable = InsnCacheTable<ArmInsnFunc, 2>;
+	using ThumbTable = InsnCacheTable<ThumbInsnFunc, 1>;
+	static constexpr u32 PAGE_SHIFT = 8;
+	static constexpr u32 WORK_RAM_PAGES = 0x40000 >> PAGE_SHIFT;
+	static constexpr u32 INTERNAL_RAM_PAGES = 0x8000 >> PAGE_SHIFT;
+
+	ArmTable arm;
+	ThumbTable thumb;
+	// returned by the fill functions for fetches that aren't cached
+	ArmTable::Entry armScratch{};
+	ThumbTable::Entry thumbScratch{};
+	// set for RAM pages with cached instructions, work RAM pages come first
+	u8 codePage[WORK_RAM_PAGES + INTERNAL_RAM_PAGES]{};
+	bool enabled = true;
+
+	// only aligned fetches from the unmirrored RAM ranges and the ROM
+	// regions backed by the ROM buffer are cached
+	static bool isCacheable(u32 pc, u32 align)
+	{
+		if(pc & (align - 1))
+			return false;
+		switch(pc >> 24)
+		{
+			case 0x00: return pc < 0x4000;
+			case 0x02: return pc < 0x02040000;
+			case 0x03: return pc < 0x03008000;
+			case 0x08 ... 0x0A:
+			case 0x0C: return true;
+		}
+		return false;
+	}
+
+	void markCode(u32 pc)
+	{
+		if((pc >> 24) == 0x02)
+			codePage[(pc & 0x3FFFF) >> PAGE_SHIFT] = 1;
+		else if((pc >> 24) == 0x03)
+			codePage[WORK_RAM_PAGES + ((pc & 0x7FFF) >> PAGE_SHIFT)] = 1;
+	}
+
+	void writeWorkRAM(u32 address)
+	{
+		u32 page = (address & 0x3FFFF) >> PAGE_SHIFT;
+		if(unlikely(codePage[page]))
+			invalidatePage(page, 0x02000000 | (page << PAGE_SHIFT));
+	}
+
+	void writeInternalRAM(u32 address)
+	{
+		u32 page = (address & 0x7FFF) >> PAGE_SHIFT;
+		if(unlikely(codePage[WORK_RAM_PAGES + page]))
+			invalidatePage(WORK_RAM_PAGES + page, 0x03000000 | (page << PAGE_SHIFT));
+	}
+
+	// ROM can only change from cheat patches, address is the ROM offset
+	void writeROM(u32 address)
+	{
+		address &= 0x1FFFFFC;
+		for(u32 mirror : {0x08000000u, 0x0A000000u, 0x0C000000u})
+		{
+			arm.invalidate(mirror | address);
+			thumb.invalidate(mirror | address);
+			thumb.invalidate(mirror | (address + 2));
+		}
+	}
+
+	void invalidatePage(u32 pageIdx, u32 base)
+	{
+		for(u32 pc = base; pc < base + (1 << PAGE_SHIFT); pc += 2)
+		{
+			if(!(pc & 2))
+				arm.invalidate(pc);
+			thumb.invalidate(pc);
+		}
+		codePage[pageIdx] = 0;
+	}
+
+	void flush()
+	{
+		arm.clear();
+		thumb.clear();
+		std::memset(codePage, 0, sizeof(codePage));
+	}
+
+	void setEnabled(bool on)
+	{
+		enabled = on;
+		flush();
+	}
+};
+
+const GBAInsnCache::ArmTable::Entry &armInsnCacheFill(ARM7TDMI &cpu, u32 pc);
+const GBAInsnCache::ThumbTable::Entry &thumbInsnCacheFill(ARM7TDMI &cpu, u32 pc);
+
+#endif
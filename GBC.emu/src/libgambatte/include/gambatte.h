@@ -23,6 +23,7 @@
 #include "inputgetter.h"
 #include "loadres.h"
 #include <cstddef>
+#include <iosfwd>
 #include <string>
 #include <imagine/util/DelegateFunc.hh>
 
@@ -154,6 +155,25 @@ public:
 	  */
 	bool loadState(std::string const &filepath);
 
+	/**
+	  * Saves emulator state to the given stream.
+	  *
+	  * @param  videoBuf 160x144 RGB32 (native endian) video frame buffer or 0. Used for
+	  *                  saving a thumbnail.
+	  * @param  pitch distance in number of pixels (not bytes) from the start of one line
+	  *               to the next in videoBuf.
+	  * @return success
+	  */
+	bool saveState(gambatte::uint_least32_t const *videoBuf, std::ptrdiff_t pitch,
+	               std::ostream &file);
+
+	/**
+	  * Loads emulator state from the given stream. Unlike the file path version,
+	  * save data isn't written out beforehand.
+	  * @return success
+	  */
+	bool loadState(std::istream &file);
+
 	/**
 	  * Selects which state slot to save state to or load state from.
 	  * There are 10 such slots, numbered from 0 to 9 (periodically extended for all n).
@@ -26,6 +26,9 @@
 #include <main/Cheats.hh>
 #include <main/Palette.hh>
 #include "internal.hh"
+#include <streambuf>
+#include <istream>
+#include <ostream>
 
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2011-2020\nRobert Broglia\nwww.explusalpha.com\n\n(c) 2011\nthe Gambatte Team\ngambatte.sourceforge.net";
 gambatte::GB gbEmu;
@@ -37,6 +40,7 @@ alignas(8) static uint_least32_t frameBuffer[gambatte::lcd_hres * gambatte::lcd_
 static const IG::Pixmap frameBufferPix{{{gambatte::lcd_hres, gambatte::lcd_vres}, IG::PIXEL_RGBA8888}, frameBuffer};
 static const GBPalette *gameBuiltinPalette{};
 bool EmuSystem::hasCheats = true;
+EmuSystem::StateFileFormat EmuSystem::stateFileFormat = StateFileFormat::RAW;
 EmuSystem::NameFilterFunc EmuSystem::defaultFsFilter =
 	[](const char *name)
 	{
@@ -145,6 +149,61 @@ EmuSystem::Error EmuSystem::loadState(const char *path)
 		return {};
 }
 
+// stream buffers for passing states to gambatte without touching the file system
+class VectorOutStreamBuf : public std::streambuf
+{
+public:
+	VectorOutStreamBuf(std::vector<uint8_t> &vec): vec{vec} {}
+
+protected:
+	std::vector<uint8_t> &vec;
+
+	int_type overflow(int_type c) final
+	{
+		if(!traits_type::eq_int_type(c, traits_type::eof()))
+			vec.push_back(c);
+		return traits_type::not_eof(c);
+	}
+
+	std::streamsize xsputn(const char_type *s, std::streamsize n) final
+	{
+		vec.insert(vec.end(), s, s + n);
+		return n;
+	}
+};
+
+class ConstBufferInStreamBuf : public std::streambuf
+{
+public:
+	ConstBufferInStreamBuf(const char *data, size_t size)
+	{
+		// get area is only read from
+		auto start = const_cast<char*>(data);
+		setg(start, start, start + size);
+	}
+};
+
+EmuSystem::Error EmuSystem::saveStateToBuffer(std::vector<uint8_t> &buff)
+{
+	buff.clear();
+	VectorOutStreamBuf streamBuf{buff};
+	std::ostream stream{&streamBuf};
+	if(!gbEmu.saveState(nullptr, 0, stream))
+		return makeError("Error writing state to memory");
+	else
+		return {};
+}
+
+EmuSystem::Error EmuSystem::loadStateFromBuffer(IG::ConstBufferView buff)
+{
+	ConstBufferInStreamBuf streamBuf{buff.data(), buff.size()};
+	std::istream stream{&streamBuf};
+	if(!gbEmu.loadState(stream))
+		return makeError("Error reading state from memory");
+	else
+		return {};
+}
+
 void EmuSystem::saveBackupMem()
 {
 	logMsg("saving battery");
@@ -267,16 +326,7 @@ void EmuSystem::runFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
 				{
 					// convert RGBA8888 to RGB565, for older GPUs with slow texture uploads
 					auto img = video->startFrame(task);
-					img.pixmap().writeTransformed(
-						[](uint32_t p)
-						{
-							unsigned r = p       & 0xFF;
-							unsigned g = p >>  8 & 0xFF;
-							unsigned b = p >> 16 & 0xFF;
-							return ((r * (31 * 2) + 255) / (255 * 2)) << 11 |
-									((g * 63 + 127) / 255) << 5 |
-									((b * 31 + 127) / 255);
-						}, frameBufferPix);
+					img.pixmap().writeRGBA8888AsRGB565(frameBufferPix);
 					img.endFrame();
 				}
 			});
@@ -96,7 +96,7 @@ static uint oldStateSizeAfterVDP(int exVersion, bool is64Bit)
   return size;
 }
 
-EmuSystem::Error state_load(const unsigned char *buffer)
+EmuSystem::Error state_load(const unsigned char *buffer, uint size)
 {
 	auto state = std::make_unique<unsigned char[]>(STATE_SIZE);
 
@@ -104,8 +104,16 @@ EmuSystem::Error state_load(const unsigned char *buffer)
   uint bufferptr = 0;
 
   /* uncompress savestate */
+  if (size < 4)
+  {
+    return EmuSystem::makeError("Invalid state data");
+  }
   uint32 inbytes32;
   memcpy(&inbytes32, buffer, 4);
+  if (inbytes32 > size - 4)
+  {
+    return EmuSystem::makeError("Invalid state data");
+  }
   unsigned long inbytes = inbytes32;
   unsigned long outbytes = STATE_SIZE;
   logMsg("uncompressing %d bytes to buffer of %d size", (int)inbytes, (int)outbytes);
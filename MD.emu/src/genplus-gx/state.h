@@ -43,7 +43,7 @@
   bufferptr+= size;
 
 /* Function prototypes */
-EmuSystem::Error state_load(const unsigned char *buffer);
+EmuSystem::Error state_load(const unsigned char *buffer, uint size);
 int state_save(unsigned char *buffer);
 
 #endif
@@ -38,6 +38,7 @@
 
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2011-2020\nRobert Broglia\nwww.explusalpha.com\n\nPortions (c) the\nGenesis Plus Team\ncgfm2.emuviews.com";
 bool EmuSystem::hasCheats = true;
+EmuSystem::StateFileFormat EmuSystem::stateFileFormat = StateFileFormat::RAW;
 bool EmuSystem::hasPALVideoSystem = true;
 t_config config{};
 bool config_ym2413_enabled = true;
@@ -123,53 +124,17 @@ static FS::PathString sprintBRAMSaveFilename()
 
 static const uint maxSaveStateSize = STATE_SIZE+4;
 
-static EmuSystem::Error saveMDState(const char *path)
+EmuSystem::Error EmuSystem::saveStateToBuffer(std::vector<uint8_t> &buff)
 {
-	auto stateData = std::make_unique<uint8_t[]>(maxSaveStateSize);
-	if(!stateData)
-		return EmuSystem::makeError("Out of memory");
-	logMsg("saving state data");
-	int size = state_save(stateData.get());
-	logMsg("writing to file");
-	std::error_code ec;
-	if(FileUtils::writeToPath(path, stateData.get(), size, &ec) == -1)
-	{
-		return EmuSystem::makeError(std::error_code{ec});
-	}
-	logMsg("wrote %d byte state", size);
+	buff.resize(maxSaveStateSize);
+	int size = state_save(buff.data());
+	buff.resize(size);
 	return {};
 }
 
-static EmuSystem::Error loadMDState(const char *path)
-{
-	FileIO f;
-	if(auto ec = f.open(path, IO::AccessHint::ALL);
-		ec)
-	{
-		EmuSystem::makeError(std::error_code{ec});
-	}
-	auto stateData = (const uint8_t *)f.mmapConst();
-	if(!stateData)
-	{
-		return EmuSystem::makeFileReadError();
-	}
-	if(auto err = state_load(stateData);
-		err)
-	{
-		return err;
-	}
-	//sound_restore();
-	return {};
-}
-
-EmuSystem::Error EmuSystem::saveState(const char *path)
-{
-	return saveMDState(path);
-}
-
-EmuSystem::Error EmuSystem::loadState(const char *path)
+EmuSystem::Error EmuSystem::loadStateFromBuffer(IG::ConstBufferView buff)
 {
-	return loadMDState(path);
+	return state_load((const uint8_t *)buff.data(), buff.size());
 }
 
 void EmuSystem::saveBackupMem() // for manually saving when not closing game
@@ -475,20 +475,13 @@ FS::PathString EmuSystem::sprintStateFilename(int slot, const char *statePath, c
 	return FS::makePathStringPrintf("%s/%s.0%c.sta", statePath, gameName, saveSlotCharUpper(slot));
 }
 
-static EmuSystem::Error saveBlueMSXState(const char *filename)
+static EmuSystem::Error writeBlueMSXState(const char *filename)
 {
-	CallResult res = zipStartWrite(filename);
-	if(res != OK)
-	{
-		logErr("error creating zip:%s", filename);
-		return EmuSystem::makeFileWriteError();
-	}
 	saveStateCreateForWrite(filename);
 	int rv = zipSaveFile(filename, "version", 0, saveStateVersion, sizeof(saveStateVersion));
 	if (!rv)
 	{
 		saveStateDestroy();
-		zipEndWrite();
 		logErr("error writing to zip:%s", filename);
 		return EmuSystem::makeFileWriteError();
 	}
@@ -519,15 +512,35 @@ static EmuSystem::Error saveBlueMSXState(const char *filename)
 	machineSaveState(machine);
 	boardInfo.saveState();
 	saveStateDestroy();
-	zipEndWrite();
 	return {};
 }
 
+static EmuSystem::Error saveBlueMSXState(const char *filename)
+{
+	CallResult res = zipStartWrite(filename);
+	if(res != OK)
+	{
+		logErr("error creating zip:%s", filename);
+		return EmuSystem::makeFileWriteError();
+	}
+	auto err = writeBlueMSXState(filename);
+	zipEndWrite();
+	return err;
+}
+
 EmuSystem::Error EmuSystem::saveState(const char *path)
 {
 	return saveBlueMSXState(path);
 }
 
+EmuSystem::Error EmuSystem::saveStateToBuffer(std::vector<uint8_t> &buff)
+{
+	zipStartMemoryWrite(buff);
+	auto err = writeBlueMSXState(zipMemoryArchiveName);
+	zipEndMemoryAccess();
+	return err;
+}
+
 static FS::FileString saveStateGetFileString(SaveState* state, const char* tagName)
 {
 	FS::FileString name{};
@@ -606,6 +619,14 @@ EmuSystem::Error EmuSystem::loadState(const char *path)
 	return loadBlueMSXState(path);
 }
 
+EmuSystem::Error EmuSystem::loadStateFromBuffer(IG::ConstBufferView buff)
+{
+	zipStartMemoryRead(buff.data(), buff.size());
+	auto err = loadBlueMSXState(zipMemoryArchiveName);
+	zipEndMemoryAccess();
+	return err;
+}
+
 void EmuSystem::saveBackupMem()
 {
 	if(gameIsRunning())
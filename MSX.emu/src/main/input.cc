@@ -200,6 +200,12 @@ uint EmuSystem::translateInputAction(uint input, bool &turbo)
 	return 0;
 }
 
+bool EmuSystem::inputActionNeedsMainThread(uint emuKey)
+{
+	// toggles the virtual keyboard
+	return (emuKey & 0xFF) == EC_KEYCOUNT;
+}
+
 void EmuSystem::handleInputAction(uint state, uint emuKey)
 {
 	uint event1 = emuKey & 0xFF;
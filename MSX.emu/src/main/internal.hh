@@ -44,6 +44,11 @@ bool insertROM(const char *name, uint slot = 0);
 bool insertDisk(const char *name, uint slot = 0);
 CallResult zipStartWrite(const char *fileName);
 CallResult zipEndWrite();
+// state archive kept in memory, used by the zip functions when passed zipMemoryArchiveName
+extern const char *zipMemoryArchiveName;
+void zipStartMemoryWrite(std::vector<uint8_t> &buff);
+void zipStartMemoryRead(const void *data, size_t size);
+void zipEndMemoryAccess();
 const char *machineBasePathStr();
 void setupVKeyboardMap(uint boardType);
 IG::Pixmap frameBufferPixmap();
@@ -29,7 +29,7 @@ const AspectRatioInfo EmuSystem::aspectRatioInfo[] =
 		EMU_SYSTEM_DEFAULT_ASPECT_RATIO_INFO_INIT
 };
 const uint EmuSystem::aspectRatioInfos = std::size(EmuSystem::aspectRatioInfo);
-int EmuSystem::forcedSoundRate = 44100;
+int EmuSystem::nativeSoundRate = 44100;
 #define optionMachineNameDefault "MSX2"
 static char optionDefaultMachineNameStr[128] = optionMachineNameDefault;
 static char optionSessionMachineNameStr[128]{};
@@ -22,8 +22,72 @@
 #include <imagine/util/ScopeGuard.hh>
 #include "ziphelper.h"
 #include <cstdlib>
+#include <cstring>
+#include <vector>
 
 static struct archive *writeArch{};
+// memory archive entries are stored as: name length, name, data size, data
+static std::vector<uint8_t> *writeMem{};
+static const uint8_t *readMemData{};
+static size_t readMemSize{};
+const char *zipMemoryArchiveName = ":memory:";
+
+static void *memoryArchiveLoadFile(const char* fileName, int* size)
+{
+	auto pos = readMemData;
+	auto end = pos + readMemSize;
+	auto nameLen = strlen(fileName);
+	while(pos + sizeof(uint32_t) <= end)
+	{
+		uint32_t entryNameLen;
+		memcpy(&entryNameLen, pos, sizeof(uint32_t));
+		auto entryName = pos + sizeof(uint32_t);
+		auto dataSizePtr = entryName + entryNameLen;
+		if(dataSizePtr + sizeof(uint32_t) > end)
+			break;
+		uint32_t dataSize;
+		memcpy(&dataSize, dataSizePtr, sizeof(uint32_t));
+		auto data = dataSizePtr + sizeof(uint32_t);
+		if(data + dataSize > end)
+			break;
+		if(entryNameLen == nameLen && !memcmp(entryName, fileName, nameLen))
+		{
+			void *buff = malloc(dataSize);
+			memcpy(buff, data, dataSize);
+			*size = dataSize;
+			return buff;
+		}
+		pos = data + dataSize;
+	}
+	logErr("file %s not in memory archive", fileName);
+	return nullptr;
+}
+
+static void memoryArchiveAppend(const void *data, uint32_t size)
+{
+	auto bytePtr = (const uint8_t*)data;
+	writeMem->insert(writeMem->end(), bytePtr, bytePtr + size);
+}
+
+void zipStartMemoryWrite(std::vector<uint8_t> &buff)
+{
+	assert(!writeArch);
+	buff.clear();
+	writeMem = &buff;
+}
+
+void zipStartMemoryRead(const void *data, size_t size)
+{
+	readMemData = (const uint8_t*)data;
+	readMemSize = size;
+}
+
+void zipEndMemoryAccess()
+{
+	writeMem = {};
+	readMemData = {};
+	readMemSize = 0;
+}
 
 void zipCacheReadOnlyZip(const char* zipName)
 {
@@ -32,6 +96,10 @@ void zipCacheReadOnlyZip(const char* zipName)
 
 void* zipLoadFile(const char* zipName, const char* fileName, int* size)
 {
+	if(readMemData && string_equal(zipName, zipMemoryArchiveName))
+	{
+		return memoryArchiveLoadFile(fileName, size);
+	}
 	ArchiveIO io{};
 	std::error_code ec{};
 	for(auto &entry : FS::ArchiveIterator{zipName, ec})
@@ -80,6 +148,16 @@ CallResult zipStartWrite(const char *fileName)
 
 int zipSaveFile(const char* zipName, const char* fileName, int append, const void* buffer, int size)
 {
+	if(writeMem)
+	{
+		uint32_t nameLen = strlen(fileName);
+		uint32_t dataSize = size;
+		memoryArchiveAppend(&nameLen, sizeof(nameLen));
+		memoryArchiveAppend(fileName, nameLen);
+		memoryArchiveAppend(&dataSize, sizeof(dataSize));
+		memoryArchiveAppend(buffer, dataSize);
+		return 1;
+	}
 	assert(writeArch);
 	auto entry = archive_entry_new();
 	auto freeEntry = IG::scopeGuard([&](){ archive_entry_free(entry); });
@@ -457,6 +457,9 @@ static void make_stateName(const char *game,int slot,char *st_name_out)
 	sprintf(st_name_out,"%s%s.%03d",getGngeoDir(),game,slot);
 }
 
+static const char *stateSig = "GNGST3";
+#define STATE_HEADER_SIZE (6 + sizeof(int))
+
 static gzFile open_state(/*char *game,int slot,*/const char *st_name,int mode) {
 	/*char *st_name;
 //    char *st_name_len;
@@ -479,8 +482,6 @@ static gzFile open_state(/*char *game,int slot,*/const char *st_name,int mode) {
 		return NULL;
     }
 
-	static const char *stateSig = "GNGST3";
-
 	if(mode==STREAD) {
 
 		memset(string, 0, 20);
@@ -514,7 +515,30 @@ static gzFile open_state(/*char *game,int slot,*/const char *st_name,int mode) {
 	return open_stateWithName(st_name, mode);
 }*/
 
+/* When set, state data is read from/written to memory instead of a gzFile */
+static struct {
+	Uint8 *data;
+	Uint32 size;
+	Uint32 pos;
+	bool active;
+} memState;
+
+static int mkstate_mem_data(void *data,int size,int mode) {
+	if (mode==STREAD) {
+		if (memState.pos + size > memState.size)
+			return -1;
+		memcpy(data, memState.data + memState.pos, size);
+	} else if (memState.pos + size <= memState.size) {
+		memcpy(memState.data + memState.pos, data, size);
+	}
+	/* keep counting past the end when writing so the caller learns the needed size */
+	memState.pos += size;
+	return size;
+}
+
 int mkstate_data(gzFile gzf,void *data,int size,int mode) {
+	if (memState.active)
+		return mkstate_mem_data(data,size,mode);
 	if (mode==STREAD)
 		return gzread(gzf,data,size);
 	return gzwrite(gzf,data,size);
@@ -582,28 +606,24 @@ int save_state(const char *game,int slot) {
 	return save_stateWithName(st_name);
 }
 
-int load_stateWithName(const char *name) {
-	gzFile gzf;
-	/* Save pointers */
-	Uint8 *ng_lo = memory.ng_lo;
-	Uint8 *fix_game_usage=memory.fix_game_usage;
-	Uint8 *bksw_unscramble = memory.bksw_unscramble;
-	int *bksw_offset=memory.bksw_offset;
-//	GAME_ROMS r;
-//	memcpy(&r,&memory.rom,sizeof(GAME_ROMS));
-	
-	if ((gzf = open_state(name, STREAD))==NULL)
-		return false;
-
-	//gzread(gzf,state_img_tmp->pixels,304*224*2);
+typedef struct {
+	Uint8 *ng_lo;
+	Uint8 *fix_game_usage;
+	Uint8 *bksw_unscramble;
+	int *bksw_offset;
+} MemoryPointers;
 
-	neogeo_mkstate(gzf,STREAD);
+static MemoryPointers save_memory_pointers(void) {
+	MemoryPointers p = {memory.ng_lo, memory.fix_game_usage, memory.bksw_unscramble, memory.bksw_offset};
+	return p;
+}
 
+static void restore_after_load(MemoryPointers p) {
 	/* Restore them */
-	memory.ng_lo=ng_lo;
-	memory.fix_game_usage=fix_game_usage;
-	memory.bksw_unscramble=bksw_unscramble;
-	memory.bksw_offset=bksw_offset;
+	memory.ng_lo=p.ng_lo;
+	memory.fix_game_usage=p.fix_game_usage;
+	memory.bksw_unscramble=p.bksw_unscramble;
+	memory.bksw_offset=p.bksw_offset;
 //	memcpy(&memory.rom,&r,sizeof(GAME_ROMS));
 
 	cpu_68k_bankswitch(bankaddress);
@@ -628,11 +648,80 @@ int load_stateWithName(const char *name) {
 		current_fix = memory.rom.bios_sfix.p;
 		fix_usage = memory.fix_board_usage;
 	}
+}
+
+int load_stateWithName(const char *name) {
+	gzFile gzf;
+	/* Save pointers */
+	MemoryPointers p = save_memory_pointers();
+//	GAME_ROMS r;
+//	memcpy(&r,&memory.rom,sizeof(GAME_ROMS));
+	
+	if ((gzf = open_state(name, STREAD))==NULL)
+		return false;
+
+	//gzread(gzf,state_img_tmp->pixels,304*224*2);
+
+	neogeo_mkstate(gzf,STREAD);
+
+	restore_after_load(p);
 
 	gzclose(gzf);
 	return true;
 }
 
+Uint32 save_stateToBuffer(Uint8 *buff, Uint32 size) {
+	int flags=m68k_flag | z80_flag | endian_flag;
+	memState.data = buff;
+	memState.size = size;
+	memState.pos = 0;
+	memState.active = true;
+	mkstate_data(NULL, (void*)stateSig, 6, STWRITE);
+	mkstate_data(NULL, &flags, sizeof(int), STWRITE);
+	neogeo_mkstate(NULL,STWRITE);
+	memState.active = false;
+	return memState.pos;
+}
+
+/* The layout only holds fixed size blocks, so measure it once with a counting pass */
+static Uint32 state_buffer_size(void) {
+	static Uint32 size;
+	if (!size)
+		size = save_stateToBuffer(NULL, 0);
+	return size;
+}
+
+int load_stateFromBuffer(const Uint8 *buff, Uint32 size) {
+	char string[7] = {0};
+	int flags;
+	MemoryPointers p;
+
+	if (size != state_buffer_size()) {
+		logMsg("state size doesn't match current game");
+		return false;
+	}
+	memcpy(string, buff, 6);
+	if (strcmp(string, stateSig)) {
+		logMsg("not a valid gngeo state");
+		return false;
+	}
+	memcpy(&flags, buff + 6, sizeof(int));
+	if (flags != (m68k_flag | z80_flag | endian_flag)) {
+		logMsg("state comes from a different endian architecture");
+		return false;
+	}
+
+	p = save_memory_pointers();
+	memState.data = (Uint8*)buff;
+	memState.size = size;
+	memState.pos = STATE_HEADER_SIZE;
+	memState.active = true;
+	neogeo_mkstate(NULL,STREAD);
+	memState.active = false;
+	restore_after_load(p);
+	return true;
+}
+
 int load_state(const char *game,int slot) {
 	char *st_name=(char*)alloca(strlen(getGngeoDir())+strlen(game)+5);
 	make_stateName(game,slot,st_name);
@@ -94,6 +94,9 @@ int load_state(const char *game,int slot);
 int save_state(const char *game,int slot);
 int save_stateWithName(const char *name);
 int load_stateWithName(const char *name);
+/* Writes an uncompressed state to buff if it fits in size, returns the full size of the state */
+Uint32 save_stateToBuffer(Uint8 *buff, Uint32 size);
+int load_stateFromBuffer(const Uint8 *buff, Uint32 size);
 Uint32 how_many_slot(char *game);
 int mkstate_data(gzFile gzf,void *data,int size,int mode);
 
@@ -83,6 +83,7 @@ extern "C"
 
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2012-2020\nRobert Broglia\nwww.explusalpha.com\n\n(c) 2011 the\nGngeo Team\ncode.google.com/p/gngeo";
 bool EmuSystem::handlesGenericIO = false; // TODO: need to re-factor GnGeo file loading code
+EmuSystem::StateFileFormat EmuSystem::stateFileFormat = StateFileFormat::GZIP;
 static constexpr auto pixFmt = IG::PIXEL_FMT_RGB565;
 static uint16_t screenBuff[352*256] __attribute__ ((aligned (8))){};
 static GN_Surface sdlSurf;
@@ -146,6 +147,27 @@ EmuSystem::Error EmuSystem::loadState(const char *path)
 		return {};
 }
 
+EmuSystem::Error EmuSystem::saveStateToBuffer(std::vector<uint8_t> &buff)
+{
+	buff.resize(buff.capacity());
+	auto size = save_stateToBuffer(buff.data(), buff.size());
+	if(size > buff.size())
+	{
+		buff.resize(size);
+		save_stateToBuffer(buff.data(), buff.size());
+	}
+	buff.resize(size);
+	return {};
+}
+
+EmuSystem::Error EmuSystem::loadStateFromBuffer(IG::ConstBufferView buff)
+{
+	if(!load_stateFromBuffer((const Uint8*)buff.data(), buff.size()))
+		return EmuSystem::makeError("Invalid state data");
+	else
+		return {};
+}
+
 void EmuSystem::saveBackupMem()
 {
 	if(gameIsRunning())
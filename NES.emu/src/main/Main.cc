@@ -30,6 +30,7 @@
 #include <fceu/video.h>
 #include <fceu/sound.h>
 #include <fceu/palette.h>
+#include <zlib.h>
 
 using PalArray = std::array<pal, 512>;
 void ApplyDeemphasisComplete(pal* pal512);
@@ -37,6 +38,7 @@ void FCEU_setDefaultPalettePtr(pal *ptr);
 
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2011-2020\nRobert Broglia\nwww.explusalpha.com\n\nPortions (c) the\nFCEUX Team\nfceux.com";
 bool EmuSystem::hasCheats = true;
+EmuSystem::StateFileFormat EmuSystem::stateFileFormat = StateFileFormat::CORE_COMPRESSED;
 bool EmuSystem::hasPALVideoSystem = true;
 bool EmuSystem::hasResetModes = true;
 uint fceuCheats = 0;
@@ -147,6 +149,45 @@ EmuSystem::Error EmuSystem::loadState(const char *path)
 		return {};
 }
 
+EmuSystem::Error EmuSystem::saveStateToBuffer(std::vector<uint8_t> &buff)
+{
+	buff.clear();
+	EMUFILE_MEMORY memFile{&buff};
+	if(!FCEUSS_SaveMS(&memFile, Z_NO_COMPRESSION))
+		return EmuSystem::makeError("Error writing state to memory");
+	buff.resize(memFile.size());
+	return {};
+}
+
+EmuSystem::Error EmuSystem::compressStateFileData(std::vector<uint8_t> &buff)
+{
+	// memory states are stored uncompressed for rewind & run-ahead, compress the
+	// payload after the FCSX header like FCEUSS_SaveMS() does for state files
+	constexpr size_t headerSize = 16;
+	if(!compressSavestates || buff.size() < headerSize)
+		return {};
+	auto payloadSize = buff.size() - headerSize;
+	uLongf comprLen = compressBound(payloadSize);
+	std::vector<uint8_t> compressed(headerSize + comprLen);
+	if(compress2(&compressed[headerSize], &comprLen, &buff[headerSize], payloadSize, Z_DEFAULT_COMPRESSION) != Z_OK)
+		return EmuSystem::makeError("Error compressing state");
+	memcpy(compressed.data(), buff.data(), 12);
+	FCEU_en32lsb(&compressed[12], comprLen);
+	compressed.resize(headerSize + comprLen);
+	buff = std::move(compressed);
+	return {};
+}
+
+EmuSystem::Error EmuSystem::loadStateFromBuffer(IG::ConstBufferView buff)
+{
+	BufferMapIO io{};
+	io.open(buff.data(), buff.size());
+	EmuFileIO memFile{io};
+	if(!FCEUSS_LoadFP(&memFile, SSLOADPARAM_NOBACKUP))
+		return EmuSystem::makeError("Error reading state from memory");
+	return {};
+}
+
 void EmuSystem::saveBackupMem() // for manually saving when not closing game
 {
 	if(gameIsRunning())
@@ -418,7 +459,7 @@ void FCEUPPU_FrameReady(EmuSystemTask *task, EmuVideo *video, uint8 *buf)
 	auto pix = img.pixmap();
 	IG::Pixmap ppuPix{{{256, 256}, IG::PIXEL_FMT_I8}, buf};
 	auto ppuPixRegion = ppuPix.subPixmap({0, 8}, {256, 224});
-	pix.writeTransformed([](uint8 p){ return nativeCol[p]; }, ppuPixRegion);
+	pix.writeLookup(nativeCol, ppuPixRegion);
 	img.endFrame();
 }
 
@@ -303,6 +303,7 @@ static void read_REGS(const uint8 *p)
 		gpr[i] = read4(p), p+=4;
 	f_dash = read1(p), p+=1;
 	eepromStatusEnable = read1(p), p+=1;
+	memory_map_update();
 	Z80_regs.AF.W = read2(p), p+=2;
 	Z80_regs.BC.W = read2(p), p+=2;
 	Z80_regs.DE.W = read2(p), p+=2;
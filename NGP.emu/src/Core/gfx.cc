@@ -46,6 +46,7 @@
 //=============================================================================
 
 uint16 cfb[256*256] __attribute__ ((aligned (8))) {0};
+uint16* cfb_dest = cfb;
 uint8 zbuffer[256];
 
 uint16* cfb_scanline;	//set = scanline * SCREEN_WIDTH
@@ -56,7 +56,7 @@
 //---------------------------
 
 extern uint8 zbuffer[256];	//Line z-buffer
-extern uint16* cfb_scanline;	//set = cfb + (scanline * SCREEN_WIDTH)
+extern uint16* cfb_scanline;	//set = cfb_dest + (scanline * SCREEN_WIDTH)
 
 extern uint8 scanline;		//Current scanline
 
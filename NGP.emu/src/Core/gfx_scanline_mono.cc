@@ -208,7 +208,7 @@ void gfx_draw_scanline_mono(void)
 
 	//Get the current scanline
 	scanline = ram[0x8009];
-	cfb_scanline = cfb + (scanline * SCREEN_WIDTH);	//Calculate fast offset
+	cfb_scanline = cfb_dest + (scanline * SCREEN_WIDTH);	//Calculate fast offset
 
 	memset(cfb_scanline, 0, SCREEN_WIDTH * sizeof(uint16));
 	memset(zbuffer, 0, SCREEN_WIDTH);
@@ -90,6 +90,7 @@ should stop "Gals Fighters" from writing all over itself.
 #include <assert.h>
 #include <imagine/logger/logger.h>
 #include <imagine/util/bits.h>
+#include <imagine/util/utility.h>
 
 //=============================================================================
 
@@ -130,6 +131,86 @@ static void memory_error(uint32 address, bool read)
 
 static uint32 memNullVal = 0;
 
+// Direct host pointers for 4KB pages of the 24-bit address space, indexed by
+// address >> MEM_PAGE_SHIFT. Pages without a pointer go through the
+// translate_address_* functions below, covering I/O registers, RAS.H, EEPROM
+// status & flash commands, partial ROM pages and invalid accesses. Each
+// pointer matches what the translate functions return for the start of the
+// page so multi-byte accesses behave the same on either path.
+#define MEM_PAGE_SHIFT	12
+#define MEM_PAGE_SIZE	(1 << MEM_PAGE_SHIFT)
+#define MEM_PAGES		(0x1000000 >> MEM_PAGE_SHIFT)
+
+static uint8* readPage[MEM_PAGES];
+static uint8* writePage[MEM_PAGES];
+
+static uint8* direct_read_page(uint32 address)
+{
+	uint32 last = address + MEM_PAGE_SIZE - 1;
+
+	if (last <= RAM_END)
+	{
+		//RAS.H is computed on read
+		if ((address >> MEM_PAGE_SHIFT) == (0x8008 >> MEM_PAGE_SHIFT))
+			return NULL;
+		return ram + address;
+	}
+
+	//Any read past RAM clears a pending EEPROM status read
+	if (eepromStatusEnable)
+		return NULL;
+
+	if (rom.data)
+	{
+		//ROM (LOW)
+		if (address >= ROM_START && last <= rom.realEnd)
+			return rom.data + (address & 0x1FFFFF);
+
+		//ROM (HIGH)
+		if (address > rom.realEnd && address >= HIROM_START && last <= rom.realHEnd)
+			return rom.data + 0x200000 + (address - HIROM_START);
+	}
+
+	//BIOS, the ROM always ends below it
+	if (address >= BIOS_START)
+		return bios + (address & 0xFFFF);
+
+	return NULL;
+}
+
+void memory_map_update(void)
+{
+	for (uint32 i = 0; i < MEM_PAGES; i++)
+	{
+		uint32 address = i << MEM_PAGE_SHIFT;
+		readPage[i] = direct_read_page(address);
+		//Page 0 holds the registers checked in post_write()
+		writePage[i] = (i && address + MEM_PAGE_SIZE - 1 <= RAM_END) ? ram + address : NULL;
+	}
+}
+
+static void memory_map_update_read_range(uint32 start, uint32 end)
+{
+	for (uint32 i = start >> MEM_PAGE_SHIFT; i <= (end >> MEM_PAGE_SHIFT); i++)
+		readPage[i] = direct_read_page(i << MEM_PAGE_SHIFT);
+}
+
+static void set_eeprom_status_enable(bool on)
+{
+	if (eepromStatusEnable == on)
+		return;
+	eepromStatusEnable = on;
+	//Only the ROM and BIOS pages past RAM have direct pointers to toggle,
+	//games poll the status while saving so skip rebuilding the whole table
+	if (rom.data)
+	{
+		memory_map_update_read_range(ROM_START, rom.realEnd);
+		if (rom.realHEnd >= HIROM_START)
+			memory_map_update_read_range(HIROM_START, rom.realHEnd);
+	}
+	memory_map_update_read_range(BIOS_START, 0xFFFFFF);
+}
+
 void* translate_address_read(uint32 address)
 {
 	address &= 0xFFFFFF;
@@ -159,7 +240,7 @@ void* translate_address_read(uint32 address)
 	//Get EEPROM status?
 	if (eepromStatusEnable)
 	{
-		eepromStatusEnable = FALSE;
+		set_eeprom_status_enable(FALSE);
 		if (address == 0x220000 || address == 0x230000)
 		{
 			eepromStatus = 0xFFFFFFFF;
@@ -281,7 +362,7 @@ void* translate_address_write(uint32 address)
 			if (address == 0x220000 || address == 0x230000)
 			{
 	//			system_debug_message("%06X: EEPROM status read from %06X", pc, address);
-				eepromStatusEnable = TRUE;
+				set_eeprom_status_enable(TRUE);
 				return &memNullVal;
 			}
 
@@ -351,25 +432,21 @@ void post_write(uint32 address)
 
 static const bool ALIGN_ACCESS = 0;
 
+static inline void* read_ptr(uint32 address)
+{
+	if (uint8* page = readPage[(address & 0xFFFFFF) >> MEM_PAGE_SHIFT]; likely(page))
+		return page + (address & (MEM_PAGE_SIZE - 1));
+	return translate_address_read(address);
+}
+
 uint8 loadB(uint32 address)
 {
-	uint8* ptr = (uint8*)translate_address_read(address);
-	/*if (ptr == NULL)
-		return 0;
-	else*/
-		return *ptr;
+	return *(uint8*)read_ptr(address);
 }
 
 uint16 loadW(uint32 address)
 {
-	uint16* ptr = (uint16*)translate_address_read(address);
-	if((uintptr_t)ptr % 2 != 0)
-	{
-		//bug_exit("address %X", address);
-	}
-	/*if (ptr == NULL)
-		return 0;
-	else*/
+	uint16* ptr = (uint16*)read_ptr(address);
 	if(ALIGN_ACCESS && ((uintptr_t)ptr & IG::bit(0)))
 	{
 		uint16 v;
@@ -382,15 +459,7 @@ uint16 loadW(uint32 address)
 
 uint32 loadL(uint32 address)
 {
-	uint32* ptr = (uint32*)translate_address_read(address);
-	if((uintptr_t)ptr % 4 != 0)
-	{
-		//bug_exit("address %X", address);
-	}
-	/*if (ptr == NULL)
-		return 0;
-	else*/
-
+	uint32* ptr = (uint32*)read_ptr(address);
 	if(ALIGN_ACCESS && ((uintptr_t)ptr & (IG::bit(0) | IG::bit(1))))
 	{
 		uint32 v;
@@ -403,56 +472,46 @@ uint32 loadL(uint32 address)
 
 //=============================================================================
 
-void storeB(uint32 address, uint8 data)
+// Pages in the write table never contain registers handled by post_write()
+static inline uint8* write_ptr(uint32 address, bool &slowPath)
 {
-	uint8* ptr = (uint8*)translate_address_write(address);
+	if (uint8* page = writePage[(address & 0xFFFFFF) >> MEM_PAGE_SHIFT]; likely(page))
+		return page + (address & (MEM_PAGE_SIZE - 1));
+	slowPath = true;
+	return (uint8*)translate_address_write(address);
+}
 
-	//Write
-	//if (ptr)
-	{
-		*ptr = data;
+void storeB(uint32 address, uint8 data)
+{
+	bool slowPath = false;
+	uint8* ptr = write_ptr(address, slowPath);
+	*ptr = data;
+	if (slowPath)
 		post_write(address);
-	}
 }
 
 void storeW(uint32 address, uint16 data)
 {
-	uint16* ptr = (uint16*)translate_address_write(address);
-	if((uintptr_t)ptr % 2 != 0)
-	{
-		//bug_exit("address %X", address);
-	}
-
-	//Write
-	//if (ptr)
-
+	bool slowPath = false;
+	uint8* ptr = write_ptr(address, slowPath);
 	if(ALIGN_ACCESS && ((uintptr_t)ptr & IG::bit(0)))
 		memcpy(ptr, &data, 2); // LE
 	else
-		*ptr = htole16(data);
-	{
-
+		*(uint16*)ptr = htole16(data);
+	if (slowPath)
 		post_write(address);
-	}
 }
 
 void storeL(uint32 address, uint32 data)
 {
-	uint32* ptr = (uint32*)translate_address_write(address);
-	if((uintptr_t)ptr % 4 != 0)
-	{
-		//bug_exit("address %X", address);
-	}
-
-	//Write
-	//if (ptr)
+	bool slowPath = false;
+	uint8* ptr = write_ptr(address, slowPath);
 	if(ALIGN_ACCESS && ((uintptr_t)ptr & (IG::bit(0) | IG::bit(1))))
 		memcpy(ptr, &data, 4); // LE
 	else
-		*ptr = htole32(data);
-	{
+		*(uint32*)ptr = htole32(data);
+	if (slowPath)
 		post_write(address);
-	}
 }
 
 //=============================================================================
@@ -606,6 +665,8 @@ void reset_memory(void)
 
 	ram[0x8400] = 0xFF;	// LED on
 	ram[0x8402] = 0x80;	// Flash cycle = 1.3s
+
+	memory_map_update();
 }
 
 //=============================================================================
@@ -54,6 +54,10 @@
 
 void reset_memory(void);
 
+//Rebuilds the direct page tables used by the load/store functions,
+//call after changing the rom or eepromStatusEnable outside of mem.c
+void memory_map_update(void);
+
 void* translate_address_read(uint32 address) __attribute__ ((hot));
 void* translate_address_write(uint32 address) __attribute__ ((hot));
 
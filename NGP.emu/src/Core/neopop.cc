@@ -94,17 +94,22 @@ void __cdecl instruction_error(const char* vaMessage,...)
 
 //=============================================================================
 
+uint64 executed_instructions = 0;
+
 #ifndef NEOPOP_DEBUG
 
 void emulate(void)
 {
 	unsigned int gotVBL = 0;
+	uint64 instructions = 0;
 	
 	//system_message("start loop");
 	while(!gotVBL)
 	{
 		gotVBL = updateTimers<1>(TLCS900h_interpret());
+		instructions++;
 	}
+	executed_instructions += instructions;
 }
 
 #endif
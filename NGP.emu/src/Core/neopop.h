@@ -225,6 +225,9 @@ RomHeader;
 
 	void emulate(void);
 
+	/* number of TLCS900h instructions run by emulate() */
+	extern uint64 executed_instructions;
+
 /*! Call this function when a rom has just been loaded, it will perform
 	the system independent actions required. */
 
@@ -304,6 +307,9 @@ RomHeader;
 	//16-bit Frame buffer: Format X4B4G4R4
 	extern uint16 cfb[256*256] __attribute__ ((aligned (8)));
 
+	//Where scanlines are drawn, either cfb or a system buffer with the same line pitch
+	extern uint16* cfb_dest;
+
 	extern COLOURMODE system_colour;
 
 	extern uint32 frameskip_active;
@@ -355,6 +361,12 @@ RomHeader;
 	bool state_restore(const char* filename);
 	bool state_store(const char* filename);
 
+/*! Versions of the above working on an already opened stream, only
+	the current chunked state format is supported. */
+
+	bool state_restore_stream(FILE *fp);
+	bool state_store_stream(FILE *fp);
+
 		//=========================================
 
 /*! Reads a byte from the other system. If no data is available or no
@@ -84,6 +84,7 @@
 
 #include "neopop.h"
 #include "flash.h"
+#include "mem.h"
 #include "interrupt.h"
 #include "TLCS900h_interpret.h"
 #include <imagine/logger/logger.h>
@@ -283,6 +284,7 @@ void rom_unload(void)
 		free(rom.data);
 		rom.data = NULL;
 		rom.length = 0;
+		memory_map_update();
 		rom_header = 0;
 
 		for (i = 0; i < 16; i++)
@@ -97,17 +97,12 @@ bool state_restore(const char* filename)
 bool state_store(const char* filename)
 {
 	FILE *fp;
-	int ret, options;
+	int ret;
 
-	/* XXX: user settable */
-	options = OPT_ROMH;
-	
 	if ((fp=fopen(filename, "wb")) == NULL)
 		return FALSE;
 	
-	ret = write_header(fp);
-	ret = write_SNAP(fp, options);
-	ret = write_EOD(fp);
+	ret = state_store_stream(fp);
 
 	if (fclose(fp) < 0)
 		ret = FALSE;
@@ -115,6 +110,23 @@ bool state_store(const char* filename)
 	return ret;
 }
 
+//-----------------------------------------------------------------------------
+// state_store_stream()
+//-----------------------------------------------------------------------------
+bool state_store_stream(FILE *fp)
+{
+	int ret, options;
+
+	/* XXX: user settable */
+	options = OPT_ROMH;
+
+	ret = write_header(fp);
+	ret &= write_SNAP(fp, options);
+	ret &= write_EOD(fp);
+
+	return ret;
+}
+
 //=============================================================================
 
 static bool read_state_0050(const char* filename)
@@ -135,6 +147,7 @@ static bool read_state_0050(const char* filename)
 		reset();
 
 		eepromStatusEnable = state.eepromStatusEnable;
+		memory_map_update();
 
 		//TLCS-900h Registers
 		pc = state.pc;
@@ -142,6 +155,7 @@ static bool read_state_0050(const char* filename)
 		f_dash = state.f_dash;
 
 		eepromStatusEnable = state.eepromStatusEnable;
+		memory_map_update();
 
 		for (i = 0; i < 4; i++)
 		{
@@ -189,25 +203,31 @@ static bool read_state_0050(const char* filename)
 static bool read_state_0060(const char* filename)
 {
 	FILE *fp;
-	uint32 tag, size;
-	
+	bool ret;
+
 	if ((fp=fopen(filename, "rb")) == NULL)
 		return FALSE;
 
-	if (read_header(fp) != TRUE) {
-		fclose(fp);
+	ret = state_restore_stream(fp);
+	fclose(fp);
+	return ret;
+}
+
+//-----------------------------------------------------------------------------
+// state_restore_stream()
+//-----------------------------------------------------------------------------
+bool state_restore_stream(FILE *fp)
+{
+	uint32 tag, size;
+
+	if (read_header(fp) != TRUE)
 		return FALSE;
-	}
 
-	if (read_chunk(fp, &tag, &size) != TRUE) {
-	    fclose(fp);
-	    return FALSE;
-	}
+	if (read_chunk(fp, &tag, &size) != TRUE)
+		return FALSE;
 
-	if (tag != TAG_SNAP) {
-	    fclose(fp);
-	    return FALSE;
-	}
+	if (tag != TAG_SNAP)
+		return FALSE;
 
 	return read_SNAP(fp, size);
 }
@@ -24,14 +24,20 @@
 #include <emuframework/EmuAppInlines.hh>
 #include <emuframework/EmuAudio.hh>
 #include <emuframework/EmuVideo.hh>
+#include <imagine/io/BufferMapIO.hh>
+#include <imagine/io/IOStream.hh>
+#include <imagine/io/VectorIO.hh>
 #include <imagine/logger/logger.h>
 
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2011-2020\nRobert Broglia\nwww.explusalpha.com\n\n(c) 2004\nthe NeoPop Team\nwww.nih.at";
+EmuSystem::StateFileFormat EmuSystem::stateFileFormat = StateFileFormat::RAW;
+bool EmuSystem::hasDirectVideoRendering = true;
 uint32 frameskip_active = 0;
 static const int ngpResX = SCREEN_WIDTH, ngpResY = SCREEN_HEIGHT;
 static constexpr auto pixFmt = IG::PIXEL_FMT_RGB565;
 static EmuSystemTask *emuSysTask{};
 static EmuVideo *emuVideo{};
+static EmuVideoImage directImg{};
 static IG::Pixmap srcPix{{{ngpResX, ngpResY}, pixFmt}, cfb};
 
 EmuSystem::NameFilterFunc EmuSystem::defaultFsFilter =
@@ -72,6 +78,11 @@ EmuSystem::Error EmuSystem::saveState(const char *path)
 		return {};
 }
 
+uint64_t EmuSystem::executedInstructions()
+{
+	return executed_instructions;
+}
+
 EmuSystem::Error EmuSystem::loadState(const char *path)
 {
 	if(!state_restore(path))
@@ -80,6 +91,29 @@ EmuSystem::Error EmuSystem::loadState(const char *path)
 		return {};
 }
 
+EmuSystem::Error EmuSystem::saveStateToBuffer(std::vector<uint8_t> &buff)
+{
+	buff.clear();
+	VectorIO io;
+	io.open(buff);
+	IOStream<VectorIO> stream{std::move(io), "wb"};
+	if(!state_store_stream(static_cast<FILE*>(stream)) || fflush(static_cast<FILE*>(stream)))
+		return makeError("Error writing state to memory");
+	else
+		return {};
+}
+
+EmuSystem::Error EmuSystem::loadStateFromBuffer(IG::ConstBufferView buff)
+{
+	BufferMapIO io;
+	io.open(buff.data(), buff.size());
+	IOStream<BufferMapIO> stream{std::move(io), "rb"};
+	if(!state_restore_stream(static_cast<FILE*>(stream)))
+		return makeError("Error reading state from memory");
+	else
+		return {};
+}
+
 bool system_io_state_read(const char* filename, uint8_t* buffer, uint32 bufferLength)
 {
 	return FileUtils::readFromPath(filename, buffer, bufferLength) > 0;
@@ -171,7 +205,19 @@ void system_VBL(void)
 {
 	if(likely(emuVideo))
 	{
-		emuVideo->startFrame(emuSysTask, srcPix);
+		if(directImg)
+		{
+			if(cfb_dest == cfb)
+				directImg.endFrame(srcPix);
+			else
+				directImg.endFrame();
+			directImg = {};
+			cfb_dest = cfb;
+		}
+		else
+		{
+			emuVideo->startFrame(emuSysTask, srcPix);
+		}
 		emuVideo = {};
 		emuSysTask = {};
 	}
@@ -182,6 +228,13 @@ void EmuSystem::runFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
 	emuSysTask = task;
 	emuVideo = video;
 	frameskip_active = video ? 0 : 1;
+	if(video)
+	{
+		// draw scanlines straight into the video image when its pitch matches cfb's
+		directImg = video->startDirectFrame(task, srcPix);
+		if(directImg && directImg.pixmap().pitchBytes() == srcPix.pitchBytes())
+			cfb_dest = (uint16*)directImg.pixmap().pixel({});
+	}
 
 	#ifndef NEOPOP_DEBUG
 	emulate();
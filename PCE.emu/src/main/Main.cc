@@ -27,8 +27,10 @@
 #include <mednafen/pce_fast/vdc.h>
 #include <mednafen/pce_fast/pcecd_drive.h>
 #include <mednafen/MemoryStream.h>
+#include <mednafen/state.h>
 
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2011-2020\nRobert Broglia\nwww.explusalpha.com\n\nPortions (c) the\nMednafen Team\nmednafen.sourceforge.net";
+EmuSystem::StateFileFormat EmuSystem::stateFileFormat = StateFileFormat::GZIP;
 FS::PathString sysCardPath{};
 static std::vector<CDIF *> CDInterfaces;
 using Pixel = uint16;
@@ -421,6 +423,36 @@ EmuSystem::Error EmuSystem::loadState(const char *path)
 		return {};
 }
 
+EmuSystem::Error EmuSystem::saveStateToBuffer(std::vector<uint8_t> &buff)
+{
+	try
+	{
+		MemoryStream stream{65536};
+		MDFNSS_SaveSM(&stream, false);
+		buff.assign(stream.map(), stream.map() + stream.size());
+	}
+	catch(std::exception &e)
+	{
+		return makeError("%s", e.what());
+	}
+	return {};
+}
+
+EmuSystem::Error EmuSystem::loadStateFromBuffer(IG::ConstBufferView buff)
+{
+	try
+	{
+		MemoryStream stream{buff.size(), -1};
+		memcpy(stream.map(), buff.data(), buff.size());
+		MDFNSS_LoadSM(&stream, false);
+	}
+	catch(std::exception &e)
+	{
+		return makeError("%s", e.what());
+	}
+	return {};
+}
+
 void EmuApp::onCustomizeNavView(EmuApp::NavView &view)
 {
 	const Gfx::LGradientStopDesc navViewGrad[] =
@@ -42,9 +42,18 @@ ifeq ($(ARCH), arm)
   yabause/sh2_dynarec/sh2_dynarec.c
  endif
 else ifeq ($(ARCH), x86_64)
- # TODO: x86_64 dynarec has 64/32-bit pointer conversion issues
- #CPPFLAGS += -DCPU_X64=1 -DUSE_DYNAREC=1 -DSH2_DYNAREC=1
- #SRC += yabause/sh2_dynarec/linkage_x64.s yabause/sh2_dynarec/sh2_dynarec.c
+ # experimental, build with SATURN_X64_DYNAREC=1 to include it
+ ifeq ($(ENV)-$(SATURN_X64_DYNAREC), linux-1)
+  # generated code and linkage_x64.s address globals with 32-bit operands,
+  # so they must be linked into the low 2GB, which gives up PIE
+  CFLAGS_CODEGEN += -fno-pie
+  LDFLAGS += -no-pie
+  CPPFLAGS += -DCPU_X64=1 \
+  -DUSE_DYNAREC=1 \
+  -DSH2_DYNAREC=1
+  SRC += yabause/sh2_dynarec/linkage_x64.s \
+  yabause/sh2_dynarec/sh2_dynarec.c
+ endif
 else ifeq ($(ARCH), x86)
  CPPFLAGS += -DCPU_X86=1 \
  -DUSE_DYNAREC=1 \
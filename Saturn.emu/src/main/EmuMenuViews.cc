@@ -87,10 +87,46 @@ public:
 	}
 };
 
+class CustomVideoOptionView : public VideoOptionView
+{
+	TextMenuItem layerThreadsItem[6]
+	{
+		{"Auto", [](){ setLayerThreads(0); }},
+		{"1", [](){ setLayerThreads(1); }},
+		{"2", [](){ setLayerThreads(2); }},
+		{"3", [](){ setLayerThreads(3); }},
+		{"4", [](){ setLayerThreads(4); }},
+		{"5", [](){ setLayerThreads(5); }},
+	};
+
+	MultiChoiceMenuItem layerThreads
+	{
+		"Render Threads",
+		optionLayerThreads,
+		layerThreadsItem
+	};
+
+	static void setLayerThreads(uint8_t val)
+	{
+		optionLayerThreads = val;
+		if(EmuSystem::gameIsRunning())
+			updateLayerThreads();
+	}
+
+public:
+	CustomVideoOptionView(ViewAttachParams attach): VideoOptionView{attach, true}
+	{
+		loadStockItems();
+		item.emplace_back(&systemSpecificHeading);
+		item.emplace_back(&layerThreads);
+	}
+};
+
 std::unique_ptr<View> EmuApp::makeCustomView(ViewAttachParams attach, ViewID id)
 {
 	switch(id)
 	{
+		case ViewID::VIDEO_OPTIONS: return std::make_unique<CustomVideoOptionView>(attach);
 		case ViewID::SYSTEM_OPTIONS: return std::make_unique<CustomSystemOptionView>(attach);
 		default: return nullptr;
 	}
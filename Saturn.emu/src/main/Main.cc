@@ -18,6 +18,10 @@
 #include <emuframework/EmuAppInlines.hh>
 #include <emuframework/EmuAudio.hh>
 #include <emuframework/EmuVideo.hh>
+#include <imagine/io/BufferMapIO.hh>
+#include <imagine/io/IOStream.hh>
+#include <imagine/io/VectorIO.hh>
+#include <thread>
 #include "internal.hh"
 
 extern "C"
@@ -32,13 +36,17 @@ extern "C"
 	#include <yabause/cdbase.h>
 	#include <yabause/cs0.h>
 	#include <yabause/cs2.h>
+	#include <yabause/memory.h>
 }
 
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2012-2020\nRobert Broglia\nwww.explusalpha.com\n\n(c) 2012 the\nYabause Team\nyabause.org";
 bool EmuSystem::handlesGenericIO = false;
+bool EmuSystem::hasDirectVideoRendering = true;
+EmuSystem::StateFileFormat EmuSystem::stateFileFormat = StateFileFormat::RAW;
 static EmuSystemTask *emuSysTask{};
 static EmuAudio *emuAudio{};
 static EmuVideo *emuVideo{};
+static EmuVideoImage directImg{};
 PerPad_struct *pad[2];
 // from sh2_dynarec.c
 #define SH2CORE_DYNAREC 2
@@ -129,8 +137,9 @@ static FS::PathString bupPath{};
 static char mpegPath[] = "";
 static char cartPath[] = "";
 
+// the x86_64 dynarec is only built with SATURN_X64_DYNAREC=1 and is opt-in through the SH2 core option
 extern const int defaultSH2CoreID =
-#ifdef SH2_DYNAREC
+#if defined SH2_DYNAREC && !defined CPU_X64
 SH2CORE_DYNAREC;
 #else
 SH2CORE_INTERPRETER;
@@ -219,6 +228,17 @@ EmuSystem::NameFilterFunc EmuSystem::defaultBenchmarkFsFilter = hasCDExtension;
 
 static constexpr auto pixFmt = IG::PIXEL_FMT_RGBA8888;
 
+CLINK pixel_t *YuiGetDisplayBuffer(int width, int height)
+{
+	if(!emuVideo)
+		return nullptr;
+	directImg = emuVideo->startDirectFrame(emuSysTask, {{width, height}, pixFmt});
+	// Titan composes frames with a pitch of exactly the frame width
+	if(!directImg || directImg.pixmap().isPadded())
+		return nullptr;
+	return (pixel_t*)directImg.pixmap().pixel({});
+}
+
 CLINK void YuiSwapBuffers()
 {
 	//logMsg("YuiSwapBuffers");
@@ -227,7 +247,18 @@ CLINK void YuiSwapBuffers()
 		int height, width;
 		VIDCore->GetGlSize(&width, &height);
 		IG::Pixmap srcPix = {{{width, height}, pixFmt}, dispbuffer};
-		emuVideo->startFrameWithFormat(emuSysTask, srcPix);
+		if(directImg)
+		{
+			if(directImg.pixmap().isPadded())
+				directImg.endFrame(srcPix);
+			else
+				directImg.endFrame();
+			directImg = {};
+		}
+		else
+		{
+			emuVideo->startFrameWithFormat(emuSysTask, srcPix);
+		}
 		emuVideo = {};
 		emuSysTask = {};
 	}
@@ -284,6 +315,29 @@ EmuSystem::Error EmuSystem::loadState(const char *path)
 		return EmuSystem::makeFileReadError();
 }
 
+EmuSystem::Error EmuSystem::saveStateToBuffer(std::vector<uint8_t> &buff)
+{
+	buff.clear();
+	VectorIO io;
+	io.open(buff);
+	IOStream<VectorIO> stream{std::move(io), "wb"};
+	if(YabSaveStateStream(static_cast<FILE*>(stream)) == 0 && fflush(static_cast<FILE*>(stream)) == 0)
+		return {};
+	else
+		return EmuSystem::makeError("Error writing state to memory");
+}
+
+EmuSystem::Error EmuSystem::loadStateFromBuffer(IG::ConstBufferView buff)
+{
+	BufferMapIO io;
+	io.open(buff.data(), buff.size());
+	IOStream<BufferMapIO> stream{std::move(io), "rb"};
+	if(YabLoadStateStream(static_cast<FILE*>(stream)) == 0)
+		return {};
+	else
+		return EmuSystem::makeError("Error reading state from memory");
+}
+
 void EmuSystem::saveBackupMem() // for manually saving when not closing game
 {
 	if(gameIsRunning())
@@ -295,6 +349,243 @@ void EmuSystem::saveBackupMem() // for manually saving when not closing game
 
 static bool yabauseIsInit = 0;
 
+#ifdef SH2_DYNAREC
+// Check of the dynarec against the interpreter, enabled by setting
+// SATURN_VALIDATE_DYNAREC to a number of frames. The dynarec runs the game
+// continuously with its block cache intact. After each of its frames, an
+// interpreter shadow replays the frame from the dynarec's state at the start
+// of it, then the dynarec's end state is put back. The states are loaded with
+// the interpreter as the active core so the dynarec's cache isn't flushed,
+// its RAM contents are restored exactly so the cached blocks stay valid.
+// CPU registers are compared at every line end, where the dynarec returns to
+// the cc/interrupt linkage, and work RAM at the end of the frame, stopping at
+// the first difference.
+
+extern "C" int saved_centicycles;
+
+struct SH2LineRegs
+{
+	sh2regs_struct regs[2]{};
+	bool slaveRunning{};
+};
+
+struct SH2ValidateResult
+{
+	std::vector<SH2LineRegs> lines{};
+	std::vector<uint8_t> lowWram{}, highWram{};
+};
+
+// timing fractions that don't round-trip through save states
+struct SH2ValidateTiming
+{
+	yabsys_struct sys;
+	int centicycles;
+
+	static SH2ValidateTiming save() { return {yabsys, saved_centicycles}; }
+
+	void restore() const
+	{
+		yabsys = sys;
+		saved_centicycles = centicycles;
+	}
+};
+
+static uint32_t dynarecValidateFrames{};
+static uint32_t dynarecValidatedFrames{};
+static std::vector<uint8_t> dynarecValidateStartState{}, dynarecValidateEndState{};
+static std::vector<SH2LineRegs> *dynarecValidateLines{};
+
+static SH2LineRegs captureLineRegs()
+{
+	SH2LineRegs line;
+	SH2Core->GetRegisters(MSH2, &line.regs[0]);
+	line.slaveRunning = yabsys.IsSSH2Running;
+	if(line.slaveRunning)
+		SH2Core->GetRegisters(SSH2, &line.regs[1]);
+	return line;
+}
+
+static void recordValidateLine()
+{
+	dynarecValidateLines->push_back(captureLineRegs());
+}
+
+static void startDynarecValidation()
+{
+	dynarecValidateFrames = 0;
+	auto framesStr = getenv("SATURN_VALIDATE_DYNAREC");
+	if(!framesStr || SH2Core->id != SH2CORE_DYNAREC)
+		return;
+	if(SH2Interpreter.Init() != 0)
+	{
+		logErr("error initializing interpreter for dynarec validation");
+		return;
+	}
+	dynarecValidateFrames = std::max(atoi(framesStr), 1);
+	dynarecValidatedFrames = 0;
+	logMsg("validating dynarec against interpreter for %u frames", dynarecValidateFrames);
+}
+
+static void stopDynarecValidation()
+{
+	dynarecValidateFrames = 0;
+	dynarecValidateStartState = {};
+	dynarecValidateEndState = {};
+}
+
+static void captureValidateMemory(SH2ValidateResult &res)
+{
+	res.lowWram.assign(LowWram, LowWram + 0x100000);
+	res.highWram.assign(HighWram, HighWram + 0x100000);
+}
+
+static bool reportRegisterDivergence(const char *cpuName, unsigned line, const sh2regs_struct &interp, const sh2regs_struct &dynarec)
+{
+	auto report =
+		[&](const char *regName, u32 interpVal, u32 dynarecVal)
+		{
+			if(interpVal == dynarecVal)
+				return false;
+			logErr("dynarec divergence in frame %u line %u: %s %s interpreter:0x%08X dynarec:0x%08X (interpreter PC:0x%08X dynarec PC:0x%08X)",
+				dynarecValidatedFrames, line, cpuName, regName, interpVal, dynarecVal, interp.PC, dynarec.PC);
+			return true;
+		};
+	static const char *gprName[16]{"R0", "R1", "R2", "R3", "R4", "R5", "R6", "R7",
+		"R8", "R9", "R10", "R11", "R12", "R13", "R14", "R15"};
+	iterateTimes(16, i)
+	{
+		if(report(gprName[i], interp.R[i], dynarec.R[i]))
+			return true;
+	}
+	// only compare the implemented status bits
+	const u32 srMask = 0x3F3;
+	return report("SR", interp.SR.all & srMask, dynarec.SR.all & srMask) ||
+		report("GBR", interp.GBR, dynarec.GBR) ||
+		report("VBR", interp.VBR, dynarec.VBR) ||
+		report("MACH", interp.MACH, dynarec.MACH) ||
+		report("MACL", interp.MACL, dynarec.MACL) ||
+		report("PR", interp.PR, dynarec.PR) ||
+		report("PC", interp.PC, dynarec.PC);
+}
+
+static bool compareLineRegs(unsigned line, const SH2LineRegs &interp, const SH2LineRegs &dynarec)
+{
+	if(reportRegisterDivergence("MSH2", line, interp.regs[0], dynarec.regs[0]))
+		return false;
+	if(interp.slaveRunning != dynarec.slaveRunning)
+	{
+		logErr("dynarec divergence in frame %u line %u: slave SH2 %s only on interpreter",
+			dynarecValidatedFrames, line, interp.slaveRunning ? "running" : "stopped");
+		return false;
+	}
+	return !(interp.slaveRunning && reportRegisterDivergence("SSH2", line, interp.regs[1], dynarec.regs[1]));
+}
+
+static bool reportMemoryDivergence(const char *memName, u32 baseAddr, const std::vector<uint8_t> &interp, const std::vector<uint8_t> &dynarec)
+{
+	auto [interpIt, dynarecIt] = std::mismatch(interp.begin(), interp.end(), dynarec.begin());
+	if(interpIt == interp.end())
+		return false;
+	auto offset = interpIt - interp.begin();
+	// work RAM is stored with each 16-bit word byte swapped
+	logErr("dynarec divergence at end of frame %u: %s at 0x%08X (byte offset 0x%X) interpreter:0x%02X dynarec:0x%02X",
+		dynarecValidatedFrames, memName, baseAddr + ((u32)offset ^ 1), (u32)offset, *interpIt, *dynarecIt);
+	return true;
+}
+
+static bool compareValidateResults(const SH2ValidateResult &interp, const SH2ValidateResult &dynarec)
+{
+	if(interp.lines.size() != dynarec.lines.size())
+	{
+		logErr("dynarec divergence in frame %u: ran %zu lines, interpreter ran %zu",
+			dynarecValidatedFrames, dynarec.lines.size(), interp.lines.size());
+		return false;
+	}
+	iterateTimes(dynarec.lines.size(), i)
+	{
+		if(!compareLineRegs(i, interp.lines[i], dynarec.lines[i]))
+			return false;
+	}
+	return !reportMemoryDivergence("low work RAM", 0x200000, interp.lowWram, dynarec.lowWram) &&
+		!reportMemoryDivergence("high work RAM", 0x6000000, interp.highWram, dynarec.highWram);
+}
+
+static void runValidatedFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
+{
+	if(EmuSystem::saveStateToBuffer(dynarecValidateStartState))
+	{
+		logErr("error saving state, stopping dynarec validation");
+		stopDynarecValidation();
+		return;
+	}
+	auto startTiming = SH2ValidateTiming::save();
+	// dynarec frame, this is the one that's kept
+	SH2ValidateResult dynarecResult, interpResult;
+	dynarecValidateLines = &dynarecResult.lines;
+	YabauseLineEndHook = recordValidateLine;
+	emuSysTask = task;
+	emuVideo = video;
+	emuAudio = audio;
+	SNDImagine.UpdateAudio = audio ? SNDImagineUpdateAudio : SNDImagineUpdateAudioNull;
+	YabauseEmulate();
+	emuAudio = {};
+	captureValidateMemory(dynarecResult);
+	auto dynarecEndRegs = captureLineRegs();
+	if(EmuSystem::saveStateToBuffer(dynarecValidateEndState))
+	{
+		YabauseLineEndHook = {};
+		logErr("error saving state, stopping dynarec validation");
+		stopDynarecValidation();
+		return;
+	}
+	auto endTiming = SH2ValidateTiming::save();
+	// interpreter shadow from the dynarec's start state with no video or audio output,
+	// state loads with a non-dynarec core leave the dynarec's block cache alone
+	auto dynarecCore = SH2Core;
+	SH2Core = &SH2Interpreter;
+	EmuSystem::loadStateFromBuffer({(const char*)dynarecValidateStartState.data(), dynarecValidateStartState.size()});
+	startTiming.restore();
+	dynarecValidateLines = &interpResult.lines;
+	emuSysTask = {};
+	emuVideo = {};
+	SNDImagine.UpdateAudio = SNDImagineUpdateAudioNull;
+	YabauseEmulate();
+	YabauseLineEndHook = {};
+	dynarecValidateLines = {};
+	captureValidateMemory(interpResult);
+	if(dynarecResult.lines.empty())
+	{
+		// only the x86_64 linkage reports line ends, other dynarecs are just
+		// checked at the end of the frame
+		dynarecResult.lines.push_back(dynarecEndRegs);
+		interpResult.lines = {captureLineRegs()};
+	}
+	// back to where the dynarec left off, its registers and cache were never touched
+	EmuSystem::loadStateFromBuffer({(const char*)dynarecValidateEndState.data(), dynarecValidateEndState.size()});
+	endTiming.restore();
+	SH2Core = dynarecCore;
+	dynarecValidatedFrames++;
+	if(!compareValidateResults(interpResult, dynarecResult))
+	{
+		stopDynarecValidation();
+		return;
+	}
+	if(dynarecValidatedFrames == dynarecValidateFrames)
+	{
+		logMsg("dynarec matched interpreter for %u frames", dynarecValidatedFrames);
+		stopDynarecValidation();
+	}
+}
+#endif
+
+void updateLayerThreads()
+{
+	int threads = optionLayerThreads;
+	if(!threads)
+		threads = std::thread::hardware_concurrency();
+	VIDSoftSetNumLayerThreads(threads);
+}
+
 void EmuSystem::closeSystem()
 {
 	if(yabauseIsInit)
@@ -307,6 +598,10 @@ void EmuSystem::closeSystem()
 EmuSystem::Error EmuSystem::loadGame(IO &, OnLoadProgressDelegate)
 {
 	string_printf(bupPath, "%s/bkram.bin", savePath());
+	updateLayerThreads();
+	// set SATURN_VALIDATE_LAYER_THREADS to check threaded VDP2 layer drawing
+	// against the single threaded path every frame
+	VIDSoftSetLayerThreadsValidate(getenv("SATURN_VALIDATE_LAYER_THREADS") != nullptr);
 	if(YabauseInit(&yinit) != 0)
 	{
 		logErr("YabauseInit failed");
@@ -319,6 +614,9 @@ EmuSystem::Error EmuSystem::loadGame(IO &, OnLoadProgressDelegate)
 	pad[0] = PerPadAdd(&PORTDATA1);
 	pad[1] = PerPadAdd(&PORTDATA2);
 	ScspSetFrameAccurate(1);
+	#ifdef SH2_DYNAREC
+	startDynarecValidation();
+	#endif
 
 	return {};
 }
@@ -330,6 +628,13 @@ void EmuSystem::configAudioRate(IG::FloatSeconds frameTime, uint32_t rate)
 
 void EmuSystem::runFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
 {
+	#ifdef SH2_DYNAREC
+	if(unlikely(dynarecValidateFrames))
+	{
+		runValidatedFrame(task, video, audio);
+		return;
+	}
+	#endif
 	emuSysTask = task;
 	emuVideo = video;
 	emuAudio = audio;
@@ -15,6 +15,7 @@ static const uint gamepadKeys = 23;
 }
 
 extern Byte1Option optionSH2Core;
+extern Byte1Option optionLayerThreads;
 extern FS::PathString biosPath;
 extern SH2Interface_struct *SH2CoreList[];
 extern uint SH2Cores;
@@ -23,3 +24,4 @@ extern const int defaultSH2CoreID;
 extern PerPad_struct *pad[2];
 
 bool hasBIOSExtension(const char *name);
+void updateLayerThreads();
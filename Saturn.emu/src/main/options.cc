@@ -23,7 +23,8 @@ extern "C"
 
 enum
 {
-	CFGKEY_BIOS_PATH = 279, CFGKEY_SH2_CORE = 280
+	CFGKEY_BIOS_PATH = 279, CFGKEY_SH2_CORE = 280,
+	CFGKEY_LAYER_THREADS = 281
 };
 
 SH2Interface_struct *SH2CoreList[]
@@ -53,6 +54,8 @@ static bool OptionSH2CoreIsValid(uint8_t val)
 const char *EmuSystem::configFilename = "SaturnEmu.config";
 static PathOption optionBiosPath{CFGKEY_BIOS_PATH, biosPath, ""};
 Byte1Option optionSH2Core{CFGKEY_SH2_CORE, (uint8_t)defaultSH2CoreID, false, OptionSH2CoreIsValid};
+// 0 picks a count from the number of CPU cores
+Byte1Option optionLayerThreads{CFGKEY_LAYER_THREADS, 0, false, optionIsValidWithMax<5>};
 const AspectRatioInfo EmuSystem::aspectRatioInfo[] =
 {
 		{"4:3 (Original)", 4, 3},
@@ -85,6 +88,7 @@ bool EmuSystem::readConfig(IO &io, uint key, uint readSize)
 		default: return 0;
 		bcase CFGKEY_BIOS_PATH: optionBiosPath.readFromIO(io, readSize);
 		bcase CFGKEY_SH2_CORE: optionSH2Core.readFromIO(io, readSize);
+		bcase CFGKEY_LAYER_THREADS: optionLayerThreads.readFromIO(io, readSize);
 	}
 	return 1;
 }
@@ -93,4 +97,5 @@ void EmuSystem::writeConfig(IO &io)
 {
 	optionBiosPath.writeToIO(io);
 	optionSH2Core.writeWithKeyIfNotDefault(io);
+	optionLayerThreads.writeWithKeyIfNotDefault(io);
 }
@@ -1900,8 +1900,7 @@ void emit_readword_map(int addr, int map, int rt)
   if(map<0) emit_readword(addr, rt);
   else
   {
-    assem_debug("addr32 mov %x(,%%%s,4),%%%s\n",addr,regname[map],regname[rt]);
-    output_byte(0x67);
+    assem_debug("mov %x(,%%%s,4),%%%s\n",addr,regname[map],regname[rt]);
     output_byte(0x8B);
     output_modrm(0,4,rt);
     output_sib(2,map,5);
@@ -2006,8 +2005,7 @@ void emit_movsbl_map(u64 addr, int map, int rt)
   else
   {
     //FIXME
-    assem_debug("addr32 movsbl %x(,%%%s,4),%%%s\n",addr,regname[map],regname[rt]);
-    output_byte(0x67);
+    assem_debug("movsbl %x(,%%%s,4),%%%s\n",addr,regname[map],regname[rt]);
     output_byte(0x0F);
     output_byte(0xBE);
     output_modrm(0,4,rt);
@@ -2079,8 +2077,7 @@ void emit_movswl_map(u64 addr, int map, int rt)
   else
   {
     //FIXME
-    assem_debug("addr32 movswl %x(,%%%s,4),%%%s\n",addr,regname[map],regname[rt]);
-    output_byte(0x67);
+    assem_debug("movswl %x(,%%%s,4),%%%s\n",addr,regname[map],regname[rt]);
     output_byte(0x0F);
     output_byte(0xBF);
     output_modrm(0,4,rt);
@@ -2136,8 +2133,7 @@ void emit_movzbl_map(int addr, int map, int rt)
   if(map<0) emit_movzbl(addr, rt);
   else
   {
-    assem_debug("addr32 movzbl %x(,%%%s,4),%%%s\n",addr,regname[map],regname[rt]);
-    output_byte(0x67);
+    assem_debug("movzbl %x(,%%%s,4),%%%s\n",addr,regname[map],regname[rt]);
     output_byte(0x0F);
     output_byte(0xB6);
     output_modrm(0,4,rt);
@@ -2149,9 +2145,8 @@ void emit_movzbl_indexed_map(int addr, int rs, int map, int rt)
 {
   if(map<0) emit_movzbl_indexed(addr, rs, rt);
   else {
-    assem_debug("addr32 movzbl %x(%%%s,%%%s,4),%%%s\n",addr,regname[rs],regname[map],regname[rt]);
+    assem_debug("movzbl %x(%%%s,%%%s,4),%%%s\n",addr,regname[rs],regname[map],regname[rt]);
     assert(rs!=ESP);
-    output_byte(0x67);
     output_byte(0x0F);
     output_byte(0xB6);
     if(addr==0&&rs!=EBP) {
@@ -2192,8 +2187,7 @@ void emit_movzwl_map(int addr, int map, int rt)
   if(map<0) emit_movzwl(addr, rt);
   else
   {
-    assem_debug("addr32 movzwl %x(,%%%s,4),%%%s\n",addr,regname[map],regname[rt]);
-    output_byte(0x67);
+    assem_debug("movzwl %x(,%%%s,4),%%%s\n",addr,regname[map],regname[rt]);
     output_byte(0x0F);
     output_byte(0xB7);
     output_modrm(0,4,rt);
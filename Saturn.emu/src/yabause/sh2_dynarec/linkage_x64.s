@@ -101,7 +101,7 @@ newline:
 	sub	%edx, %ebx  /* sh2cycles(full line) - decilinecycles*9 */
 	mov	%rax, CurrentSH2
 	mov	%ebx, -52(%rbp) /* sh2cycles */
-	cmp	$0, (%rax, %rcx)
+	cmpl	$0, (%rax, %rcx)
 	jne	master_handle_interrupts
 	mov	master_cc, %esi
 	sub	%ebx, %esi
@@ -131,12 +131,12 @@ slave_entry:
 	mov	%ebx, %edi
 	call	WDTExec
 	mov	slave_ip, %rdx
-	test	%edx, %edx
+	test	%rdx, %rdx
 	je	cc_interrupt_master /* slave not running */
 	mov	SSH2, %rax
 	mov	NumberOfInterruptsOffset, %ecx
 	mov	%rax, CurrentSH2
-	cmp	$0, (%rax, %rcx)
+	cmpl	$0, (%rax, %rcx)
 	jne	slave_handle_interrupts
 	mov	slave_cc, %esi
 	sub	%ebx, %esi
@@ -189,6 +189,11 @@ cc_interrupt_master:
 	call	Vdp2HBlankIN
 	jmp	.A1
 .A3:
+	mov	YabauseLineEndHook, %rax
+	test	%rax, %rax
+	je	.A8
+	call	*%rax
+.A8:
 	mov	-56(%rbp), %edi /* scucycles */
 	call	ScuExec
 	call	M68KSync
@@ -262,7 +267,7 @@ nextframe:
 	inc	%esi
 	andl	$0, invalidate_count
 	and	$0x3f, %esi
-	cmpl	$0, restore_candidate(,%esi,4)
+	cmpl	$0, restore_candidate(,%rsi,4)
 	mov	%esi, rccount
 	jne	.A5
 .A4:
@@ -278,9 +283,9 @@ nextframe:
 	ret
 .A5:
 	/* Move 'dirty' blocks to the 'clean' list */
-	mov	restore_candidate(,%esi,4), %ebx
+	mov	restore_candidate(,%rsi,4), %ebx
 	mov	%esi, %ebp
-	andl	$0, restore_candidate(,%esi,4)
+	andl	$0, restore_candidate(,%rsi,4)
 	shl	$5, %ebp
 .A6:
 	shr	$1, %ebx
@@ -308,7 +313,7 @@ dyna_linker:
 	cmp	%edx, %ecx
 	cmova	%edx, %ecx
 	/* jump_in lookup */
-	movq	jump_in(,%ecx,8), %r12
+	movq	jump_in(,%rcx,8), %r12
 .B1:
 	test	%r12, %r12
 	je	.B3
@@ -318,7 +323,7 @@ dyna_linker:
 	movq	16(%r12), %r12
 	jmp	.B1
 .B2:
-	mov	(%ebx), %edi
+	mov	(%rbx), %edi
 	mov	%esi, %ebp
 	lea	4(%ebx,%edi,1), %esi
 	mov	%eax, %edi
@@ -327,7 +332,7 @@ dyna_linker:
 	mov	%ebp, %esi
 	lea	-4(%edi), %edx
 	subl	%ebx, %edx
-	movl	%edx, (%ebx)
+	movl	%edx, (%rbx)
 	jmp	*%rdi
 .B3:
 	/* hash_table lookup */
@@ -336,17 +341,17 @@ dyna_linker:
 	xor	%eax, %edi
 	movzwl	%di, %edi
 	shl	$4, %edi
-	cmp	hash_table(%edi), %eax
+	cmp	hash_table(%rdi), %eax
 	jne	.B5
 .B4:
-	mov	hash_table+4(%edi), %edx
+	mov	hash_table+4(%rdi), %edx
 	jmp	*%rdx
 .B5:
-	cmp	hash_table+8(%edi), %eax
-	lea	8(%edi), %edi
+	cmp	hash_table+8(%rdi), %eax
+	lea	8(%rdi), %rdi
 	je	.B4
 	/* jump_dirty lookup */
-	movq	jump_dirty(,%ecx,8), %r12
+	movq	jump_dirty(,%rcx,8), %r12
 .B6:
 	test	%r12, %r12
 	je	.B8
@@ -358,12 +363,12 @@ dyna_linker:
 .B7:
 	movl	8(%r12), %edx
 	/* hash_table insert */
-	mov	hash_table-8(%edi), %ebx
-	mov	hash_table-4(%edi), %ecx
-	mov	%eax, hash_table-8(%edi)
-	mov	%edx, hash_table-4(%edi)
-	mov	%ebx, hash_table(%edi)
-	mov	%ecx, hash_table+4(%edi)
+	mov	hash_table-8(%rdi), %ebx
+	mov	hash_table-4(%rdi), %ecx
+	mov	%eax, hash_table-8(%rdi)
+	mov	%edx, hash_table-4(%rdi)
+	mov	%ebx, hash_table(%rdi)
+	mov	%ecx, hash_table+4(%rdi)
 	jmp	*%rdx
 .B8:
 	mov	%eax, %edi
@@ -456,14 +461,14 @@ jump_vaddr:
 	xor	%edi, %eax
 	movzwl	%ax, %eax
 	shl	$4, %eax
-	cmp	hash_table(%eax), %edi
+	cmp	hash_table(%rax), %edi
 	jne	.C2
 .C1:
-	mov	hash_table+4(%eax), %edi
+	mov	hash_table+4(%rax), %edi
 	jmp	*%rdi
 .C2:
-	cmp	hash_table+8(%eax), %edi
-	lea	8(%eax), %eax
+	cmp	hash_table+8(%rax), %edi
+	lea	8(%rax), %rax
 	je	.C1
   /* No hit on hash table, call compiler */
 	mov	%esi, %ebx /* CCREG */
@@ -480,7 +485,7 @@ verify_code:
 	/* ecx = length */
 	/* r12d = instruction pointer */
 	mov	-4(%rax,%rcx,1), %edi
-	xor	-4(%ebx,%ecx,1), %edi
+	xor	-4(%rbx,%rcx,1), %edi
 	jne	.D4
 	mov	%ecx, %edx
 	add	$-4, %ecx
@@ -489,7 +494,7 @@ verify_code:
 	cmove	%edx, %ecx
 .D2:
 	mov	-8(%rax,%rcx,1), %rdi
-	cmp	-8(%ebx,%ecx,1), %rdi
+	cmp	-8(%rbx,%rcx,1), %rdi
 	jne	.D4
 	add	$-8, %ecx
 	jne	.D2
@@ -747,3 +752,5 @@ breakpoint:
 	ret
 	/* Set breakpoint here for debugging */
 	.size	breakpoint, .-breakpoint
+
+	.section	.note.GNU-stack,"",@progbits
@@ -109,7 +109,7 @@ struct ll_entry
   pointer instr_addr[MAXBLOCK];
   u32 link_addr[MAXBLOCK][3];
   int linkcount;
-  u32 stubs[MAXBLOCK*3][8];
+  pointer stubs[MAXBLOCK*3][8];
   int stubcount;
   pointer ccstub_return[MAXBLOCK];
   u32 literals[1024][2];
@@ -913,14 +913,16 @@ void invalidate_blocks(u32 firstblock,u32 lastblock)
       if((head->vaddr>>12)==block) { // Ignore vaddr hash collision
         get_bounds((pointer)head->addr,&start,&end);
         //printf("start: %x end: %x\n",start,end);
-        if(start>=(u32)LowWram&&end<(u32)LowWram+1048576) {
+        // Compare offsets rather than addresses, the truncated host
+        // pointers can wrap around on 64-bit hosts
+        if(start-(u32)LowWram<1048576&&end-(u32)LowWram<1048576) {
           if(((start-(u32)LowWram)>>12)<=page&&((end-1-(u32)LowWram)>>12)>=page) {
             if((((start-(u32)LowWram)>>12)+512)<first) first=((start-(u32)LowWram)>>12)&1023;
             if((((end-1-(u32)LowWram)>>12)+512)>last) last=((end-1-(u32)LowWram)>>12)&1023;
           }
         }
         // FIXME: Aliasing/mirroring is wrong here
-        if(start>=(u32)HighWram&&end<(u32)HighWram+1048576) {
+        if(start-(u32)HighWram<1048576&&end-(u32)HighWram<1048576) {
           if(((start-(u32)HighWram)>>12)<=page-1024&&((end-1-(u32)HighWram)>>12)>=page-1024) {
             if((((start-(u32)HighWram)>>12)&255)<first-1024) first=(((start-(u32)HighWram)>>12)&255)+1024;
             if((((end-1-(u32)HighWram)>>12)&255)>last-1024) last=(((end-1-(u32)HighWram)>>12)&255)+1024;
@@ -1789,7 +1791,7 @@ void delayslot_alloc(struct regstat *current,int i)
   }
 }
 
-void add_stub(int type,int addr,int retaddr,int a,int b,int c,int d,int e)
+void add_stub(int type,int addr,int retaddr,int a,int b,pointer c,int d,int e)
 {
   stubs[stubcount][0]=type;
   stubs[stubcount][1]=addr;
@@ -2290,7 +2292,7 @@ void load_assemble(int i,struct regstat *i_regs)
         }
       }
       if(jaddr)
-        add_stub(LOADB_STUB,jaddr,(int)out,i,addr,(int)i_regs,ccadj[i],reglist);
+        add_stub(LOADB_STUB,jaddr,(int)out,i,addr,(pointer)i_regs,ccadj[i],reglist);
     }
     else
       inline_readstub(LOADB_STUB,i,constaddr,i_regs->regmap,rt1[i],ccadj[i],reglist);
@@ -2315,7 +2317,7 @@ void load_assemble(int i,struct regstat *i_regs)
         }
       }
       if(jaddr)
-        add_stub(LOADW_STUB,jaddr,(int)out,i,addr,(int)i_regs,ccadj[i],reglist);
+        add_stub(LOADW_STUB,jaddr,(int)out,i,addr,(pointer)i_regs,ccadj[i],reglist);
     }
     else
       inline_readstub(LOADW_STUB,i,constaddr,i_regs->regmap,rt1[i],ccadj[i],reglist);
@@ -2332,7 +2334,7 @@ void load_assemble(int i,struct regstat *i_regs)
         emit_rorimm(t,16,t);
       }
       if(jaddr)
-        add_stub(LOADL_STUB,jaddr,(int)out,i,addr,(int)i_regs,ccadj[i],reglist);
+        add_stub(LOADL_STUB,jaddr,(int)out,i,addr,(pointer)i_regs,ccadj[i],reglist);
     }
     else
       inline_readstub(LOADL_STUB,i,constaddr,i_regs->regmap,rt1[i],ccadj[i],reglist);
@@ -2482,7 +2484,7 @@ void store_assemble(int i,struct regstat *i_regs)
     type=STOREL_STUB;
   }
   if(jaddr) {
-    add_stub(type,jaddr,(int)out,i,addr,(int)i_regs,ccadj[i],reglist);
+    add_stub(type,jaddr,(int)out,i,addr,(pointer)i_regs,ccadj[i],reglist);
   } else if(c&&!memtarget) {
     inline_writestub(type,i,constaddr,i_regs->regmap,rs1[i],ccadj[i],reglist);
   }
@@ -2583,7 +2585,7 @@ void rmw_assemble(int i,struct regstat *i_regs)
     if(opcode2[i]==15) emit_rmw_orimm(addr,map,imm[i]); // OR.B
   }
   if(jaddr)
-    add_stub(type,jaddr,(int)out,i,addr,(int)i_regs,ccadj[i],reglist);
+    add_stub(type,jaddr,(int)out,i,addr,(pointer)i_regs,ccadj[i],reglist);
 }
 
 void pcrel_assemble(int i,struct regstat *i_regs)
@@ -3953,7 +3955,7 @@ void rjump_assemble(int i,struct regstat *i_regs)
     emit_addimm(sp,4,sp);
     emit_rorimm(sr,16,sr);
     assert(jaddr);
-    add_stub(LOADS_STUB,jaddr,(int)out,i,sp,(int)(&branch_regs[i]),ccadj[i],reglist);
+    add_stub(LOADS_STUB,jaddr,(int)out,i,sp,(pointer)(&branch_regs[i]),ccadj[i],reglist);
     store_regs_bt(branch_regs[i].regmap,branch_regs[i].dirty,-1);
     emit_addimm_and_set_flags(CLOCK_DIVIDER*(ccadj[i]+cycles[i]+cycles[i+1]),HOST_CCREG);
     add_stub(CC_STUB,(int)out,jump_vaddr_reg[slave][temp],0,i,-1,TAKEN,0);
@@ -4437,7 +4439,7 @@ void system_assemble(int i,struct regstat *i_regs)
     emit_writeword_indexed_map(sr,0,st,map,map);
     emit_rorimm(sr,16,sr);
     if(jaddr) {
-      add_stub(STOREL_STUB,jaddr,(int)out,i,st,(int)i_regs,ccadj[i],reglist);
+      add_stub(STOREL_STUB,jaddr,(int)out,i,st,(pointer)i_regs,ccadj[i],reglist);
     }
     emit_addimm(st,-4,st);
     store_regs_bt(i_regs->regmap,i_regs->dirty,-1);
@@ -4449,7 +4451,7 @@ void system_assemble(int i,struct regstat *i_regs)
     emit_rorimm(sr,16,sr);
     emit_writeword_indexed_map(sr,0,st,map,map);
     if(jaddr) {
-      add_stub(STOREL_STUB,jaddr,(int)out,i,st,(int)i_regs,ccadj[i],reglist);
+      add_stub(STOREL_STUB,jaddr,(int)out,i,st,(pointer)i_regs,ccadj[i],reglist);
     }
     // Load PC
     map=do_map_r(b,b,map,cache,0,-1,-1,0,0);
@@ -4457,7 +4459,7 @@ void system_assemble(int i,struct regstat *i_regs)
     emit_readword_indexed_map(0,b,map,t);
     emit_rorimm(t,16,t);
     if(jaddr)
-      add_stub(LOADL_STUB,jaddr,(int)out,i,t,(int)i_regs,ccadj[i],reglist);
+      add_stub(LOADL_STUB,jaddr,(int)out,i,t,(pointer)i_regs,ccadj[i],reglist);
     if(i_regs->regmap[HOST_CCREG]!=CCREG) {
       emit_loadreg(CCREG,HOST_CCREG);
     }
@@ -5238,11 +5240,6 @@ void sh2_dynarec_init()
   out=(u8 *)BASE_ADDR;
   #ifdef __arm__
   mprotect(out, 1<<TARGET_SIZE_2, PROT_READ | PROT_WRITE | PROT_EXEC);
-  #else
-  if (mmap (out, 1<<TARGET_SIZE_2,
-            PROT_READ | PROT_WRITE | PROT_EXEC,
-            MAP_FIXED | MAP_PRIVATE | MAP_ANONYMOUS,
-            -1, 0) == MAP_FAILED) {printf("mmap() failed\n");}
   #endif
   //for(n=0x80000;n<0x80800;n++)
   //  invalid_code[n]=1;
@@ -5259,10 +5256,6 @@ void sh2_dynarec_init()
   expirep=16384; // Expiry pointer, +2 blocks
   literalcount=0;
   stop_after_jal=0;
-  if (mmap ((void *)0x80000000, 4194304,
-            PROT_READ | PROT_WRITE,
-            MAP_FIXED | MAP_PRIVATE | MAP_ANONYMOUS,
-            -1, 0) == MAP_FAILED) {printf("mmap() failed\n");}
 
   // This has to be done after BiosRom etc are allocated
   for(n=0;n<1048576;n++) {
@@ -5323,7 +5316,6 @@ void sh2_dynarec_cleanup()
   #ifndef __arm__
   if (munmap ((void *)BASE_ADDR, 1<<TARGET_SIZE_2) < 0) {printf("munmap() failed\n");}
   #endif
-  munmap ((void *)0x80000000, 4194304);
   for(n=0;n<2048;n++) ll_clear(jump_in+n);
   for(n=0;n<2048;n++) ll_clear(jump_out+n);
   for(n=0;n<2048;n++) ll_clear(jump_dirty+n);
@@ -8225,7 +8217,43 @@ int SH2InterpreterGetInterrupts(SH2_struct *context,
 void SH2InterpreterSetInterrupts(SH2_struct *context, int num_interrupts,
                                  const interrupt_struct interrupts[MAX_INTERRUPTS]);
 
-int SH2DynarecInit(void) {return 0;}
+int SH2DynarecInit(void) {
+  #ifndef __arm__
+  void *cache;
+  #ifdef __x86_64__
+  // Blocks reach the globals below with 32-bit absolute and rip-relative
+  // operands, this only holds when they're linked into the low 2GB
+  if((pointer)(memory_map+1048576)>0x80000000||(pointer)(&master_cc+1)>0x80000000||
+     (pointer)(hash_table+65536)>0x80000000||(pointer)(shadow+sizeof(shadow))>0x80000000) {
+    printf("sh2_dynarec: globals outside the low 2GB, executable must be built without PIE\n");
+    return -1;
+  }
+  #endif
+  // Code pointers are stored as 32-bit values so the cache must be mapped at
+  // exactly BASE_ADDR, never on top of an existing mapping
+  #ifdef MAP_FIXED_NOREPLACE
+  cache=mmap((void *)BASE_ADDR, 1<<TARGET_SIZE_2,
+             PROT_READ | PROT_WRITE | PROT_EXEC,
+             MAP_FIXED_NOREPLACE | MAP_PRIVATE | MAP_ANONYMOUS,
+             -1, 0);
+  #else
+  cache=mmap((void *)BASE_ADDR, 1<<TARGET_SIZE_2,
+             PROT_READ | PROT_WRITE | PROT_EXEC,
+             MAP_PRIVATE | MAP_ANONYMOUS,
+             -1, 0);
+  #endif
+  if(cache==MAP_FAILED) {
+    printf("sh2_dynarec: mmap() of code cache failed\n");
+    return -1;
+  }
+  if(cache!=(void *)BASE_ADDR) {
+    printf("sh2_dynarec: code cache mapped at %p instead of %p\n",cache,(void *)BASE_ADDR);
+    munmap(cache, 1<<TARGET_SIZE_2);
+    return -1;
+  }
+  #endif
+  return 0;
+}
 
 void SH2DynarecDeInit() {
   sh2_dynarec_cleanup();
@@ -24,6 +24,8 @@
 #include "debug.h"
 #include "memory.h"
 #include "yabause.h"
+#include "sh2int.h"
+#include "error.h"
 
 #if defined(SH2_DYNAREC)
 #include "sh2_dynarec/sh2_dynarec.h"
@@ -82,7 +84,22 @@ int SH2Init(int coreid)
       }
    }
 
-   if ((SH2Core == NULL) || (SH2Core->Init() != 0)) {
+   if (SH2Core != NULL && SH2Core->Init() != 0)
+   {
+      if (SH2Core->id == SH2CORE_INTERPRETER)
+         SH2Core = NULL;
+      else
+      {
+         // Cores like the dynarec can fail to map their code cache, the
+         // interpreter always works so use it instead of failing the load
+         YabSetError(YAB_ERR_OTHER, "SH2 core failed to initialize, falling back to the interpreter");
+         SH2Core = &SH2Interpreter;
+         if (SH2Core->Init() != 0)
+            SH2Core = NULL;
+      }
+   }
+
+   if (SH2Core == NULL) {
       free(MSH2);
       free(SSH2);
       MSH2 = SSH2 = NULL;
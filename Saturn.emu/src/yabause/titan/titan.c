@@ -20,6 +20,7 @@
 #include "titan.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 /* private */
 typedef u32 (*TitanBlendFunc)(u32 top, u32 bottom);
@@ -41,6 +42,14 @@ static struct TitanContext {
    224
 };
 
+/* pixels a layer drew on another thread, composited later in draw order */
+struct TitanLayerRecord_struct {
+   u32 * pixel;
+   u8 * priority; /* 0 where the layer didn't draw */
+   u32 * linescreen[4];
+   int linescreenused;
+};
+
 #if defined WORDS_BIGENDIAN
 #ifdef USE_RGB_555
 static INLINE u32 TitanFixAlpha(u32 pixel) { return (((pixel >> 16) & 0xF800) | ((pixel >> 13) & 0x7C0) | ((pixel >> 10) & 0x3E)); }
@@ -269,6 +278,137 @@ void TitanPutPixel(int priority, s32 x, s32 y, u32 color, int linescreen)
    }
 }
 
+TitanLayerRecord * TitanLayerRecordNew(void)
+{
+   TitanLayerRecord * record;
+   int i;
+
+   if ((record = (TitanLayerRecord *)calloc(1, sizeof(TitanLayerRecord))) == NULL)
+      return NULL;
+
+   record->pixel = (u32 *)malloc(sizeof(u32) * 704 * 512);
+   record->priority = (u8 *)calloc(sizeof(u8), 704 * 512);
+   for(i = 1;i < 4;i++)
+      record->linescreen[i] = (u32 *)malloc(sizeof(u32) * 512);
+
+   if (!record->pixel || !record->priority || !record->linescreen[1] || !record->linescreen[2] || !record->linescreen[3])
+   {
+      TitanLayerRecordFree(record);
+      return NULL;
+   }
+
+   return record;
+}
+
+void TitanLayerRecordFree(TitanLayerRecord * record)
+{
+   int i;
+
+   if (record == NULL) return;
+
+   free(record->pixel);
+   free(record->priority);
+   for(i = 1;i < 4;i++)
+      free(record->linescreen[i]);
+   free(record);
+}
+
+void TitanLayerRecordPutLineHLine(TitanLayerRecord * record, int linescreen, s32 y, u32 color)
+{
+   if (linescreen == 0) return;
+
+   record->linescreen[linescreen][y] = color;
+   record->linescreenused |= 1 << linescreen;
+}
+
+/* Same as TitanPutPixel, but the blending with the framebuffer is left to
+   TitanLayerRecordReplay. Each layer draws a pixel at most once, so the
+   record only needs to keep the last color. */
+void TitanLayerRecordPutPixel(TitanLayerRecord * record, int priority, s32 x, s32 y, u32 color, int linescreen)
+{
+   if (priority == 0) return;
+
+   {
+      int pos = (y * tt_context.vdp2width) + x;
+      if (linescreen)
+      {
+         u32 * line = (record->linescreenused & (1 << linescreen)) ? record->linescreen[linescreen] : tt_context.linescreen[linescreen];
+         color = TitanBlendPixelsTop(color, line[y]);
+      }
+      record->pixel[pos] = color;
+      record->priority[pos] = priority;
+   }
+}
+
+/* Blend the recorded lines into the framebuffers. Lines are independent so
+   bands of them can be replayed on separate threads, records sharing a band
+   must be replayed in the order the layers were drawn. */
+void TitanLayerRecordReplay(TitanLayerRecord * record, s32 ystart, s32 yend)
+{
+   s32 x, y;
+   int i;
+
+   for (y = ystart; y < yend; y++)
+   {
+      int pos = y * tt_context.vdp2width;
+
+      for(i = 1;i < 4;i++)
+      {
+         if (record->linescreenused & (1 << i))
+            tt_context.linescreen[i][y] = record->linescreen[i][y];
+      }
+
+      for (x = 0; x < tt_context.vdp2width; x++, pos++)
+      {
+         int priority = record->priority[pos];
+         u32 color, * buffer;
+
+         if (priority == 0) continue;
+
+         record->priority[pos] = 0;
+         color = record->pixel[pos];
+         buffer = tt_context.vdp2framebuffer[priority] + pos;
+         if (tt_context.trans(color) && *buffer)
+            color = tt_context.blend(color, *buffer);
+         *buffer = color;
+      }
+   }
+}
+
+void TitanLayerRecordReset(TitanLayerRecord * record)
+{
+   record->linescreenused = 0;
+}
+
+int TitanLayersSize(void)
+{
+   return (8 * tt_context.vdp2width * tt_context.vdp2height) + (3 * 512);
+}
+
+void TitanSaveLayers(u32 * buffer)
+{
+   int size = tt_context.vdp2width * tt_context.vdp2height;
+   int i;
+
+   for(i = 0;i < 8;i++, buffer += size)
+      memcpy(buffer, tt_context.vdp2framebuffer[i], sizeof(u32) * size);
+
+   for(i = 1;i < 4;i++, buffer += 512)
+      memcpy(buffer, tt_context.linescreen[i], sizeof(u32) * 512);
+}
+
+void TitanLoadLayers(const u32 * buffer)
+{
+   int size = tt_context.vdp2width * tt_context.vdp2height;
+   int i;
+
+   for(i = 0;i < 8;i++, buffer += size)
+      memcpy(tt_context.vdp2framebuffer[i], buffer, sizeof(u32) * size);
+
+   for(i = 1;i < 4;i++, buffer += 512)
+      memcpy(tt_context.linescreen[i], buffer, sizeof(u32) * 512);
+}
+
 void TitanPutHLine(int priority, s32 x, s32 y, s32 width, u32 color)
 {
    if (priority == 0) return;
@@ -308,6 +448,18 @@ void TitanRender(pixel_t * dispbuffer)
    }
 }
 
+/* Like TitanRender, but also writes the pixels no layer covers, for
+   buffers that don't keep their contents from the previous frame */
+void TitanRenderFull(pixel_t * dispbuffer)
+{
+   int i;
+
+   for (i = 0; i < (tt_context.vdp2width * tt_context.vdp2height); i++)
+   {
+      dispbuffer[i] = TitanFixAlpha(TitanDigPixel(7, i));
+   }
+}
+
 #ifdef WORDS_BIGENDIAN
 void TitanWriteColor(pixel_t * dispbuffer, s32 bufwidth, s32 x, s32 y, u32 color)
 {
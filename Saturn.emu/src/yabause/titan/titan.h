@@ -43,7 +43,24 @@ void TitanPutHLine(int priority, s32 x, s32 y, s32 width, u32 color);
 
 void TitanPutShadow(int priority, s32 x, s32 y);
 
+/* Layers drawn on worker threads write to a record instead of the
+   framebuffers, records are then replayed in the original draw order */
+typedef struct TitanLayerRecord_struct TitanLayerRecord;
+
+TitanLayerRecord * TitanLayerRecordNew(void);
+void TitanLayerRecordFree(TitanLayerRecord * record);
+void TitanLayerRecordPutLineHLine(TitanLayerRecord * record, int linescreen, s32 y, u32 color);
+void TitanLayerRecordPutPixel(TitanLayerRecord * record, int priority, s32 x, s32 y, u32 color, int linescreen);
+void TitanLayerRecordReplay(TitanLayerRecord * record, s32 ystart, s32 yend);
+void TitanLayerRecordReset(TitanLayerRecord * record);
+
+/* Copies of the framebuffers & line screens at the current resolution */
+int TitanLayersSize(void);
+void TitanSaveLayers(u32 * buffer);
+void TitanLoadLayers(const u32 * buffer);
+
 void TitanRender(pixel_t * dispbuffer);
+void TitanRenderFull(pixel_t * dispbuffer);
 
 void TitanWriteColor(pixel_t * dispbuffer, s32 bufwidth, s32 x, s32 y, u32 color);
 
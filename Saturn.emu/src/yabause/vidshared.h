@@ -179,6 +179,9 @@ typedef struct
    u32 LineColorBase;
    
    void (*LoadLineParams)(void *, int line);
+
+   // Software renderer layers drawn on a worker thread, NULL otherwise
+   struct TitanLayerRecord_struct * titanrecord;
 } vdp2draw_struct;
 
 
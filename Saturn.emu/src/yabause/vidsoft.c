@@ -38,6 +38,8 @@
 
 #include <stdlib.h>
 #include <limits.h>
+#include <stdio.h>
+#include <pthread.h>
 
 #if defined(__APPLE__)
 // malloc pointers always 16-byte aligned
@@ -623,6 +625,26 @@ static INLINE void SetupScreenVars(vdp2draw_struct *info, screeninfo_struct *sin
 
 //////////////////////////////////////////////////////////////////////////////
 
+static INLINE void Vdp2PutPixel(vdp2draw_struct * info, s32 x, s32 y, u32 color)
+{
+   if (info->titanrecord)
+      TitanLayerRecordPutPixel(info->titanrecord, info->priority, x, y, color, info->linescreen);
+   else
+      TitanPutPixel(info->priority, x, y, color, info->linescreen);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static INLINE void Vdp2PutLineHLine(vdp2draw_struct * info, s32 y, u32 color)
+{
+   if (info->titanrecord)
+      TitanLayerRecordPutLineHLine(info->titanrecord, info->linescreen, y, color);
+   else
+      TitanPutLineHLine(info->linescreen, y, color);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 static u8 FASTCALL GetAlpha(vdp2draw_struct * info, u32 color)
 {
    if (((info->specialcolormode == 1) || (info->specialcolormode == 2)) && ((info->specialcolorfunction & 1) == 0)) {
@@ -642,6 +664,23 @@ static u8 FASTCALL GetAlpha(vdp2draw_struct * info, u32 color)
 
 //////////////////////////////////////////////////////////////////////////////
 
+// filled in VIDSoftInit, layers can be drawn from several threads
+static int mosaic_table[16][1024];
+
+static void InitMosaicTable(void)
+{
+   int i, j;
+
+   for(i=0;i<16;i++)
+   {
+      int m = i+1;
+      for(j=0;j<1024;j++)
+         mosaic_table[i][j] = j/m*m;
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 static void FASTCALL Vdp2DrawScroll(vdp2draw_struct *info)
 {
    int i, j;
@@ -667,22 +706,8 @@ static void FASTCALL Vdp2DrawScroll(vdp2draw_struct *info)
    ReadLineWindowData(&info->islinewindow, info->wctl, &linewnd0addr, &linewnd1addr);
    /* color calculation window: in => no color calc, out => color calc */
    ReadWindowData(Vdp2Regs->WCTLD >> 8, colorcalcwindow);
-   {
-	   static int tables_initialized = 0;
-	   static int mosaic_table[16][1024];
-	   if(!tables_initialized)
-	   {
-		   tables_initialized = 1;
-			for(i=0;i<16;i++)
-			{
-				int m = i+1;
-				for(j=0;j<1024;j++)
-					mosaic_table[i][j] = j/m*m;
-			}
-	   }
-	   mosaic_x = mosaic_table[info->mosaicxmask-1];
-	   mosaic_y = mosaic_table[info->mosaicymask-1];
-   }
+   mosaic_x = mosaic_table[info->mosaicxmask-1];
+   mosaic_y = mosaic_table[info->mosaicymask-1];
 
    for (j = 0; j < vdp2height; j++)
    {
@@ -786,7 +811,7 @@ static void FASTCALL Vdp2DrawScroll(vdp2draw_struct *info)
             else
                alpha = GetAlpha(info, color);
 
-            TitanPutPixel(info->priority, i, j, info->PostPixelFetchCalc(info, COLSAT2YAB32(alpha, color)), info->linescreen);
+            Vdp2PutPixel(info, i, j, info->PostPixelFetchCalc(info, COLSAT2YAB32(alpha, color)));
          }
       }
    }    
@@ -861,7 +886,7 @@ static void FASTCALL Vdp2DrawRotationFP(vdp2draw_struct *info, vdp2rotationparam
                   continue;
                }
 
-               TitanPutPixel(info->priority, i, j, info->PostPixelFetchCalc(info, COLSAT2YAB32(GetAlpha(info, color), color)), info->linescreen);
+               Vdp2PutPixel(info, i, j, info->PostPixelFetchCalc(info, COLSAT2YAB32(GetAlpha(info, color), color)));
             }
             xmul += p->deltaXst;
             ymul += p->deltaYst;
@@ -956,7 +981,7 @@ static void FASTCALL Vdp2DrawRotationFP(vdp2draw_struct *info, vdp2rotationparam
             lineColorAddr = (T1ReadWord(Vdp2Ram, lineAddr) & 0x780) | p->linescreen;
             lineColor = Vdp2ColorRamGetColor(lineColorAddr);
             lineAddr += lineInc;
-            TitanPutLineHLine(info->linescreen, j, COLSAT2YAB32(0x3F, lineColor));
+            Vdp2PutLineHLine(info, j, COLSAT2YAB32(0x3F, lineColor));
          }
 
          info->LoadLineParams(info, j);
@@ -1059,7 +1084,7 @@ static void FASTCALL Vdp2DrawRotationFP(vdp2draw_struct *info, vdp2rotationparam
                continue;
             }
 
-            TitanPutPixel(info->priority, i, j, info->PostPixelFetchCalc(info, COLSAT2YAB32(GetAlpha(info, color), color)), info->linescreen);
+            Vdp2PutPixel(info, i, j, info->PostPixelFetchCalc(info, COLSAT2YAB32(GetAlpha(info, color), color)));
          }
          xmul += p->deltaXst;
          ymul += p->deltaYst;
@@ -1187,11 +1212,12 @@ static void LoadLineParamsNBG0(vdp2draw_struct * info, int line)
 
 //////////////////////////////////////////////////////////////////////////////
 
-static void Vdp2DrawNBG0(void)
+static void Vdp2DrawNBG0(TitanLayerRecord * record)
 {
    vdp2draw_struct info;
    vdp2rotationparameterfp_struct parameter[2];
 
+   info.titanrecord = record;
    parameter[0].PlaneAddr = (void FASTCALL (*)(void *, int))&Vdp2ParameterAPlaneAddr;
    parameter[1].PlaneAddr = (void FASTCALL (*)(void *, int))&Vdp2ParameterBPlaneAddr;
 
@@ -1335,10 +1361,11 @@ static void LoadLineParamsNBG1(vdp2draw_struct * info, int line)
 
 //////////////////////////////////////////////////////////////////////////////
 
-static void Vdp2DrawNBG1(void)
+static void Vdp2DrawNBG1(TitanLayerRecord * record)
 {
    vdp2draw_struct info;
 
+   info.titanrecord = record;
    info.enable = Vdp2Regs->BGON & 0x2;
    info.transparencyenable = !(Vdp2Regs->BGON & 0x200);
    info.specialprimode = (Vdp2Regs->SFPRMD >> 2) & 0x3;
@@ -1436,10 +1463,11 @@ static void LoadLineParamsNBG2(vdp2draw_struct * info, int line)
 
 //////////////////////////////////////////////////////////////////////////////
 
-static void Vdp2DrawNBG2(void)
+static void Vdp2DrawNBG2(TitanLayerRecord * record)
 {
    vdp2draw_struct info;
 
+   info.titanrecord = record;
    info.enable = Vdp2Regs->BGON & 0x4;
    info.transparencyenable = !(Vdp2Regs->BGON & 0x400);
    info.specialprimode = (Vdp2Regs->SFPRMD >> 4) & 0x3;
@@ -1503,10 +1531,11 @@ static void LoadLineParamsNBG3(vdp2draw_struct * info, int line)
 
 //////////////////////////////////////////////////////////////////////////////
 
-static void Vdp2DrawNBG3(void)
+static void Vdp2DrawNBG3(TitanLayerRecord * record)
 {
    vdp2draw_struct info;
 
+   info.titanrecord = record;
    info.enable = Vdp2Regs->BGON & 0x8;
    info.transparencyenable = !(Vdp2Regs->BGON & 0x800);
    info.specialprimode = (Vdp2Regs->SFPRMD >> 6) & 0x3;
@@ -1572,11 +1601,12 @@ static void LoadLineParamsRBG0(vdp2draw_struct * info, int line)
 
 //////////////////////////////////////////////////////////////////////////////
 
-static void Vdp2DrawRBG0(void)
+static void Vdp2DrawRBG0(TitanLayerRecord * record)
 {
    vdp2draw_struct info;
    vdp2rotationparameterfp_struct parameter[2];
 
+   info.titanrecord = record;
    parameter[0].PlaneAddr = (void FASTCALL (*)(void *, int))&Vdp2ParameterAPlaneAddr;
    parameter[1].PlaneAddr = (void FASTCALL (*)(void *, int))&Vdp2ParameterBPlaneAddr;
 
@@ -1692,11 +1722,294 @@ static void LoadLineParamsSprite(vdp2draw_struct * info, int line)
 
 //////////////////////////////////////////////////////////////////////////////
 
+// VDP2 layers can be drawn on a pool of threads. Each layer then writes to
+// its own Titan record and the records are blended into the framebuffers in
+// the same order the single threaded path draws them, so the output doesn't
+// depend on the thread count.
+
+#define VIDSOFT_NUM_LAYERS         5
+#define VIDSOFT_MAX_LAYER_THREADS  VIDSOFT_NUM_LAYERS
+
+typedef void (*Vdp2DrawLayer_func)(TitanLayerRecord *);
+
+static int layerthreads = 1;
+static int layerthreadsrunning = 0;
+static int layerthreadsquit = 0;
+static pthread_t layerthread[VIDSOFT_MAX_LAYER_THREADS - 1];
+static pthread_mutex_t layermutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t layerstartcond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t layerdonecond = PTHREAD_COND_INITIALIZER;
+static void (*layertask)(int);
+static int layertaskgen, layertaskcount, layertasknext, layertasksdone;
+
+static TitanLayerRecord * layerrecord[VIDSOFT_NUM_LAYERS];
+static Vdp2DrawLayer_func layerdraw[VIDSOFT_NUM_LAYERS];
+static int layercount;
+
+static int layerthreadsvalidate = 0;
+static int layervalidateframe;
+static int layervalidatesize;
+static u32 * layervalidatebuffer[2];
+
+// Runs the remaining tasks, must be called with layermutex locked
+static void RunLayerTasks(void)
+{
+   while (layertasknext < layertaskcount)
+   {
+      void (*task)(int) = layertask;
+      int i = layertasknext++;
+
+      pthread_mutex_unlock(&layermutex);
+      task(i);
+      pthread_mutex_lock(&layermutex);
+      if (++layertasksdone == layertaskcount)
+         pthread_cond_signal(&layerdonecond);
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void * LayerThreadFunc(UNUSED void * arg)
+{
+   int gen;
+
+   pthread_mutex_lock(&layermutex);
+   gen = layertaskgen;
+   for (;;)
+   {
+      while (!layerthreadsquit && layertaskgen == gen)
+         pthread_cond_wait(&layerstartcond, &layermutex);
+      if (layerthreadsquit)
+         break;
+      gen = layertaskgen;
+      RunLayerTasks();
+   }
+   pthread_mutex_unlock(&layermutex);
+   return NULL;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+// Runs task(0) to task(count - 1) on the pool and the calling thread,
+// returning once all of them are done
+static void DispatchLayerTasks(void (*task)(int), int count)
+{
+   pthread_mutex_lock(&layermutex);
+   layertask = task;
+   layertaskcount = count;
+   layertasknext = 0;
+   layertasksdone = 0;
+   layertaskgen++;
+   pthread_cond_broadcast(&layerstartcond);
+   RunLayerTasks();
+   while (layertasksdone < layertaskcount)
+      pthread_cond_wait(&layerdonecond, &layermutex);
+   pthread_mutex_unlock(&layermutex);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void StopLayerThreads(void)
+{
+   int i;
+
+   pthread_mutex_lock(&layermutex);
+   layerthreadsquit = 1;
+   pthread_cond_broadcast(&layerstartcond);
+   pthread_mutex_unlock(&layermutex);
+
+   for (i = 0; i < layerthreadsrunning; i++)
+      pthread_join(layerthread[i], NULL);
+
+   layerthreadsrunning = 0;
+   layerthreadsquit = 0;
+
+   for (i = 0; i < VIDSOFT_NUM_LAYERS; i++)
+   {
+      TitanLayerRecordFree(layerrecord[i]);
+      layerrecord[i] = NULL;
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void StartLayerThreads(void)
+{
+   int i;
+
+   if (layerthreads < 2)
+      return;
+
+   for (i = 0; i < VIDSOFT_NUM_LAYERS; i++)
+   {
+      if ((layerrecord[i] = TitanLayerRecordNew()) == NULL)
+      {
+         StopLayerThreads();
+         return;
+      }
+   }
+
+   for (i = 0; i < layerthreads - 1; i++)
+   {
+      if (pthread_create(&layerthread[i], NULL, LayerThreadFunc, NULL) != 0)
+         break;
+      layerthreadsrunning++;
+   }
+
+   if (layerthreadsrunning == 0)
+      StopLayerThreads();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void DrawLayerTask(int i)
+{
+   layerdraw[i](layerrecord[i]);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void ReplayLayerTask(int band)
+{
+   int bands = layerthreadsrunning + 1;
+   int ystart = vdp2height * band / bands;
+   int yend = vdp2height * (band + 1) / bands;
+   int i;
+
+   for (i = 0; i < layercount; i++)
+      TitanLayerRecordReplay(layerrecord[i], ystart, yend);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void Vdp2DrawLayers(int threaded)
+{
+   int i;
+
+   layercount = 0;
+   for (i = 7; i > 0; i--)
+   {
+      if (nbg3priority == i)
+         layerdraw[layercount++] = Vdp2DrawNBG3;
+      if (nbg2priority == i)
+         layerdraw[layercount++] = Vdp2DrawNBG2;
+      if (nbg1priority == i)
+         layerdraw[layercount++] = Vdp2DrawNBG1;
+      if (nbg0priority == i)
+         layerdraw[layercount++] = Vdp2DrawNBG0;
+      if (rbg0priority == i)
+         layerdraw[layercount++] = Vdp2DrawRBG0;
+   }
+
+   if (threaded && layerthreadsrunning && layercount > 1)
+   {
+      DispatchLayerTasks(DrawLayerTask, layercount);
+      // barrier, then composite bands of lines in parallel
+      DispatchLayerTasks(ReplayLayerTask, layerthreadsrunning + 1);
+      for (i = 0; i < layercount; i++)
+         TitanLayerRecordReset(layerrecord[i]);
+   }
+   else
+   {
+      for (i = 0; i < layercount; i++)
+         layerdraw[i](NULL);
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+// Draws the frame both ways from the same starting framebuffers and keeps
+// the single threaded result, reporting the first difference
+static void Vdp2DrawLayersValidated(void)
+{
+   int size = TitanLayersSize();
+   int layersize = vdp2width * vdp2height;
+   int i;
+
+   if (size > layervalidatesize)
+   {
+      for (i = 0; i < 2; i++)
+      {
+         free(layervalidatebuffer[i]);
+         if ((layervalidatebuffer[i] = (u32 *)malloc(sizeof(u32) * size)) == NULL)
+         {
+            free(layervalidatebuffer[0]);
+            layervalidatebuffer[0] = NULL;
+            layervalidatesize = 0;
+            layerthreadsvalidate = 0;
+            YuiErrorMsg("Not enough memory to validate VDP2 layer threads\n");
+            Vdp2DrawLayers(1);
+            return;
+         }
+      }
+      layervalidatesize = size;
+   }
+
+   TitanSaveLayers(layervalidatebuffer[0]);
+   Vdp2DrawLayers(1);
+   TitanSaveLayers(layervalidatebuffer[1]);
+   TitanLoadLayers(layervalidatebuffer[0]);
+   Vdp2DrawLayers(0);
+   TitanSaveLayers(layervalidatebuffer[0]);
+   layervalidateframe++;
+
+   for (i = 0; i < size; i++)
+   {
+      if (layervalidatebuffer[0][i] != layervalidatebuffer[1][i])
+      {
+         char msg[256];
+
+         if (i < 8 * layersize)
+            sprintf(msg, "VDP2 layer threads mismatch on frame %d: priority %d x %d y %d threaded:%08X single:%08X\n",
+               layervalidateframe, i / layersize, (i % layersize) % vdp2width, (i % layersize) / vdp2width,
+               (unsigned int)layervalidatebuffer[1][i], (unsigned int)layervalidatebuffer[0][i]);
+         else
+            sprintf(msg, "VDP2 layer threads mismatch on frame %d: line screen %d y %d threaded:%08X single:%08X\n",
+               layervalidateframe, (i - 8 * layersize) / 512 + 1, (i - 8 * layersize) % 512,
+               (unsigned int)layervalidatebuffer[1][i], (unsigned int)layervalidatebuffer[0][i]);
+         YuiErrorMsg(msg);
+         break;
+      }
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void VIDSoftSetNumLayerThreads(int num)
+{
+   if (num < 1)
+      num = 1;
+   else if (num > VIDSOFT_MAX_LAYER_THREADS)
+      num = VIDSOFT_MAX_LAYER_THREADS;
+
+   if (num == layerthreads)
+      return;
+
+   layerthreads = num;
+   if (dispbuffer)
+   {
+      StopLayerThreads();
+      StartLayerThreads();
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void VIDSoftSetLayerThreadsValidate(int enable)
+{
+   layerthreadsvalidate = enable;
+   layervalidateframe = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 int VIDSoftInit(void)
 {
    if (TitanInit() == -1)
       return -1;
 
+   InitMosaicTable();
+
    if ((dispbuffer = (pixel_t *)memalign(8, sizeof(pixel_t) * 704 * 512)) == NULL)
       return -1;
 
@@ -1713,6 +2026,8 @@ int VIDSoftInit(void)
    vdp2width = 320;
    vdp2height = 224;
 
+   StartLayerThreads();
+
 #ifdef USE_OPENGL
    glClear(GL_COLOR_BUFFER_BIT);
 
@@ -1734,6 +2049,12 @@ int VIDSoftInit(void)
 
 void VIDSoftDeInit(void)
 {
+   StopLayerThreads();
+   free(layervalidatebuffer[0]);
+   free(layervalidatebuffer[1]);
+   layervalidatebuffer[0] = layervalidatebuffer[1] = NULL;
+   layervalidatesize = 0;
+
    if (dispbuffer)
    {
       free(dispbuffer);
@@ -2845,6 +3166,7 @@ void VIDSoftVdp2DrawEnd(void)
    u32 linewnd0addr, linewnd1addr;
    int wctl;
    clipping_struct colorcalcwindow[2];
+   pixel_t *renderbuffer;
 
    // Figure out whether to draw vdp1 framebuffer or vdp2 framebuffer pixels
    // based on priority
@@ -3075,12 +3397,18 @@ void VIDSoftVdp2DrawEnd(void)
          }
       }
    }
-   TitanRender(dispbuffer);
+   if ((renderbuffer = YuiGetDisplayBuffer(vdp2width, vdp2height)) != NULL)
+      TitanRenderFull(renderbuffer);
+   else
+   {
+      renderbuffer = dispbuffer;
+      TitanRender(renderbuffer);
+   }
 
    VIDSoftVdp1SwapFrameBuffer();
 
    if (OSDUseBuffer())
-      OSDDisplayMessages(dispbuffer, vdp2width, vdp2height);
+      OSDDisplayMessages(renderbuffer, vdp2width, vdp2height);
 
 #ifdef USE_OPENGL	
 	if (vdp2height == 224)
@@ -3090,7 +3418,7 @@ void VIDSoftVdp2DrawEnd(void)
 
    glRasterPos2i(0, outputheight * i / vdp2height);
    glPixelZoom((float)outputwidth / (float)vdp2width, 0 - ((float)outputheight / (float)(vdp2height+i+i)));
-   glDrawPixels(vdp2width, vdp2height, GL_RGBA, GL_UNSIGNED_BYTE, dispbuffer);
+   glDrawPixels(vdp2width, vdp2height, GL_RGBA, GL_UNSIGNED_BYTE, renderbuffer);
 
    if (! OSDUseBuffer())
       OSDDisplayMessages(NULL, -1, -1);
@@ -3103,8 +3431,6 @@ void VIDSoftVdp2DrawEnd(void)
 
 void VIDSoftVdp2DrawScreens(void)
 {
-   int i;
-
    VIDSoftVdp2SetResolution(Vdp2Regs->TVMD);
    VIDSoftVdp2SetPriorityNBG0(Vdp2Regs->PRINA & 0x7);
    VIDSoftVdp2SetPriorityNBG1((Vdp2Regs->PRINA >> 8) & 0x7);
@@ -3112,19 +3438,10 @@ void VIDSoftVdp2DrawScreens(void)
    VIDSoftVdp2SetPriorityNBG3((Vdp2Regs->PRINB >> 8) & 0x7);
    VIDSoftVdp2SetPriorityRBG0(Vdp2Regs->PRIR & 0x7);
 
-   for (i = 7; i > 0; i--)
-   {   
-      if (nbg3priority == i)
-         Vdp2DrawNBG3();
-      if (nbg2priority == i)
-         Vdp2DrawNBG2();
-      if (nbg1priority == i)
-         Vdp2DrawNBG1();
-      if (nbg0priority == i)
-         Vdp2DrawNBG0();
-      if (rbg0priority == i)
-         Vdp2DrawRBG0();
-   }
+   if (layerthreadsvalidate && layerthreadsrunning)
+      Vdp2DrawLayersValidated();
+   else
+      Vdp2DrawLayers(1);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -3140,19 +3457,19 @@ void VIDSoftVdp2DrawScreen(int screen)
    switch(screen)
    {
       case 0:
-         Vdp2DrawNBG0();
+         Vdp2DrawNBG0(NULL);
          break;
       case 1:
-         Vdp2DrawNBG1();
+         Vdp2DrawNBG1(NULL);
          break;
       case 2:
-         Vdp2DrawNBG2();
+         Vdp2DrawNBG2(NULL);
          break;
       case 3:
-         Vdp2DrawNBG3();
+         Vdp2DrawNBG3(NULL);
          break;
       case 4:
-         Vdp2DrawRBG0();
+         Vdp2DrawRBG0(NULL);
          break;
    }
 }
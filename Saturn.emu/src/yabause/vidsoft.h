@@ -30,4 +30,9 @@ extern VideoInterface_struct VIDSoft;
 
 void VIDSoftVdp2DrawScreen(int screen);
 
+// Number of threads drawing VDP2 layers, including the emulation thread
+void VIDSoftSetNumLayerThreads(int num);
+// Also draw each frame single threaded & report any difference
+void VIDSoftSetLayerThreadsValidate(int enable);
+
 #endif
@@ -82,6 +82,7 @@
 //////////////////////////////////////////////////////////////////////////////
 
 yabsys_struct yabsys;
+void (*YabauseLineEndHook)(void) = NULL;
 const char *bupfilename = NULL;
 u64 tickfreq;
 
@@ -538,6 +539,9 @@ int YabauseEmulate(void) {
 
       if (!yabsys.DecilineMode || yabsys.DecilineCount == 10)
       {
+         if (YabauseLineEndHook)
+            YabauseLineEndHook();
+
          // HBlankOUT
          PROFILE_START("hblankout");
          Vdp2HBlankOUT();
@@ -99,6 +99,9 @@ typedef struct
 
 extern yabsys_struct yabsys;
 
+// Called at the end of every line once both SH2s have run, before HBlankOUT
+extern void (*YabauseLineEndHook)(void);
+
 int YabauseEmulate(void);
 
 #endif
@@ -36,6 +36,11 @@ void YuiErrorMsg(const char *string);
    up being moved to the Video Core. */
 void YuiSwapBuffers(void);
 
+/* Returns a buffer with a pitch of width pixels that the video core can
+   render the next frame into instead of its own display buffer, or NULL
+   if it should use its own. The frame is finished by YuiSwapBuffers. */
+pixel_t *YuiGetDisplayBuffer(int width, int height);
+
 //////////////////////////////////////////////////////////////////////////////
 // Helper functions(you can use these in your own port)
 //////////////////////////////////////////////////////////////////////////////
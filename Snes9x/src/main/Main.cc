@@ -28,6 +28,13 @@ static uint heightChangeFrames = heightChangeFrameDelay;
 bool EmuSystem::hasCheats = true;
 bool EmuSystem::hasPALVideoSystem = true;
 bool EmuSystem::hasResetModes = true;
+#ifndef SNES9X_VERSION_1_4
+#ifdef ZLIB
+EmuSystem::StateFileFormat EmuSystem::stateFileFormat = StateFileFormat::GZIP;
+#else
+EmuSystem::StateFileFormat EmuSystem::stateFileFormat = StateFileFormat::RAW;
+#endif
+#endif
 
 EmuSystem::NameFilterFunc EmuSystem::defaultFsFilter =
 	[](const char *name)
@@ -81,8 +88,7 @@ bool8 S9xDeinitUpdate(int width, int height, bool8)
 	IG::Pixmap srcPix = {{{width, height}, pixFmt}, GFX.Screen};
 	emuVideo->startFrameWithFormat(emuSysTask, srcPix);
 	#ifndef SNES9X_VERSION_1_4
-	memset(GFX.ZBuffer, 0, GFX.ScreenSize);
-	memset(GFX.SubZBuffer, 0, GFX.ScreenSize);
+	S9xAdvanceDepthEpoch();
 	#endif
 	return 1;
 }
@@ -142,6 +148,23 @@ EmuSystem::Error EmuSystem::loadState(const char *path)
 		return EmuSystem::makeFileReadError();
 }
 
+#ifndef SNES9X_VERSION_1_4
+EmuSystem::Error EmuSystem::saveStateToBuffer(std::vector<uint8_t> &buff)
+{
+	buff.resize(S9xFreezeSize());
+	S9xFreezeGameMem(buff.data(), buff.size());
+	return {};
+}
+
+EmuSystem::Error EmuSystem::loadStateFromBuffer(IG::ConstBufferView buff)
+{
+	if(S9xUnfreezeGameMem((const uint8*)buff.data(), buff.size()) != SUCCESS)
+		return EmuSystem::makeError("Error reading state from memory");
+	IPPU.RenderThisFrame = TRUE;
+	return {};
+}
+#endif
+
 void EmuSystem::saveBackupMem() // for manually saving when not closing game
 {
 	if(gameIsRunning())
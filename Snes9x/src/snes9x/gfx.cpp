@@ -57,6 +57,7 @@ bool8 S9xGraphicsInit (void)
 	GFX.SubScreen  = (uint16 *) calloc(GFX.ScreenSize, sizeof(uint16));
 	GFX.ZBuffer    = (uint8 *)  calloc(GFX.ScreenSize, 1);
 	GFX.SubZBuffer = (uint8 *)  calloc(GFX.ScreenSize, 1);
+	GFX.DepthBase  = 0;
 
 	if (!GFX.ZERO || !GFX.SubScreen || !GFX.ZBuffer || !GFX.SubZBuffer)
 	{
@@ -148,6 +149,19 @@ void S9xGraphicsScreenResize (void)
 	}	
 }
 
+// Depths drawn in a frame stay below 64, so instead of clearing both Z-buffers
+// for every frame, each frame draws 64 higher than the last and older depths
+// compare as if cleared. The buffers only need clearing when the base wraps.
+void S9xAdvanceDepthEpoch (void)
+{
+	GFX.DepthBase += 64;
+	if (GFX.DepthBase == 0)
+	{
+		memset(GFX.ZBuffer, 0, GFX.ScreenSize);
+		memset(GFX.SubZBuffer, 0, GFX.ScreenSize);
+	}
+}
+
 void S9xBuildDirectColourMaps (void)
 {
 	IPPU.XB = mul_brightness[PPU.Brightness];
@@ -323,7 +337,7 @@ static inline void RenderScreen (bool8 sub)
 		GFX.DB = GFX.ZBuffer;
 		GFX.Clip = IPPU.Clip[0];
 		BGActive = Memory.FillRAM[0x212c] & ~Settings.BG_Forced;
-		D = 32;
+		D = GFX.DepthBase + 32;
 	}
 	else
 	{
@@ -331,7 +345,7 @@ static inline void RenderScreen (bool8 sub)
 		GFX.DB = GFX.SubZBuffer;
 		GFX.Clip = IPPU.Clip[1];
 		BGActive = Memory.FillRAM[0x212d] & ~Settings.BG_Forced;
-		D = (Memory.FillRAM[0x2130] & 2) << 4; // 'do math' depth flag
+		D = GFX.DepthBase + ((Memory.FillRAM[0x2130] & 2) << 4); // 'do math' depth flag
 	}
 
 	if (BGActive & 0x10)
@@ -787,7 +801,7 @@ static void DrawOBJS (int D)
 
 	int	PixWidth = IPPU.DoubleWidthPixels ? 2 : 1;
 	BG.InterlaceLine = GFX.InterlaceFrame ? 8 : 0;
-	GFX.Z1 = 2;
+	GFX.Z1 = GFX.DepthBase + 2;
 	int sprite_limit = (Settings.MaxSpriteTilesPerLine == 128) ? 128 : 32;
 
 	for (uint32 Y = GFX.StartY, Offset = Y * GFX.PPL; Y <= GFX.EndY; Y++, Offset += GFX.PPL)
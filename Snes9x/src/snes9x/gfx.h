@@ -48,6 +48,7 @@ struct SGFX
 	const uint16	*RealScreenColors;	// screen colors, ignoring color window clipping
 	uint8	Z1;					// depth for comparison
 	uint8	Z2;					// depth to save
+	uint8	DepthBase;			// added to all depths drawn this frame, see S9xAdvanceDepthEpoch()
 	uint32	FixedColour;
 	uint8	DoInterlace;
 	uint8	InterlaceFrame;
@@ -208,6 +209,7 @@ void RenderLine (uint8);
 void S9xComputeClipWindows (void);
 void S9xDisplayChar (uint16 *, uint8);
 void S9xGraphicsScreenResize (void);
+void S9xAdvanceDepthEpoch (void);
 // called automatically unless Settings.AutoDisplayMessages is false
 void S9xDisplayMessages (uint16 *, int, int, int, int);
 
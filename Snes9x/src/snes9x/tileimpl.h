@@ -141,6 +141,10 @@ namespace TileImpl {
 	};
 
 
+	// The sub screen's 'do math' depth flag (0x20 above the frame's depth base).
+	// Depths left over from earlier frames are below the base and never match.
+	#define SUB_DO_MATH(SD)	((SD) >= GFX.DepthBase + 0x20)
+
 	struct NOMATH
 	{
 		static alwaysinline uint16 Calc(uint16 Main, uint16 Sub, uint8 SD)
@@ -155,7 +159,7 @@ namespace TileImpl {
 	{
 		static alwaysinline uint16 Calc(uint16 Main, uint16 Sub, uint8 SD)
 		{
-			return Op::fn(Main, (SD & 0x20) ? Sub : GFX.FixedColour);
+			return Op::fn(Main, SUB_DO_MATH(SD) ? Sub : GFX.FixedColour);
 		}
 	};
 	typedef REGMATH<COLOR_ADD> Blend_Add;
@@ -178,7 +182,7 @@ namespace TileImpl {
 	{
 		static alwaysinline uint16 Calc(uint16 Main, uint16 Sub, uint8 SD)
 		{
-			return GFX.ClipColors ? REGMATH<Op>::Calc(Main, Sub, SD) : (SD & 0x20) ? Op::fn1_2(Main, Sub) : Op::fn(Main, GFX.FixedColour);
+			return GFX.ClipColors ? REGMATH<Op>::Calc(Main, Sub, SD) : SUB_DO_MATH(SD) ? Op::fn1_2(Main, Sub) : Op::fn(Main, GFX.FixedColour);
 		}
 	};
 	typedef MATHS1_2<COLOR_ADD> Blend_AddS1_2;
@@ -468,8 +472,8 @@ namespace TileImpl {
 	// (or interlace at all, really).
 	// The backdrop is always depth = 1, so Z1 = Z2 = 1. And backdrop is always color 0.
 
-	#define Z1				1
-	#define Z2				1
+	#define Z1				(GFX.DepthBase + 1)
+	#define Z2				(GFX.DepthBase + 1)
 	#define Pix				0
 
 	template<class PIXEL>
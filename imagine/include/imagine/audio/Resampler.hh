@@ -0,0 +1,80 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+
+#include <imagine/config/defs.hh>
+#include <memory>
+#include <vector>
+
+namespace IG::Audio
+{
+
+// Windowed-sinc polyphase resampler for interleaved int16 or float frames.
+// Input is always fully consumed and the ratio can be adjusted between
+// calls without a discontinuity, so it can follow a varying source rate.
+class Resampler
+{
+public:
+	static constexpr uint32_t TAPS = 32;
+	static constexpr uint32_t PHASES = 256;
+
+	Resampler() {}
+	Resampler(uint32_t inputRate, uint32_t outputRate, uint8_t channels);
+	void setRates(uint32_t inputRate, uint32_t outputRate);
+	// scale the output rate by a factor close to 1, like for rate control,
+	// without redesigning the filter
+	void setRatioAdjust(double adjust);
+	// scale applied to the input samples
+	void setGain(float gain);
+	// input frames allowed to wait for output space beyond what the filter
+	// needs, the oldest are dropped past this, 0 for no limit
+	void setMaxBacklog(uint32_t frames);
+	// input frames needed for the given output frames at the unadjusted ratio
+	uint32_t inputFramesFor(uint32_t outputFrames) const;
+	// input frames dropped over the backlog limit since the last reset()
+	uint32_t droppedFrames() const { return droppedFrames_; }
+	void reset();
+	// upper bound on the frames the next process() call can output
+	uint32_t maxOutputFrames(uint32_t inputFrames) const;
+	uint32_t process(const int16_t *in, uint32_t inputFrames, int16_t *out, uint32_t maxOutFrames);
+	uint32_t process(const float *in, uint32_t inputFrames, float *out, uint32_t maxOutFrames);
+	uint32_t process(const int16_t *in, uint32_t inputFrames, float *out, uint32_t maxOutFrames);
+	uint32_t process(const float *in, uint32_t inputFrames, int16_t *out, uint32_t maxOutFrames);
+	uint8_t channels() const { return channels_; }
+	explicit operator bool() const { return channels_; }
+
+protected:
+	std::unique_ptr<float[]> filter{};
+	std::vector<float> history{};
+	uint32_t historyFrames = 0;
+	uint32_t historyCapacity = 0;
+	uint32_t maxBacklogFrames = 0;
+	uint32_t droppedFrames_ = 0;
+	double baseStep = 1;
+	double step = 1;
+	double pos = 0;
+	float gain = 1;
+	uint8_t channels_ = 0;
+
+	template <class T>
+	void appendInput(const T *in, uint32_t inputFrames);
+	void dropHistory(uint32_t frames);
+	template <class T>
+	uint32_t filterOutput(T *out, uint32_t maxOutFrames);
+};
+
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/config/defs.hh>
+#include <cstddef>
+
+namespace IG::Audio
+{
+
+// Convert interleaved samples while applying a gain, with int16 full scale
+// mapping to [-1, 1). Float output isn't clipped so it keeps any headroom
+// past full scale, int16 output saturates.
+void convertSamples(float *dest, const int16_t *src, size_t samples, float gain = 1.f);
+void convertSamples(int16_t *dest, const float *src, size_t samples, float gain = 1.f);
+void convertSamples(int16_t *dest, const int16_t *src, size_t samples, float gain);
+void convertSamples(float *dest, const float *src, size_t samples, float gain);
+
+}
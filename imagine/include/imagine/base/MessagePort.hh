@@ -17,6 +17,14 @@
 
 #include <imagine/config/defs.hh>
 #include <imagine/base/Pipe.hh>
+#include <imagine/base/CustomEvent.hh>
+#include <imagine/util/DelegateFunc.hh>
+#include <imagine/util/math/int.hh>
+#include <imagine/util/utility.h>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <mutex>
 #include <type_traits>
 #include <utility>
 
@@ -159,6 +167,201 @@ protected:
 	Pipe pipe;
 };
 
+// Lock-free port for one sending thread and one receiving thread. Messages are
+// passed through a ring buffer in shared memory instead of a pipe, and the
+// event is only signaled when the ring goes from empty to non-empty, so a
+// batch of messages costs one wake-up instead of a write() and read() each.
+// Extra data isn't supported, use PipeMessagePort for variable-sized messages.
+// When the ring is full, messages go to a mutex-guarded overflow queue instead
+// of waiting on the receiver, which may itself be blocked on the sending thread.
+template<class MsgType, uint32_t CAPACITY = 16>
+class SPSCMessagePort
+{
+public:
+	static_assert(IG::isPowerOf2(CAPACITY), "capacity must be a power of 2");
+	static_assert(std::is_trivially_copyable_v<MsgType>, "messages must be trivially copyable");
+
+	class Messages
+	{
+	public:
+		class Iterator
+		{
+		public:
+			Iterator(SPSCMessagePort *port):
+				port{port}, msg{port ? port->pop() : MsgType{}}
+			{
+				if(!msg)
+					this->port = nullptr;
+			}
+
+			Iterator operator++()
+			{
+				msg = port->pop();
+				if(!msg)
+				{
+					// end of messages
+					port = nullptr;
+				}
+				return *this;
+			}
+
+			bool operator!=(const Iterator &rhs) const
+			{
+				return port != rhs.port;
+			}
+
+			const MsgType &operator*() const
+			{
+				return msg;
+			}
+
+		private:
+			SPSCMessagePort *port;
+			MsgType msg;
+		};
+
+		constexpr Messages(SPSCMessagePort &port): port{port} {}
+
+		Iterator begin() { return Iterator{&port}; }
+		Iterator end() { return Iterator{nullptr}; }
+
+	protected:
+		SPSCMessagePort &port;
+	};
+
+	SPSCMessagePort(const char *debugLabel = nullptr):
+		event{debugLabel}
+	{}
+
+	template<class Func>
+	void attach(Func &&func)
+	{
+		attach(EventLoop::forThread(), std::forward<Func>(func));
+	}
+
+	template<class Func>
+	void attach(EventLoop loop, Func &&func)
+	{
+		msgDel =
+			[=](Messages &msg) -> bool
+			{
+				constexpr auto returnsVoid = std::is_same_v<void, decltype(func(msg))>;
+				if constexpr(returnsVoid)
+				{
+					func(msg);
+					return true;
+				}
+				else
+				{
+					return func(msg);
+				}
+			};
+		event.attach(loop,
+			PollEventDelegate
+			{
+				[this](int, int) -> bool
+				{
+					event.cancel();
+					Messages msg{*this};
+					return msgDel(msg);
+				}
+			});
+	}
+
+	void detach()
+	{
+		event.detach();
+	}
+
+	bool send(MsgType msg)
+	{
+		auto writeIdx = writeIdx_.load(std::memory_order_relaxed);
+		// once messages overflow, later ones follow them until the receiver drains the queue
+		if(unlikely(hasOverflow.load(std::memory_order_acquire) ||
+			writeIdx - readIdx_.load(std::memory_order_acquire) == CAPACITY))
+		{
+			{
+				std::lock_guard lock{overflowMutex};
+				overflow.push_back(msg);
+				hasOverflow.store(true, std::memory_order_release);
+			}
+			// the receiver may have drained everything before the push above
+			event.notify();
+			return true;
+		}
+		ring[writeIdx % CAPACITY] = msg;
+		// Sequentially consistent so this store and the load of the read index below
+		// can't be reordered with the matching pair in pop(), either the receiver
+		// sees the new message before it stops reading or it's woken up here
+		writeIdx_.store(writeIdx + 1, std::memory_order_seq_cst);
+		if(readIdx_.load(std::memory_order_seq_cst) == writeIdx)
+		{
+			event.notify();
+		}
+		return true;
+	}
+
+	// only call when the receiving thread isn't running
+	void clear()
+	{
+		while(pop()) {}
+		event.cancel();
+	}
+
+	// messages currently held in the overflow queue, for debugging and tests
+	size_t overflowSize()
+	{
+		std::lock_guard lock{overflowMutex};
+		return overflow.size();
+	}
+
+	explicit operator bool() const { return (bool)event; }
+
+protected:
+	alignas(64) std::atomic<uint32_t> writeIdx_{};
+	alignas(64) std::atomic<uint32_t> readIdx_{};
+	std::array<MsgType, CAPACITY> ring{};
+	DelegateFunc<bool (Messages &)> msgDel{};
+	CustomEvent event;
+	std::atomic_bool hasOverflow{};
+	std::mutex overflowMutex{};
+	std::deque<MsgType> overflow{};
+
+	MsgType pop()
+	{
+		auto readIdx = readIdx_.load(std::memory_order_relaxed);
+		if(readIdx == writeIdx_.load(std::memory_order_seq_cst))
+			return popOverflow();
+		return popRing(readIdx);
+	}
+
+	MsgType popRing(uint32_t readIdx)
+	{
+		auto msg = ring[readIdx % CAPACITY];
+		readIdx_.store(readIdx + 1, std::memory_order_seq_cst);
+		return msg;
+	}
+
+	// overflowed messages are newer than any in the ring, so they're read once it's empty
+	MsgType popOverflow()
+	{
+		if(likely(!hasOverflow.load(std::memory_order_acquire)))
+			return {};
+		std::lock_guard lock{overflowMutex};
+		if(overflow.empty())
+			return {};
+		// the ring may have filled up again since pop() found it empty
+		auto readIdx = readIdx_.load(std::memory_order_relaxed);
+		if(readIdx != writeIdx_.load(std::memory_order_seq_cst))
+			return popRing(readIdx);
+		auto msg = overflow.front();
+		overflow.pop_front();
+		if(overflow.empty())
+			hasOverflow.store(false, std::memory_order_release);
+		return msg;
+	}
+};
+
 template<class MsgType>
 using MessagePort = PipeMessagePort<MsgType>;
 
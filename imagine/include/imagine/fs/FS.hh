@@ -222,6 +222,7 @@ static PathString dirname(std::array<char, S> &path)
 using FileStringCompareFunc = bool (*)(const FS::FileString &s1, const FS::FileString &s2);
 
 bool fileStringNoCaseLexCompare(FS::FileString s1, FS::FileString s2);
+bool fileStringNoCaseLexCompare(const char *s1, const char *s2);
 
 int directoryItems(const char *path);
 static int directoryItems(PathString path) { return directoryItems(path.data()); }
@@ -95,6 +95,7 @@ private:
 using Sprite = SpriteBase<TexRect>;
 using ShadedSprite = SpriteBase<ColTexQuad>;
 
+std::array<TexVertex, 4> makeTexVertArray(GCRect pos, IG::Rect2<GTexC> uvBounds);
 std::array<TexVertex, 4> makeTexVertArray(GCRect pos, PixmapTexture &img);
 
 }
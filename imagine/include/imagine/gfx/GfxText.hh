@@ -17,6 +17,7 @@
 
 #include <imagine/config/defs.hh>
 #include <imagine/gfx/defs.hh>
+#include <imagine/gfx/GlyphTextureSet.hh>
 #include <float.h>
 #include <imagine/util/2DOrigin.h>
 #include <imagine/util/string.h>
@@ -26,7 +27,6 @@ namespace Gfx
 
 class Renderer;
 class RendererCommands;
-class GlyphTextureSet;
 class ProjectionPlane;
 
 class Text
@@ -52,6 +52,8 @@ public:
 	uint16_t lines = 0;
 	uint16_t maxLines = NO_MAX_LINES;
 	LineInfo *lineInfo{};
+	// atlas pages of the glyphs compile() measured, draw() can't re-cache them
+	GlyphPagePins pagePins{};
 
 	constexpr Text() {}
 	constexpr Text(const char *str): str{str} {}
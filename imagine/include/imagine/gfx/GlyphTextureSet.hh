@@ -22,17 +22,43 @@
 #include <imagine/font/Font.hh>
 #include <system_error>
 #include <memory>
+#include <vector>
+#include <array>
 
 namespace Gfx
 {
 
 struct GlyphEntry
 {
-	std::unique_ptr<Gfx::PixmapTexture> glyphPtr{};
+	IG::Rect2<GTexC> uv{};
 	IG::GlyphMetrics metrics{};
+	uint8_t page = 0; // 1-based index of the atlas page holding the glyph, 0 if not cached
 
 	constexpr GlyphEntry() {}
-	Gfx::PixmapTexture &glyph() { return *glyphPtr; }
+	bool isCached() const { return page; }
+};
+
+// per-page pin counts of a glyph table, a fresh set is made when the table
+// is reset so pins taken before then can be released without effect
+using GlyphPageCounts = std::array<uint32_t, 32>;
+
+// Keeps atlas pages from being evicted while a compiled Text draws from them
+class GlyphPagePins
+{
+public:
+	constexpr GlyphPagePins() {}
+	GlyphPagePins(std::shared_ptr<GlyphPageCounts> counts, uint32_t pageBits);
+	GlyphPagePins(const GlyphPagePins &o): GlyphPagePins{o.counts, o.pageBits} {}
+	GlyphPagePins(GlyphPagePins &&o);
+	GlyphPagePins &operator=(GlyphPagePins &&o);
+	GlyphPagePins &operator=(const GlyphPagePins &o) { return *this = GlyphPagePins{o}; }
+	~GlyphPagePins();
+	void reset();
+	uint32_t pages() const { return pageBits; }
+
+protected:
+	std::shared_ptr<GlyphPageCounts> counts{};
+	uint32_t pageBits = 0;
 };
 
 class GlyphTextureSet
@@ -59,20 +85,47 @@ public:
 		return precache(r, "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789");
 	}
 	GlyphEntry *glyphEntry(Renderer &r, int c, bool allowCache = true);
+	PixmapTexture &glyphTexture(const GlyphEntry &entry) { return atlasPages[entry.page - 1].tex; }
+	// bit N of pageBits is the page of glyph entries with page N + 1
+	GlyphPagePins pinPages(uint32_t pageBits) { return {pageCounts, pageBits}; }
 	uint32_t nominalHeight() const;
 	void freeCaches(uint32_t rangeToFreeBits);
 	void freeCaches() { freeCaches(~0); }
 
 private:
+	// Glyphs are packed into shared textures in rows ("shelves") so text
+	// can be drawn with one texture bind per string, pages are recycled
+	// least recently used first once MAX_ATLAS_PAGES are in use, pages
+	// pinned by texts are skipped and more are added if all are pinned
+	struct AtlasPage
+	{
+		PixmapTexture tex{};
+		std::vector<uint32_t> glyphs{}; // glyph table indices packed into this page
+		IG::WP size{};
+		int penX = 0, shelfY = 0, shelfHeight = 0;
+		uint32_t lastUse = 0;
+
+		bool allocRect(IG::WP rectSize, IG::WP &pos);
+	};
+	static constexpr uint32_t MAX_ATLAS_PAGES = 8;
+	static constexpr uint32_t MAX_PINNED_ATLAS_PAGES = std::tuple_size_v<GlyphPageCounts>;
+	static constexpr int ATLAS_PAGE_SIZE = 512;
+
 	std::unique_ptr<IG::Font> font{};
 	GlyphEntry *glyphTable{};
+	std::vector<AtlasPage> atlasPages{};
+	std::shared_ptr<GlyphPageCounts> pageCounts{};
 	IG::FontSize faceSize{};
 	uint32_t nominalHeight_ = 0;
 	uint32_t usedGlyphTableBits = 0;
+	uint32_t atlasUseClock = 0;
 
 	void calcNominalHeight(Renderer &r);
 	bool initGlyphTable();
 	std::errc cacheChar(Renderer &r, int c, int tableIdx);
+	int allocAtlasRect(Renderer &r, IG::WP size, IG::PixelFormat format, IG::WP &pos);
+	int evictableAtlasPage() const;
+	void resetAtlasPage(AtlasPage &page);
 	void deinit();
 };
 
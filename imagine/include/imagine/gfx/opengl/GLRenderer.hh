@@ -31,8 +31,8 @@
 #include <imagine/util/typeTraits.hh>
 #include <memory>
 #include <thread>
-#ifdef CONFIG_GFX_RENDERER_TASK_DRAW_LOCK
 #include <mutex>
+#ifdef CONFIG_GFX_RENDERER_TASK_DRAW_LOCK
 #include <condition_variable>
 #endif
 
@@ -149,7 +149,8 @@ public:
 	void initialCommands(RendererCommands &cmds);
 
 protected:
-	Base::MessagePort<CommandMessage> commandPort{"RenderTask Command"};
+	Base::SPSCMessagePort<CommandMessage> commandPort{"RenderTask Command"};
+	std::mutex commandSendMutex{}; // both the main and emulation threads send commands
 	#ifdef CONFIG_GFX_RENDERER_TASK_REPLY_PORT
 	Base::MessagePort<ReplyMessage> replyPort{"RenderTask Reply"}; // currently unused
 	#endif
@@ -178,6 +179,7 @@ protected:
 	bool canDraw = true;
 	#endif
 
+	void sendCommand(CommandMessage msg);
 	void replyHandler(Renderer &r, ReplyMessage msg);
 	bool commandHandler(decltype(commandPort)::Messages messages, Base::GLDisplay glDpy, bool ownsThread);
 };
@@ -241,6 +243,7 @@ public:
 
 	bool hasDrawReadBuffers() const;
 	bool hasSyncFences() const;
+	bool hasBufferStorage() const;
 	#ifdef CONFIG_GFX_OPENGL_ES
 	void (* GL_APIENTRY glGenSamplers) (GLsizei count, GLuint* samplers){};
 	void (* GL_APIENTRY glDeleteSamplers) (GLsizei count, const GLuint* samplers){};
@@ -271,6 +274,8 @@ public:
 	static GLenum glClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) { return ::glClientWaitSync(sync, flags, timeout); }
 	static void glWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) { ::glWaitSync(sync, flags, timeout); }
 	#endif
+	using BufferStorageProto = void (* GL_APIENTRY)(GLenum target, GLsizeiptr size, const GLvoid *data, GLbitfield flags);
+	BufferStorageProto glBufferStorage{}; // set via extensions
 	GLenum luminanceFormat = GL_LUMINANCE;
 	GLenum luminanceInternalFormat = GL_LUMINANCE8;
 	GLenum luminanceAlphaFormat = GL_LUMINANCE_ALPHA;
@@ -392,6 +397,7 @@ public:
 	void setupSpecifyDrawReadBuffers();
 	void setupUnmapBufferFunc();
 	void setupFenceSync();
+	void setupBufferStorage(const char *procName);
 	void setupAppleFenceSync();
 	void setupEGLFenceSync(bool supportsServerSync);
 	void checkExtensionString(const char *extStr, bool &useFBOFuncs);
@@ -28,6 +28,7 @@ namespace Gfx
 
 class Renderer;
 class TextureSampler;
+class PixelBufferRing;
 
 class GLTextureSampler
 {
@@ -120,6 +121,7 @@ public:
 protected:
 	Renderer *r{};
 	DirectTextureStorage *directTex{};
+	PixelBufferRing *pboRing{}; // used by textures that are written often
 	#ifdef CONFIG_GFX_OPENGL_SHADER_PIPELINE
 	uint32_t type_ = TEX_UNSET;
 	#else
@@ -134,6 +136,7 @@ protected:
 	IG::PixmapDesc pixDesc;
 	GLuint sampler = 0; // used when separate sampler objects not supported
 	uint32_t levels_ = 0;
+	bool usePBORing = false;
 	#ifdef __ANDROID__
 	static AndroidStorageImpl androidStorageImpl_;
 	#endif
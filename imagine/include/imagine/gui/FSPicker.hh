@@ -16,6 +16,11 @@
 	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
 
 #include <vector>
+#include <string>
+#include <optional>
+#include <thread>
+#include <mutex>
+#include <atomic>
 #include <system_error>
 #include <imagine/config/defs.hh>
 #include <imagine/gfx/GfxText.hh>
@@ -27,6 +32,7 @@
 #include <imagine/gui/View.hh>
 #include <imagine/gui/NavView.hh>
 #include <imagine/gui/ViewStack.hh>
+#include <imagine/base/CustomEvent.hh>
 
 namespace Gfx
 {
@@ -43,8 +49,20 @@ public:
 	using OnPathReadError = DelegateFunc<void (FSPicker &picker, std::error_code ec)>;
 	static constexpr bool needsUpDirControl = true;
 
+	struct FileEntry
+	{
+		std::string name{};
+		bool isDir{};
+
+		FileEntry() {}
+		FileEntry(std::string name, bool isDir):
+			name{std::move(name)}, isDir{isDir}
+		{}
+	};
+
 	FSPicker(ViewAttachParams attach, Gfx::PixmapTexture *backRes, Gfx::PixmapTexture *closeRes,
 			FilterFunc filter = {}, bool singleDir = false, Gfx::GlyphTextureSet *face = &View::defaultFace);
+	~FSPicker();
 	void place() override;
 	bool inputEvent(Input::Event e) override;
 	void prepareDraw() override;
@@ -81,17 +99,16 @@ public:
 	void goUpDirectory(Input::Event e);
 
 protected:
-	struct FileEntry
+	struct CachedItem
 	{
-		FS::FileString name{};
-		bool isDir{};
-
-		constexpr FileEntry() {}
-		constexpr FileEntry(FS::FileString name, bool isDir):
-			name{name}, isDir{isDir}
-		{}
+		int idx = -1;
+		std::optional<TextMenuItem> item{};
 	};
 
+	// Menu items only exist for rows near the visible area,
+	// each row maps to the slot at (row % ITEM_CACHE_SIZE)
+	static constexpr uint32_t ITEM_CACHE_SIZE = 128;
+
 	FilterFunc filter{};
 	ViewStack controller{};
 	OnChangePathDelegate onChangePath_{};
@@ -104,8 +121,17 @@ protected:
 		}
 	};
 	OnPathReadError onPathReadError_{};
-	std::vector<TextMenuItem> text{};
+	std::vector<CachedItem> itemCache{};
 	std::vector<FileEntry> dir{};
+	// directory scanning thread & the entries it hands back to the main thread
+	std::thread scanThread{};
+	std::mutex scanMutex{};
+	std::vector<FileEntry> scanPending{};
+	Base::CustomEvent scanEvent{"FSPicker::scanEvent"};
+	std::atomic_bool cancelScan_{};
+	bool scanDone = true;
+	bool highlightOnScan = false;
+	FS::file_time_type scanMTime{};
 	std::vector<FS::PathLocation> rootLocation{};
 	FS::RootPathInfo root{};
 	FS::PathString currPath{};
@@ -117,4 +143,10 @@ protected:
 	void changeDirByInput(const char *path, FS::RootPathInfo rootInfo, bool forcePathChange, Input::Event e);
 	bool isAtRoot() const;
 	void pushFileLocationsView(Input::Event e);
+	MenuItem &fileItem(uint32_t idx);
+	void clearItemCache();
+	void startScan(FS::directory_iterator dirIt);
+	void cancelScan();
+	void applyScanResults();
+	void mergeEntries(std::vector<FileEntry> entries);
 };
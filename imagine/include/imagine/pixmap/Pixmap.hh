@@ -125,6 +125,13 @@ public:
 		subPixmap(destPos, size() - destPos).writeTransformed(func, pixmap);
 	}
 
+	// Conversions of common framebuffer formats using SIMD kernels chosen
+	// for the running CPU, prefer these over writeTransformed() with an
+	// equivalent function
+	void writeLookup(const uint16_t *lut, const IG::Pixmap &pixmap);
+	void writeLookup(const uint32_t *lut, const IG::Pixmap &pixmap);
+	void writeRGBA8888AsRGB565(const IG::Pixmap &pixmap);
+
 	void clear(IG::WP pos, IG::WP size);
 	void clear();
 	Pixmap subPixmap(IG::WP pos, IG::WP size) const;
@@ -27,12 +27,20 @@ public:
 	BaseBufferView() {}
 	BaseBufferView(T *data, size_t size, void(*deleter)(T*)):
 		data_{data, deleter}, size_{size} {}
+	// non-owning view, data must outlive this object
+	BaseBufferView(T *data, size_t size):
+		data_{data, [](T*){}}, size_{size} {}
 
 	T *data()
 	{
 		return data_.get();
 	}
 
+	const T *data() const
+	{
+		return data_.get();
+	}
+
 	size_t size() const
 	{
 		return size_;
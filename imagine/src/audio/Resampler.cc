@@ -0,0 +1,346 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+
+#define LOGTAG "Resampler"
+#include <imagine/audio/Resampler.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/utility.h>
+#include <imagine/util/algorithm.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#if defined __x86_64__ || defined __i386__
+#include <immintrin.h>
+#define CONFIG_RESAMPLER_X86_KERNELS
+#endif
+#if defined __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+namespace IG::Audio
+{
+
+static constexpr uint32_t TAPS = Resampler::TAPS;
+static constexpr uint32_t PHASES = Resampler::PHASES;
+// taps before the output position, the rest are at or after it
+static constexpr uint32_t LEAD_TAPS = TAPS / 2 - 1;
+static constexpr double KAISER_BETA = 8.;
+
+// Sums x[k] * (a[k] + (b[k] - a[k]) * t), the dot product of the input with
+// a filter phase interpolated between the two nearest table rows
+using DotFunc = float(*)(const float *x, const float *a, const float *b, float t);
+
+#if !defined __SSE2__ && !defined __x86_64__ && !defined __ARM_NEON
+static float dot(const float *__restrict__ x, const float *__restrict__ a, const float *__restrict__ b, float t)
+{
+	float sum = 0;
+	iterateTimes(TAPS, k)
+	{
+		sum += x[k] * (a[k] + (b[k] - a[k]) * t);
+	}
+	return sum;
+}
+#endif
+
+#if defined __SSE2__ || defined __x86_64__
+static float dotSSE2(const float *__restrict__ x, const float *__restrict__ a, const float *__restrict__ b, float t)
+{
+	auto tv = _mm_set1_ps(t);
+	auto sum = _mm_setzero_ps();
+	for(uint32_t k = 0; k < TAPS; k += 4)
+	{
+		auto av = _mm_loadu_ps(&a[k]);
+		auto coef = _mm_add_ps(av, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&b[k]), av), tv));
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(&x[k]), coef));
+	}
+	sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+	sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+	return _mm_cvtss_f32(sum);
+}
+#endif
+
+#ifdef CONFIG_RESAMPLER_X86_KERNELS
+[[gnu::target("avx2,fma")]]
+static float dotAVX2(const float *__restrict__ x, const float *__restrict__ a, const float *__restrict__ b, float t)
+{
+	auto tv = _mm256_set1_ps(t);
+	auto sum = _mm256_setzero_ps();
+	for(uint32_t k = 0; k < TAPS; k += 8)
+	{
+		auto av = _mm256_loadu_ps(&a[k]);
+		auto coef = _mm256_fmadd_ps(_mm256_sub_ps(_mm256_loadu_ps(&b[k]), av), tv, av);
+		sum = _mm256_fmadd_ps(_mm256_loadu_ps(&x[k]), coef, sum);
+	}
+	auto sum4 = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+	sum4 = _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4));
+	sum4 = _mm_add_ss(sum4, _mm_shuffle_ps(sum4, sum4, 1));
+	return _mm_cvtss_f32(sum4);
+}
+
+static bool cpuHasAVX2()
+{
+	static const bool hasAVX2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+	return hasAVX2;
+}
+#endif
+
+#ifdef __ARM_NEON
+static float dotNEON(const float *__restrict__ x, const float *__restrict__ a, const float *__restrict__ b, float t)
+{
+	auto sum = vdupq_n_f32(0);
+	for(uint32_t k = 0; k < TAPS; k += 4)
+	{
+		auto av = vld1q_f32(&a[k]);
+		auto coef = vmlaq_n_f32(av, vsubq_f32(vld1q_f32(&b[k]), av), t);
+		sum = vmlaq_f32(sum, vld1q_f32(&x[k]), coef);
+	}
+	auto sum2 = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+	return vget_lane_f32(vpadd_f32(sum2, sum2), 0);
+}
+#endif
+
+static DotFunc dotKernel()
+{
+	#ifdef CONFIG_RESAMPLER_X86_KERNELS
+	if(cpuHasAVX2())
+		return dotAVX2;
+	#endif
+	#if defined __SSE2__ || defined __x86_64__
+	return dotSSE2;
+	#elif defined __ARM_NEON
+	return dotNEON;
+	#else
+	return dot;
+	#endif
+}
+
+static double besselI0(double x)
+{
+	double sum = 1, term = 1;
+	for(int k = 1; k < 32; k++)
+	{
+		term *= (x / (2 * k)) * (x / (2 * k));
+		sum += term;
+	}
+	return sum;
+}
+
+// PHASES + 1 rows of TAPS coefficients, row p is the kernel offset by p / PHASES frames
+static std::unique_ptr<float[]> makeFilter(double cutoff)
+{
+	auto filter = std::make_unique<float[]>((PHASES + 1) * TAPS);
+	const double halfSpan = TAPS / 2.;
+	iterateTimes(PHASES + 1, p)
+	{
+		auto row = &filter[p * TAPS];
+		double frac = (double)p / PHASES;
+		double sum = 0;
+		iterateTimes(TAPS, k)
+		{
+			double t = (double)k - LEAD_TAPS - frac;
+			double x = cutoff * t;
+			double sinc = x == 0. ? 1. : std::sin(M_PI * x) / (M_PI * x);
+			double w = t / halfSpan;
+			double window = std::abs(w) >= 1. ? 0. : besselI0(KAISER_BETA * std::sqrt(1. - w * w)) / besselI0(KAISER_BETA);
+			row[k] = sinc * window;
+			sum += row[k];
+		}
+		// unity gain at DC for every phase
+		iterateTimes(TAPS, k)
+		{
+			row[k] /= sum;
+		}
+	}
+	return filter;
+}
+
+Resampler::Resampler(uint32_t inputRate, uint32_t outputRate, uint8_t channels):
+	channels_{channels}
+{
+	assumeExpr(channels);
+	setRates(inputRate, outputRate);
+	reset();
+}
+
+void Resampler::setRates(uint32_t inputRate, uint32_t outputRate)
+{
+	assumeExpr(inputRate && outputRate);
+	// pass band ends a little below the lower Nyquist frequency of the two rates
+	double cutoff = std::min(1., (double)outputRate / inputRate) * .91;
+	filter = makeFilter(cutoff);
+	baseStep = (double)inputRate / outputRate;
+	step = baseStep;
+	logMsg("rates:%u -> %u, cutoff:%.3f", inputRate, outputRate, cutoff);
+}
+
+void Resampler::setRatioAdjust(double adjust)
+{
+	step = baseStep / adjust;
+}
+
+void Resampler::setGain(float gain_)
+{
+	gain = gain_;
+}
+
+void Resampler::setMaxBacklog(uint32_t frames)
+{
+	maxBacklogFrames = frames;
+}
+
+uint32_t Resampler::inputFramesFor(uint32_t outputFrames) const
+{
+	return std::ceil(outputFrames * baseStep);
+}
+
+void Resampler::reset()
+{
+	// start with silence before the first input frame so output 0 lines up with input 0
+	historyFrames = LEAD_TAPS;
+	droppedFrames_ = 0;
+	if(historyCapacity < TAPS * 2)
+	{
+		historyCapacity = TAPS * 2;
+		history.assign(historyCapacity * channels_, 0.f);
+	}
+	else
+	{
+		std::fill(history.begin(), history.end(), 0.f);
+	}
+	pos = LEAD_TAPS;
+}
+
+uint32_t Resampler::maxOutputFrames(uint32_t inputFrames) const
+{
+	// the last output needs TAPS - LEAD_TAPS frames from its index onward
+	double lastIdx = (double)historyFrames + inputFrames - (TAPS - LEAD_TAPS);
+	if(pos >= lastIdx + 1)
+		return 0;
+	return std::ceil((lastIdx + 1 - pos) / step);
+}
+
+void Resampler::dropHistory(uint32_t frames)
+{
+	iterateTimes(channels_, ch)
+	{
+		auto hist = &history[ch * historyCapacity];
+		std::memmove(hist, hist + frames, (historyFrames - frames) * sizeof(float));
+	}
+	historyFrames -= frames;
+}
+
+template <class T>
+void Resampler::appendInput(const T *in, uint32_t inputFrames)
+{
+	if(maxBacklogFrames && historyFrames + inputFrames > TAPS + maxBacklogFrames)
+	{
+		// output is falling behind, drop the oldest input so the history
+		// doesn't grow without bound
+		auto excess = historyFrames + inputFrames - (TAPS + maxBacklogFrames);
+		auto dropFrames = std::min(excess, historyFrames);
+		dropHistory(dropFrames);
+		pos = std::max(pos - dropFrames, (double)LEAD_TAPS);
+		in += (excess - dropFrames) * channels_;
+		inputFrames -= excess - dropFrames;
+		droppedFrames_ += excess;
+		logMsg("dropped %u input frames over the backlog limit", excess);
+	}
+	if(historyFrames + inputFrames > historyCapacity)
+	{
+		// channels are stored one after another, so each keeps its own region
+		auto newCapacity = historyFrames + inputFrames + TAPS;
+		std::vector<float> newHistory(newCapacity * channels_);
+		iterateTimes(channels_, ch)
+		{
+			std::copy_n(&history[ch * historyCapacity], historyFrames, &newHistory[ch * newCapacity]);
+		}
+		history = std::move(newHistory);
+		historyCapacity = newCapacity;
+	}
+	float scale = std::is_same_v<T, int16_t> ? gain * (1.f / 32768.f) : gain;
+	iterateTimes(channels_, ch)
+	{
+		auto dest = &history[ch * historyCapacity + historyFrames];
+		iterateTimes(inputFrames, i)
+		{
+			dest[i] = in[i * channels_ + ch] * scale;
+		}
+	}
+	historyFrames += inputFrames;
+}
+
+template <class T>
+uint32_t Resampler::filterOutput(T *out, uint32_t maxOutFrames)
+{
+	static const auto kernel = dotKernel();
+	uint32_t outFrames = 0;
+	while(outFrames < maxOutFrames)
+	{
+		auto idx = (uint32_t)pos;
+		if(idx + TAPS - LEAD_TAPS > historyFrames)
+			break; // needs more input
+		double phasePos = (pos - idx) * PHASES;
+		auto phase = (uint32_t)phasePos;
+		float t = phasePos - phase;
+		auto a = &filter[phase * TAPS];
+		auto b = a + TAPS;
+		iterateTimes(channels_, ch)
+		{
+			float s = kernel(&history[ch * historyCapacity + idx - LEAD_TAPS], a, b, t);
+			if constexpr(std::is_same_v<T, int16_t>)
+				out[outFrames * channels_ + ch] = std::clamp(std::lround(s * 32768.f), -32768l, 32767l);
+			else
+				out[outFrames * channels_ + ch] = s;
+		}
+		outFrames++;
+		pos += step;
+	}
+	// drop frames no longer reachable by the filter
+	auto consumed = std::min((uint32_t)pos - LEAD_TAPS, historyFrames);
+	if(consumed)
+	{
+		dropHistory(consumed);
+		pos -= consumed;
+	}
+	return outFrames;
+}
+
+uint32_t Resampler::process(const int16_t *in, uint32_t inputFrames, int16_t *out, uint32_t maxOutFrames)
+{
+	appendInput(in, inputFrames);
+	return filterOutput(out, maxOutFrames);
+}
+
+uint32_t Resampler::process(const float *in, uint32_t inputFrames, float *out, uint32_t maxOutFrames)
+{
+	appendInput(in, inputFrames);
+	return filterOutput(out, maxOutFrames);
+}
+
+uint32_t Resampler::process(const int16_t *in, uint32_t inputFrames, float *out, uint32_t maxOutFrames)
+{
+	appendInput(in, inputFrames);
+	return filterOutput(out, maxOutFrames);
+}
+
+uint32_t Resampler::process(const float *in, uint32_t inputFrames, int16_t *out, uint32_t maxOutFrames)
+{
+	appendInput(in, inputFrames);
+	return filterOutput(out, maxOutFrames);
+}
+
+}
@@ -0,0 +1,231 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/audio/SampleConvert.hh>
+#include <imagine/util/algorithm.h>
+#include <algorithm>
+#include <cmath>
+#if defined __x86_64__ || defined __i386__
+#include <immintrin.h>
+#define CONFIG_SAMPLE_CONVERT_X86_KERNELS
+#endif
+#if defined __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+namespace IG::Audio
+{
+
+using I16ToF32Func = void(*)(float *dest, const int16_t *src, size_t samples, float scale);
+using F32ToI16Func = void(*)(int16_t *dest, const float *src, size_t samples, float scale);
+
+// scalar versions also handle the tails of the vector kernels
+
+static void i16ToF32(float *__restrict__ dest, const int16_t *__restrict__ src, size_t samples, float scale)
+{
+	iterateTimes(samples, i)
+	{
+		dest[i] = src[i] * scale;
+	}
+}
+
+static void f32ToI16(int16_t *__restrict__ dest, const float *__restrict__ src, size_t samples, float scale)
+{
+	iterateTimes(samples, i)
+	{
+		dest[i] = std::lrint(std::clamp(src[i] * scale, -32768.f, 32767.f));
+	}
+}
+
+#if defined __SSE2__ || defined __x86_64__
+static void i16ToF32SSE2(float *__restrict__ dest, const int16_t *__restrict__ src, size_t samples, float scale)
+{
+	auto scaleV = _mm_set1_ps(scale);
+	size_t i = 0;
+	for(; i + 8 <= samples; i += 8)
+	{
+		auto v = _mm_loadu_si128((const __m128i*)&src[i]);
+		// sign extend by placing each sample in the upper half of a 32-bit lane
+		auto lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+		auto hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+		_mm_storeu_ps(&dest[i], _mm_mul_ps(_mm_cvtepi32_ps(lo), scaleV));
+		_mm_storeu_ps(&dest[i + 4], _mm_mul_ps(_mm_cvtepi32_ps(hi), scaleV));
+	}
+	i16ToF32(dest + i, src + i, samples - i, scale);
+}
+
+static void f32ToI16SSE2(int16_t *__restrict__ dest, const float *__restrict__ src, size_t samples, float scale)
+{
+	auto scaleV = _mm_set1_ps(scale);
+	auto minV = _mm_set1_ps(-32768.f);
+	auto maxV = _mm_set1_ps(32767.f);
+	size_t i = 0;
+	for(; i + 8 <= samples; i += 8)
+	{
+		auto a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(&src[i]), scaleV), minV), maxV);
+		auto b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(&src[i + 4]), scaleV), minV), maxV);
+		_mm_storeu_si128((__m128i*)&dest[i], _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+	}
+	f32ToI16(dest + i, src + i, samples - i, scale);
+}
+#endif
+
+#ifdef CONFIG_SAMPLE_CONVERT_X86_KERNELS
+[[gnu::target("avx2")]]
+static void i16ToF32AVX2(float *__restrict__ dest, const int16_t *__restrict__ src, size_t samples, float scale)
+{
+	auto scaleV = _mm256_set1_ps(scale);
+	size_t i = 0;
+	for(; i + 16 <= samples; i += 16)
+	{
+		auto lo = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)&src[i]));
+		auto hi = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)&src[i + 8]));
+		_mm256_storeu_ps(&dest[i], _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scaleV));
+		_mm256_storeu_ps(&dest[i + 8], _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scaleV));
+	}
+	i16ToF32SSE2(dest + i, src + i, samples - i, scale);
+}
+
+[[gnu::target("avx2")]]
+static void f32ToI16AVX2(int16_t *__restrict__ dest, const float *__restrict__ src, size_t samples, float scale)
+{
+	auto scaleV = _mm256_set1_ps(scale);
+	auto minV = _mm256_set1_ps(-32768.f);
+	auto maxV = _mm256_set1_ps(32767.f);
+	size_t i = 0;
+	for(; i + 16 <= samples; i += 16)
+	{
+		auto a = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(&src[i]), scaleV), minV), maxV);
+		auto b = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(&src[i + 8]), scaleV), minV), maxV);
+		// packing works per 128-bit lane, reorder the 64-bit groups back into sequence
+		auto packed = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+		_mm256_storeu_si256((__m256i*)&dest[i], _mm256_permute4x64_epi64(packed, 0xD8));
+	}
+	f32ToI16SSE2(dest + i, src + i, samples - i, scale);
+}
+
+static bool cpuHasAVX2()
+{
+	static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+	return hasAVX2;
+}
+#endif
+
+#ifdef __ARM_NEON
+static void i16ToF32NEON(float *__restrict__ dest, const int16_t *__restrict__ src, size_t samples, float scale)
+{
+	size_t i = 0;
+	for(; i + 8 <= samples; i += 8)
+	{
+		auto v = vld1q_s16(&src[i]);
+		vst1q_f32(&dest[i], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+		vst1q_f32(&dest[i + 4], vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+	}
+	i16ToF32(dest + i, src + i, samples - i, scale);
+}
+
+static void f32ToI16NEON(int16_t *__restrict__ dest, const float *__restrict__ src, size_t samples, float scale)
+{
+	size_t i = 0;
+	for(; i + 8 <= samples; i += 8)
+	{
+		auto a = vmulq_n_f32(vld1q_f32(&src[i]), scale);
+		auto b = vmulq_n_f32(vld1q_f32(&src[i + 4]), scale);
+		// conversion and narrowing both saturate
+		#ifdef __aarch64__
+		auto ai = vcvtnq_s32_f32(a), bi = vcvtnq_s32_f32(b);
+		#else
+		// ARMv7 only converts with truncation, so first round to the nearest even integer
+		// like lrint() by adding and removing 1.5 * 2^23, which pushes the fraction out of the mantissa
+		auto magicV = vdupq_n_f32(12582912.f);
+		a = vsubq_f32(vaddq_f32(a, magicV), magicV);
+		b = vsubq_f32(vaddq_f32(b, magicV), magicV);
+		auto ai = vcvtq_s32_f32(a), bi = vcvtq_s32_f32(b);
+		#endif
+		vst1q_s16(&dest[i], vcombine_s16(vqmovn_s32(ai), vqmovn_s32(bi)));
+	}
+	f32ToI16(dest + i, src + i, samples - i, scale);
+}
+#endif
+
+static I16ToF32Func i16ToF32Kernel()
+{
+	#ifdef CONFIG_SAMPLE_CONVERT_X86_KERNELS
+	if(cpuHasAVX2())
+		return i16ToF32AVX2;
+	#endif
+	#if defined __SSE2__ || defined __x86_64__
+	return i16ToF32SSE2;
+	#elif defined __ARM_NEON
+	return i16ToF32NEON;
+	#else
+	return i16ToF32;
+	#endif
+}
+
+static F32ToI16Func f32ToI16Kernel()
+{
+	#ifdef CONFIG_SAMPLE_CONVERT_X86_KERNELS
+	if(cpuHasAVX2())
+		return f32ToI16AVX2;
+	#endif
+	#if defined __SSE2__ || defined __x86_64__
+	return f32ToI16SSE2;
+	#elif defined __ARM_NEON
+	return f32ToI16NEON;
+	#else
+	return f32ToI16;
+	#endif
+}
+
+void convertSamples(float *dest, const int16_t *src, size_t samples, float gain)
+{
+	static const auto kernel = i16ToF32Kernel();
+	kernel(dest, src, samples, gain * (1.f / 32768.f));
+}
+
+void convertSamples(int16_t *dest, const float *src, size_t samples, float gain)
+{
+	static const auto kernel = f32ToI16Kernel();
+	kernel(dest, src, samples, gain * 32768.f);
+}
+
+void convertSamples(int16_t *dest, const int16_t *src, size_t samples, float gain)
+{
+	// go through float in blocks small enough to stay in L1
+	static const auto toFloat = i16ToF32Kernel();
+	static const auto toInt = f32ToI16Kernel();
+	constexpr size_t blockSamples = 256;
+	float block[blockSamples];
+	while(samples)
+	{
+		auto n = std::min(samples, blockSamples);
+		toFloat(block, src, n, gain);
+		toInt(dest, block, n, 1.f);
+		src += n;
+		dest += n;
+		samples -= n;
+	}
+}
+
+void convertSamples(float *__restrict__ dest, const float *__restrict__ src, size_t samples, float gain)
+{
+	iterateTimes(samples, i)
+	{
+		dest[i] = src[i] * gain;
+	}
+}
+
+}
@@ -1,3 +1,5 @@
+SRC += audio/Resampler.cc audio/SampleConvert.cc
+
 ifeq ($(ENV), linux)
  ifneq ($(SUBENV), pandora)
   include $(imagineSrcDir)/audio/pulseaudio/build.mk
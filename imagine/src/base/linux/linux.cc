@@ -225,6 +225,17 @@ void exitWithErrorMessageVPrintf(int exitVal, const char *format, va_list args)
 
 }
 
+static bool isHeadlessLaunch(int argc, char** argv)
+{
+	// a --benchmark launch runs without windows, so it also works without a display server
+	for(int i = 1; i < argc; i++)
+	{
+		if(string_equal(argv[i], "--benchmark"))
+			return true;
+	}
+	return false;
+}
+
 int main(int argc, char** argv)
 {
 	using namespace Base;
@@ -233,13 +244,17 @@ int main(int argc, char** argv)
 	appPath = FS::makeAppPathFromLaunchCommand(argv[0]);
 	auto eventLoop = EventLoop::makeForThread();
 	#ifdef CONFIG_BASE_X11
-	auto [ec, fd] = initWindowSystem(eventLoop);
-	if(fd == -1)
+	FDEventSource x11Src{};
+	if(!isHeadlessLaunch(argc, argv))
 	{
-		return ec.value();
+		auto [ec, fd] = initWindowSystem(eventLoop);
+		if(fd == -1)
+		{
+			return ec.value();
+		}
+		x11Src = {"XServer", fd};
+		x11Src.attach(eventLoop, nullptr, &Base::x11SourceFuncs);
 	}
-	FDEventSource x11Src{"XServer", fd};
-	x11Src.attach(eventLoop, nullptr, &Base::x11SourceFuncs);
 	#endif
 	#ifdef CONFIG_INPUT_EVDEV
 	Input::initEvdev(eventLoop);
@@ -256,6 +256,8 @@ void Window::deinit()
 
 void deinitWindowSystem()
 {
+	if(!dpy) // never opened in a headless launch
+		return;
 	logMsg("shutting down window system");
 	deinitFrameTimer();
 	iterateTimes(Window::windows(), i)
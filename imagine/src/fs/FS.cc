@@ -131,10 +131,15 @@ PathString dirname(const char *path)
 }
 
 bool fileStringNoCaseLexCompare(FS::FileString s1, FS::FileString s2)
+{
+	return fileStringNoCaseLexCompare(s1.data(), s2.data());
+}
+
+bool fileStringNoCaseLexCompare(const char *s1, const char *s2)
 {
 	return std::lexicographical_compare(
-		s1.data(), s1.data() + strlen(s1.data()),
-		s2.data(), s2.data() + strlen(s2.data()),
+		s1, s1 + strlen(s1),
+		s2, s2 + strlen(s2),
 		[](char c1, char c2)
 		{
 			return std::tolower(c1) < std::tolower(c2);
@@ -20,6 +20,8 @@
 #include <imagine/gfx/ProjectionPlane.hh>
 #include <imagine/gfx/Gfx.hh>
 #include <imagine/util/math/int.hh>
+#include <imagine/util/bits.h>
+#include <imagine/util/container/ArrayList.hh>
 #include <cstdlib>
 #include <algorithm>
 #include <cctype>
@@ -44,10 +46,12 @@ void Text::setString(const char *str)
 void Text::setFace(GlyphTextureSet *face)
 {
 	assert(face);
+	if(face != this->face)
+		pagePins.reset();
 	this->face = face;
 }
 
-static GC xSizeOfChar(Renderer &r, GlyphTextureSet *face, int c, GC spaceX, const ProjectionPlane &projP)
+static GC xSizeOfChar(Renderer &r, GlyphTextureSet *face, int c, GC spaceX, const ProjectionPlane &projP, GlyphPagePins &pins)
 {
 	assert(c != '\0');
 	if(c == ' ')
@@ -57,7 +61,12 @@ static GC xSizeOfChar(Renderer &r, GlyphTextureSet *face, int c, GC spaceX, cons
 
 	GlyphEntry *gly = face->glyphEntry(r, c);
 	if(gly != NULL)
+	{
+		// pin each page as it's first used so caching later chars can't evict it
+		if(auto pageBit = IG::bit(gly->page - 1u); !(pins.pages() & pageBit))
+			pins = face->pinPages(pins.pages() | pageBit);
 		return projP.unprojectXSize(gly->metrics.xAdvance);
+	}
 	else
 		return 0;
 }
@@ -100,6 +109,7 @@ void Text::compile(Renderer &r, const ProjectionPlane &projP)
 	//int maxLineSizeI = Gfx::toIXSize(maxLineSize);
 	//logMsg("max line size %f", maxLineSize);
 	
+	GlyphPagePins newPins{};
 	lines = 1;
 	GC xLineSize = 0, maxXLineSize = 0;
 	const char *s = str;
@@ -109,7 +119,7 @@ void Text::compile(Renderer &r, const ProjectionPlane &projP)
 	uint32_t charIdx = 0, charsInLine = 0;
 	while(!(bool)string_convertCharCode(&s, c))
 	{
-		auto cSize = xSizeOfChar(r, face, c, spaceSize, projP);
+		auto cSize = xSizeOfChar(r, face, c, spaceSize, projP, newPins);
 		charsInLine++;
 
 		// Is this the start of a text block?
@@ -173,6 +183,7 @@ void Text::compile(Renderer &r, const ProjectionPlane &projP)
 	maxXLineSize = std::max(xLineSize, maxXLineSize);
 	xSize = maxXLineSize;
 	ySize = nominalHeight * (GC)lines;
+	pagePins = std::move(newPins);
 }
 
 void Text::draw(RendererCommands &cmds, GC xPos, GC yPos, _2DOrigin o, const ProjectionPlane &projP) const
@@ -183,9 +194,20 @@ void Text::draw(RendererCommands &cmds, GC xPos, GC yPos, _2DOrigin o, const Pro
 	//logMsg("drawing with origin: %s,%s", o.toString(o.x), o.toString(o.y));
 	cmds.setBlendMode(BLEND_MODE_ALPHA);
 	cmds.setCommonTextureSampler(CommonTextureSampler::NO_MIP_CLAMP);
-	std::array<TexVertex, 4> vArr;
-	cmds.bindTempVertexBuffer();
-	TexVertex::bindAttribs(cmds, vArr.data());
+	// glyphs sharing an atlas page are batched into a single draw call
+	StaticArrayList<std::array<TexVertex, 4>, 128> vArr;
+	StaticArrayList<std::array<VertexIndex, 6>, vArr.maxSize()> vArrIdx;
+	PixmapTexture *batchTex{};
+	auto drawBatch =
+		[&]()
+		{
+			if(!vArr.size())
+				return;
+			cmds.setTexture(*batchTex);
+			drawQuads(cmds, &vArr[0], vArr.size(), &vArrIdx[0], vArrIdx.size());
+			vArr.clear();
+			vArrIdx.clear();
+		};
 	_2DOrigin align = o;
 	xPos = o.adjustX(xPos, xSize, LT2DO);
 	//logMsg("aligned to %f, converted to %d", Gfx::alignYToPixel(yPos), toIYPos(Gfx::alignYToPixel(yPos)));
@@ -217,6 +239,7 @@ void Text::draw(RendererCommands &cmds, GC xPos, GC yPos, _2DOrigin o, const Pro
 				(bool)err)
 			{
 				logWarn("failed char conversion while drawing line %d, char %d, result %d", l, i, (int)err);
+				drawBatch();
 				return;
 			}
 
@@ -241,18 +264,21 @@ void Text::draw(RendererCommands &cmds, GC xPos, GC yPos, _2DOrigin o, const Pro
 
 			auto x = xPos + projP.unprojectXSize(gly->metrics.xOffset);
 			auto y = yPos - projP.unprojectYSize(gly->metrics.ySize - gly->metrics.yOffset);
-			auto &glyph = gly->glyph();
-			vArr = makeTexVertArray({x, y, x + xSize, y + projP.unprojectYSize(gly->metrics.ySize)}, glyph);
-			cmds.vertexBufferData(vArr.data(), sizeof(vArr));
-			cmds.setTexture(glyph);
-			//logMsg("drawing");
-			cmds.drawPrimitives(Primitive::TRIANGLE_STRIP, 0, 4);
+			auto &glyphTex = face->glyphTexture(*gly);
+			if(&glyphTex != batchTex || vArr.size() == vArr.maxSize())
+			{
+				drawBatch();
+				batchTex = &glyphTex;
+			}
+			vArrIdx.emplace_back(makeRectIndexArray(vArr.size()));
+			vArr.emplace_back(makeTexVertArray({x, y, x + xSize, y + projP.unprojectYSize(gly->metrics.ySize)}, gly->uv));
 			xPos += projP.unprojectXSize(gly->metrics.xAdvance);
 		}
 		yPos -= nominalHeight;
 		yPos = projP.alignYToPixel(yPos);
 		totalCharsDrawn += charsToDraw;
 	}
+	drawBatch();
 	if(totalCharsDrawn < chars)
 	{
 		logWarn("only rendered %d/%d chars", totalCharsDrawn, chars);
@@ -19,9 +19,11 @@
 #include <imagine/gfx/GlyphTextureSet.hh>
 #include <imagine/gfx/Gfx.hh>
 #include <imagine/io/FileIO.hh>
-#include <imagine/data-type/image/GfxImageSource.hh>
 #include <imagine/logger/logger.h>
+#include <imagine/util/ScopeGuard.hh>
+#include <imagine/util/math/int.hh>
 #include <cstdlib>
+#include <algorithm>
 
 namespace Gfx
 {
@@ -43,43 +45,17 @@ static constexpr uint32_t glyphTableEntries = GlyphTextureSet::supportsUnicode ?
 
 static std::errc mapCharToTable(uint32_t c, uint32_t &tableIdx);
 
-class GfxGlyphImage : public GfxImageSource
+static IG::Pixmap glyphPixmap(IG::GlyphImage &img)
 {
-public:
-	GfxGlyphImage(IG::GlyphImage glyphBuff): lockBuff{std::move(glyphBuff)} {}
-
-	std::errc write(IG::Pixmap out) final
-	{
-		auto src = lockBuff.pixmap();
-		//logDMsg("copying char %dx%d, pitch %d to dest %dx%d, pitch %d", src.x, src.y, src.pitch, out.x, out.y, out.pitch);
-		assert(src.w() != 0 && src.h() != 0 && src.pixel({}));
-		if(Config::envIsAndroid && !src.pitchBytes()) // Hack for JXD S7300B which returns y = x, and pitch = 0
-		{
-			logWarn("invalid pitch returned for char bitmap");
-			src = {{out.size(), out.format()}, src.pixel({}), {out.pitchBytes(), IG::Pixmap::BYTE_UNITS}};
-		}
-		out.write(src, {});
-		return {};
-	}
-
-	IG::Pixmap lockPixmap() final
-	{
-		return lockBuff.pixmap();
-	}
-
-	void unlockPixmap() final
-	{
-		lockBuff.unlock();
-	}
-
-	explicit operator bool() const final
+	auto src = img.pixmap();
+	//logDMsg("copying char %dx%d, pitch %d", src.x, src.y, src.pitch);
+	if(Config::envIsAndroid && !src.pitchBytes()) // Hack for JXD S7300B which returns y = x, and pitch = 0
 	{
-		return (bool)lockBuff;
+		logWarn("invalid pitch returned for char bitmap");
+		src = {{src.size(), src.format()}, src.pixel({})};
 	}
-
-protected:
-	IG::GlyphImage lockBuff{};
-};
+	return src;
+}
 
 static int charIsDrawableAscii(int c)
 {
@@ -113,9 +89,51 @@ bool GlyphTextureSet::initGlyphTable()
 		return false;
 	}
 	usedGlyphTableBits = 0;
+	pageCounts = std::make_shared<GlyphPageCounts>();
 	return true;
 }
 
+GlyphPagePins::GlyphPagePins(std::shared_ptr<GlyphPageCounts> counts_, uint32_t pageBits):
+	counts{std::move(counts_)}, pageBits{counts ? pageBits : 0}
+{
+	iterateTimes(counts ? counts->size() : 0, i)
+	{
+		if(pageBits & IG::bit(i))
+			(*counts)[i]++;
+	}
+}
+
+GlyphPagePins::GlyphPagePins(GlyphPagePins &&o)
+{
+	*this = std::move(o);
+}
+
+GlyphPagePins &GlyphPagePins::operator=(GlyphPagePins &&o)
+{
+	reset();
+	counts = std::move(o.counts);
+	pageBits = std::exchange(o.pageBits, 0);
+	return *this;
+}
+
+GlyphPagePins::~GlyphPagePins()
+{
+	reset();
+}
+
+void GlyphPagePins::reset()
+{
+	if(!counts)
+		return;
+	iterateTimes(counts->size(), i)
+	{
+		if(pageBits & IG::bit(i))
+			(*counts)[i]--;
+	}
+	counts = {};
+	pageBits = 0;
+}
+
 void GlyphTextureSet::freeCaches(uint32_t purgeBits)
 {
 	auto tableBits = usedGlyphTableBits;
@@ -133,15 +151,24 @@ void GlyphTextureSet::freeCaches(uint32_t purgeBits)
 					//logMsg( "%c not a known drawable character, skipping", c);
 					continue;
 				}
-				auto &glyphPtr = glyphTable[tableIdx].glyphPtr;
-				if(glyphPtr)
-					glyphPtr.reset();
+				glyphTable[tableIdx].page = 0;
 			}
 			usedGlyphTableBits = IG::clearBits(usedGlyphTableBits, IG::bit(i));
 		}
 		tableBits >>= 1;
 		purgeBits >>= 1;
 	}
+	// drop purged glyphs from their pages and release any pages left empty
+	for(auto &page : atlasPages)
+	{
+		page.glyphs.erase(std::remove_if(page.glyphs.begin(), page.glyphs.end(),
+			[&](uint32_t tableIdx){ return !glyphTable[tableIdx].isCached(); }), page.glyphs.end());
+		if(page.glyphs.empty() && page.tex)
+		{
+			resetAtlasPage(page);
+			page.tex = {};
+		}
+	}
 }
 
 GlyphTextureSet::GlyphTextureSet(Renderer &r, const char *path, IG::FontSettings set):
@@ -187,9 +214,12 @@ GlyphTextureSet &GlyphTextureSet::operator=(GlyphTextureSet &&o)
 	settings = std::exchange(o.settings, {});
 	font = std::move(o.font);
 	glyphTable = std::exchange(o.glyphTable, {});
+	atlasPages = std::move(o.atlasPages);
+	pageCounts = std::move(o.pageCounts);
 	faceSize = std::move(o.faceSize);
 	nominalHeight_ = o.nominalHeight_;
 	usedGlyphTableBits = o.usedGlyphTableBits;
+	atlasUseClock = o.atlasUseClock;
 	return *this;
 }
 
@@ -200,14 +230,10 @@ GlyphTextureSet::~GlyphTextureSet()
 
 void GlyphTextureSet::deinit()
 {
+	atlasPages.clear();
+	pageCounts = {};
 	if(!glyphTable)
 		return;
-	iterateTimes(glyphTableEntries, i)
-	{
-		auto &glyphPtr = glyphTable[i].glyphPtr;
-		if(glyphPtr)
-			glyphPtr.reset();
-	}
 	std::free(glyphTable);
 	glyphTable = {};
 }
@@ -270,14 +296,125 @@ std::errc GlyphTextureSet::cacheChar(Renderer &r, int c, int tableIdx)
 		return ec;
 	}
 	//logMsg("setting up table entry %d", tableIdx);
-	glyphTable[tableIdx].metrics = res.metrics;
-	auto img = GfxGlyphImage(std::move(res.image));
-	glyphTable[tableIdx].glyphPtr = std::make_unique<Gfx::PixmapTexture>(r.makePixmapTexture(img, false));
+	auto pix = glyphPixmap(res.image);
+	auto unlockImage = IG::scopeGuard([&](){ res.image.unlock(); });
+	if(!pix.w() || !pix.h() || !pix.pixel({}))
+	{
+		logErr("empty bitmap for glyph:0x%X", c);
+		glyphTable[tableIdx].metrics.ySize = -1;
+		return std::errc::invalid_argument;
+	}
+	IG::WP pos{};
+	int pageIdx = allocAtlasRect(r, {(int)pix.w(), (int)pix.h()}, pix.format(), pos);
+	auto &page = atlasPages[pageIdx];
+	page.tex.write(0, pix, pos);
+	page.glyphs.emplace_back(tableIdx);
+	auto texSize = page.tex.size(0);
+	auto &entry = glyphTable[tableIdx];
+	entry.metrics = res.metrics;
+	entry.uv = {pixelToTexC(pos.x, texSize.x), pixelToTexC(pos.y, texSize.y),
+		pixelToTexC(pos.x + (int)pix.w(), texSize.x), pixelToTexC(pos.y + (int)pix.h(), texSize.y)};
+	entry.page = pageIdx + 1;
 	usedGlyphTableBits |= IG::bit((c >> 11) & 0x1F); // use upper 5 BMP plane bits to map in range 0-31
 	//logMsg("used table bits 0x%X", usedGlyphTableBits);
 	return {};
 }
 
+bool GlyphTextureSet::AtlasPage::allocRect(IG::WP rectSize, IG::WP &pos)
+{
+	int x = penX, y = shelfY, rowHeight = shelfHeight;
+	if(x + rectSize.x > size.x)
+	{
+		// start a new shelf below the current one
+		x = 0;
+		y += rowHeight;
+		rowHeight = 0;
+	}
+	if(rectSize.x > size.x || y + rectSize.y > size.y)
+		return false;
+	pos = {x, y};
+	penX = x + rectSize.x;
+	shelfY = y;
+	shelfHeight = std::max(rowHeight, rectSize.y);
+	return true;
+}
+
+void GlyphTextureSet::resetAtlasPage(AtlasPage &page)
+{
+	for(auto tableIdx : page.glyphs)
+	{
+		glyphTable[tableIdx].page = 0;
+	}
+	page.glyphs.clear();
+	page.penX = page.shelfY = page.shelfHeight = 0;
+}
+
+int GlyphTextureSet::allocAtlasRect(Renderer &r, IG::WP size, IG::PixelFormat format, IG::WP &pos)
+{
+	// leave a blank pixel between glyphs so filtering doesn't pick up neighbors
+	IG::WP paddedSize{size.x + 1, size.y + 1};
+	iterateTimes(atlasPages.size(), i)
+	{
+		auto &page = atlasPages[i];
+		if(page.tex && page.tex.pixmapDesc().format() == format && page.allocRect(paddedSize, pos))
+			return i;
+	}
+	int pageIdx;
+	if(auto it = std::find_if(atlasPages.begin(), atlasPages.end(), [](auto &page){ return !page.tex; });
+		it != atlasPages.end())
+	{
+		pageIdx = std::distance(atlasPages.begin(), it);
+	}
+	else if(atlasPages.size() < MAX_ATLAS_PAGES)
+	{
+		pageIdx = atlasPages.size();
+		atlasPages.emplace_back();
+	}
+	else if(int evictIdx = evictableAtlasPage(); evictIdx != -1)
+	{
+		pageIdx = evictIdx;
+		auto &page = atlasPages[pageIdx];
+		logMsg("evicting glyph atlas page %d with %zu glyphs", pageIdx, page.glyphs.size());
+		resetAtlasPage(page);
+		page.tex = {};
+	}
+	else
+	{
+		pageIdx = atlasPages.size();
+		logMsg("all glyph atlas pages are pinned, adding page %d", pageIdx);
+		atlasPages.emplace_back();
+	}
+	auto &page = atlasPages[pageIdx];
+	int pageSize = std::max(ATLAS_PAGE_SIZE, (int)IG::roundUpPowOf2((uint32_t)std::max(paddedSize.x, paddedSize.y)));
+	page.size = {pageSize, pageSize};
+	page.tex = {r, TextureConfig{{page.size, format}}};
+	page.tex.clear(0);
+	logMsg("made glyph atlas page %d (%dx%d %s)", pageIdx, pageSize, pageSize, format.name());
+	page.allocRect(paddedSize, pos);
+	return pageIdx;
+}
+
+int GlyphTextureSet::evictableAtlasPage() const
+{
+	int pageIdx = -1;
+	iterateTimes(atlasPages.size(), i)
+	{
+		if(i < MAX_PINNED_ATLAS_PAGES && pageCounts && (*pageCounts)[i])
+			continue;
+		if(pageIdx == -1 || atlasPages[i].lastUse < atlasPages[pageIdx].lastUse)
+			pageIdx = i;
+	}
+	if(pageIdx == -1 && atlasPages.size() >= MAX_PINNED_ATLAS_PAGES)
+	{
+		// out of pages that can be pinned, fall back to plain LRU
+		logWarn("too many pinned glyph atlas pages");
+		auto it = std::min_element(atlasPages.begin(), atlasPages.end(),
+			[](auto &a, auto &b){ return a.lastUse < b.lastUse; });
+		pageIdx = std::distance(atlasPages.begin(), it);
+	}
+	return pageIdx;
+}
+
 static std::errc mapCharToTable(uint32_t c, uint32_t &tableIdx)
 {
 	if(GlyphTextureSet::supportsUnicode)
@@ -328,7 +465,7 @@ std::errc GlyphTextureSet::precache(Renderer &r, const char *string)
 			//logMsg( "%c not a known drawable character, skipping", c);
 			continue;
 		}
-		if(glyphTable[tableIdx].glyphPtr)
+		if(glyphTable[tableIdx].isCached())
 		{
 			//logMsg( "%c already cached", c);
 			continue;
@@ -346,7 +483,7 @@ GlyphEntry *GlyphTextureSet::glyphEntry(Renderer &r, int c, bool allowCache)
 	if((bool)mapCharToTable(c, tableIdx))
 		return nullptr;
 	assert(tableIdx < glyphTableEntries);
-	if(!glyphTable[tableIdx].glyphPtr)
+	if(!glyphTable[tableIdx].isCached())
 	{
 		if(!allowCache)
 		{
@@ -357,7 +494,9 @@ GlyphEntry *GlyphTextureSet::glyphEntry(Renderer &r, int c, bool allowCache)
 			return nullptr;
 		//logMsg("glyph:%c (0x%X) was not in table", c, c);
 	}
-	return &glyphTable[tableIdx];
+	auto &entry = glyphTable[tableIdx];
+	atlasPages[entry.page - 1].lastUse = ++atlasUseClock;
+	return &entry;
 }
 
 }
@@ -0,0 +1,200 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "PixelBufferRing"
+#include <imagine/gfx/Gfx.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/utility.h>
+#include "PixelBufferRing.hh"
+#include "private.hh"
+#include <algorithm>
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+namespace Gfx
+{
+
+static constexpr GLbitfield persistentMapFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+static constexpr uint64_t acquireSyncTimeout = 1000000000; // 1 second
+
+PixelBufferRing::PixelBufferRing(Renderer &r, uint32_t bytes):
+	r{r}, bytes{bytes}, persistent{r.support.hasBufferStorage()}
+{
+	for(auto &s : slot)
+	{
+		glGenBuffers(1, &s.pbo);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s.pbo);
+		if(persistent)
+		{
+			r.support.glBufferStorage(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, persistentMapFlags);
+			s.persistentData = r.support.glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, persistentMapFlags);
+			s.data = s.persistentData;
+		}
+		else
+		{
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+			s.data = r.support.glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes,
+				GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		}
+		if(unlikely(!s.data))
+		{
+			logErr("error mapping %u byte buffer", bytes);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			deleteBuffers();
+			return;
+		}
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	logMsg("allocated %u %u byte buffers%s", BUFFERS, bytes, persistent ? " (persistent)" : "");
+}
+
+PixelBufferRing::~PixelBufferRing()
+{
+	deleteBuffers();
+}
+
+PixelBufferRing::Buffer PixelBufferRing::acquire()
+{
+	// buffers are handed out in order so the oldest upload has the most time to complete
+	auto start = nextSlot.load(std::memory_order_relaxed);
+	iterateTimes(BUFFERS, i)
+	{
+		auto idx = (start + i) % BUFFERS;
+		auto &s = slot[idx];
+		if(auto data = s.data.exchange(nullptr, std::memory_order_acquire);
+			data)
+		{
+			nextSlot.store((idx + 1) % BUFFERS, std::memory_order_relaxed);
+			return {data, s.pbo};
+		}
+	}
+	return {};
+}
+
+PixelBufferRing::Buffer PixelBufferRing::acquireSync()
+{
+	if(auto buff = acquire(); buff)
+		return buff;
+	// no free buffer, wait for the oldest pending upload
+	auto start = nextSlot.load(std::memory_order_relaxed);
+	iterateTimes(BUFFERS, i)
+	{
+		auto idx = (start + i) % BUFFERS;
+		auto &s = slot[idx];
+		if(!s.fence)
+			continue;
+		if(r.support.glClientWaitSync(s.fence, GL_SYNC_FLUSH_COMMANDS_BIT, acquireSyncTimeout) == GL_TIMEOUT_EXPIRED)
+		{
+			logWarn("timeout waiting for upload from buffer:%u", s.pbo);
+		}
+		releaseSlot(s);
+		if(auto data = s.data.exchange(nullptr, std::memory_order_acquire);
+			data)
+		{
+			nextSlot.store((idx + 1) % BUFFERS, std::memory_order_relaxed);
+			return {data, s.pbo};
+		}
+	}
+	logErr("no buffers available, all are locked");
+	return {};
+}
+
+bool PixelBufferRing::owns(GLuint pbo) const
+{
+	return pbo && std::any_of(slot.begin(), slot.end(), [pbo](const Slot &s){ return s.pbo == pbo; });
+}
+
+void PixelBufferRing::prepareUpload(GLuint pbo)
+{
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+	if(!persistent)
+		r.support.glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+}
+
+void PixelBufferRing::finishUpload(GLuint pbo)
+{
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	auto s = findSlot(pbo);
+	assumeExpr(s);
+	assert(!s->fence);
+	s->fence = r.support.glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	// return any buffers whose uploads completed since the last check
+	for(auto &other : slot)
+	{
+		if(&other == s || !other.fence)
+			continue;
+		auto status = r.support.glClientWaitSync(other.fence, 0, 0);
+		if(status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+		{
+			releaseSlot(other);
+		}
+	}
+}
+
+void PixelBufferRing::deleteBuffers()
+{
+	for(auto &s : slot)
+	{
+		if(s.fence)
+			r.support.glDeleteSync(s.fence);
+		s.fence = {};
+		// deleting a buffer also unmaps it
+		if(s.pbo)
+			glDeleteBuffers(1, &s.pbo);
+		s.pbo = 0;
+		s.data = nullptr;
+	}
+}
+
+PixelBufferRing::Slot *PixelBufferRing::findSlot(GLuint pbo)
+{
+	for(auto &s : slot)
+	{
+		if(s.pbo == pbo)
+			return &s;
+	}
+	return nullptr;
+}
+
+void *PixelBufferRing::mapSlot(Slot &s)
+{
+	if(persistent)
+		return s.persistentData;
+	// upload has completed so there's no need to synchronize
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s.pbo);
+	auto data = r.support.glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	if(unlikely(!data))
+	{
+		logErr("error mapping buffer:%u", s.pbo);
+	}
+	return data;
+}
+
+void PixelBufferRing::releaseSlot(Slot &s)
+{
+	r.support.glDeleteSync(s.fence);
+	s.fence = {};
+	s.data.store(mapSlot(s), std::memory_order_release);
+}
+
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/gfx/defs.hh>
+#include <array>
+#include <atomic>
+
+namespace Gfx
+{
+
+class Renderer;
+
+// Fixed set of PBOs reused round-robin to stream pixel data into a texture.
+// Each upload is followed by a fence that the GL thread polls when queuing
+// later uploads, handing the buffer back once the GPU is done with it, so
+// acquire() normally returns a mapped buffer without a round trip to the GL
+// thread. Buffers stay mapped for their lifetime when buffer storage is
+// supported, otherwise they're re-mapped after each upload completes.
+class PixelBufferRing
+{
+public:
+	static constexpr uint32_t BUFFERS = 3;
+
+	struct Buffer
+	{
+		void *data{};
+		GLuint pbo = 0;
+
+		constexpr Buffer() {}
+		constexpr Buffer(void *data, GLuint pbo): data{data}, pbo{pbo} {}
+		explicit operator bool() const { return data; }
+	};
+
+	// all functions except acquire() must run on the GL thread
+	PixelBufferRing(Renderer &r, uint32_t bytes);
+	~PixelBufferRing();
+	explicit operator bool() const { return slot[0].pbo; }
+	Buffer acquire();
+	Buffer acquireSync();
+	bool owns(GLuint pbo) const;
+	void prepareUpload(GLuint pbo);
+	void finishUpload(GLuint pbo);
+	bool isPersistent() const { return persistent; }
+
+private:
+	struct Slot
+	{
+		GLuint pbo = 0;
+		GLsync fence{};
+		void *persistentData{};
+		// set when the buffer is mapped & free to write, cleared when acquired
+		std::atomic<void*> data{};
+	};
+	Renderer &r;
+	std::array<Slot, BUFFERS> slot{};
+	std::atomic_uint32_t nextSlot{};
+	uint32_t bytes = 0;
+	bool persistent = false;
+
+	void deleteBuffers();
+	Slot *findSlot(GLuint pbo);
+	void *mapSlot(Slot &s);
+	void releaseSlot(Slot &s);
+};
+
+}
@@ -171,6 +171,12 @@ bool GLRendererTask::commandHandler(decltype(commandPort)::Messages messages, Ba
 	return true;
 }
 
+void GLRendererTask::sendCommand(CommandMessage msg)
+{
+	auto lock = std::scoped_lock<std::mutex>{commandSendMutex};
+	commandPort.send(msg);
+}
+
 RendererTask::RendererTask(Renderer &r): r{r}
 {
 	onExit =
@@ -312,7 +318,7 @@ void RendererTask::draw(DrawableHolder &drawableHolder, Base::Window &win, Base:
 		auto lock = std::unique_lock<std::mutex>{drawMutex};
 		drawCondition.wait(lock, [this](){ return canDraw; });
 		#endif
-		commandPort.send(
+		sendCommand(
 			{
 				Command::DRAW,
 				del,
@@ -366,7 +372,7 @@ void RendererTask::run(RenderTaskFuncDelegate func, IG::Semaphore *semAddr)
 {
 	if(!glCtx)
 		return;
-	commandPort.send({Command::RUN_FUNC, func, semAddr});
+	sendCommand({Command::RUN_FUNC, func, semAddr});
 }
 
 void RendererTask::runSync(RenderTaskFuncDelegate func)
@@ -400,7 +406,7 @@ void RendererTask::stop()
 	}
 	if(hasSeparateContextThread())
 	{
-		commandPort.send({Command::EXIT});
+		sendCommand({Command::EXIT});
 		thread.join(); // GL implementation may assign thread destructor so must join() to make sure it completes
 		commandPort.clear();
 		destroyContext(r.glDpy);
@@ -408,7 +414,7 @@ void RendererTask::stop()
 	else
 	{
 		IG::Semaphore sem{0};
-		commandPort.send({Command::EXIT, &sem});
+		sendCommand({Command::EXIT, &sem});
 		sem.wait();
 		commandPort.clear();
 		r.runGLTaskSync(
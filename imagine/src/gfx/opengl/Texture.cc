@@ -21,6 +21,7 @@
 #include <imagine/util/math/int.hh>
 #include <imagine/data-type/image/GfxImageSource.hh>
 #include "private.hh"
+#include "PixelBufferRing.hh"
 #ifdef __ANDROID__
 #include "../../base/android/android.hh"
 #include "android/GraphicBufferStorage.hh"
@@ -378,6 +379,8 @@ Error GLTexture::init(Renderer &r, TextureConfig config)
 			}
 		}
 		#endif
+		// stream writes through persistent buffers instead of creating one per lock()
+		usePBORing = !directTex && r.support.hasPBOFuncs && r.support.hasSyncFences();
 	}
 	if(config.willGenerateMipmaps() && !r.support.hasImmutableTexStorage)
 	{
@@ -399,6 +402,8 @@ void GLTexture::deinit()
 		{
 			glDeleteTextures(1, &texName_);
 			texName_ = 0;
+			delete pboRing;
+			pboRing = nullptr;
 		});
 	delete directTex;
 }
@@ -516,6 +521,16 @@ Error Texture::setFormat(IG::PixmapDesc desc, uint32_t levels)
 						h = std::max(1u, (h / 2));
 					}
 				}
+				if(usePBORing)
+				{
+					delete pboRing;
+					pboRing = new PixelBufferRing(*r, desc.format().pixelBytes(desc.w() * desc.h()));
+					if(!*pboRing)
+					{
+						delete pboRing;
+						pboRing = nullptr;
+					}
+				}
 			});
 	}
 	assert(levels);
@@ -692,6 +707,26 @@ LockedTextureBuffer Texture::lock(uint32_t level, IG::WindowRect rect)
 		IG::Pixmap pix{pixDesc, buff.data, {buff.pitch, IG::Pixmap::BYTE_UNITS}};
 		return makeLockedTextureBuffer(pix, rect, 0);
 	}
+	else if(pboRing && level == 0)
+	{
+		auto buff = pboRing->acquire();
+		if(unlikely(!buff))
+		{
+			// GPU is still reading every buffer, wait on the GL thread
+			r->runGLTaskSync(
+				[this, &buff]()
+				{
+					buff = pboRing->acquireSync();
+				});
+			if(!buff)
+			{
+				logErr("error acquiring pixel buffer");
+				return {};
+			}
+		}
+		IG::Pixmap pix{{rect.size(), pixDesc.format()}, buff.data};
+		return makeLockedTextureBuffer(pix, rect, level, buff.pbo);
+	}
 	else if(r->support.hasPBOFuncs)
 	{
 		void *data;
@@ -740,11 +775,19 @@ void Texture::unlock(LockedTextureBuffer lockBuff)
 		r->runGLTask(
 			[r = this->r, texName_ = this->texName_, pix = lockBuff.pixmap(),
 			 destPos = IG::WP{lockBuff.sourceDirtyRect().x, lockBuff.sourceDirtyRect().y},
-			 level = lockBuff.level(), pbo = lockBuff.pbo()]()
+			 level = lockBuff.level(), pbo = lockBuff.pbo(), pboRing = this->pboRing]()
 			{
-				//logDMsg("unmapped PBO");
-				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
-				r->support.glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+				bool isRingBuffer = pboRing && pboRing->owns(pbo);
+				if(isRingBuffer)
+				{
+					pboRing->prepareUpload(pbo);
+				}
+				else
+				{
+					//logDMsg("unmapped PBO");
+					glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+					r->support.glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+				}
 				glBindTexture(GL_TEXTURE_2D, texName_);
 				glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignForAddrAndPitch(nullptr, pix.pitchBytes()));
 				glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
@@ -756,8 +799,15 @@ void Texture::unlock(LockedTextureBuffer lockBuff)
 						glTexSubImage2D(GL_TEXTURE_2D, level, destPos.x, destPos.y,
 							pix.w(), pix.h(), format, dataType, nullptr);
 					}, "glTexSubImage2D()");
-				//logDMsg("deleting temporary PBO:%u", pbo);
-				glDeleteBuffers(1, &pbo);
+				if(isRingBuffer)
+				{
+					pboRing->finishUpload(pbo);
+				}
+				else
+				{
+					//logDMsg("deleting temporary PBO:%u", pbo);
+					glDeleteBuffers(1, &pbo);
+				}
 			});
 	}
 }
@@ -242,6 +242,14 @@ void GLRenderer::setupFenceSync()
 	#endif
 }
 
+void GLRenderer::setupBufferStorage(const char *procName)
+{
+	if(support.hasBufferStorage())
+		return;
+	logMsg("using immutable buffer storage");
+	support.glBufferStorage = (typeof(support.glBufferStorage))Base::GLContext::procAddress(procName);
+}
+
 #ifdef CONFIG_GFX_OPENGL_ES
 void GLRenderer::setupAppleFenceSync()
 {
@@ -342,6 +350,11 @@ bool DrawContextSupport::hasSyncFences() const
 	#endif
 }
 
+bool DrawContextSupport::hasBufferStorage() const
+{
+	return glBufferStorage;
+}
+
 void GLRenderer::setupUnmapBufferFunc()
 {
 	#ifdef CONFIG_GFX_OPENGL_ES
@@ -425,6 +438,10 @@ void GLRenderer::checkExtensionString(const char *extStr, bool &useFBOFuncs)
 	{
 		setupImmutableTexStorage(true);
 	}
+	else if(Config::Gfx::OPENGL_ES_MAJOR_VERSION >= 3 && string_equal(extStr, "GL_EXT_buffer_storage"))
+	{
+		setupBufferStorage("glBufferStorageEXT");
+	}
 	#if defined __ANDROID__ || defined __APPLE__
 	else if(string_equal(extStr, "GL_APPLE_sync"))
 	{
@@ -505,6 +522,10 @@ void GLRenderer::checkExtensionString(const char *extStr, bool &useFBOFuncs)
 	{
 		setupFenceSync();
 	}
+	else if(string_equal(extStr, "GL_ARB_buffer_storage"))
+	{
+		setupBufferStorage("glBufferStorage");
+	}
 	#endif
 }
 
@@ -717,6 +738,10 @@ void Renderer::configureRenderer(ThreadMode threadMode)
 			{
 				setupFenceSync();
 			}
+			if(glVer >= 44)
+			{
+				setupBufferStorage("glBufferStorage");
+			}
 
 			// extension functionality
 			if(glVer >= 30)
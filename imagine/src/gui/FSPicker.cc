@@ -23,18 +23,113 @@
 #include <imagine/util/math/int.hh>
 #include <imagine/util/string.h>
 #include <string>
+#include <algorithm>
+#include <iterator>
+
+// Listings of recently scanned directories, reused while the directory's
+// modification time and the picker's filter are unchanged. Names are stored
+// back to back in sorted order with the directories first.
+struct DirListingCache
+{
+	FS::PathString path{};
+	FS::file_time_type mTime{};
+	FSPicker::FilterFunc filter{};
+	std::string names{};
+	uint32_t entries = 0;
+	uint32_t dirs = 0;
+};
+
+static constexpr uint32_t MAX_CACHED_LISTINGS = 4;
+static std::vector<DirListingCache> listingCache{};
+
+// Start with small batches so the first entries show up quickly,
+// then grow them to keep the number of merges low
+static constexpr uint32_t MIN_SCAN_BATCH = 64;
+static constexpr uint32_t MAX_SCAN_BATCH = 4096;
+
+class FSTableView : public TableView
+{
+public:
+	using TableView::TableView;
+
+	void place() final
+	{
+		// unlike TableView, don't compile every item up front,
+		// rows are made & compiled on demand by FSPicker::fileItem()
+		auto cells_ = items(*this);
+		if(cells_)
+		{
+			setYCellSize(IG::makeEvenRoundedUp(item(*this, 0).ySize()*2));
+			visibleCells = IG::divRoundUp(viewRect().ySize(), yCellSize) + 1;
+			scrollToFocusRect();
+		}
+		else
+			visibleCells = 0;
+	}
+};
 
 static bool isValidRootEndChar(char c)
 {
 	return c == '/' || c == '\0';
 }
 
+static bool fileEntryLess(const FSPicker::FileEntry &e1, const FSPicker::FileEntry &e2)
+{
+	if(e1.isDir && !e2.isDir)
+		return true;
+	else if(!e1.isDir && e2.isDir)
+		return false;
+	else
+		return FS::fileStringNoCaseLexCompare(e1.name.data(), e2.name.data());
+}
+
+static const DirListingCache *findCachedListing(const char *path, FS::file_time_type mTime, const FSPicker::FilterFunc &filter)
+{
+	auto it = std::find_if(listingCache.begin(), listingCache.end(),
+		[&](const DirListingCache &c)
+		{
+			return c.mTime == mTime && c.filter == filter && string_equal(c.path.data(), path);
+		});
+	if(it == listingCache.end())
+		return nullptr;
+	// move to the front to keep the list in most recently used order
+	std::rotate(listingCache.begin(), it, it + 1);
+	return &listingCache.front();
+}
+
+static void cacheListing(const char *path, FS::file_time_type mTime, const FSPicker::FilterFunc &filter,
+	const std::vector<FSPicker::FileEntry> &dir)
+{
+	listingCache.erase(std::remove_if(listingCache.begin(), listingCache.end(),
+		[&](const DirListingCache &c){ return string_equal(c.path.data(), path); }), listingCache.end());
+	if(listingCache.size() == MAX_CACHED_LISTINGS)
+		listingCache.pop_back();
+	DirListingCache c{};
+	string_copy(c.path, path);
+	c.mTime = mTime;
+	c.filter = filter;
+	for(auto &entry : dir)
+	{
+		c.names.append(entry.name.data(), entry.name.size() + 1);
+		if(entry.isDir)
+			c.dirs++;
+	}
+	c.entries = dir.size();
+	listingCache.insert(listingCache.begin(), std::move(c));
+}
+
 FSPicker::FSPicker(ViewAttachParams attach, Gfx::PixmapTexture *backRes, Gfx::PixmapTexture *closeRes,
 	FilterFunc filter,  bool singleDir, Gfx::GlyphTextureSet *face):
 	View{attach},
 	filter{filter},
 	singleDir{singleDir}
 {
+	itemCache.resize(ITEM_CACHE_SIZE);
+	scanEvent.attach(
+		[this]()
+		{
+			applyScanResults();
+		});
 	msgText = {msgStr.data(), face};
 	const Gfx::LGradientStopDesc fsNavViewGrad[]
 	{
@@ -71,11 +166,20 @@ FSPicker::FSPicker(ViewAttachParams attach, Gfx::PixmapTexture *backRes, Gfx::Pi
 			}
 		});
 	controller.setNavView(std::move(nav));
-	controller.push(makeView<TableView>(text), Input::defaultEvent());
+	controller.push(makeView<FSTableView>(
+		[this](const TableView &) { return (int)dir.size(); },
+		[this](const TableView &, uint32_t idx) -> MenuItem& { return fileItem(idx); }),
+		Input::defaultEvent());
+}
+
+FSPicker::~FSPicker()
+{
+	cancelScan();
 }
 
 void FSPicker::place()
 {
+	clearItemCache();
 	controller.place(viewRect(), projP);
 	msgText.compile(renderer(), projP);
 }
@@ -182,8 +286,13 @@ std::error_code FSPicker::setPath(const char *path, bool forcePathChange, FS::Ro
 	assert(path);
 	auto prevPath = currPath;
 	std::error_code ec{};
+	std::error_code statusEc{};
+	auto mTime = FS::status(path, statusEc).lastWriteTime();
+	auto cachedListing = statusEc ? nullptr : findCachedListing(path, mTime, filter);
+	FS::directory_iterator dirIt{};
+	if(!cachedListing)
 	{
-		auto dirIt = FS::directory_iterator{path, ec};
+		dirIt = FS::directory_iterator{path, ec};
 		if(ec)
 		{
 			logErr("can't open %s", path);
@@ -193,66 +302,38 @@ std::error_code FSPicker::setPath(const char *path, bool forcePathChange, FS::Ro
 				return ec;
 			}
 		}
-		string_copy(currPath, path);
-		dir.clear();
-		for(auto &entry : dirIt)
-		{
-			if(filter && !filter(entry))
-			{
-				continue;
-			}
-			bool isDir = entry.type() == FS::file_type::directory;
-			dir.emplace_back(FS::makeFileString(entry.name()), isDir);
-		}
 	}
-	std::sort(dir.begin(), dir.end(),
-		[](FileEntry e1, FileEntry e2)
-		{
-			if(e1.isDir && !e2.isDir)
-				return true;
-			else if(!e1.isDir && e2.isDir)
-				return false;
-			else
-				return FS::fileStringNoCaseLexCompare(e1.name, e2.name);
-		});
-	waitForDrawFinished();
-	text.clear();
-	if(dir.size())
+	cancelScan();
+	clearItemCache();
+	string_copy(currPath, path);
+	dir.clear();
+	msgStr = {};
+	if(cachedListing)
 	{
-		msgStr = {};
-		text.reserve(dir.size());
-		for(unsigned idx = 0; auto const &entry : dir)
+		logMsg("using cached listing of %u entries", cachedListing->entries);
+		dir.reserve(cachedListing->entries);
+		const char *name = cachedListing->names.data();
+		iterateTimes(cachedListing->entries, i)
 		{
-			if(entry.isDir)
-			{
-				text.emplace_back(entry.name.data(), &View::defaultBoldFace,
-					[this, idx](Input::Event e)
-					{
-						assert(!singleDir);
-						auto filePath = makePathString(dir[idx].name.data());
-						logMsg("going to dir %s", filePath.data());
-						changeDirByInput(filePath.data(), root, false, e);
-					});
-			}
-			else
-			{
-				text.emplace_back(entry.name.data(),
-					[this, idx](Input::Event e)
-					{
-						onSelectFile_.callCopy(*this, dir[idx].name.data(), e);
-					});
-			}
-			idx++;
+			auto len = strlen(name);
+			dir.emplace_back(std::string{name, len}, i < cachedListing->dirs);
+			name += len + 1;
 		}
+		if(!dir.size())
+			string_copy(msgStr, "Empty Directory");
 	}
-	else
+	else if(ec)
 	{
 		// no entires, show a message instead
-		if(ec)
-			string_printf(msgStr, "Can't open directory:\n%s", ec.message().c_str());
-		else
-			string_copy(msgStr, "Empty Directory");
+		string_printf(msgStr, "Can't open directory:\n%s", ec.message().c_str());
+	}
+	else
+	{
+		string_copy(msgStr, "Loading...");
+		scanMTime = statusEc ? FS::file_time_type{} : mTime;
+		startScan(dirIt);
 	}
+	highlightOnScan = !e.isPointer() && scanThread.joinable();
 	if(!e.isPointer())
 		static_cast<TableView*>(&controller.top())->highlightCell(0);
 	else
@@ -317,6 +398,149 @@ void FSPicker::goUpDirectory(Input::Event e)
 	changeDirByInput(FS::dirname(currPath).data(), root, true, e);
 }
 
+MenuItem &FSPicker::fileItem(uint32_t idx)
+{
+	assumeExpr(idx < dir.size());
+	auto &slot = itemCache[idx % ITEM_CACHE_SIZE];
+	if(slot.idx != (int)idx)
+	{
+		slot.item.reset();
+		if(dir[idx].isDir)
+		{
+			slot.item.emplace(dir[idx].name.data(), &View::defaultBoldFace,
+				[this, idx](Input::Event e)
+				{
+					assert(!singleDir);
+					auto filePath = makePathString(dir[idx].name.data());
+					logMsg("going to dir %s", filePath.data());
+					changeDirByInput(filePath.data(), root, false, e);
+				});
+		}
+		else
+		{
+			slot.item.emplace(dir[idx].name.data(),
+				[this, idx](Input::Event e)
+				{
+					onSelectFile_.callCopy(*this, dir[idx].name.data(), e);
+				});
+		}
+		slot.item->compile(renderer(), projP);
+		slot.idx = idx;
+	}
+	return *slot.item;
+}
+
+void FSPicker::clearItemCache()
+{
+	waitForDrawFinished();
+	for(auto &slot : itemCache)
+	{
+		slot.idx = -1;
+		slot.item.reset();
+	}
+}
+
+void FSPicker::startScan(FS::directory_iterator dirIt)
+{
+	assert(!scanThread.joinable());
+	cancelScan_ = false;
+	scanDone = false;
+	scanThread = std::thread
+	{
+		[this, dirIt, filter = filter]()
+		{
+			std::vector<FileEntry> batch{};
+			uint32_t batchSize = MIN_SCAN_BATCH;
+			auto sendBatch =
+				[&](bool done)
+				{
+					{
+						auto lock = std::scoped_lock<std::mutex>{scanMutex};
+						if(scanPending.empty())
+							scanPending = std::move(batch);
+						else
+							std::move(batch.begin(), batch.end(), std::back_inserter(scanPending));
+						scanDone = done;
+					}
+					batch = {};
+					scanEvent.notify();
+				};
+			// the filter runs on this thread, so it must not touch UI state
+			for(auto &entry : dirIt)
+			{
+				if(cancelScan_.load(std::memory_order_relaxed))
+					return;
+				if(filter && !filter(entry))
+				{
+					continue;
+				}
+				bool isDir = entry.type() == FS::file_type::directory;
+				batch.emplace_back(entry.name(), isDir);
+				if(batch.size() == batchSize)
+				{
+					sendBatch(false);
+					batchSize = std::min(batchSize * 2, MAX_SCAN_BATCH);
+				}
+			}
+			sendBatch(true);
+		}
+	};
+}
+
+void FSPicker::cancelScan()
+{
+	if(!scanThread.joinable())
+		return;
+	cancelScan_ = true;
+	scanThread.join();
+	scanEvent.cancel();
+	scanPending.clear();
+	scanDone = true;
+}
+
+void FSPicker::applyScanResults()
+{
+	std::vector<FileEntry> entries{};
+	bool done;
+	{
+		auto lock = std::scoped_lock<std::mutex>{scanMutex};
+		entries = std::move(scanPending);
+		scanPending = {};
+		done = scanDone;
+	}
+	if(entries.size())
+	{
+		mergeEntries(std::move(entries));
+	}
+	if(done && scanThread.joinable())
+	{
+		scanThread.join();
+		logMsg("finished scanning %s, %zu entries", currPath.data(), dir.size());
+		if(scanMTime)
+			cacheListing(currPath.data(), scanMTime, filter, dir);
+		if(!dir.size())
+			string_copy(msgStr, "Empty Directory");
+	}
+	place();
+	if(highlightOnScan && dir.size())
+	{
+		highlightOnScan = false;
+		static_cast<TableView*>(&controller.top())->highlightCell(0);
+	}
+	postDraw();
+}
+
+void FSPicker::mergeEntries(std::vector<FileEntry> entries)
+{
+	// sort the new batch and merge it with the already sorted entries
+	std::sort(entries.begin(), entries.end(), fileEntryLess);
+	clearItemCache();
+	msgStr = {};
+	auto sortedEntries = dir.size();
+	dir.insert(dir.end(), std::make_move_iterator(entries.begin()), std::make_move_iterator(entries.end()));
+	std::inplace_merge(dir.begin(), dir.begin() + sortedEntries, dir.end(), fileEntryLess);
+}
+
 bool FSPicker::isAtRoot() const
 {
 	if(root.length)
@@ -18,6 +18,7 @@
 #include <sys/inotify.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <time.h>
 #include <imagine/util/algorithm.h>
 #include <imagine/util/bits.h>
 #include <imagine/util/fd-utils.h>
@@ -375,6 +376,13 @@ static bool processDevNode(const char *path, int id, bool notify)
 	bool isJoystick = evDev->setupJoystickBits();
 
 	fd_setNonblock(fd, 1);
+	#ifdef EVIOCSCLOCKID
+	// report event times from the same clock as steadyClockTimestamp() instead of
+	// wall time so input latency can be measured
+	int clockId = CLOCK_MONOTONIC;
+	if(ioctl(fd, EVIOCSCLOCKID, &clockId) < 0)
+		logWarn("unable to set monotonic event clock");
+	#endif
 	evDev->addPollEvent();
 
 	uint32_t devId = 0;
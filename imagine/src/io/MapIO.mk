@@ -4,6 +4,6 @@ inc_io_mmap := 1
 include $(IMAGINE_PATH)/src/io/IO.mk
 include $(IMAGINE_PATH)/src/util/system/pagesize.mk
 
-SRC += io/MapIO.cc io/BufferMapIO.cc
+SRC += io/MapIO.cc io/BufferMapIO.cc io/VectorIO.cc
 
 endif
@@ -0,0 +1,134 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+
+#define LOGTAG "VectorIO"
+#include <imagine/io/VectorIO.hh>
+#include <imagine/logger/logger.h>
+#include <cstring>
+#include "utils.hh"
+
+VectorIO::VectorIO(VectorIO &&o)
+{
+	*this = std::move(o);
+}
+
+VectorIO &VectorIO::operator=(VectorIO &&o)
+{
+	vec = std::exchange(o.vec, {});
+	pos = std::exchange(o.pos, 0);
+	return *this;
+}
+
+GenericIO VectorIO::makeGeneric()
+{
+	return GenericIO{*this};
+}
+
+std::error_code VectorIO::open(std::vector<uint8_t> &vec)
+{
+	this->vec = &vec;
+	pos = 0;
+	return {};
+}
+
+ssize_t VectorIO::read(void *buff, size_t bytes, std::error_code *ecOut)
+{
+	auto bytesRead = readAtPos(buff, bytes, pos, ecOut);
+	if(bytesRead > 0)
+	{
+		pos += bytesRead;
+	}
+	return bytesRead;
+}
+
+ssize_t VectorIO::readAtPos(void *buff, size_t bytes, off_t offset, std::error_code *ecOut)
+{
+	assumeExpr(vec);
+	if((size_t)offset >= vec->size())
+		return 0;
+	bytes = std::min(bytes, vec->size() - offset);
+	memcpy(buff, &(*vec)[offset], bytes);
+	return bytes;
+}
+
+const char *VectorIO::mmapConst()
+{
+	return vec ? (const char*)vec->data() : nullptr;
+}
+
+ssize_t VectorIO::write(const void *buff, size_t bytes, std::error_code *ecOut)
+{
+	assumeExpr(vec);
+	if(pos + bytes > vec->size())
+	{
+		vec->resize(pos + bytes);
+	}
+	memcpy(&(*vec)[pos], buff, bytes);
+	pos += bytes;
+	return bytes;
+}
+
+std::error_code VectorIO::truncate(off_t offset)
+{
+	assumeExpr(vec);
+	vec->resize(offset);
+	pos = std::min(pos, (size_t)offset);
+	return {};
+}
+
+off_t VectorIO::seek(off_t offset, IO::SeekMode mode, std::error_code *ecOut)
+{
+	assumeExpr(vec);
+	if(!isSeekModeValid(mode))
+	{
+		logErr("invalid seek parameter: %d", (int)mode);
+		if(ecOut)
+			*ecOut = {EINVAL, std::system_category()};
+		return -1;
+	}
+	auto newPos = transformOffsetToAbsolute(mode, offset, 0, vec->size(), pos);
+	if(newPos < 0)
+	{
+		logErr("illegal seek position");
+		if(ecOut)
+			*ecOut = {EINVAL, std::system_category()};
+		return -1;
+	}
+	// seeking past the end is allowed, the gap is zero-filled by the next write
+	pos = newPos;
+	return pos;
+}
+
+void VectorIO::close()
+{
+	vec = {};
+	pos = 0;
+}
+
+size_t VectorIO::size()
+{
+	return vec ? vec->size() : 0;
+}
+
+bool VectorIO::eof()
+{
+	return !vec || pos >= vec->size();
+}
+
+VectorIO::operator bool() const
+{
+	return vec;
+}
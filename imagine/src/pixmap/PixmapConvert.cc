@@ -0,0 +1,372 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "PixmapConvert"
+#include <imagine/pixmap/Pixmap.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/utility.h>
+#if defined __x86_64__ || defined __i386__
+#include <immintrin.h>
+#define CONFIG_PIXMAP_X86_KERNELS
+#endif
+#if defined __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+namespace IG
+{
+
+template <class Src, class Dest>
+using LookupLineFunc = void(*)(Dest *dest, const Src *src, const Dest *lut, uint32_t pixels);
+using PackLineFunc = void(*)(uint16_t *dest, const uint32_t *src, uint32_t pixels);
+
+template <class Src, class Dest>
+static void lookupLine(Dest *__restrict__ dest, const Src *__restrict__ src, const Dest *__restrict__ lut, uint32_t pixels)
+{
+	iterateTimes(pixels, i)
+	{
+		dest[i] = lut[src[i]];
+	}
+}
+
+static uint16_t packRGB565(uint32_t p)
+{
+	// rounds each component to the nearest value
+	unsigned r = p       & 0xFF;
+	unsigned g = p >>  8 & 0xFF;
+	unsigned b = p >> 16 & 0xFF;
+	return ((r * 31 + 127) / 255) << 11 |
+		((g * 63 + 127) / 255) << 5 |
+		((b * 31 + 127) / 255);
+}
+
+static void packRGB565Line(uint16_t *__restrict__ dest, const uint32_t *__restrict__ src, uint32_t pixels)
+{
+	iterateTimes(pixels, i)
+	{
+		dest[i] = packRGB565(src[i]);
+	}
+}
+
+// SIMD versions of packRGB565() compute x / 255 as (x + 1 + (x >> 8)) >> 8,
+// which is exact for the 16-bit range the component products stay within
+
+#if defined __SSE2__ || defined __x86_64__
+static __m128i div255Epu16SSE2(__m128i x)
+{
+	return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, _mm_set1_epi16(1)), _mm_srli_epi16(x, 8)), 8);
+}
+
+static __m128i scaleComponentSSE2(__m128i c, int16_t max)
+{
+	return div255Epu16SSE2(_mm_add_epi16(_mm_mullo_epi16(c, _mm_set1_epi16(max)), _mm_set1_epi16(127)));
+}
+
+static void packRGB565LineSSE2(uint16_t *__restrict__ dest, const uint32_t *__restrict__ src, uint32_t pixels)
+{
+	uint32_t i = 0;
+	const auto byteMask = _mm_set1_epi32(0xFF);
+	for(; i + 8 <= pixels; i += 8)
+	{
+		auto p0 = _mm_loadu_si128((const __m128i*)&src[i]);
+		auto p1 = _mm_loadu_si128((const __m128i*)&src[i + 4]);
+		auto r = _mm_packs_epi32(_mm_and_si128(p0, byteMask), _mm_and_si128(p1, byteMask));
+		auto g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 8), byteMask), _mm_and_si128(_mm_srli_epi32(p1, 8), byteMask));
+		auto b = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 16), byteMask), _mm_and_si128(_mm_srli_epi32(p1, 16), byteMask));
+		auto px = _mm_or_si128(_mm_or_si128(
+			_mm_slli_epi16(scaleComponentSSE2(r, 31), 11),
+			_mm_slli_epi16(scaleComponentSSE2(g, 63), 5)),
+			scaleComponentSSE2(b, 31));
+		_mm_storeu_si128((__m128i*)&dest[i], px);
+	}
+	packRGB565Line(dest + i, src + i, pixels - i);
+}
+#endif
+
+#ifdef CONFIG_PIXMAP_X86_KERNELS
+[[gnu::target("avx2")]]
+static __m256i scaleComponentAVX2(__m256i c, int16_t max)
+{
+	auto x = _mm256_add_epi16(_mm256_mullo_epi16(c, _mm256_set1_epi16(max)), _mm256_set1_epi16(127));
+	return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(x, _mm256_set1_epi16(1)), _mm256_srli_epi16(x, 8)), 8);
+}
+
+template <int shift>
+[[gnu::target("avx2")]]
+static __m256i packComponentAVX2(__m256i p0, __m256i p1)
+{
+	const auto byteMask = _mm256_set1_epi32(0xFF);
+	auto c = _mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(p0, shift), byteMask),
+		_mm256_and_si256(_mm256_srli_epi32(p1, shift), byteMask));
+	// packs works within 128-bit lanes, restore the pixel order
+	return _mm256_permute4x64_epi64(c, 0xD8);
+}
+
+[[gnu::target("avx2")]]
+static void packRGB565LineAVX2(uint16_t *__restrict__ dest, const uint32_t *__restrict__ src, uint32_t pixels)
+{
+	uint32_t i = 0;
+	for(; i + 16 <= pixels; i += 16)
+	{
+		auto p0 = _mm256_loadu_si256((const __m256i*)&src[i]);
+		auto p1 = _mm256_loadu_si256((const __m256i*)&src[i + 8]);
+		auto px = _mm256_or_si256(_mm256_or_si256(
+			_mm256_slli_epi16(scaleComponentAVX2(packComponentAVX2<0>(p0, p1), 31), 11),
+			_mm256_slli_epi16(scaleComponentAVX2(packComponentAVX2<8>(p0, p1), 63), 5)),
+			scaleComponentAVX2(packComponentAVX2<16>(p0, p1), 31));
+		_mm256_storeu_si256((__m256i*)&dest[i], px);
+	}
+	packRGB565Line(dest + i, src + i, pixels - i);
+}
+
+[[gnu::target("avx2")]]
+static void lookupLine8To32AVX2(uint32_t *__restrict__ dest, const uint8_t *__restrict__ src, const uint32_t *__restrict__ lut, uint32_t pixels)
+{
+	uint32_t i = 0;
+	for(; i + 8 <= pixels; i += 8)
+	{
+		auto idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)&src[i]));
+		_mm256_storeu_si256((__m256i*)&dest[i], _mm256_i32gather_epi32((const int*)lut, idx, 4));
+	}
+	lookupLine(dest + i, src + i, lut, pixels - i);
+}
+
+[[gnu::target("avx2")]]
+static void lookupLine16To32AVX2(uint32_t *__restrict__ dest, const uint16_t *__restrict__ src, const uint32_t *__restrict__ lut, uint32_t pixels)
+{
+	uint32_t i = 0;
+	for(; i + 8 <= pixels; i += 8)
+	{
+		auto idx = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)&src[i]));
+		_mm256_storeu_si256((__m256i*)&dest[i], _mm256_i32gather_epi32((const int*)lut, idx, 4));
+	}
+	lookupLine(dest + i, src + i, lut, pixels - i);
+}
+
+// 32-bit gathers of 16-bit entries read each entry together with the one
+// before it, or the one after for index 0, so no read leaves a table of at
+// least 2 entries
+
+[[gnu::target("avx2")]]
+static __m256i gatherLookup16AVX2(__m256i idx, const uint16_t *lut)
+{
+	auto notFirst = _mm256_min_epu32(idx, _mm256_set1_epi32(1));
+	auto pairs = _mm256_i32gather_epi32((const int*)lut, _mm256_sub_epi32(idx, notFirst), 2);
+	return _mm256_and_si256(_mm256_srlv_epi32(pairs, _mm256_slli_epi32(notFirst, 4)), _mm256_set1_epi32(0xFFFF));
+}
+
+template <class Src>
+[[gnu::target("avx2")]]
+static void lookupLineTo16AVX2(uint16_t *__restrict__ dest, const Src *__restrict__ src, const uint16_t *__restrict__ lut, uint32_t pixels)
+{
+	uint32_t i = 0;
+	for(; i + 16 <= pixels; i += 16)
+	{
+		__m256i idx0, idx1;
+		if constexpr(std::is_same_v<Src, uint8_t>)
+		{
+			auto s = _mm_loadu_si128((const __m128i*)&src[i]);
+			idx0 = _mm256_cvtepu8_epi32(s);
+			idx1 = _mm256_cvtepu8_epi32(_mm_srli_si128(s, 8));
+		}
+		else
+		{
+			idx0 = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)&src[i]));
+			idx1 = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)&src[i + 8]));
+		}
+		auto px = _mm256_packus_epi32(gatherLookup16AVX2(idx0, lut), gatherLookup16AVX2(idx1, lut));
+		// packus works within 128-bit lanes, restore the pixel order
+		_mm256_storeu_si256((__m256i*)&dest[i], _mm256_permute4x64_epi64(px, 0xD8));
+	}
+	lookupLine(dest + i, src + i, lut, pixels - i);
+}
+
+static bool cpuHasAVX2()
+{
+	static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+	return hasAVX2;
+}
+#endif
+
+#ifdef __ARM_NEON
+static uint16x8_t scaleComponentNEON(uint8x8_t c, uint16_t max)
+{
+	auto x = vmlaq_n_u16(vdupq_n_u16(127), vmovl_u8(c), max);
+	return vshrq_n_u16(vaddq_u16(vaddq_u16(x, vdupq_n_u16(1)), vshrq_n_u16(x, 8)), 8);
+}
+
+static void packRGB565LineNEON(uint16_t *__restrict__ dest, const uint32_t *__restrict__ src, uint32_t pixels)
+{
+	uint32_t i = 0;
+	for(; i + 8 <= pixels; i += 8)
+	{
+		auto p = vld4_u8((const uint8_t*)&src[i]);
+		auto px = vorrq_u16(vorrq_u16(
+			vshlq_n_u16(scaleComponentNEON(p.val[0], 31), 11),
+			vshlq_n_u16(scaleComponentNEON(p.val[1], 63), 5)),
+			scaleComponentNEON(p.val[2], 31));
+		vst1q_u16(&dest[i], px);
+	}
+	packRGB565Line(dest + i, src + i, pixels - i);
+}
+#endif
+
+#ifdef __aarch64__
+// 256 entry 16-bit table split into low & high byte planes, each covered by
+// 4 64-byte table registers
+struct LookupPlanes16NEON
+{
+	uint8x16x4_t lo[4];
+	uint8x16x4_t hi[4];
+};
+
+static void makeLookupPlanesNEON(LookupPlanes16NEON &planes, const uint16_t *lut)
+{
+	iterateTimes(16, i)
+	{
+		auto e = vld2q_u8((const uint8_t*)&lut[i * 16]);
+		planes.lo[i / 4].val[i % 4] = e.val[0];
+		planes.hi[i / 4].val[i % 4] = e.val[1];
+	}
+}
+
+static void lookupLine8To16NEON(uint16_t *__restrict__ dest, const uint8_t *__restrict__ src,
+	const LookupPlanes16NEON &planes, const uint16_t *__restrict__ lut, uint32_t pixels)
+{
+	uint32_t i = 0;
+	for(; i + 16 <= pixels; i += 16)
+	{
+		// indices outside a table register's 64 entries keep the previous result
+		auto idx = vld1q_u8(&src[i]);
+		auto lo = vqtbl4q_u8(planes.lo[0], idx);
+		auto hi = vqtbl4q_u8(planes.hi[0], idx);
+		auto idx1 = vsubq_u8(idx, vdupq_n_u8(64));
+		lo = vqtbx4q_u8(lo, planes.lo[1], idx1);
+		hi = vqtbx4q_u8(hi, planes.hi[1], idx1);
+		auto idx2 = vsubq_u8(idx, vdupq_n_u8(128));
+		lo = vqtbx4q_u8(lo, planes.lo[2], idx2);
+		hi = vqtbx4q_u8(hi, planes.hi[2], idx2);
+		auto idx3 = vsubq_u8(idx, vdupq_n_u8(192));
+		lo = vqtbx4q_u8(lo, planes.lo[3], idx3);
+		hi = vqtbx4q_u8(hi, planes.hi[3], idx3);
+		vst2q_u8((uint8_t*)&dest[i], uint8x16x2_t{{lo, hi}});
+	}
+	lookupLine(dest + i, src + i, lut, pixels - i);
+}
+#endif
+
+template <class Src, class Dest>
+static LookupLineFunc<Src, Dest> lookupLineKernel()
+{
+	#ifdef CONFIG_PIXMAP_X86_KERNELS
+	if(cpuHasAVX2())
+	{
+		if constexpr(std::is_same_v<Dest, uint16_t>)
+			return lookupLineTo16AVX2<Src>;
+		else if constexpr(std::is_same_v<Src, uint8_t>)
+			return lookupLine8To32AVX2;
+		else
+			return lookupLine16To32AVX2;
+	}
+	#endif
+	return lookupLine<Src, Dest>;
+}
+
+static PackLineFunc packRGB565LineKernel()
+{
+	#ifdef CONFIG_PIXMAP_X86_KERNELS
+	if(cpuHasAVX2())
+		return packRGB565LineAVX2;
+	#endif
+	#if defined __SSE2__ || defined __x86_64__
+	return packRGB565LineSSE2;
+	#elif defined __ARM_NEON
+	return packRGB565LineNEON;
+	#else
+	return packRGB565Line;
+	#endif
+}
+
+template <class Src, class Dest, class LineFunc>
+static void convertLines(const Pixmap &dest, const Pixmap &src, LineFunc lineFunc)
+{
+	auto srcData = src.pixel({});
+	auto destData = dest.pixel({});
+	if(dest.w() == src.w() && !dest.isPadded() && !src.isPadded())
+	{
+		lineFunc((Dest*)destData, (const Src*)srcData, src.w() * src.h());
+		return;
+	}
+	iterateTimes(src.h(), i)
+	{
+		lineFunc((Dest*)destData, (const Src*)srcData, src.w());
+		srcData += src.pitchBytes();
+		destData += dest.pitchBytes();
+	}
+}
+
+template <class Dest>
+static void writeLookup(const Pixmap &dest, const Dest *lut, const Pixmap &src)
+{
+	assumeExpr(dest.format().bytesPerPixel() == sizeof(Dest));
+	switch(src.format().bytesPerPixel())
+	{
+		bcase 1:
+		{
+			#ifdef __aarch64__
+			// table lookups need the planes built from the current table
+			if constexpr(std::is_same_v<Dest, uint16_t>)
+			{
+				LookupPlanes16NEON planes;
+				makeLookupPlanesNEON(planes, lut);
+				convertLines<uint8_t, Dest>(dest, src,
+					[&](Dest *d, const uint8_t *s, uint32_t pixels){ lookupLine8To16NEON(d, s, planes, lut, pixels); });
+				return;
+			}
+			#endif
+			static const auto kernel = lookupLineKernel<uint8_t, Dest>();
+			convertLines<uint8_t, Dest>(dest, src,
+				[lut](Dest *d, const uint8_t *s, uint32_t pixels){ kernel(d, s, lut, pixels); });
+		}
+		bcase 2:
+		{
+			static const auto kernel = lookupLineKernel<uint16_t, Dest>();
+			convertLines<uint16_t, Dest>(dest, src,
+				[lut](Dest *d, const uint16_t *s, uint32_t pixels){ kernel(d, s, lut, pixels); });
+		}
+		bdefault:
+			bug_unreachable("invalid lookup source bytes per pixel:%d", src.format().bytesPerPixel());
+	}
+}
+
+void Pixmap::writeLookup(const uint16_t *lut, const IG::Pixmap &pixmap)
+{
+	IG::writeLookup(*this, lut, pixmap);
+}
+
+void Pixmap::writeLookup(const uint32_t *lut, const IG::Pixmap &pixmap)
+{
+	IG::writeLookup(*this, lut, pixmap);
+}
+
+void Pixmap::writeRGBA8888AsRGB565(const IG::Pixmap &pixmap)
+{
+	assumeExpr(format().bytesPerPixel() == 2);
+	assumeExpr(pixmap.format().bytesPerPixel() == 4);
+	static const auto kernel = packRGB565LineKernel();
+	convertLines<uint32_t, uint16_t>(*this, pixmap, kernel);
+}
+
+}
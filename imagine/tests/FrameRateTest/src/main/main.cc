@@ -23,6 +23,9 @@
 #include "tests.hh"
 #include "TestPicker.hh"
 #include "cpuUtils.hh"
+#include "pixmapBench.hh"
+#include "messagePortBench.hh"
+#include "resamplerBench.hh"
 #ifdef __ANDROID__
 #include <imagine/base/android/RootCpufreqParamSetter.hh>
 #endif
@@ -43,6 +46,9 @@ static TestParams testParam[]
 	{TEST_CLEAR},
 	{TEST_DRAW, {320, 224}},
 	{TEST_WRITE, {320, 224}},
+	{TEST_UPLOAD, {256, 224}},
+	{TEST_UPLOAD, {512, 448}},
+	{TEST_UPLOAD, {704, 512}},
 };
 #ifdef __ANDROID__
 static std::unique_ptr<Base::RootCpufreqParamSetter> cpuFreq{};
@@ -108,6 +114,8 @@ TestFramework *startTest(Base::Window &win, Gfx::Renderer &r, const TestParams &
 			activeTest = new DrawTest{};
 		bcase TEST_WRITE:
 			activeTest = new WriteTest{};
+		bcase TEST_UPLOAD:
+			activeTest = new UploadTest{};
 	}
 	activeTest->init(r, t.pixmapSize);
 	Base::setIdleDisplayPowerSave(false);
@@ -156,6 +164,38 @@ namespace Base
 
 void onInit(int argc, char** argv)
 {
+	iterateTimes(argc, i)
+	{
+		if(string_equal(argv[i], "-pixmap-bench"))
+		{
+			runPixmapBenchmark();
+			Base::exit();
+			return;
+		}
+		if(string_equal(argv[i], "-message-port-bench"))
+		{
+			runMessagePortBenchmark();
+			Base::exit();
+			return;
+		}
+		if(string_equal(argv[i], "-message-port-test"))
+		{
+			Base::exit(runMessagePortOverflowTest() ? 0 : 1);
+			return;
+		}
+		if(string_equal(argv[i], "-resampler-bench"))
+		{
+			runResamplerBenchmark();
+			Base::exit();
+			return;
+		}
+		if(string_equal(argv[i], "-resampler-test"))
+		{
+			Base::exit(runResamplerBacklogTest() ? 0 : 1);
+			return;
+		}
+	}
+
 	Base::addOnResume(
 		[](bool focused)
 		{
@@ -0,0 +1,190 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+
+#define LOGTAG "messagePortBench"
+#include "messagePortBench.hh"
+#include <imagine/base/MessagePort.hh>
+#include <imagine/thread/Thread.hh>
+#include <imagine/time/Time.hh>
+#include <imagine/logger/logger.h>
+
+static constexpr uint32_t benchMessages = 100000;
+
+struct PingMessage
+{
+	uint32_t seq{};
+
+	explicit operator bool() const { return seq; }
+};
+
+template <class Port>
+struct PingPong
+{
+	Port pingPort{"PingPong Ping"};
+	Port pongPort{"PingPong Pong"};
+	bool echoRunning{};
+	bool driverRunning{};
+};
+
+// echo each ping back from another thread until the last one arrives,
+// the driver sends the next ping once it gets the reply
+template <class Port>
+static IG::Time roundTripTime()
+{
+	PingPong<Port> state;
+	auto echoThread = IG::makeThreadSync(
+		[&state](auto &sem)
+		{
+			auto eventLoop = Base::EventLoop::makeForThread();
+			state.pingPort.attach(eventLoop,
+				[&state](auto msgs)
+				{
+					for(auto msg : msgs)
+					{
+						state.pongPort.send(msg);
+						if(msg.seq == benchMessages)
+						{
+							state.echoRunning = false;
+							Base::EventLoop::forThread().stop();
+							return false;
+						}
+					}
+					return true;
+				});
+			state.echoRunning = true;
+			sem.notify();
+			eventLoop.run(state.echoRunning);
+			state.pingPort.detach();
+		});
+	IG::Time time{};
+	std::thread driverThread
+	{
+		[&state, &time]()
+		{
+			auto eventLoop = Base::EventLoop::makeForThread();
+			state.pongPort.attach(eventLoop,
+				[&state](auto msgs)
+				{
+					for(auto msg : msgs)
+					{
+						if(msg.seq == benchMessages)
+						{
+							state.driverRunning = false;
+							Base::EventLoop::forThread().stop();
+							return false;
+						}
+						state.pingPort.send({msg.seq + 1});
+					}
+					return true;
+				});
+			state.driverRunning = true;
+			time = IG::timeFunc(
+				[&]()
+				{
+					state.pingPort.send({1});
+					eventLoop.run(state.driverRunning);
+				});
+			state.pongPort.detach();
+		}
+	};
+	driverThread.join();
+	echoThread.join();
+	return time / benchMessages;
+}
+
+void runMessagePortBenchmark()
+{
+	logMsg("running message port benchmark with %u round trips", benchMessages);
+	double pipeUSecs = IG::FloatSeconds(roundTripTime<Base::PipeMessagePort<PingMessage>>()).count() * 1000000.;
+	double spscUSecs = IG::FloatSeconds(roundTripTime<Base::SPSCMessagePort<PingMessage>>()).count() * 1000000.;
+	logMsg("round trip PipeMessagePort: %.2f usecs, SPSCMessagePort: %.2f usecs (%.2fx)",
+		pipeUSecs, spscUSecs, pipeUSecs / spscUSecs);
+}
+
+// drain whatever the port holds on the calling thread, counting messages that
+// arrive out of sequence
+template <class Port>
+static uint32_t drainInOrder(Port &port, uint32_t &nextSeq)
+{
+	uint32_t outOfOrder = 0;
+	typename Port::Messages msgs{port};
+	for(auto msg : msgs)
+	{
+		if(msg.seq != nextSeq)
+			outOfOrder++;
+		nextSeq = msg.seq + 1;
+	}
+	return outOfOrder;
+}
+
+bool runMessagePortOverflowTest()
+{
+	constexpr uint32_t capacity = 16;
+	using Port = Base::SPSCMessagePort<PingMessage, capacity>;
+	bool passed = true;
+	// fill the ring past its capacity from the thread that reads it, a send()
+	// that waited for room would never return here
+	{
+		Port port{"Overflow Test"};
+		constexpr uint32_t sent = capacity * 4;
+		for(uint32_t seq = 1; seq <= sent; seq++)
+		{
+			port.send({seq});
+		}
+		auto overflowed = port.overflowSize();
+		uint32_t nextSeq = 1;
+		auto outOfOrder = drainInOrder(port, nextSeq);
+		// with the queue drained, new messages use the ring again
+		port.send({nextSeq});
+		auto overflowedAfterDrain = port.overflowSize();
+		outOfOrder += drainInOrder(port, nextSeq);
+		logMsg("same thread: %u messages through a %u entry ring, %u overflowed, %u out of order",
+			sent + 1, capacity, (uint32_t)overflowed, outOfOrder);
+		if(overflowed != sent - capacity || overflowedAfterDrain || outOfOrder || nextSeq != sent + 2)
+		{
+			logErr("same thread overflow test failed");
+			passed = false;
+		}
+	}
+	// a sender that never waits against a receiver polling from another thread
+	{
+		Port port{"Overflow Test"};
+		uint32_t nextSeq = 1;
+		uint32_t outOfOrder = 0;
+		std::thread receiverThread
+		{
+			[&]()
+			{
+				while(nextSeq <= benchMessages)
+				{
+					outOfOrder += drainInOrder(port, nextSeq);
+				}
+			}
+		};
+		for(uint32_t seq = 1; seq <= benchMessages; seq++)
+		{
+			port.send({seq});
+		}
+		receiverThread.join();
+		logMsg("two threads: %u messages, %u out of order", benchMessages, outOfOrder);
+		if(outOfOrder || port.overflowSize())
+		{
+			logErr("two thread overflow test failed");
+			passed = false;
+		}
+	}
+	return passed;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+
+// Times message round trips between two threads through the pipe and
+// SPSC message ports and logs the average latency of each
+void runMessagePortBenchmark();
+
+// Sends past the SPSC port's ring capacity, first from the receiving thread
+// and then against a receiver on another thread, and checks every message
+// arrives once and in order, returns true on success
+bool runMessagePortOverflowTest();
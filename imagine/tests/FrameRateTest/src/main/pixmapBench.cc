@@ -0,0 +1,103 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "pixmapBench"
+#include "pixmapBench.hh"
+#include <imagine/pixmap/Pixmap.hh>
+#include <imagine/time/Time.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/utility.h>
+#include <memory>
+
+static constexpr IG::WP benchSize{320, 240};
+static constexpr uint benchRuns = 500;
+
+template <class Func>
+static double mPixPerSec(Func &&func)
+{
+	func(); // warm up caches
+	auto time = IG::timeFunc(
+		[&]()
+		{
+			iterateTimes(benchRuns, i)
+			{
+				func();
+			}
+		});
+	double pixels = (double)benchSize.x * benchSize.y * benchRuns;
+	return pixels / IG::FloatSeconds(time).count() / 1000000.;
+}
+
+template <class Src, class Dest>
+static void benchLookup(IG::PixelFormat srcFormat, IG::PixelFormat destFormat, size_t lutSize)
+{
+	IG::MemPixmap srcPix{{benchSize, srcFormat}};
+	IG::MemPixmap destPix{{benchSize, destFormat}};
+	auto src = (Src*)srcPix.pixel({});
+	iterateTimes(benchSize.x * benchSize.y, i)
+	{
+		src[i] = (i * 2654435761u) % lutSize;
+	}
+	auto lut = std::make_unique<Dest[]>(lutSize);
+	iterateTimes(lutSize, i)
+	{
+		lut[i] = i * 40503u;
+	}
+	auto lutPtr = lut.get();
+	IG::Pixmap dest = destPix;
+	auto transformed = mPixPerSec([&](){ dest.writeTransformed([lutPtr](Src p){ return lutPtr[p]; }, srcPix); });
+	auto lookup = mPixPerSec([&](){ dest.writeLookup(lutPtr, srcPix); });
+	logMsg("%s -> %s lookup: %.1f MPix/s, writeTransformed: %.1f MPix/s (%.2fx)",
+		srcFormat.name(), destFormat.name(), lookup, transformed, lookup / transformed);
+}
+
+static void benchRGB565Pack()
+{
+	IG::MemPixmap srcPix{{benchSize, IG::PIXEL_FMT_RGBA8888}};
+	IG::MemPixmap destPix{{benchSize, IG::PIXEL_FMT_RGB565}};
+	auto src = (uint32_t*)srcPix.pixel({});
+	iterateTimes(benchSize.x * benchSize.y, i)
+	{
+		src[i] = i * 2654435761u;
+	}
+	IG::Pixmap dest = destPix;
+	auto transformed = mPixPerSec(
+		[&]()
+		{
+			dest.writeTransformed(
+				[](uint32_t p)
+				{
+					unsigned r = p       & 0xFF;
+					unsigned g = p >>  8 & 0xFF;
+					unsigned b = p >> 16 & 0xFF;
+					return ((r * 31 + 127) / 255) << 11 |
+						((g * 63 + 127) / 255) << 5 |
+						((b * 31 + 127) / 255);
+				}, srcPix);
+		});
+	auto packed = mPixPerSec([&](){ dest.writeRGBA8888AsRGB565(srcPix); });
+	logMsg("RGBA8888 -> RGB565 pack: %.1f MPix/s, writeTransformed: %.1f MPix/s (%.2fx)",
+		packed, transformed, packed / transformed);
+}
+
+void runPixmapBenchmark()
+{
+	logMsg("running pixmap benchmark with %dx%d frames", benchSize.x, benchSize.y);
+	benchLookup<uint8_t, uint16_t>(IG::PIXEL_FMT_I8, IG::PIXEL_FMT_RGB565, 0x100);
+	benchLookup<uint8_t, uint32_t>(IG::PIXEL_FMT_I8, IG::PIXEL_FMT_RGBA8888, 0x100);
+	benchLookup<uint16_t, uint16_t>(IG::PIXEL_FMT_RGB565, IG::PIXEL_FMT_RGB565, 0x10000);
+	benchLookup<uint16_t, uint32_t>(IG::PIXEL_FMT_RGB565, IG::PIXEL_FMT_RGBA8888, 0x10000);
+	benchRGB565Pack();
+}
@@ -0,0 +1,235 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+
+#define LOGTAG "resamplerBench"
+#include "resamplerBench.hh"
+#include <imagine/audio/Resampler.hh>
+#include <imagine/audio/SampleConvert.hh>
+#include <imagine/time/Time.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/algorithm.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+static constexpr uint32_t inRate = 44100;
+static constexpr uint32_t outRate = 48000;
+static constexpr uint32_t inFrames = inRate * 10;
+static constexpr uint32_t chunkFrames = 735; // one 60Hz video frame
+static constexpr double amplitude = 16384.;
+static constexpr double step = (double)inRate / outRate;
+
+using Samples = std::vector<int16_t>;
+
+static Samples makeTone(double freq)
+{
+	Samples samples(inFrames * 2);
+	iterateTimes(inFrames, i)
+	{
+		samples[i * 2] = samples[i * 2 + 1] = std::lround(amplitude * std::sin(2. * M_PI * freq * i / inRate));
+	}
+	return samples;
+}
+
+// resamplers differ in delay and the exact ratio they settle on, so the
+// tone is fit to the output by least squares and the residual counts as noise
+static double snrDB(const Samples &out, double freq, double outStep)
+{
+	// skip the start so filter warm-up isn't counted
+	uint32_t first = outRate / 10, last = out.size() / 2 - outRate / 10;
+	double w = 2. * M_PI * freq * outStep / inRate;
+	double sinSum = 0, cosSum = 0;
+	for(uint32_t n = first; n < last; n++)
+	{
+		sinSum += out[n * 2] * std::sin(w * n);
+		cosSum += out[n * 2] * std::cos(w * n);
+	}
+	double a = 2. * sinSum / (last - first), b = 2. * cosSum / (last - first);
+	double signal = 0, noise = 0;
+	for(uint32_t n = first; n < last; n++)
+	{
+		double ref = a * std::sin(w * n) + b * std::cos(w * n);
+		double err = out[n * 2] - ref;
+		signal += ref * ref;
+		noise += err * err;
+	}
+	return 10. * std::log10(signal / noise);
+}
+
+// nearest neighbor like EmuAudio's simpleResample(), kept as the baseline
+static double resampleNearest(const Samples &in, Samples &out)
+{
+	uint32_t outFrames = inFrames / step;
+	out.resize(outFrames * 2);
+	iterateTimes(outFrames, i)
+	{
+		auto src = std::min((uint32_t)std::lround(i * step), inFrames - 1);
+		out[i * 2] = in[src * 2];
+		out[i * 2 + 1] = in[src * 2 + 1];
+	}
+	return step;
+}
+
+static double resamplePolyphase(const Samples &in, Samples &out)
+{
+	IG::Audio::Resampler resampler{inRate, outRate, 2};
+	out.resize(resampler.maxOutputFrames(inFrames) * 2);
+	uint32_t outFrames = 0;
+	for(uint32_t i = 0; i < inFrames; i += chunkFrames)
+	{
+		auto frames = std::min(chunkFrames, inFrames - i);
+		outFrames += resampler.process(&in[i * 2], frames, &out[outFrames * 2], resampler.maxOutputFrames(frames));
+	}
+	out.resize(outFrames * 2);
+	return step;
+}
+
+template <class Func>
+static void bench(const char *name, Func &&func, const Samples &lowTone, const Samples &highTone)
+{
+	Samples out;
+	func(lowTone, out); // warm up caches
+	double outStep{};
+	auto time = IG::timeFunc([&](){ outStep = func(lowTone, out); });
+	double mFramesPerSec = (out.size() / 2) / IG::FloatSeconds(time).count() / 1000000.;
+	auto lowSNR = snrDB(out, 1000., outStep);
+	func(highTone, out);
+	auto highSNR = snrDB(out, 10000., outStep);
+	logMsg("%s: %.1f MFrames/s, SNR 1kHz:%.1fdB 10kHz:%.1fdB", name, mFramesPerSec, lowSNR, highSNR);
+}
+
+// CPU time to feed one second of audio through each of EmuAudio's write paths,
+// one video frame at a time with the output rate matching the input
+template <class Func>
+static void benchPipeline(const char *name, Func &&func)
+{
+	func(); // warm up caches
+	auto time = IG::timeFunc(func);
+	double uSecsPerSec = IG::FloatSeconds(time).count() * 1000000. / ((double)inFrames / inRate);
+	logMsg("%s: %.1fus per second of audio", name, uSecsPerSec);
+}
+
+static void runPipelineBenchmark(const Samples &tone)
+{
+	constexpr float volume = .75f;
+	constexpr double rateAdjust = 1.002; // a typical rate control nudge
+	std::vector<int16_t> outI16(chunkFrames * 4);
+	std::vector<float> outF32(chunkFrames * 4);
+	benchPipeline("i16 copy",
+		[&]()
+		{
+			for(uint32_t i = 0; i < inFrames; i += chunkFrames)
+				std::copy_n(&tone[i * 2], std::min(chunkFrames, inFrames - i) * 2, outI16.data());
+		});
+	benchPipeline("i16 with volume",
+		[&]()
+		{
+			for(uint32_t i = 0; i < inFrames; i += chunkFrames)
+				IG::Audio::convertSamples(outI16.data(), &tone[i * 2], std::min(chunkFrames, inFrames - i) * 2, volume);
+		});
+	benchPipeline("i16 -> f32 with volume",
+		[&]()
+		{
+			for(uint32_t i = 0; i < inFrames; i += chunkFrames)
+				IG::Audio::convertSamples(outF32.data(), &tone[i * 2], std::min(chunkFrames, inFrames - i) * 2, volume);
+		});
+	IG::Audio::Resampler resampler{inRate, inRate, 2};
+	resampler.setRatioAdjust(rateAdjust);
+	resampler.setGain(volume);
+	benchPipeline("i16 rate control",
+		[&]()
+		{
+			resampler.reset();
+			for(uint32_t i = 0; i < inFrames; i += chunkFrames)
+			{
+				auto frames = std::min(chunkFrames, inFrames - i);
+				resampler.process(&tone[i * 2], frames, outI16.data(), resampler.maxOutputFrames(frames));
+			}
+		});
+	benchPipeline("i16 -> f32 rate control",
+		[&]()
+		{
+			resampler.reset();
+			for(uint32_t i = 0; i < inFrames; i += chunkFrames)
+			{
+				auto frames = std::min(chunkFrames, inFrames - i);
+				resampler.process(&tone[i * 2], frames, outF32.data(), resampler.maxOutputFrames(frames));
+			}
+		});
+}
+
+void runResamplerBenchmark()
+{
+	logMsg("running resampler benchmark with %u stereo frames %uHz -> %uHz", inFrames, inRate, outRate);
+	auto lowTone = makeTone(1000.);
+	auto highTone = makeTone(10000.);
+	bench("nearest", resampleNearest, lowTone, highTone);
+	bench("polyphase", resamplePolyphase, lowTone, highTone);
+	logMsg("running audio write path benchmark at %uHz", inRate);
+	runPipelineBenchmark(lowTone);
+}
+
+bool runResamplerBacklogTest()
+{
+	constexpr uint32_t inRate = 44100, outRate = 22050, frameRate = 60, channels = 2;
+	constexpr double outFramesPerVideoFrame = (double)outRate / frameRate;
+	// buffer sizes EmuAudio uses with its smallest setting of 2 buffers and rate control on
+	const uint32_t incrementFrames = std::ceil(outFramesPerVideoFrame);
+	const uint32_t targetFillFrames = incrementFrames * 2;
+	const uint32_t capacityFrames = targetFillFrames + incrementFrames * 2;
+	logMsg("running resampler backlog test %uHz -> %uHz with %u frame target fill", inRate, outRate, targetFillFrames);
+	IG::Audio::Resampler resampler{inRate, outRate, channels};
+	resampler.setMaxBacklog(resampler.inputFramesFor(targetFillFrames + incrementFrames));
+	std::vector<int16_t> in(inRate / frameRate * 2 * channels);
+	std::vector<int16_t> out(capacityFrames * channels);
+	uint32_t fillFrames = 0;
+	bool playing = false;
+	double readFrames = 0;
+	iterateTimes(frameRate * 10, frame)
+	{
+		// cores don't write the same amount every frame and rate control
+		// runs slightly fast or slow to hold the fill level
+		uint32_t inFrames = inRate / frameRate;
+		if(frame % 7 == 0)
+			inFrames += 64;
+		else if(frame % 7 == 1)
+			inFrames -= 64;
+		resampler.setRatioAdjust(frame % 60 < 30 ? 1.005 : .995);
+		auto outFrames = std::min(resampler.maxOutputFrames(inFrames), capacityFrames - fillFrames);
+		fillFrames += resampler.process(in.data(), inFrames, out.data(), outFrames);
+		if(fillFrames >= targetFillFrames)
+			playing = true;
+		if(playing)
+		{
+			// output device reads at its own rate
+			readFrames += outFramesPerVideoFrame;
+			auto frames = std::min((uint32_t)readFrames, fillFrames);
+			readFrames -= (uint32_t)readFrames;
+			fillFrames -= frames;
+		}
+	}
+	if(resampler.droppedFrames())
+	{
+		logErr("resampler backlog test failed, dropped %u input frames", resampler.droppedFrames());
+		return false;
+	}
+	logMsg("resampler backlog test passed");
+	return true;
+}
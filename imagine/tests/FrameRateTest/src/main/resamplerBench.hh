@@ -0,0 +1,28 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+
+// Resamples test tones with IG::Audio::Resampler and nearest neighbor,
+// logging the throughput and SNR of each, then the per-second cost of
+// EmuAudio's int16 and float write paths. The comparison with the cores'
+// resamplers is in EmuFramework/tools/resamplerBench.
+void runResamplerBenchmark();
+
+// Feeds 44.1kHz input into 22.05kHz output one video frame at a time with
+// EmuAudio's backlog limit and buffer sizes, returns false if any input
+// frames were dropped
+bool runResamplerBacklogTest();
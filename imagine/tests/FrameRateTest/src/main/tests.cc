@@ -28,6 +28,7 @@ const char *testIDToStr(TestID id)
 		case TEST_CLEAR: return "Clear";
 		case TEST_DRAW: return "Draw";
 		case TEST_WRITE: return "Write";
+		case TEST_UPLOAD: return "Upload";
 		default: return "Unknown";
 	}
 }
@@ -353,3 +354,37 @@ void WriteTest::deinitTest()
 	texture.renderer().deleteSyncFence(fence);
 	DrawTest::deinitTest();
 }
+
+void UploadTest::frameUpdateTest(Gfx::RendererTask &rendererTask, Base::Screen &screen, IG::FrameTime frameTime)
+{
+	DrawTest::frameUpdateTest(rendererTask, screen, frameTime);
+	auto lockStart = IG::steadyClockTimestamp();
+	auto lockedBuff = texture.lock(0);
+	auto lockTime = IG::steadyClockTimestamp() - lockStart;
+	if(!lockedBuff)
+	{
+		logErr("texture doesn't support lock()");
+		shouldEndTest = true;
+		return;
+	}
+	auto pix = lockedBuff.pixmap();
+	// vary the contents so every upload carries new data
+	memset(pix.pixel({}), frames & 0xFF, pix.pitchBytes() * pix.h());
+	auto unlockTime = IG::timeFunc([&](){ texture.unlock(lockedBuff); });
+	auto time = lockTime + unlockTime;
+	uploadTime += time;
+	maxUploadTime = std::max(maxUploadTime, time);
+	uploads++;
+}
+
+void UploadTest::deinitTest()
+{
+	if(uploads)
+	{
+		auto size = texture.size(0);
+		logMsg("%dx%d upload: %.3fus average, %.3fus max over %u frames", size.x, size.y,
+			std::chrono::duration<double, std::micro>(uploadTime).count() / uploads,
+			std::chrono::duration<double, std::micro>(maxUploadTime).count(), uploads);
+	}
+	DrawTest::deinitTest();
+}
@@ -26,6 +26,7 @@ enum TestID
 	TEST_CLEAR,
 	TEST_DRAW,
 	TEST_WRITE,
+	TEST_UPLOAD,
 };
 
 struct FramePresentTime
@@ -146,5 +147,21 @@ public:
 	void deinitTest() override;
 };
 
+// Streams a new frame into the texture each update without waiting on the
+// previous draw, timing the lock() & unlock() calls made by the caller
+class UploadTest : public DrawTest
+{
+protected:
+	IG::Time uploadTime{};
+	IG::Time maxUploadTime{};
+	uint uploads{};
+
+public:
+	UploadTest() {}
+
+	void frameUpdateTest(Gfx::RendererTask &rendererTask, Base::Screen &screen, IG::FrameTime frameTime) override;
+	void deinitTest() override;
+};
+
 TestFramework *startTest(Base::Window &win, Gfx::Renderer &r, const TestParams &t);
 const char *testIDToStr(TestID id);